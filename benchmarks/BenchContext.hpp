@@ -0,0 +1,81 @@
+#ifndef BENCHCONTEXT_H
+#define BENCHCONTEXT_H
+#pragma once
+
+/**
+ * Shared setup for the benchmarks in this directory. Each benchmark is a single translation unit
+ * that compiles the library in:
+ *
+ * g++ -std=c++17 -O2 -I../single_header -I<glad, glm and stb include dirs> BufferUploadBench.cpp glad.c -lEGL -lpthread
+ *
+ * The context is created headless through EGL's surfaceless platform (Mesa, NVIDIA), no window is needed.
+ * Numbers from a software rasterizer like llvmpipe only say something about the CPU side.
+ */
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace EaseGL
+{
+	/** @brief Makes an OpenGL 4.5 core context current and loads the GL functions, false if that isn't possible */
+	inline bool CreateBenchContext()
+	{
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if(getPlatformDisplay == nullptr)
+		{
+			std::printf("ERROR: EGL_EXT_platform_base is not supported\n");
+			return false;
+		}
+
+		EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		EGLint major, minor;
+		if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+		{
+			std::printf("ERROR: Couldn't initialize a surfaceless EGL display\n");
+			return false;
+		}
+		eglBindAPI(EGL_OPENGL_API);
+
+		EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		EGLConfig config = nullptr;
+		EGLint configCount = 0;
+		eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+		EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 4,
+			EGL_CONTEXT_MINOR_VERSION, 5,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		EGLContext context = eglCreateContext(display, configCount > 0 ? config : nullptr, EGL_NO_CONTEXT, contextAttributes);
+		if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+		{
+			std::printf("ERROR: Couldn't create an OpenGL 4.5 core context\n");
+			return false;
+		}
+		return gladLoadGLLoader((GLADloadproc)eglGetProcAddress) != 0;
+	}
+
+	/** @brief Best wall time of 'repeats' runs of 'function', in milliseconds. The first call is a warm up */
+	template<typename Function>
+	double BenchBestOf(int repeats, Function function)
+	{
+		function();
+		double best = 1e30;
+		for(int i = 0; i < repeats; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			function();
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count());
+		}
+		return best;
+	}
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,97 @@
+// Time per GLBuffer::Upload() plus a draw reading the buffer, for every upload strategy and a range of sizes.
+// The draw makes the GPU hold on to the data, which is what separates the strategies.
+#define EASEGL_IMPLEMENTATION
+#include "BenchContext.hpp"
+#include <EaseGL.hpp>
+
+#include <vector>
+
+using namespace EaseGL;
+
+static GLuint CreatePointProgram()
+{
+   const char* vertexSource = "#version 330 core\nlayout(location = 0) in vec4 a_Pos;\nvoid main() { gl_Position = vec4(a_Pos.xy, 0.0, 1.0); gl_PointSize = 1.0; }\n";
+   const char* fragmentSource = "#version 330 core\nout vec4 o_Color;\nvoid main() { o_Color = vec4(1.0); }\n";
+   GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+   GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+   glShaderSource(vertex, 1, &vertexSource, nullptr);
+   glShaderSource(fragment, 1, &fragmentSource, nullptr);
+   glCompileShader(vertex);
+   glCompileShader(fragment);
+   GLuint program = glCreateProgram();
+   glAttachShader(program, vertex);
+   glAttachShader(program, fragment);
+   glLinkProgram(program);
+   glDeleteShader(vertex);
+   glDeleteShader(fragment);
+   return program;
+}
+
+int main()
+{
+   if(!CreateBenchContext())
+      return 1;
+
+   // draws go to an offscreen target, there is no default framebuffer
+   GLuint framebuffer, target, vertexArray;
+   glGenFramebuffers(1, &framebuffer);
+   glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+   glGenTextures(1, &target);
+   glBindTexture(GL_TEXTURE_2D, target);
+   glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 256, 256);
+   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+   glViewport(0, 0, 256, 256);
+   GLuint program = CreatePointProgram();
+   glUseProgram(program);
+   glGenVertexArrays(1, &vertexArray);
+   glBindVertexArray(vertexArray);
+   glEnableVertexAttribArray(0);
+
+   const char* strategyNames[] = { "AUTO", "SUB_DATA", "ORPHAN", "MAP_INVALIDATE", "MAP_UNSYNCHRONIZED" };
+   const size_t sizes[] = { 4 << 10, 64 << 10, 1 << 20, 4 << 20 };
+
+   std::printf("%-20s", "us per upload+draw");
+   for(size_t size : sizes)
+      std::printf("%10zuKB", size >> 10);
+   std::printf("\n");
+
+   for(int strategy = (int)GLBufferUploadStrategy::SUB_DATA; strategy <= (int)GLBufferUploadStrategy::MAP_UNSYNCHRONIZED; strategy++)
+   {
+      std::printf("%-20s", strategyNames[strategy]);
+      for(size_t size : sizes)
+      {
+         std::vector<float> data(size / sizeof(float));
+         for(size_t i = 0; i < data.size(); i++)
+            data[i] = (float)((i * 7919) % 1000) / 1000.0f - 0.5f;
+
+         // the ring needs room for a few frames in flight
+         GLBuffer buffer(GLBufferType::ARRAY_BUFFER);
+         uint32_t capacity = (uint32_t)(strategy == (int)GLBufferUploadStrategy::MAP_UNSYNCHRONIZED ? size * 4 : size);
+         buffer.BufferData(nullptr, capacity, GLBufferUsage::STREAM_DRAW);
+         buffer.SetUploadStrategy((GLBufferUploadStrategy)strategy);
+
+         const int frames = size >= (1 << 20) ? 60 : 400;
+         double milliseconds = BenchBestOf(3, [&]()
+         {
+            for(int frame = 0; frame < frames; frame++)
+            {
+               GLintptr offset = buffer.Upload(data.data(), (GLsizeiptr)size, 0);
+               buffer.Bind();
+               glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 16, (const void*)offset);
+               glDrawArrays(GL_POINTS, 0, (GLsizei)std::min<size_t>(size / 16, 256));
+               glFlush();
+            }
+            glFinish();
+         });
+         std::printf("%12.1f", milliseconds * 1000.0 / frames);
+         std::fflush(stdout);
+      }
+      std::printf("\n");
+   }
+
+   glDeleteVertexArrays(1, &vertexArray);
+   glDeleteProgram(program);
+   glDeleteTextures(1, &target);
+   glDeleteFramebuffers(1, &framebuffer);
+   return glGetError() == GL_NO_ERROR ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// Source bytes converted per second by each PixelConvert kernel, against a plain per-pixel loop.
+// No GL context is needed. Build once per instruction set to compare backends, e.g. with
+// -DEASEGL_PIXELCONVERT_SCALAR, -mssse3, -mavx2 and -mavx2 -mf16c.
+//
+// usage: PixelConvertBench [width] [height]
+#define EASEGL_IMPLEMENTATION
+#include "BenchContext.hpp"
+#include <EaseGL.hpp>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace EaseGL;
+
+static const int ITERATIONS = 20;
+
+template<typename Function>
+static void Report(const char* name, size_t sourceBytes, Function function)
+{
+   double milliseconds = BenchBestOf(10, [&]()
+   {
+      for(int i = 0; i < ITERATIONS; i++)
+         function();
+   });
+   std::printf("  %-20s %8.2f GB/s\n", name, (double)sourceBytes * ITERATIONS / (milliseconds / 1000.0) / 1e9);
+}
+
+int main(int argc, char** argv)
+{
+   int width = argc > 1 ? std::atoi(argv[1]) : 1024;
+   int height = argc > 2 ? std::atoi(argv[2]) : 1024;
+   size_t pixelCount = (size_t)width * height;
+
+   std::mt19937 random(1);
+   std::vector<uint8_t> source(pixelCount * 4);
+   for(uint8_t& value : source)
+      value = (uint8_t)random();
+   std::vector<uint8_t> destination(pixelCount * 4);
+   std::vector<uint16_t> halves(pixelCount * 4);
+
+   std::printf("%s backend, %dx%d, source bytes per second\n", PixelConvert::Backend(), width, height);
+
+   Report("rgb -> rgba", pixelCount * 3, [&]() { PixelConvert::RGBToRGBA(source.data(), destination.data(), pixelCount); });
+   Report("rgb -> rgba (loop)", pixelCount * 3, [&]()
+   {
+      const uint8_t* rgb = source.data();
+      uint8_t* rgba = destination.data();
+      for(size_t i = 0; i < pixelCount; i++)
+      {
+         rgba[i * 4 + 0] = rgb[i * 3 + 0];
+         rgba[i * 4 + 1] = rgb[i * 3 + 1];
+         rgba[i * 4 + 2] = rgb[i * 3 + 2];
+         rgba[i * 4 + 3] = 255;
+      }
+   });
+
+   Report("premultiply", pixelCount * 4, [&]() { PixelConvert::PremultiplyAlpha(source.data(), destination.data(), pixelCount); });
+   Report("premultiply (loop)", pixelCount * 4, [&]()
+   {
+      const uint8_t* rgba = source.data();
+      uint8_t* out = destination.data();
+      for(size_t i = 0; i < pixelCount; i++)
+      {
+         uint32_t alpha = rgba[i * 4 + 3];
+         for(int channel = 0; channel < 3; channel++)
+            out[i * 4 + channel] = (uint8_t)((rgba[i * 4 + channel] * alpha + 127) / 255);
+         out[i * 4 + 3] = (uint8_t)alpha;
+      }
+   });
+
+   Report("swap red/blue", pixelCount * 4, [&]() { PixelConvert::SwapRedBlue(source.data(), destination.data(), pixelCount); });
+   Report("u8 -> half", pixelCount * 4, [&]() { PixelConvert::ToHalf(source.data(), halves.data(), pixelCount * 4); });
+   Report("gray -> rg", pixelCount, [&]() { PixelConvert::GrayToRG(source.data(), destination.data(), pixelCount); });
+
+   // one mip step of the whole image, rows are 'width' rgba pixels
+   Report("halve box (rgba)", pixelCount * 4, [&]()
+   {
+      size_t rowBytes = (size_t)width * 4;
+      for(int y = 0; y + 1 < height; y += 2)
+      {
+         const uint8_t* row0 = source.data() + (size_t)y * rowBytes;
+         PixelConvert::HalveBox(row0, row0 + rowBytes, destination.data() + (size_t)(y / 2) * (width / 2) * 4, width / 2, 4);
+      }
+   });
+   return 0;
+}
@@ -0,0 +1,96 @@
+// Startup time of loading a set of shaders without the program binary cache, with an empty cache (cold)
+// and with a filled one (warm). Drivers keep their own shader cache (Mesa's also backs its program binaries),
+// so every source set is salted with a fresh value and the cold runs really compile.
+//
+// usage: ProgramCacheBench [shader count] [scratch directory]
+#define EASEGL_IMPLEMENTATION
+#include "BenchContext.hpp"
+#include <EaseGL.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace EaseGL;
+
+// distinct programs, so neither the cache nor the driver can share work between them
+static void WriteShader(const std::string& path, int index, unsigned int salt)
+{
+   std::ofstream file(path);
+   file << "#shader vertex\n#version 330 core\n// salt " << salt << "\n"
+      << "layout(location = 0) in vec3 a_Pos;\nuniform mat4 u_Model;\nout vec3 v_Pos;\n"
+      << "void main() {\n   v_Pos = a_Pos * " << index + 1 << ".0;\n"
+      << "   for(int i = 0; i < 8; i++) v_Pos = sin(v_Pos) + cos(v_Pos * float(i));\n"
+      << "   gl_Position = u_Model * vec4(v_Pos, 1.0);\n}\n"
+      << "#shader fragment\n#version 330 core\n"
+      << "in vec3 v_Pos;\nout vec4 o_Color;\nuniform sampler2D u_Texture;\n"
+      << "void main() {\n   vec4 color = texture(u_Texture, v_Pos.xy);\n"
+      << "   for(int i = 0; i < 16; i++) color = color * 0.5 + vec4(sin(color.x * " << index + 1 << ".0));\n"
+      << "   o_Color = color;\n}\n";
+}
+
+static std::vector<std::string> WriteShaders(const std::filesystem::path& directory, int count)
+{
+   static unsigned int salt = (unsigned int)std::chrono::steady_clock::now().time_since_epoch().count();
+   salt++;
+
+   std::filesystem::create_directories(directory);
+   std::vector<std::string> paths;
+   for(int i = 0; i < count; i++)
+   {
+      paths.push_back((directory / ("shader" + std::to_string(i) + ".glsl")).string());
+      WriteShader(paths.back(), i, salt);
+   }
+   return paths;
+}
+
+static double LoadAll(const std::vector<std::string>& paths)
+{
+   auto start = std::chrono::steady_clock::now();
+   {
+      std::vector<Shader> shaders;
+      shaders.reserve(paths.size());
+      for(const std::string& path : paths)
+         shaders.emplace_back(path.c_str());
+      glFinish();
+   }
+   std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+   return elapsed.count();
+}
+
+int main(int argc, char** argv)
+{
+   int count = argc > 1 ? std::atoi(argv[1]) : 100;
+   std::filesystem::path scratch = argc > 2 ? std::filesystem::path(argv[2]) : std::filesystem::temp_directory_path() / "easegl_program_cache_bench";
+
+   if(!CreateBenchContext())
+      return 1;
+
+   std::error_code error;
+   std::filesystem::remove_all(scratch, error);
+   double uncached = LoadAll(WriteShaders(scratch / "uncached", count));
+
+   ProgramBinaryCache::SetDirectory((scratch / "cache").string());
+   if(!ProgramBinaryCache::IsAvailable())
+   {
+      std::printf("ERROR: The driver doesn't support program binaries\n");
+      return 1;
+   }
+
+   std::vector<std::string> paths = WriteShaders(scratch / "cached", count);
+   ProgramBinaryCache::ResetStats();
+   double cold = LoadAll(paths);
+   ProgramBinaryCache::ResetStats();
+   double warm = LoadAll(paths);
+   const ProgramBinaryCacheStats& stats = ProgramBinaryCache::GetStats();
+
+   std::printf("%d programs\n", count);
+   std::printf("  no cache   %8.1f ms\n", uncached);
+   std::printf("  cold cache %8.1f ms (compiles and stores)\n", cold);
+   std::printf("  warm cache %8.1f ms (%u hits, %u misses, %u rejected)\n", warm, stats.hits, stats.misses, stats.rejected);
+
+   std::filesystem::remove_all(scratch, error);
+   return 0;
+}
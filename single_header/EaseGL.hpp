@@ -29,8 +29,28 @@
  * EaseGL::GLBuffer buffer = IndexBuffer::New();
  * 
  * EaseGL::GLTexture texture = Texture2D::New();
+ * EaseGL::TextureCreateInfo createInfo; createInfo.format = EaseGL::TextureFormat::RGBA16F; Texture2D::New("sky.hdr", createInfo);
+ * EaseGL::GLTexture::GetMemoryStats().cpuBytes; // decoded pixels still in RAM, see TextureCreateInfo::residency
+ * texture.Update({ x, y, width, height }, pixels); // per frame updates through a ring of PBOs, see TextureCreateInfo::updateBuffers
+ * shader.Uniform("u_Texture", texture, EaseGL::SamplerDesc::Anisotropic(8.0f), 0); // shared GL sampler objects, see SamplerCache
+ * EaseGL::GLTexture tiles = Texture2DArray::New({ "grass.png", "dirt.png" }); tiles.SubImageLayer(1, 0, 0, w, h, 4, pixels);
+ * EaseGL::GLTexture compressed = Texture2D::NewCompressed("texture.ktx2");
+ * EaseGL::GLTexture::BindTextures(0, { &albedo, &normal }); // redundant binds are skipped, see GLContext::GetTextureBindingStats()
+ * EaseGL::TextureLoader loader; std::shared_ptr<EaseGL::GLTexture> async = loader.Load("texture.png"); loader.Update(2.0);
+ * EaseGL::TextureAtlas atlas; atlas.InsertFiles({ "a.png", "b.png" }); atlas.Find("a.png")->TransformUV(uv);
+ * EaseGL::PixelConvert::RGBToRGBA(rgb, rgba, pixelCount); // SIMD when available, see PixelConvert::Backend()
+ * EaseGL::TextureCreateInfo info; info.mipFilter = EaseGL::MipFilter::KAISER; // CPU mip chain, MipGenerator::SetCacheDirectory("cache/mips")
  * 
  * EaseGL::Shader
+ * EaseGL::ProgramBinaryCache::SetDirectory("cache/shaders");
+ * std::shared_ptr<EaseGL::Shader> shared = EaseGL::ShaderRegistry::Load("shader.glsl");
+ * EaseGL::ShaderBatch batch; batch.Add("shader.glsl"); batch.Poll();
+ * EaseGL::ShaderVariants variants("shader.glsl", { "KEYWORD" }); variants.Get(variants.Mask({ "KEYWORD" }));
+ * 
+ * EaseGL::StreamBuffer stream(GLBufferType::ARRAY_BUFFER, regionSize);
+ * EaseGL::BufferArena arena(GLBufferType::ARRAY_BUFFER, pageSize);
+ * 
+ * EaseGL::UniformBlock<UniformLayout<BlockLayout::STD140, glm::mat4, glm::vec3>> block;
  */
 
 
@@ -46,6 +66,72 @@
 #define GLBUFFER_H
 
 #include <glad/glad.h>
+/*-- #include "src/GLObjectPool.hpp" start --*/
+#ifndef GLOBJECTPOOL_H
+#define GLOBJECTPOOL_H
+
+#include <glad/glad.h>
+#include <cstdint>
+
+namespace EaseGL
+{
+	enum class GLObjectType
+	{
+		NONE = 0,
+		BUFFER,
+		TEXTURE,
+		VERTEX_ARRAY,
+		FRAMEBUFFER,
+		RENDERBUFFER,
+		PROGRAM,
+		SAMPLER,
+	};
+
+	/**
+	 * @brief Generational reference to a GL object owned by GLObjectPool.
+	 * A handle becomes stale once its object is destroyed, even if the slot or the GL name gets reused.
+	 */
+	struct GLHandle
+	{
+		uint32_t index = 0xFFFFFFFF;
+		uint32_t generation = 0;
+
+		bool operator==(const GLHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const GLHandle& other) const { return !(*this == other); }
+	};
+
+	/**
+	 * @brief Table of every GL object created by EaseGL.
+	 * Names are generated in batches (one glGen* call per SetBatchSize() objects) and handed out from per type pools.
+	 * GLBuffer, GLTexture, VertexArray, Shader and Framebuffer are move-only owners of a GLHandle.
+	 */
+	class GLObjectPool
+	{
+		private:
+			GLObjectPool() {}
+
+			static GLuint TakeName(GLObjectType type);
+		public:
+			static GLHandle Create(GLObjectType type);
+			// Deletes the GL object, 'handle' and its copies become invalid
+			static void Destroy(GLHandle& handle);
+
+			static bool IsValid(GLHandle handle);
+			// 0 if the handle is stale
+			static GLuint Name(GLHandle handle);
+			static GLObjectType Type(GLHandle handle);
+
+			static void SetBatchSize(uint32_t count);
+			// Deletes pre-generated names that were never handed out
+			static void ReleaseUnusedNames();
+
+			static uint32_t LiveObjectCount();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/GLObjectPool.hpp" end --*/
 
 namespace EaseGL
 {
@@ -55,6 +141,10 @@ namespace EaseGL
 		ARRAY_BUFFER,
 		ELEMENT_ARRAY_BUFFER,
 		UNIFORM_BUFFER,
+		SHADER_STORAGE_BUFFER,
+		DISPATCH_INDIRECT_BUFFER,
+		DRAW_INDIRECT_BUFFER,
+		PIXEL_UNPACK_BUFFER,
 	};
 
 	enum class GLBufferUsage
@@ -65,6 +155,15 @@ namespace EaseGL
 		STREAM_DRAW,
 	};
 
+	enum class GLBufferUploadStrategy
+	{
+		AUTO = 0,           // picked from GLBufferUsage
+		SUB_DATA,           // glBufferSubData
+		ORPHAN,             // respecify storage with glBufferData(NULL) then glBufferSubData, previous contents are lost
+		MAP_INVALIDATE,     // glMapBufferRange with GL_MAP_INVALIDATE_RANGE_BIT
+		MAP_UNSYNCHRONIZED, // appends to a ring inside the buffer with GL_MAP_UNSYNCHRONIZED_BIT, guarded by fences
+	};
+
 	class GLBuffer  
 	{
 		private:
@@ -74,6 +173,26 @@ namespace EaseGL
 			GLenum GetGLBufferUsage(GLBufferUsage usage) const;
 
 			GLuint m_BufferID;
+			GLHandle m_Handle;
+
+			GLsizeiptr m_Size;
+			GLBufferUsage m_Usage;
+			GLBufferUploadStrategy m_UploadStrategy;
+
+			// MAP_UNSYNCHRONIZED ring state, the buffer is split into RING_SEGMENTS fenced segments
+			static constexpr int RING_SEGMENTS = 4;
+			GLintptr m_RingHead;
+			int m_RingSegment;
+			GLsync m_RingFences[RING_SEGMENTS];
+
+			// set by BufferStorage(), the store can't be respecified
+			bool m_Immutable;
+
+			// respecifies the store with 'size' bytes, the first 'keepBytes' of the old store are copied over
+			void Grow(GLsizeiptr size, GLsizeiptr keepBytes);
+			GLintptr UploadUnsynchronized(const void* data, GLsizeiptr size);
+			void DeleteRingFences();
+			void MoveFrom(GLBuffer& other);
 
 			friend class Shader;
 		public:
@@ -82,19 +201,52 @@ namespace EaseGL
 			GLBuffer(GLBufferType bufferType);
 			~GLBuffer();
 
+			GLBuffer(const GLBuffer&) = delete;
+			GLBuffer& operator=(const GLBuffer&) = delete;
+			GLBuffer(GLBuffer&& other) noexcept;
+			GLBuffer& operator=(GLBuffer&& other) noexcept;
+
 			/**
 			 * @brief Call when buffer objects needs to be created/recreated
 			 */
 			void RecreateBuffer();
 
-			void BufferData(const void* data, uint32_t size, GLBufferUsage usage) const;
+			void BufferData(const void* data, uint32_t size, GLBufferUsage usage);
 			void BufferSubData(const void* data, GLintptr offset, GLsizeiptr size) const;
 
+			/**
+			 * @brief Writes 'size' bytes with the buffer's upload strategy, BufferData() has to be called first.
+			 * Writing past the end grows the buffer, bytes before 'offset' are kept (except for ORPHAN and MAP_UNSYNCHRONIZED)
+			 * 
+			 * @return offset the data was written to. Same as 'offset', except for MAP_UNSYNCHRONIZED
+			 *         which ignores 'offset' and appends to a ring, with 16 byte alignment.
+			 *         -1 if the data doesn't fit storage allocated with BufferStorage()
+			 */
+			GLintptr Upload(const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+			void SetUploadStrategy(GLBufferUploadStrategy strategy) { m_UploadStrategy = strategy; }
+			// AUTO is resolved from the usage of the last BufferData() call
+			GLBufferUploadStrategy GetUploadStrategy() const;
+
+			GLsizeiptr Size() const { return m_Size; }
+
+			/**
+			 * @brief Allocates immutable storage, size can't be changed afterwards
+			 * 
+			 * @param flags combination of GL_MAP_*_BIT and GL_DYNAMIC_STORAGE_BIT
+			 */
+			void BufferStorage(const void* data, GLsizeiptr size, GLbitfield flags);
+
 			void* MapBuffer();
+			void* MapBufferRange(GLintptr offset, GLsizeiptr length, GLbitfield access);
 			void UnmapBuffer();
 			void BindBufferBase(GLuint bufferIndex);
+			void BindBufferRange(GLuint bufferIndex, GLintptr offset, GLsizeiptr size);
 
 			void Bind() const;
+
+			operator GLuint() const { return m_BufferID; }
+			GLHandle Handle() const { return m_Handle; }
 	};
 } // namespace EaseGL
 #endif
@@ -145,7 +297,6 @@ namespace EaseGL
 		public:
 			static GLBuffer New()
 			{
-				std::cout << "DONT USE UNIFORM BUFFERS YET!" << std::endl;
 				return GLBuffer(GLBufferType::UNIFORM_BUFFER);
 			}
 			static void Unbind()
@@ -158,179 +309,238 @@ namespace EaseGL
 		public:
 			~UniformBuffer() {}
 	};
-} // namespace EaseGL
-
-#endif
-/*-- #include "src/Buffer.hpp" end --*/
-#ifdef EASEGL_IMPLEMENTATION
-
-namespace EaseGL
-{
-   
-} // namespace EaseGL
-
-
-#endif
-/*-- File: src/Buffer.cpp end --*/
-/*-- File: src/Framebuffer.cpp start --*/
-/*-- #include "src/Framebuffer.hpp" start --*/
-#ifndef FRAMEBUFFER_H
-#define FRAMEBUFFER_H
 
-#include <glad/glad.h>
-/*-- #include "src/Texture.hpp" start --*/
-#ifndef TEXTURE_H
-#define TEXTURE_H
-	
-#include <glad/glad.h>
-/*-- #include "src/GLTexture.hpp" start --*/
-#ifndef GLTEXTURE_H
-#define GLTEXTURE_H
-	
-#include <glad/glad.h>
-#include <string>
-
-namespace EaseGL
-{
-	enum class TextureType
+	struct ShaderStorageBuffer
 	{
-		NONE = 0,
-		TEXTURE2D,
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::SHADER_STORAGE_BUFFER);
+			}
+			static void Unbind()
+			{
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			}
 
-		// Cubemap, 1d, 3d textures
-	};
-	
-	class GLTexture 
-	{
 		private:
-			GLuint m_TextureID;
-			TextureType m_TextureType;
-
-			int m_Width, m_Height, m_Channels;
-			unsigned char* m_Pixels;
-
-			std::string m_Filepath;
-
-			GLenum GetGLTextureType() const;
-
-			void GenTextures();
-			void DeleteTextures();
+			ShaderStorageBuffer() {}
 		public:
-			GLTexture() : m_TextureType(TextureType::TEXTURE2D), m_Pixels(nullptr), m_Width(0), m_Height(0), m_Channels(0), m_TextureID(0), m_Filepath("") {};
-			GLTexture(GLuint textureID, TextureType textureType);
+			~ShaderStorageBuffer() {}
+	};
 
-			void LoadTexture(const char* filepath);
+	struct DispatchIndirectCommand
+	{
+		GLuint numGroupsX;
+		GLuint numGroupsY;
+		GLuint numGroupsZ;
+	};
 
-			int Width() { return m_Width; }
-			int Height() { return m_Height; }
+	struct DrawArraysIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint first;
+		GLuint baseInstance;
+	};
 
-			GLTexture(TextureType type);
-			GLTexture(TextureType type, const char* filepath);
-			~GLTexture();
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
 
-			operator GLuint() { return m_TextureID; }
+	// Holds DispatchIndirectCommand structs, see Shader::DispatchIndirect
+	struct DispatchIndirectBuffer
+	{
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::DISPATCH_INDIRECT_BUFFER);
+			}
+			static void Unbind()
+			{
+				glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+			}
 
-			void Bind(int slot = 0) const;
+		private:
+			DispatchIndirectBuffer() {}
+		public:
+			~DispatchIndirectBuffer() {}
 	};
-} // namespace EaseGL
-
-#endif
-/*-- #include "src/GLTexture.hpp" end --*/
 
-namespace EaseGL
-{
-	struct Texture2D
+	// Holds DrawArraysIndirectCommand/DrawElementsIndirectCommand structs for glDraw*Indirect
+	struct DrawIndirectBuffer
 	{
 		public:
-			static GLTexture New(const char* filepath)
+			static GLBuffer New()
 			{
-				return GLTexture(TextureType::TEXTURE2D, filepath);
+				return GLBuffer(GLBufferType::DRAW_INDIRECT_BUFFER);
 			}
-			static GLTexture New()
+			static void Unbind()
 			{
-				return GLTexture(TextureType::TEXTURE2D);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 			}
 
+		private:
+			DrawIndirectBuffer() {}
+		public:
+			~DrawIndirectBuffer() {}
+	};
+
+	// Source of glTexImage*/glTexSubImage* while bound, the pixel pointer becomes an offset into the buffer
+	struct PixelUnpackBuffer
+	{
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::PIXEL_UNPACK_BUFFER);
+			}
 			static void Unbind()
 			{
-				glBindTexture(GL_TEXTURE_2D, 0);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 			}
 
 		private:
-			Texture2D();
+			PixelUnpackBuffer() {}
 		public:
-			~Texture2D();
+			~PixelUnpackBuffer() {}
 	};
 } // namespace EaseGL
+
 #endif
-/*-- #include "src/Texture.hpp" end --*/
-#include <vector>
+/*-- #include "src/Buffer.hpp" end --*/
+#ifdef EASEGL_IMPLEMENTATION
 
 namespace EaseGL
 {
-	enum class FramebufferAttachmentFormat
-	{
-		RGB,
-		RGBA,
-		RGBA8,
-		RED_INTEGER,
+   
+} // namespace EaseGL
 
-		DEPTH24STENCIL8,
-	};
 
-	struct FrameBufferCreateInfo
-	{
-		int width = 1280;
-		int height = 720;
-		int samples = 1;
+#endif
+/*-- File: src/Buffer.cpp end --*/
+/*-- File: src/BufferArena.cpp start --*/
+/*-- #include "src/BufferArena.hpp" start --*/
+#ifndef BUFFERARENA_H
+#define BUFFERARENA_H
 
-		std::vector<FramebufferAttachmentFormat> attachments;
-		FrameBufferCreateInfo()
-			: attachments({ FramebufferAttachmentFormat::RGBA8,
-								 FramebufferAttachmentFormat::DEPTH24STENCIL8 })
-		{
-		}
+#include <glad/glad.h>
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace EaseGL
+{
+	typedef uint32_t BufferArenaHandle;
+
+	struct BufferArenaBlock
+	{
+		GLBuffer* buffer = nullptr;
+		uint32_t page = 0;
+		GLintptr offset = 0;
+		GLsizeiptr size = 0;
+		GLsizeiptr alignment = 1;
+
+		// Valid as base vertex / first index when the block was allocated with alignment == elementSize
+		GLint FirstElement(GLsizeiptr elementSize) const { return (GLint)(offset / elementSize); }
 	};
 
-	class Framebuffer  
+	/**
+	 * @brief Sub-allocates ranges of a few large GLBuffers so many meshes can share one bound buffer.
+	 * Free ranges are kept sorted by offset (for coalescing on free) and by size (for best fit).
+	 * 
+	 * BufferArena arena(GLBufferType::ARRAY_BUFFER, 64 * 1024 * 1024);
+	 * BufferArenaHandle mesh = arena.Allocate(sizeof(Vertex) * count, sizeof(Vertex));
+	 * arena.Upload(mesh, vertices, sizeof(Vertex) * count);
+	 * 
+	 * const BufferArenaBlock& block = arena.Get(mesh);
+	 * block.buffer->Bind();
+	 * glDrawArrays(GL_TRIANGLES, block.FirstElement(sizeof(Vertex)), count);
+	 * 
+	 * Offsets can change after Compact(), query them with Get() instead of caching them.
+	 */
+	class BufferArena  
 	{
 		private:
-			GLuint m_BufferID;
-			
-			struct Attachment
+			struct Page
 			{
-				GLuint id;
-				FramebufferAttachmentFormat format;
-
-				Attachment()
-					: id(0), format(FramebufferAttachmentFormat::DEPTH24STENCIL8)
-				{
-				}
+				std::unique_ptr<GLBuffer> buffer;
+				GLsizeiptr capacity = 0;
+				GLsizeiptr used = 0;
 
-				Attachment(GLuint _id, FramebufferAttachmentFormat _format)
-					: id(id), format(_format)
-				{
-				}
+				std::map<GLintptr, GLsizeiptr> freeByOffset;
+				std::multimap<GLsizeiptr, GLintptr> freeBySize;
+				std::map<GLintptr, BufferArenaHandle> allocations; // offset -> handle
 			};
-			std::vector<Attachment> m_ColorAttachments; // Texture2D
-			Attachment m_DepthAttachment;// RenderBufferObject
+
+			GLBufferType m_BufferType;
+			GLBufferUsage m_Usage;
+			GLsizeiptr m_PageSize;
+
+			std::vector<Page> m_Pages;
+
+			std::vector<BufferArenaBlock> m_Blocks; // indexed by handle
+			std::vector<BufferArenaHandle> m_FreeHandles;
+
+			// temporary storage for moves where source and destination overlap
+			std::unique_ptr<GLBuffer> m_CopyBuffer;
+			GLsizeiptr m_CopyBufferSize;
+
+			uint64_t m_Version;
+
+			uint32_t CreatePage(GLsizeiptr minimumSize);
+			bool AllocateFromPage(uint32_t pageIndex, GLsizeiptr size, GLsizeiptr alignment, GLintptr& outOffset);
+
+			void InsertFreeRange(Page& page, GLintptr offset, GLsizeiptr size);
+			void EraseFreeRange(Page& page, std::map<GLintptr, GLsizeiptr>::iterator it);
+			void RebuildFreeRanges(Page& page);
+
+			void MoveBlock(BufferArenaBlock& block, GLintptr newOffset);
 		public:
-			Framebuffer();
-			~Framebuffer();
+			static constexpr BufferArenaHandle INVALID_HANDLE = 0xFFFFFFFF;
 
-			// Create/Recreate framebuffer
-			void RecreateBuffer(const FrameBufferCreateInfo& createInfo);
+			BufferArena(GLBufferType bufferType, GLsizeiptr pageSize, GLBufferUsage usage = GLBufferUsage::STATIC_DRAW);
+			~BufferArena();
 
-			void Bind();
-			void Unbind();
+			BufferArena(const BufferArena&) = delete;
+			BufferArena& operator=(const BufferArena&) = delete;
 
-			operator GLuint() { return m_BufferID; }
+			/**
+			 * @param alignment doesn't have to be a power of two, use vertex size to be able to draw with a base vertex
+			 */
+			BufferArenaHandle Allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+			void Free(BufferArenaHandle handle);
 
-			GLuint GetColorAttachment(int at = 0) const { return m_ColorAttachments[at].id; }
+			const BufferArenaBlock& Get(BufferArenaHandle handle) const { return m_Blocks[handle]; }
+
+			void Upload(BufferArenaHandle handle, const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+			/**
+			 * @brief Incrementally slides allocations towards the start of their page with GPU side copies.
+			 * Call once per frame with a small budget to compact in the background.
+			 * 
+			 * @param maxBytes upper limit of bytes to move in this call
+			 * @return bytes moved, 0 if the arena is already compact
+			 */
+			GLsizeiptr Compact(GLsizeiptr maxBytes);
+
+			// Changes every time Compact() moves a block
+			uint64_t Version() const { return m_Version; }
+
+			size_t PageCount() const { return m_Pages.size(); }
+			GLsizeiptr BytesUsed() const;
+			GLsizeiptr BytesReserved() const;
 	};
 } // namespace EaseGL
+
 #endif
-/*-- #include "src/Framebuffer.hpp" end --*/
+
+/*-- #include "src/BufferArena.hpp" end --*/
 
 #ifdef EASEGL_IMPLEMENTATION
 #include <glad/glad.h>
@@ -338,201 +548,1953 @@ namespace EaseGL
 
 namespace EaseGL
 {
-   Framebuffer::Framebuffer()
-      : m_BufferID(0)
+   GLintptr AlignArenaOffset(GLintptr offset, GLsizeiptr alignment)
    {
-      
+      return ((offset + alignment - 1) / alignment) * alignment;
    }
-      
-   Framebuffer::~Framebuffer()
+
+   BufferArena::BufferArena(GLBufferType bufferType, GLsizeiptr pageSize, GLBufferUsage usage /* = GLBufferUsage::STATIC_DRAW*/)
+      : m_BufferType(bufferType), m_Usage(usage), m_PageSize(pageSize), m_CopyBufferSize(0), m_Version(0)
    {
-      
    }
-   
-   bool IsColorAttachment(FramebufferAttachmentFormat format)
+
+   BufferArena::~BufferArena()
    {
-      return format == FramebufferAttachmentFormat::RGBA8 
-         || format == FramebufferAttachmentFormat::RGB
-         || format == FramebufferAttachmentFormat::RGBA
-         || format == FramebufferAttachmentFormat::RED_INTEGER;
    }
 
-   bool IsDepthAttachment(FramebufferAttachmentFormat format)
+   uint32_t BufferArena::CreatePage(GLsizeiptr minimumSize)
    {
-      return format == FramebufferAttachmentFormat::DEPTH24STENCIL8;
+      Page page;
+      page.capacity = minimumSize > m_PageSize ? minimumSize : m_PageSize;
+      page.buffer = std::make_unique<GLBuffer>(m_BufferType);
+      page.buffer->BufferData(nullptr, (uint32_t)page.capacity, m_Usage);
+      InsertFreeRange(page, 0, page.capacity);
+
+      m_Pages.push_back(std::move(page));
+      return (uint32_t)m_Pages.size() - 1;
    }
 
-   GLenum GetAttachmentFormat(FramebufferAttachmentFormat format)
+   void BufferArena::EraseFreeRange(Page& page, std::map<GLintptr, GLsizeiptr>::iterator it)
    {
-      return format == FramebufferAttachmentFormat::RGBA8 ? GL_RGBA8
-           : format == FramebufferAttachmentFormat::RGB ? GL_RGB
-           : format == FramebufferAttachmentFormat::RGBA ? GL_RGBA
-           : format == FramebufferAttachmentFormat::DEPTH24STENCIL8 ? GL_RGBA
-           : format == FramebufferAttachmentFormat::RED_INTEGER ? GL_RED_INTEGER
-           : GL_NONE;
+      auto range = page.freeBySize.equal_range(it->second);
+      for(auto sizeIt = range.first; sizeIt != range.second; ++sizeIt)
+      {
+         if(sizeIt->second == it->first)
+         {
+            page.freeBySize.erase(sizeIt);
+            break;
+         }
+      }
+      page.freeByOffset.erase(it);
    }
-   GLenum GetAttachmentInternalFormat(FramebufferAttachmentFormat format)
+
+   void BufferArena::InsertFreeRange(Page& page, GLintptr offset, GLsizeiptr size)
    {
-      return format == FramebufferAttachmentFormat::RGBA8 ? GL_RGBA8
-           : format == FramebufferAttachmentFormat::RGB ? GL_RGB
-           : format == FramebufferAttachmentFormat::RGBA ? GL_RGBA
-           : format == FramebufferAttachmentFormat::DEPTH24STENCIL8 ? GL_RGBA
-           : format == FramebufferAttachmentFormat::RED_INTEGER ? GL_R32I
-           : GL_NONE;
+      // coalesce with the following range
+      auto next = page.freeByOffset.lower_bound(offset);
+      if(next != page.freeByOffset.end() && offset + size == next->first)
+      {
+         size += next->second;
+         EraseFreeRange(page, next);
+      }
+
+      // coalesce with the previous range
+      auto it = page.freeByOffset.lower_bound(offset);
+      if(it != page.freeByOffset.begin())
+      {
+         auto prev = std::prev(it);
+         if(prev->first + prev->second == offset)
+         {
+            offset = prev->first;
+            size += prev->second;
+            EraseFreeRange(page, prev);
+         }
+      }
+
+      page.freeByOffset[offset] = size;
+      page.freeBySize.emplace(size, offset);
    }
 
-   void Framebuffer::RecreateBuffer(const FrameBufferCreateInfo& createInfo)
+   void BufferArena::RebuildFreeRanges(Page& page)
    {
-      if(m_BufferID != 0)
+      page.freeByOffset.clear();
+      page.freeBySize.clear();
+
+      GLintptr cursor = 0;
+      for(const auto& allocation : page.allocations)
       {
-         glDeleteFramebuffers(1, &m_BufferID);
-         m_BufferID = 0;
+         if(allocation.first > cursor)
+         {
+            page.freeByOffset[cursor] = allocation.first - cursor;
+            page.freeBySize.emplace(allocation.first - cursor, cursor);
+         }
+         cursor = allocation.first + m_Blocks[allocation.second].size;
       }
 
-      glGenFramebuffers(1, &m_BufferID);
-      glBindFramebuffer(GL_FRAMEBUFFER, m_BufferID);
+      if(cursor < page.capacity)
+      {
+         page.freeByOffset[cursor] = page.capacity - cursor;
+         page.freeBySize.emplace(page.capacity - cursor, cursor);
+      }
+   }
 
-      bool hasDepthAttachment = false;
-      int colorAttachmentCount = 0;
-      for(const FramebufferAttachmentFormat& attachment : createInfo.attachments)
+   bool BufferArena::AllocateFromPage(uint32_t pageIndex, GLsizeiptr size, GLsizeiptr alignment, GLintptr& outOffset)
+   {
+      Page& page = m_Pages[pageIndex];
+      if(page.capacity - page.used < size)
+         return false;
+
+      // best fit, smallest free range that still fits after alignment
+      for(auto it = page.freeBySize.lower_bound(size); it != page.freeBySize.end(); ++it)
       {
-         if(IsDepthAttachment(attachment))
-            hasDepthAttachment = true;
-         else if(IsColorAttachment(attachment))
-            m_ColorAttachments.emplace_back(0, attachment);
+         GLintptr start = it->second;
+         GLintptr end = start + it->first;
+         GLintptr offset = AlignArenaOffset(start, alignment);
+         if(offset + size > end)
+            continue;
+
+         EraseFreeRange(page, page.freeByOffset.find(start));
+         if(offset > start)
+            InsertFreeRange(page, start, offset - start);
+         if(offset + size < end)
+            InsertFreeRange(page, offset + size, end - (offset + size));
+
+         outOffset = offset;
+         return true;
       }
-      
-      for(int i=0; i<m_ColorAttachments.size(); i++)
-         glGenTextures(1, &m_ColorAttachments[i].id);
+      return false;
+   }
 
-      if(createInfo.samples > 1)
-         std::cout << "SAMPLES DOESNT WORK" << std::endl;
+   BufferArenaHandle BufferArena::Allocate(GLsizeiptr size, GLsizeiptr alignment /* = 4*/)
+   {
+      if(size <= 0)
+         return INVALID_HANDLE;
+      if(alignment <= 0)
+         alignment = 1;
+
+      uint32_t pageIndex = 0;
+      GLintptr offset = 0;
+      bool found = false;
+      for(; pageIndex < m_Pages.size(); pageIndex++)
+      {
+         if(AllocateFromPage(pageIndex, size, alignment, offset))
+         {
+            found = true;
+            break;
+         }
+      }
 
-      for(int i = 0; i < m_ColorAttachments.size(); i++)
+      if(!found)
       {
-         glBindTexture(GL_TEXTURE_2D, m_ColorAttachments[i].id);
-         glTexImage2D(GL_TEXTURE_2D, 0, // level
-               GetAttachmentInternalFormat(m_ColorAttachments[i].format), // internal format
-               createInfo.width, createInfo.height,
-               0, // border
-               GetAttachmentFormat(m_ColorAttachments[i].format), // format
-               GL_UNSIGNED_BYTE, // type
-               NULL); // pixels
-         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-         if(IsColorAttachment(createInfo.attachments[i]))
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+i, GL_TEXTURE_2D, m_ColorAttachments[i].id, 0);
+         pageIndex = CreatePage(size + alignment - 1);
+         if(!AllocateFromPage(pageIndex, size, alignment, offset))
+         {
+            std::cout << "ERROR: BufferArena failed to allocate " << size << " bytes" << std::endl;
+            return INVALID_HANDLE;
+         }
       }
 
-      if(hasDepthAttachment)
+      BufferArenaHandle handle;
+      if(!m_FreeHandles.empty())
       {
-         glGenRenderbuffers(1, &m_DepthAttachment.id);
-         glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment.id);
-         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, createInfo.width, createInfo.height);
-         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment.id);
+         handle = m_FreeHandles.back();
+         m_FreeHandles.pop_back();
+      }
+      else
+      {
+         handle = (BufferArenaHandle)m_Blocks.size();
+         m_Blocks.emplace_back();
       }
 
-      GLenum framebufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-      if(framebufferStatus != GL_FRAMEBUFFER_COMPLETE)
+      Page& page = m_Pages[pageIndex];
+      BufferArenaBlock& block = m_Blocks[handle];
+      block.buffer = page.buffer.get();
+      block.page = pageIndex;
+      block.offset = offset;
+      block.size = size;
+      block.alignment = alignment;
+
+      page.allocations[offset] = handle;
+      page.used += size;
+      return handle;
+   }
+
+   void BufferArena::Free(BufferArenaHandle handle)
+   {
+      if(handle >= m_Blocks.size() || m_Blocks[handle].buffer == nullptr)
       {
-         std::cout << "Framebuffer Error: " << framebufferStatus << std::endl;
+         std::cout << "ERROR: BufferArena::Free invalid handle " << handle << std::endl;
+         return;
       }
+
+      BufferArenaBlock& block = m_Blocks[handle];
+      Page& page = m_Pages[block.page];
+      page.allocations.erase(block.offset);
+      page.used -= block.size;
+      InsertFreeRange(page, block.offset, block.size);
+
+      block = BufferArenaBlock();
+      m_FreeHandles.push_back(handle);
    }
 
+   void BufferArena::Upload(BufferArenaHandle handle, const void* data, GLsizeiptr size, GLintptr offset /* = 0*/)
+   {
+      if(handle >= m_Blocks.size() || m_Blocks[handle].buffer == nullptr)
+      {
+         std::cout << "ERROR: BufferArena::Upload invalid handle " << handle << std::endl;
+         return;
+      }
 
-   void Framebuffer::Bind()
+      const BufferArenaBlock& block = m_Blocks[handle];
+      if(offset < 0 || size < 0 || offset + size > block.size)
+      {
+         std::cout << "ERROR: BufferArena upload of " << size << " bytes at offset " << offset
+            << " is outside of the block of " << block.size << " bytes" << std::endl;
+         return;
+      }
+      block.buffer->BufferSubData(data, block.offset + offset, size);
+   }
+
+   void BufferArena::MoveBlock(BufferArenaBlock& block, GLintptr newOffset)
    {
-      glBindFramebuffer(GL_FRAMEBUFFER, m_BufferID);
+      GLuint bufferID = *block.buffer;
+
+      // glCopyBufferSubData doesn't allow overlapping ranges inside the same buffer
+      if(newOffset + block.size > block.offset)
+      {
+         if(m_CopyBufferSize < block.size)
+         {
+            m_CopyBuffer = std::make_unique<GLBuffer>(GLBufferType::ARRAY_BUFFER);
+            m_CopyBuffer->BufferData(nullptr, (uint32_t)block.size, GLBufferUsage::STREAM_DRAW);
+            m_CopyBufferSize = block.size;
+         }
+
+         glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+         glBindBuffer(GL_COPY_WRITE_BUFFER, *m_CopyBuffer);
+         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, block.offset, 0, block.size);
+
+         glBindBuffer(GL_COPY_READ_BUFFER, *m_CopyBuffer);
+         glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, newOffset, block.size);
+      }
+      else
+      {
+         glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+         glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, block.offset, newOffset, block.size);
+      }
+
+      block.offset = newOffset;
    }
 
-   void Framebuffer::Unbind()
+   GLsizeiptr BufferArena::Compact(GLsizeiptr maxBytes)
    {
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      GLsizeiptr movedBytes = 0;
+      bool budgetLeft = true;
+
+      for(uint32_t pageIndex = 0; pageIndex < m_Pages.size() && budgetLeft; pageIndex++)
+      {
+         Page& page = m_Pages[pageIndex];
+         bool changed = false;
+
+         GLintptr cursor = 0;
+         for(auto it = page.allocations.begin(); it != page.allocations.end(); )
+         {
+            BufferArenaHandle handle = it->second;
+            BufferArenaBlock& block = m_Blocks[handle];
+
+            GLintptr target = AlignArenaOffset(cursor, block.alignment);
+            if(target >= block.offset)
+            {
+               cursor = block.offset + block.size;
+               ++it;
+               continue;
+            }
+
+            // always allow one move so blocks larger than the budget still get compacted
+            if(movedBytes > 0 && movedBytes + block.size > maxBytes)
+            {
+               budgetLeft = false;
+               break;
+            }
+
+            MoveBlock(block, target);
+            it = page.allocations.erase(it);
+            page.allocations.emplace_hint(it, target, handle);
+
+            cursor = target + block.size;
+            movedBytes += block.size;
+            changed = true;
+         }
+
+         if(changed)
+         {
+            RebuildFreeRanges(page);
+            m_Version++;
+         }
+      }
+
+      return movedBytes;
+   }
+
+   GLsizeiptr BufferArena::BytesUsed() const
+   {
+      GLsizeiptr used = 0;
+      for(const Page& page : m_Pages)
+         used += page.used;
+      return used;
    }
 
+   GLsizeiptr BufferArena::BytesReserved() const
+   {
+      GLsizeiptr reserved = 0;
+      for(const Page& page : m_Pages)
+         reserved += page.capacity;
+      return reserved;
+   }
 } // namespace EaseGL
 #endif
-/*-- File: src/Framebuffer.cpp end --*/
-/*-- File: src/GLBuffer.cpp start --*/
-/*-- #include "src/GLBuffer.hpp" start --*/
-/*-- #include "src/GLBuffer.hpp" end --*/
+
+/*-- File: src/BufferArena.cpp end --*/
+/*-- File: src/CompressedTexture.cpp start --*/
+/*-- #include "src/CompressedTexture.hpp" start --*/
+#ifndef COMPRESSEDTEXTURE_H
+#define COMPRESSEDTEXTURE_H
+
+#include <glad/glad.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Not core in any GL version, glad only has them when the extensions were selected
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace EaseGL
+{
+	enum class CompressedFormat
+	{
+		NONE = 0,
+		BC1_RGB,   // DXT1
+		BC1_RGBA,  // DXT1 with 1 bit alpha
+		BC2,       // DXT3
+		BC3,       // DXT5
+		BC4,       // RGTC1, single channel
+		BC5,       // RGTC2, two channels
+		BC7,       // BPTC
+		ETC2_RGB,
+		ETC2_RGBA, // ETC2 + EAC alpha
+	};
+
+	struct CompressedLevel
+	{
+		int width, height;
+		size_t offset; // into CompressedImage::data
+		size_t size;
+	};
+
+	struct CompressedImage
+	{
+		CompressedFormat format = CompressedFormat::NONE;
+		bool srgb = false;
+		int width = 0, height = 0;
+		std::vector<CompressedLevel> levels; // level 0 first, as many as the file stores
+		std::vector<unsigned char> data;
+
+		const unsigned char* LevelData(size_t level) const { return data.data() + levels[level].offset; }
+	};
+
+	/**
+	 * @brief Reads block compressed 2D images from KTX, KTX2 and DDS containers, see GLTexture::LoadCompressed().
+	 * Formats the driver can't sample are decoded on the CPU where a decoder exists (BC1-BC5).
+	 */
+	class CompressedTexture
+	{
+		private:
+			CompressedTexture() {}
+
+			static bool ParseKTX(const unsigned char* file, size_t size, CompressedImage& image);
+			static bool ParseKTX2(const unsigned char* file, size_t size, CompressedImage& image);
+			static bool ParseDDS(const unsigned char* file, size_t size, CompressedImage& image);
+			// fills 'image.levels' from level sizes, false if a level runs past 'size' or the chain is longer than MaxLevelCount()
+			static bool AddLevel(CompressedImage& image, size_t offset, size_t fileSize);
+		public:
+			/** @brief Detects the container from its header, false if it is unknown, not 2D or holds an unsupported format */
+			static bool Load(const char* filepath, CompressedImage& image);
+			static bool LoadFromMemory(const unsigned char* file, size_t size, CompressedImage& image);
+
+			static GLenum GetGLFormat(CompressedFormat format, bool srgb);
+			/** @brief The context can upload 'format' with glCompressedTexImage2D */
+			static bool IsSupported(CompressedFormat format, bool srgb);
+
+			/** @brief Levels of a full chain down to 1x1, floor(log2(max(width, height))) + 1 */
+			static int MaxLevelCount(int width, int height);
+			static int BlockSize(CompressedFormat format);
+			static size_t LevelSize(CompressedFormat format, int width, int height);
+
+			/** @brief Channels Decode() writes, 0 if there is no CPU decoder for 'format' */
+			static int DecodedChannels(CompressedFormat format);
+			/** @brief Decodes one level to 8 bit pixels with DecodedChannels() channels */
+			static bool Decode(CompressedFormat format, int width, int height, const unsigned char* blocks, unsigned char* pixels);
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/CompressedTexture.hpp" end --*/
 
 #ifdef EASEGL_IMPLEMENTATION
 #include <glad/glad.h>
 
-#include <cassert>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+/*-- #include "src/GLContext.hpp" start --*/
+#ifndef GLCONTEXT_H
+#define GLCONTEXT_H
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <string>
 
 namespace EaseGL
 {
-   GLBuffer::GLBuffer(GLBufferType bufferType)
-      : m_BufferType(bufferType), m_BufferID(0)
+	struct TextureBindingStats
+	{
+		uint64_t requested = 0;         // textures asked to be bound to a unit
+		uint64_t issued = 0;            // glBindTexture and glBindTextures calls that reached the driver
+		uint64_t activeUnitChanges = 0; // glActiveTexture calls
+	};
+
+	/**
+	 * @brief Queries about the current OpenGL context, cached on first use.
+	 * EaseGL assumes a single context, call Reset() if the context is recreated.
+	 *
+	 * Also mirrors the texture bound to each target of each texture unit and the active unit, so binds that
+	 * change nothing never reach the driver. Textures bound with raw GL calls bypass the mirror, call
+	 * InvalidateTextureBindings() afterwards.
+	 */
+	class GLContext
+	{
+		private:
+			GLContext() {}
+
+			static void LoadCapabilities();
+		public:
+			static bool HasVersion(int major, int minor);
+			static bool HasExtension(const char* extension);
+			// GL_VENDOR, GL_RENDERER and GL_VERSION joined, changes whenever the driver does
+			static const std::string& DriverIdentity();
+
+			/**
+			 * @brief Binds 'texture' to 'target' of 'unit' for sampling, skipped if it is bound there already.
+			 * The active unit is only changed when the bind is issued
+			 */
+			static void BindTexture(int unit, GLenum target, GLuint texture);
+			/**
+			 * @brief Binds 'count' textures to the units from 'firstUnit' on, with a single glBindTextures if the
+			 * context has it and more than one unit changes. Texture 0 unbinds every target of its unit
+			 */
+			static void BindTextures(int firstUnit, int count, const GLenum* targets, const GLuint* textures);
+			/** @brief Binds 'texture' on whichever unit is active, for uploads and parameter changes */
+			static void BindTextureOnActiveUnit(GLenum target, GLuint texture);
+			static int GetActiveTextureUnit();
+			/** @brief OpenGL 4.4 or GL_ARB_multi_bind */
+			static bool HasMultiBind();
+
+			/** @brief Call when 'texture' is deleted, GL unbinds it everywhere and may hand out the name again */
+			static void InvalidateTexture(GLuint texture);
+			static void InvalidateTextureBindings();
+
+			static const TextureBindingStats& GetTextureBindingStats();
+			/** @brief Call once per frame to get per frame counts */
+			static void ResetTextureBindingStats();
+
+			// also forgets every texture binding, SamplerCache drops its samplers on next use
+			static void Reset();
+			// changes on every Reset(), caches of GL objects compare it to notice their objects are gone
+			static uint32_t ResetCount();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   // containers are little endian, like every platform EaseGL runs on
+   uint32_t ReadContainerU32(const unsigned char* data)
    {
-      RecreateBuffer();
+      uint32_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
    }
 
-   GLBuffer::GLBuffer() 
-      : m_BufferType(GLBufferType::NONE), m_BufferID(0)
+   uint64_t ReadContainerU64(const unsigned char* data)
    {
+      uint64_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
    }
-      
-   GLBuffer::~GLBuffer()
+
+   // static
+   bool CompressedTexture::Load(const char* filepath, CompressedImage& image)
    {
-      if(m_BufferID != 0)
-         glDeleteBuffers(1, &m_BufferID);
+      FILE* fp = fopen(filepath, "rb");
+      if(fp == nullptr)
+      {
+         std::cout << "ERROR on loading Texture " << filepath << std::endl;
+         return false;
+      }
+
+      std::vector<unsigned char> file;
+      fseek(fp, 0, SEEK_END);
+      long size = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      file.resize(size > 0 ? (size_t)size : 0);
+      file.resize(fread(file.data(), 1, file.size(), fp));
+      fclose(fp);
+
+      if(!LoadFromMemory(file.data(), file.size(), image))
+      {
+         std::cout << "ERROR: " << filepath << " is not a supported KTX, KTX2 or DDS texture" << std::endl;
+         return false;
+      }
+      return true;
    }
 
-   void GLBuffer::RecreateBuffer() 
+   // static
+   bool CompressedTexture::LoadFromMemory(const unsigned char* file, size_t size, CompressedImage& image)
    {
-      if(m_BufferID != 0) {
-         glDeleteBuffers(1, &m_BufferID);
+      static const unsigned char ktxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+      static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+      image = CompressedImage();
+      bool parsed = size >= 12 && memcmp(file, ktxIdentifier, 12) == 0 ? ParseKTX(file, size, image)
+         : size >= 12 && memcmp(file, ktx2Identifier, 12) == 0 ? ParseKTX2(file, size, image)
+         : size >= 4 && memcmp(file, "DDS ", 4) == 0 ? ParseDDS(file, size, image)
+         : false;
+      if(!parsed || image.format == CompressedFormat::NONE || image.levels.empty())
+      {
+         image = CompressedImage();
+         return false;
       }
 
-      glGenBuffers(1, &m_BufferID);
-      glBindBuffer(GetGLBufferType(), m_BufferID);
+      // the levels were located in 'file', copy only what they cover
+      size_t begin = image.levels.front().offset;
+      size_t end = image.levels.back().offset + image.levels.back().size;
+      for(const CompressedLevel& level : image.levels)
+      {
+         begin = std::min(begin, level.offset);
+         end = std::max(end, level.offset + level.size);
+      }
+      image.data.assign(file + begin, file + end);
+      for(CompressedLevel& level : image.levels)
+         level.offset -= begin;
+      return true;
    }
 
-   void GLBuffer::BufferData(const void* data, uint32_t size, GLBufferUsage usage) const
+   // static
+   bool CompressedTexture::AddLevel(CompressedImage& image, size_t offset, size_t fileSize)
    {
-      glBindBuffer(GetGLBufferType(), m_BufferID);
-      glBufferData(GetGLBufferType(), size, data, GetGLBufferUsage(usage));
+      // a file claiming more levels than the size allows is corrupt, and shifting by 32 or more is undefined
+      int level = (int)image.levels.size();
+      if(level >= MaxLevelCount(image.width, image.height))
+         return false;
+      int width = std::max(image.width >> level, 1);
+      int height = std::max(image.height >> level, 1);
+      size_t size = LevelSize(image.format, width, height);
+      if(offset > fileSize || size > fileSize - offset)
+         return false;
+
+      image.levels.push_back({ width, height, offset, size });
+      return true;
    }
 
-   void GLBuffer::BufferSubData(const void* data, GLintptr offset, GLsizeiptr size) const
+   // static
+   bool CompressedTexture::ParseKTX(const unsigned char* file, size_t size, CompressedImage& image)
    {
-      glBindBuffer(GetGLBufferType(), m_BufferID);
-      glBufferSubData(GetGLBufferType(), offset, size, data);
+      if(size < 64 || ReadContainerU32(file + 12) != 0x04030201)
+         return false;
+
+      GLenum internalFormat = ReadContainerU32(file + 28);
+      image.width = (int)ReadContainerU32(file + 36);
+      image.height = (int)ReadContainerU32(file + 40);
+      uint32_t depth = ReadContainerU32(file + 44);
+      uint32_t arrayElements = ReadContainerU32(file + 48);
+      uint32_t faces = ReadContainerU32(file + 52);
+      uint32_t levelCount = std::max(ReadContainerU32(file + 56), 1u);
+      uint32_t keyValueBytes = ReadContainerU32(file + 60);
+      if(image.width <= 0 || image.height <= 0 || depth > 1 || arrayElements > 1 || faces != 1)
+         return false;
+
+      struct { GLenum gl; CompressedFormat format; bool srgb; } formats[] = {
+         { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, CompressedFormat::BC1_RGB, false },
+         { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, CompressedFormat::BC1_RGB, true },
+         { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, CompressedFormat::BC1_RGBA, false },
+         { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, CompressedFormat::BC1_RGBA, true },
+         { GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, CompressedFormat::BC2, false },
+         { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, CompressedFormat::BC2, true },
+         { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, CompressedFormat::BC3, false },
+         { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, CompressedFormat::BC3, true },
+         { GL_COMPRESSED_RED_RGTC1, CompressedFormat::BC4, false },
+         { GL_COMPRESSED_RG_RGTC2, CompressedFormat::BC5, false },
+         { GL_COMPRESSED_RGBA_BPTC_UNORM, CompressedFormat::BC7, false },
+         { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, CompressedFormat::BC7, true },
+         { GL_COMPRESSED_RGB8_ETC2, CompressedFormat::ETC2_RGB, false },
+         { GL_COMPRESSED_SRGB8_ETC2, CompressedFormat::ETC2_RGB, true },
+         { GL_COMPRESSED_RGBA8_ETC2_EAC, CompressedFormat::ETC2_RGBA, false },
+         { GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, CompressedFormat::ETC2_RGBA, true },
+      };
+      for(const auto& it : formats)
+      {
+         if(it.gl == internalFormat)
+         {
+            image.format = it.format;
+            image.srgb = it.srgb;
+         }
+      }
+      if(image.format == CompressedFormat::NONE)
+         return false;
+
+      // every level is prefixed with its size, block sizes keep everything 4 byte aligned
+      size_t offset = 64 + (size_t)keyValueBytes;
+      for(uint32_t level = 0; level < levelCount; level++)
+      {
+         if(offset + 4 > size)
+            return false;
+         offset += 4;
+         if(!AddLevel(image, offset, size))
+            return false;
+         offset += image.levels.back().size;
+      }
+      return true;
    }
 
-   void* GLBuffer::MapBuffer() 
+   // static
+   bool CompressedTexture::ParseKTX2(const unsigned char* file, size_t size, CompressedImage& image)
    {
-      void* pointer = glMapBuffer(GetGLBufferType(), GL_READ_WRITE); 
-      return pointer;
+      if(size < 80)
+         return false;
+
+      uint32_t vkFormat = ReadContainerU32(file + 12);
+      image.width = (int)ReadContainerU32(file + 20);
+      image.height = (int)ReadContainerU32(file + 24);
+      uint32_t depth = ReadContainerU32(file + 28);
+      uint32_t layers = ReadContainerU32(file + 32);
+      uint32_t faces = ReadContainerU32(file + 36);
+      uint32_t levelCount = std::max(ReadContainerU32(file + 40), 1u);
+      uint32_t supercompression = ReadContainerU32(file + 44);
+      // Basis and zstd supercompressed files need a transcoder first
+      if(image.width <= 0 || image.height <= 0 || depth > 1 || layers > 1 || faces != 1 || supercompression != 0)
+         return false;
+      if(80 + (size_t)levelCount * 24 > size)
+         return false;
+
+      // VkFormat values, the _SRGB variant always follows the _UNORM one
+      switch(vkFormat)
+      {
+         case 131: case 132: image.format = CompressedFormat::BC1_RGB; image.srgb = vkFormat == 132; break;
+         case 133: case 134: image.format = CompressedFormat::BC1_RGBA; image.srgb = vkFormat == 134; break;
+         case 135: case 136: image.format = CompressedFormat::BC2; image.srgb = vkFormat == 136; break;
+         case 137: case 138: image.format = CompressedFormat::BC3; image.srgb = vkFormat == 138; break;
+         case 139: image.format = CompressedFormat::BC4; break;
+         case 141: image.format = CompressedFormat::BC5; break;
+         case 145: case 146: image.format = CompressedFormat::BC7; image.srgb = vkFormat == 146; break;
+         case 147: case 148: image.format = CompressedFormat::ETC2_RGB; image.srgb = vkFormat == 148; break;
+         case 151: case 152: image.format = CompressedFormat::ETC2_RGBA; image.srgb = vkFormat == 152; break;
+         default: return false;
+      }
+
+      // the level index follows the 80 byte header, level 0 first (the data itself is stored smallest first)
+      for(uint32_t level = 0; level < levelCount; level++)
+      {
+         uint64_t offset = ReadContainerU64(file + 80 + level * 24);
+         if(offset > size || !AddLevel(image, (size_t)offset, size))
+            return false;
+      }
+      return true;
    }
 
-   void GLBuffer::UnmapBuffer() 
+   // static
+   bool CompressedTexture::ParseDDS(const unsigned char* file, size_t size, CompressedImage& image)
    {
-      glUnmapBuffer(GetGLBufferType());
+      if(size < 128)
+         return false;
+
+      const unsigned char* header = file + 4;
+      image.height = (int)ReadContainerU32(header + 8);
+      image.width = (int)ReadContainerU32(header + 12);
+      uint32_t flags = ReadContainerU32(header + 4);
+      uint32_t levelCount = (flags & 0x20000) != 0 ? std::max(ReadContainerU32(header + 24), 1u) : 1; // DDSD_MIPMAPCOUNT
+      uint32_t pixelFormatFlags = ReadContainerU32(header + 76);
+      uint32_t fourCC = ReadContainerU32(header + 80);
+      uint32_t caps2 = ReadContainerU32(header + 108);
+      if(image.width <= 0 || image.height <= 0 || (pixelFormatFlags & 0x4) == 0 || (caps2 & 0x200000 /* volume */) != 0 || (caps2 & 0x200 /* cube map */) != 0)
+         return false;
+
+      auto FourCC = [](const char* code) { return ReadContainerU32((const unsigned char*)code); };
+      size_t offset = 128;
+      if(fourCC == FourCC("DX10"))
+      {
+         if(size < 148)
+            return false;
+         uint32_t dxgiFormat = ReadContainerU32(file + 128);
+         uint32_t dimension = ReadContainerU32(file + 132);
+         uint32_t miscFlags = ReadContainerU32(file + 136);
+         uint32_t arraySize = ReadContainerU32(file + 140);
+         if(dimension != 3 /* TEXTURE2D */ || arraySize > 1 || (miscFlags & 0x4 /* cube map */) != 0)
+            return false;
+         offset = 148;
+
+         // DXGI_FORMAT values, _UNORM_SRGB follows _UNORM
+         switch(dxgiFormat)
+         {
+            case 71: case 72: image.format = CompressedFormat::BC1_RGBA; image.srgb = dxgiFormat == 72; break;
+            case 74: case 75: image.format = CompressedFormat::BC2; image.srgb = dxgiFormat == 75; break;
+            case 77: case 78: image.format = CompressedFormat::BC3; image.srgb = dxgiFormat == 78; break;
+            case 80: image.format = CompressedFormat::BC4; break;
+            case 83: image.format = CompressedFormat::BC5; break;
+            case 98: case 99: image.format = CompressedFormat::BC7; image.srgb = dxgiFormat == 99; break;
+            default: return false;
+         }
+      }
+      // DXT1 may use its transparent mode, decode it as RGBA to keep that
+      else if(fourCC == FourCC("DXT1"))
+         image.format = CompressedFormat::BC1_RGBA;
+      else if(fourCC == FourCC("DXT3"))
+         image.format = CompressedFormat::BC2;
+      else if(fourCC == FourCC("DXT5"))
+         image.format = CompressedFormat::BC3;
+      else if(fourCC == FourCC("ATI1") || fourCC == FourCC("BC4U"))
+         image.format = CompressedFormat::BC4;
+      else if(fourCC == FourCC("ATI2") || fourCC == FourCC("BC5U"))
+         image.format = CompressedFormat::BC5;
+      else
+         return false;
+
+      for(uint32_t level = 0; level < levelCount; level++)
+      {
+         if(!AddLevel(image, offset, size))
+            return false;
+         offset += image.levels.back().size;
+      }
+      return true;
    }
 
+   // static
+   int CompressedTexture::MaxLevelCount(int width, int height)
+   {
+      int levels = 1;
+      for(int size = std::max(width, height); size > 1; size >>= 1)
+         levels++;
+      return levels;
+   }
 
-   void GLBuffer::Bind()  const
+   // static
+   GLenum CompressedTexture::GetGLFormat(CompressedFormat format, bool srgb)
    {
-      glBindBuffer(GetGLBufferType(), m_BufferID);
+      switch(format)
+      {
+         case CompressedFormat::BC1_RGB: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+         case CompressedFormat::BC1_RGBA: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+         case CompressedFormat::BC2: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT : GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+         case CompressedFormat::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+         case CompressedFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+         case CompressedFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+         case CompressedFormat::BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+         case CompressedFormat::ETC2_RGB: return srgb ? GL_COMPRESSED_SRGB8_ETC2 : GL_COMPRESSED_RGB8_ETC2;
+         case CompressedFormat::ETC2_RGBA: return srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC : GL_COMPRESSED_RGBA8_ETC2_EAC;
+         default: return GL_NONE;
+      }
    }
 
-   GLenum GLBuffer::GetGLBufferType() const
+   // static
+   bool CompressedTexture::IsSupported(CompressedFormat format, bool srgb)
    {
-      return m_BufferType == GLBufferType::ARRAY_BUFFER ? GL_ARRAY_BUFFER
-         : m_BufferType == GLBufferType::ELEMENT_ARRAY_BUFFER ? GL_ELEMENT_ARRAY_BUFFER
-         : m_BufferType == GLBufferType::UNIFORM_BUFFER ? GL_UNIFORM_BUFFER
-         : GL_NONE; 
+      switch(format)
+      {
+         case CompressedFormat::BC1_RGB:
+         case CompressedFormat::BC1_RGBA:
+         case CompressedFormat::BC2:
+         case CompressedFormat::BC3:
+            if(!GLContext::HasExtension("GL_EXT_texture_compression_s3tc"))
+               return false;
+            return !srgb || GLContext::HasExtension("GL_EXT_texture_sRGB") || GLContext::HasExtension("GL_EXT_texture_compression_s3tc_srgb");
+         case CompressedFormat::BC4:
+         case CompressedFormat::BC5:
+            return GLContext::HasVersion(3, 0) || GLContext::HasExtension("GL_ARB_texture_compression_rgtc");
+         case CompressedFormat::BC7:
+            return GLContext::HasVersion(4, 2) || GLContext::HasExtension("GL_ARB_texture_compression_bptc");
+         case CompressedFormat::ETC2_RGB:
+         case CompressedFormat::ETC2_RGBA:
+            return GLContext::HasVersion(4, 3) || GLContext::HasExtension("GL_ARB_ES3_compatibility");
+         default:
+            return false;
+      }
    }
 
-   GLenum GLBuffer::GetGLBufferUsage(GLBufferUsage usage) const 
+   // static
+   int CompressedTexture::BlockSize(CompressedFormat format)
    {
-      return usage == GLBufferUsage::STATIC_DRAW ? GL_STATIC_DRAW
+      return format == CompressedFormat::BC1_RGB || format == CompressedFormat::BC1_RGBA || format == CompressedFormat::BC4 || format == CompressedFormat::ETC2_RGB ? 8
+         : format == CompressedFormat::NONE ? 0
+         : 16;
+   }
+
+   // static
+   size_t CompressedTexture::LevelSize(CompressedFormat format, int width, int height)
+   {
+      return (size_t)((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+   }
+
+   // static
+   int CompressedTexture::DecodedChannels(CompressedFormat format)
+   {
+      return format == CompressedFormat::BC1_RGB || format == CompressedFormat::BC1_RGBA || format == CompressedFormat::BC2 || format == CompressedFormat::BC3 ? 4
+         : format == CompressedFormat::BC4 ? 1
+         : format == CompressedFormat::BC5 ? 2
+         : 0;
+   }
+
+   // 4x4 RGBA from a BC1 color block. BC2/BC3 color blocks always use the 4 color mode ('fourColors').
+   // BC1 switches to 3 colors plus black when c0 <= c1, 'punchThroughAlpha' makes that black transparent (BC1_RGBA)
+   void DecodeBC1Block(const unsigned char* block, unsigned char* rgba, bool fourColors, bool punchThroughAlpha)
+   {
+      uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+      uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+      uint32_t indices = ReadContainerU32(block + 4);
+
+      unsigned char colors[4][4];
+      for(int i = 0; i < 2; i++)
+      {
+         uint16_t c = i == 0 ? c0 : c1;
+         int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+         colors[i][0] = (unsigned char)((r << 3) | (r >> 2));
+         colors[i][1] = (unsigned char)((g << 2) | (g >> 4));
+         colors[i][2] = (unsigned char)((b << 3) | (b >> 2));
+         colors[i][3] = 255;
+      }
+      for(int channel = 0; channel < 3; channel++)
+      {
+         int a = colors[0][channel], b = colors[1][channel];
+         if(c0 > c1 || fourColors)
+         {
+            colors[2][channel] = (unsigned char)((2 * a + b + 1) / 3);
+            colors[3][channel] = (unsigned char)((a + 2 * b + 1) / 3);
+         }
+         else
+         {
+            colors[2][channel] = (unsigned char)((a + b + 1) / 2);
+            colors[3][channel] = 0;
+         }
+      }
+      colors[2][3] = 255;
+      colors[3][3] = c0 > c1 || fourColors || !punchThroughAlpha ? 255 : 0;
+
+      for(int i = 0; i < 16; i++)
+         memcpy(rgba + i * 4, colors[(indices >> (i * 2)) & 3], 4);
+   }
+
+   // 4x4 values from a BC4 block (also BC3 alpha and both BC5 channels), written 'stride' bytes apart
+   void DecodeBC4Block(const unsigned char* block, unsigned char* out, int stride)
+   {
+      int v0 = block[0], v1 = block[1];
+      unsigned char values[8] = { (unsigned char)v0, (unsigned char)v1 };
+      if(v0 > v1)
+      {
+         for(int i = 1; i < 7; i++)
+            values[i + 1] = (unsigned char)(((7 - i) * v0 + i * v1 + 3) / 7);
+      }
+      else
+      {
+         for(int i = 1; i < 5; i++)
+            values[i + 1] = (unsigned char)(((5 - i) * v0 + i * v1 + 2) / 5);
+         values[6] = 0;
+         values[7] = 255;
+      }
+
+      uint64_t indices = 0;
+      for(int i = 0; i < 6; i++)
+         indices |= (uint64_t)block[2 + i] << (i * 8);
+      for(int i = 0; i < 16; i++)
+         out[i * stride] = values[(indices >> (i * 3)) & 7];
+   }
+
+   // static
+   bool CompressedTexture::Decode(CompressedFormat format, int width, int height, const unsigned char* blocks, unsigned char* pixels)
+   {
+      int channels = DecodedChannels(format);
+      if(channels == 0)
+         return false;
+
+      int blockSize = BlockSize(format);
+      unsigned char texels[16 * 4];
+      for(int by = 0; by < (height + 3) / 4; by++)
+      {
+         for(int bx = 0; bx < (width + 3) / 4; bx++, blocks += blockSize)
+         {
+            switch(format)
+            {
+               case CompressedFormat::BC1_RGB:
+               case CompressedFormat::BC1_RGBA:
+                  DecodeBC1Block(blocks, texels, false, format == CompressedFormat::BC1_RGBA);
+                  break;
+               case CompressedFormat::BC2:
+                  DecodeBC1Block(blocks + 8, texels, true, false);
+                  for(int i = 0; i < 16; i++)
+                     texels[i * 4 + 3] = (unsigned char)(((blocks[i / 2] >> ((i & 1) * 4)) & 15) * 17);
+                  break;
+               case CompressedFormat::BC3:
+                  DecodeBC1Block(blocks + 8, texels, true, false);
+                  DecodeBC4Block(blocks, texels + 3, 4);
+                  break;
+               case CompressedFormat::BC4:
+                  DecodeBC4Block(blocks, texels, 1);
+                  break;
+               case CompressedFormat::BC5:
+                  DecodeBC4Block(blocks, texels, 2);
+                  DecodeBC4Block(blocks + 8, texels + 1, 2);
+                  break;
+               default:
+                  return false;
+            }
+
+            // blocks on the right and bottom edge can hang over the image
+            int copyWidth = std::min(4, width - bx * 4);
+            for(int y = 0; y < 4 && by * 4 + y < height; y++)
+            {
+               unsigned char* row = pixels + ((size_t)(by * 4 + y) * width + bx * 4) * channels;
+               memcpy(row, texels + y * 4 * channels, (size_t)copyWidth * channels);
+            }
+         }
+      }
+      return true;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/CompressedTexture.cpp end --*/
+/*-- File: src/Framebuffer.cpp start --*/
+/*-- #include "src/Framebuffer.hpp" start --*/
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <glad/glad.h>
+/*-- #include "src/Texture.hpp" start --*/
+#ifndef TEXTURE_H
+#define TEXTURE_H
+	
+#include <glad/glad.h>
+/*-- #include "src/GLTexture.hpp" start --*/
+#ifndef GLTEXTURE_H
+#define GLTEXTURE_H
+	
+#include <glad/glad.h>
+/*-- #include "src/GLObjectPool.hpp" start --*/
+/*-- #include "src/GLObjectPool.hpp" end --*/
+/*-- #include "src/MipChain.hpp" start --*/
+#ifndef MIPCHAIN_H
+#define MIPCHAIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace EaseGL
+{
+	enum class MipFilter
+	{
+		NONE = 0, // levels are generated by the driver with glGenerateMipmap
+		BOX,      // 2x2 average, what most drivers do, but computed on the CPU
+		KAISER,   // Kaiser windowed sinc, keeps small details sharper down the chain
+	};
+
+	struct MipLevel
+	{
+		int width, height;
+		size_t offset; // into MipChain::data
+		size_t size;
+	};
+
+	/** @brief 8 bit pixels of every level down to 1x1, tightly packed one after another */
+	struct MipChain
+	{
+		int width = 0, height = 0, channels = 0;
+		std::vector<MipLevel> levels; // level 0 first
+		std::vector<unsigned char> data;
+
+		const unsigned char* LevelData(size_t level) const { return data.data() + levels[level].offset; }
+	};
+
+	struct MipCacheStats
+	{
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		uint32_t stored = 0;
+	};
+
+	/**
+	 * @brief Builds mip chains on the CPU, see TextureCreateInfo::mipFilter and GLTexture::UploadMipChain().
+	 * Each level is filtered from the previous one, split into bands of rows over worker threads.
+	 * sRGB images are filtered in linear space (alpha is always linear), which keeps them from darkening
+	 * down the chain the way averaging encoded values does.
+	 *
+	 * With SetCacheDirectory() finished chains are also written to disk, keyed by the level 0 pixels and
+	 * the filter, so loading the same image again skips filtering.
+	 * Safe to call from any thread.
+	 */
+	class MipGenerator
+	{
+		private:
+			MipGenerator() {}
+
+			static std::string FilePath(uint64_t key);
+			static bool LoadCached(uint64_t key, int width, int height, int channels, MipChain& chain);
+			static void StoreCached(uint64_t key, const MipChain& chain);
+		public:
+			// bump when the file layout, the key or a filter changes, old directories are left alone
+			static constexpr uint32_t FORMAT_VERSION = 1;
+
+			/**
+			 * @brief Fills 'chain' with 'pixels' as level 0 and every smaller level down to 1x1.
+			 * @param srgb color is sRGB encoded, the last channel of 2 and 4 channel images is alpha and stays linear
+			 * @param threadCount threads per level, 0 uses the hardware threads. Small levels always use one
+			 */
+			static bool Build(const unsigned char* pixels, int width, int height, int channels, MipFilter filter, bool srgb,
+				MipChain& chain, uint32_t threadCount = 0);
+
+			/** @brief Enables the disk cache, files are written to 'directory'/v<FORMAT_VERSION>. Empty string disables it */
+			static void SetCacheDirectory(const std::string& directory);
+			static std::string GetCacheDirectory();
+
+			static MipCacheStats GetStats();
+			static void ResetStats();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/MipChain.hpp" end --*/
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace EaseGL
+{
+	struct CompressedImage;
+	struct TextureStreamRing;
+
+	enum class TextureType
+	{
+		NONE = 0,
+		TEXTURE2D,
+		TEXTURE2D_ARRAY,
+		TEXTURE_CUBE_MAP, // layers are the faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order: +X, -X, +Y, -Y, +Z, -Z
+		TEXTURE3D,        // layers are depth slices
+	};
+
+	enum class TextureFormat
+	{
+		NONE = 0, // picked from the channel count: R8, RG8, RGB8 or RGBA8 (SRGB8, SRGB8_ALPHA8 if 'srgb')
+		R8,
+		RG8,
+		RGB8,
+		RGBA8,
+		SRGB8,
+		SRGB8_ALPHA8,
+		// pixels are uploaded as floats
+		R16F,
+		RG16F,
+		RGB16F,
+		RGBA16F,
+	};
+
+	enum class TextureResidency
+	{
+		DROP_AFTER_UPLOAD = 0, // decoded pixels are freed once they are on the GPU
+		KEEP,                  // kept for CPU side reads through GetPixels()
+		RELOAD_ON_DEMAND,      // freed after upload, GetPixels() decodes the file again
+	};
+
+	struct TextureMemoryStats
+	{
+		size_t cpuBytes = 0; // decoded pixels held by GLTexture
+		size_t gpuBytes = 0; // estimated from the internal format and allocated levels, drivers may pad
+		uint32_t textures = 0; // with GPU storage
+	};
+
+	struct TextureCreateInfo
+	{
+		TextureFormat format = TextureFormat::NONE;
+		bool srgb = false;   // only used with TextureFormat::NONE, for 3 and 4 channel images
+		bool mipmaps = true; // allocate and generate the full mip chain
+		// builds the mip chain of 8 bit 2D textures on the CPU (see MipGenerator) instead of glGenerateMipmap
+		MipFilter mipFilter = MipFilter::NONE;
+		TextureResidency residency = TextureResidency::DROP_AFTER_UPLOAD; // for pixels decoded by LoadTexture()
+		uint32_t updateBuffers = 2; // pixel unpack buffers Update() cycles through
+
+		/** @brief Color of a 'channels' channel image is stored sRGB encoded */
+		bool IsSRGB(int channels) const
+		{
+			return format == TextureFormat::SRGB8 || format == TextureFormat::SRGB8_ALPHA8
+				|| (format == TextureFormat::NONE && srgb && channels >= 3);
+		}
+	};
+	
+	struct TextureRegion
+	{
+		int x = 0, y = 0;
+		int width = 0, height = 0; // 0 extends to the edge of level 0
+		int layer = 0;             // array layer, cube face or 3D slice
+	};
+
+	class GLTexture 
+	{
+		private:
+			GLuint m_TextureID;
+			GLHandle m_Handle; // invalid for textures that were created outside of GLTexture
+			TextureType m_TextureType;
+
+			int m_Width, m_Height, m_Channels;
+			int m_Layers; // array layers, cube faces or depth, 1 for 2D textures
+			unsigned char* m_Pixels; // floats for 16F formats
+			size_t m_PixelBytes = 0;
+			size_t m_GpuBytes = 0;
+
+			std::string m_Filepath;
+
+			TextureCreateInfo m_CreateInfo;
+			// immutable storage made with glTexStorage*, 0 if the texture is mutable
+			GLenum m_StorageFormat = 0;
+			GLsizei m_StorageLevels = 0;
+
+			TextureStreamRing* m_Stream = nullptr; // created by the first Update()
+
+			GLenum GetGLTextureType() const;
+			GLenum GetInternalFormat(int channels) const;
+			GLenum GetPixelType() const;
+
+			void CreateTexture();
+			/**
+			 * @brief Makes immutable storage if the context supports it, recreating the texture object unless the
+			 * current storage already matches. Returns false for mutable textures, the caller specifies level 0 itself
+			 */
+			bool AllocateStorage(GLenum internalFormat, int width, int height, int layers, GLsizei levels);
+			void SetGpuBytes(size_t bytes);
+			bool DecodePixels(const char* filepath);
+			// 'layerStride' bytes between the layers in 'pixels', 0 repeats the same image
+			void SpecifyLayers(int width, int height, int layers, int channels, const void* pixels, size_t layerStride);
+			void GenTextures();
+			void DeleteTextures();
+			void DeleteStream();
+			// binds on the active unit so glTex* calls that follow act on this texture
+			void BindForEdit() const;
+			void MoveFrom(GLTexture& other);
+		public:
+			GLTexture() : m_TextureID(0), m_TextureType(TextureType::TEXTURE2D), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath("") {};
+			// Doesn't take ownership of 'textureID'
+			GLTexture(GLuint textureID, TextureType textureType);
+			GLTexture(TextureType type, const TextureCreateInfo& createInfo);
+
+			/** @brief Decodes and uploads 'filepath', the pixels are kept or dropped as TextureCreateInfo::residency says */
+			void LoadTexture(const char* filepath);
+
+			/**
+			 * @brief Pixels decoded by LoadTexture(), nullptr if they were dropped.
+			 * With RELOAD_ON_DEMAND the file is decoded again and kept until ReleasePixels()
+			 */
+			const void* GetPixels();
+			void ReleasePixels();
+			size_t CpuBytes() const { return m_PixelBytes; }
+			size_t GpuBytes() const { return m_GpuBytes; }
+
+			/** @brief Totals over all GLTextures */
+			static const TextureMemoryStats& GetMemoryStats();
+
+			/**
+			 * @brief (Re)specifies the image and regenerates mipmaps, creates the texture object on first use.
+			 * If a GL_PIXEL_UNPACK_BUFFER is bound 'pixels' is an offset into it.
+			 * The pixels are not kept, unlike LoadTexture().
+			 * Storage is immutable where glTexStorage2D is available, uploading another size or format
+			 * then creates a new texture object (GLTexture::Bind() always uses the current one)
+			 */
+			void Upload(int width, int height, int channels, const void* pixels);
+			/** @brief Replaces a region of level 0, mipmaps are not regenerated */
+			void SubImage(int x, int y, int width, int height, int channels, const void* pixels);
+			void GenerateMipmaps();
+			/**
+			 * @brief (Re)specifies a 2D texture with every level of 'chain', nothing is generated by the driver.
+			 * If a GL_PIXEL_UNPACK_BUFFER is bound, a copy of 'chain.data' starts at 'unpackOffset' in it
+			 */
+			bool UploadMipChain(const MipChain& chain, GLintptr unpackOffset = 0);
+
+			/**
+			 * @brief Replaces 'region' of level 0 with tightly packed pixels in the texture's current channel count
+			 * (floats for 16F formats), without waiting for the GPU. The pixels are copied into the next of
+			 * TextureCreateInfo::updateBuffers pixel unpack buffers and uploaded from there, so the copy for frame N
+			 * overlaps the GPU still reading frame N - 1. A buffer the GPU isn't done with yet is orphaned
+			 * instead of waited on. Mipmaps are not regenerated.
+			 *
+			 * video.Update({ 0, 0, width, height }, frame);
+			 */
+			void Update(const TextureRegion& region, const void* pixels);
+			/**
+			 * @brief Same as Update() without the copy: returns write only memory for 'region' that
+			 * has to be filled before EndUpdate(), nullptr if the region is invalid
+			 */
+			void* BeginUpdate(const TextureRegion& region);
+			void EndUpdate();
+			// Update() calls that found their buffer still in use and orphaned it
+			uint64_t UpdateOrphanCount() const;
+
+			/**
+			 * @brief Loads one file per layer of a 2D array, face of a cube map or slice of a 3D texture.
+			 * Every file has to have the same size and channel count, cube maps need exactly 6
+			 */
+			bool LoadLayers(const std::vector<std::string>& filepaths);
+			/**
+			 * @brief (Re)specifies all layers at once from 'layers' tightly packed images and regenerates mipmaps.
+			 * Upload() on these types specifies a single layer, or the same image on every cube face
+			 */
+			void UploadLayers(int width, int height, int layers, int channels, const void* pixels);
+			/** @brief Replaces a region of one layer (or cube face) of level 0, mipmaps are not regenerated */
+			void SubImageLayer(int layer, int x, int y, int width, int height, int channels, const void* pixels);
+
+			/**
+			 * @brief Loads a block compressed KTX, KTX2 or DDS file with all of its stored mip levels.
+			 * Formats the driver doesn't support are decoded on the CPU if possible (BC1-BC5), see CompressedTexture
+			 */
+			bool LoadCompressed(const char* filepath);
+			bool UploadCompressed(const CompressedImage& image);
+
+			int Width() { return m_Width; }
+			int Height() { return m_Height; }
+			int Layers() const { return m_Layers; }
+			/** @brief Applies to the next Upload()/LoadTexture() */
+			void SetCreateInfo(const TextureCreateInfo& createInfo) { m_CreateInfo = createInfo; }
+			const TextureCreateInfo& GetCreateInfo() const { return m_CreateInfo; }
+			bool IsImmutable() const { return m_StorageFormat != 0; }
+			TextureType Type() const { return m_TextureType; }
+
+			GLTexture(TextureType type);
+			GLTexture(TextureType type, const char* filepath);
+			~GLTexture();
+
+			GLTexture(const GLTexture&) = delete;
+			GLTexture& operator=(const GLTexture&) = delete;
+			GLTexture(GLTexture&& other) noexcept;
+			GLTexture& operator=(GLTexture&& other) noexcept;
+
+			operator GLuint() { return m_TextureID; }
+			GLHandle Handle() const { return m_Handle; }
+
+			/** @brief Binds for sampling, skipped if the texture is already bound to 'slot' (see GLContext) */
+			void Bind(int slot = 0) const;
+			/**
+			 * @brief Binds a material's textures to consecutive slots, with one glBindTextures where available.
+			 * nullptr unbinds the slot
+			 *
+			 * EaseGL::GLTexture::BindTextures(0, { &albedo, &normal, &roughness });
+			 */
+			static void BindTextures(int firstSlot, std::initializer_list<const GLTexture*> textures);
+			/** @brief Unbinds 'type' on the active unit */
+			static void Unbind(TextureType type);
+	};
+} // namespace EaseGL
+
+#endif
+/*-- #include "src/GLTexture.hpp" end --*/
+#include <string>
+#include <vector>
+
+namespace EaseGL
+{
+	struct Texture2D
+	{
+		public:
+			static GLTexture New(const char* filepath)
+			{
+				return GLTexture(TextureType::TEXTURE2D, filepath);
+			}
+			static GLTexture New(const char* filepath, const TextureCreateInfo& createInfo)
+			{
+				GLTexture texture(TextureType::TEXTURE2D, createInfo);
+				texture.LoadTexture(filepath);
+				return texture;
+			}
+			// KTX, KTX2 or DDS with BCn/ETC2 blocks
+			static GLTexture NewCompressed(const char* filepath)
+			{
+				GLTexture texture(TextureType::TEXTURE2D);
+				texture.LoadCompressed(filepath);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE2D);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE2D);
+			}
+
+		private:
+			Texture2D();
+		public:
+			~Texture2D();
+	};
+
+	struct Texture2DArray
+	{
+		public:
+			// one file per layer, all of the same size
+			static GLTexture New(const std::vector<std::string>& filepaths)
+			{
+				GLTexture texture(TextureType::TEXTURE2D_ARRAY);
+				texture.LoadLayers(filepaths);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE2D_ARRAY);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE2D_ARRAY);
+			}
+
+		private:
+			Texture2DArray();
+		public:
+			~Texture2DArray();
+	};
+
+	struct TextureCubeMap
+	{
+		public:
+			// faces in +X, -X, +Y, -Y, +Z, -Z order
+			static GLTexture New(const std::vector<std::string>& faceFilepaths)
+			{
+				GLTexture texture(TextureType::TEXTURE_CUBE_MAP);
+				texture.LoadLayers(faceFilepaths);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE_CUBE_MAP);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE_CUBE_MAP);
+			}
+
+		private:
+			TextureCubeMap();
+		public:
+			~TextureCubeMap();
+	};
+
+	struct Texture3D
+	{
+		public:
+			// one file per depth slice
+			static GLTexture New(const std::vector<std::string>& sliceFilepaths)
+			{
+				GLTexture texture(TextureType::TEXTURE3D);
+				texture.LoadLayers(sliceFilepaths);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE3D);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE3D);
+			}
+
+		private:
+			Texture3D();
+		public:
+			~Texture3D();
+	};
+} // namespace EaseGL
+#endif
+/*-- #include "src/Texture.hpp" end --*/
+/*-- #include "src/GLObjectPool.hpp" start --*/
+/*-- #include "src/GLObjectPool.hpp" end --*/
+#include <vector>
+
+namespace EaseGL
+{
+	enum class FramebufferAttachmentFormat
+	{
+		RGB,
+		RGBA,
+		RGBA8,
+		RED_INTEGER,
+
+		DEPTH24STENCIL8,
+	};
+
+	struct FrameBufferCreateInfo
+	{
+		int width = 1280;
+		int height = 720;
+		int samples = 1;
+
+		std::vector<FramebufferAttachmentFormat> attachments;
+		FrameBufferCreateInfo()
+			: attachments({ FramebufferAttachmentFormat::RGBA8,
+								 FramebufferAttachmentFormat::DEPTH24STENCIL8 })
+		{
+		}
+	};
+
+	class Framebuffer  
+	{
+		private:
+			GLuint m_BufferID;
+			GLHandle m_Handle;
+			
+			struct Attachment
+			{
+				GLuint id;
+				GLHandle handle;
+				FramebufferAttachmentFormat format;
+
+				Attachment()
+					: id(0), format(FramebufferAttachmentFormat::DEPTH24STENCIL8)
+				{
+				}
+
+				Attachment(GLuint _id, FramebufferAttachmentFormat _format)
+					: id(_id), format(_format)
+				{
+				}
+			};
+			std::vector<Attachment> m_ColorAttachments; // Texture2D
+			Attachment m_DepthAttachment;// RenderBufferObject
+
+			void DeleteBuffer();
+		public:
+			Framebuffer();
+			~Framebuffer();
+
+			Framebuffer(const Framebuffer&) = delete;
+			Framebuffer& operator=(const Framebuffer&) = delete;
+			Framebuffer(Framebuffer&& other) noexcept;
+			Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+			// Create/Recreate framebuffer
+			void RecreateBuffer(const FrameBufferCreateInfo& createInfo);
+
+			void Bind();
+			void Unbind();
+
+			operator GLuint() { return m_BufferID; }
+			GLHandle Handle() const { return m_Handle; }
+
+			GLuint GetColorAttachment(int at = 0) const { return m_ColorAttachments[at].id; }
+	};
+} // namespace EaseGL
+#endif
+/*-- #include "src/Framebuffer.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <iostream>
+
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   Framebuffer::Framebuffer()
+      : m_BufferID(0)
+   {
+      
+   }
+      
+   Framebuffer::~Framebuffer()
+   {
+      DeleteBuffer();
+   }
+
+   Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+      : m_BufferID(other.m_BufferID), m_Handle(other.m_Handle),
+      m_ColorAttachments(std::move(other.m_ColorAttachments)), m_DepthAttachment(other.m_DepthAttachment)
+   {
+      other.m_BufferID = 0;
+      other.m_Handle = GLHandle();
+      other.m_ColorAttachments.clear();
+      other.m_DepthAttachment = Attachment();
+   }
+
+   Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteBuffer();
+
+         m_BufferID = other.m_BufferID;
+         m_Handle = other.m_Handle;
+         m_ColorAttachments = std::move(other.m_ColorAttachments);
+         m_DepthAttachment = other.m_DepthAttachment;
+
+         other.m_BufferID = 0;
+         other.m_Handle = GLHandle();
+         other.m_ColorAttachments.clear();
+         other.m_DepthAttachment = Attachment();
+      }
+      return *this;
+   }
+
+   void Framebuffer::DeleteBuffer()
+   {
+      for(Attachment& attachment : m_ColorAttachments)
+         GLObjectPool::Destroy(attachment.handle);
+      m_ColorAttachments.clear();
+
+      GLObjectPool::Destroy(m_DepthAttachment.handle);
+      m_DepthAttachment = Attachment();
+
+      GLObjectPool::Destroy(m_Handle);
+      m_BufferID = 0;
+   }
+   
+   bool IsColorAttachment(FramebufferAttachmentFormat format)
+   {
+      return format == FramebufferAttachmentFormat::RGBA8 
+         || format == FramebufferAttachmentFormat::RGB
+         || format == FramebufferAttachmentFormat::RGBA
+         || format == FramebufferAttachmentFormat::RED_INTEGER;
+   }
+
+   bool IsDepthAttachment(FramebufferAttachmentFormat format)
+   {
+      return format == FramebufferAttachmentFormat::DEPTH24STENCIL8;
+   }
+
+   GLenum GetAttachmentFormat(FramebufferAttachmentFormat format)
+   {
+      return format == FramebufferAttachmentFormat::RGBA8 ? GL_RGBA8
+           : format == FramebufferAttachmentFormat::RGB ? GL_RGB
+           : format == FramebufferAttachmentFormat::RGBA ? GL_RGBA
+           : format == FramebufferAttachmentFormat::DEPTH24STENCIL8 ? GL_RGBA
+           : format == FramebufferAttachmentFormat::RED_INTEGER ? GL_RED_INTEGER
+           : GL_NONE;
+   }
+   GLenum GetAttachmentInternalFormat(FramebufferAttachmentFormat format)
+   {
+      return format == FramebufferAttachmentFormat::RGBA8 ? GL_RGBA8
+           : format == FramebufferAttachmentFormat::RGB ? GL_RGB
+           : format == FramebufferAttachmentFormat::RGBA ? GL_RGBA
+           : format == FramebufferAttachmentFormat::DEPTH24STENCIL8 ? GL_RGBA
+           : format == FramebufferAttachmentFormat::RED_INTEGER ? GL_R32I
+           : GL_NONE;
+   }
+
+   void Framebuffer::RecreateBuffer(const FrameBufferCreateInfo& createInfo)
+   {
+      DeleteBuffer();
+
+      m_Handle = GLObjectPool::Create(GLObjectType::FRAMEBUFFER);
+      m_BufferID = GLObjectPool::Name(m_Handle);
+      glBindFramebuffer(GL_FRAMEBUFFER, m_BufferID);
+
+      bool hasDepthAttachment = false;
+      int colorAttachmentCount = 0;
+      for(const FramebufferAttachmentFormat& attachment : createInfo.attachments)
+      {
+         if(IsDepthAttachment(attachment))
+            hasDepthAttachment = true;
+         else if(IsColorAttachment(attachment))
+            m_ColorAttachments.emplace_back(0, attachment);
+      }
+      
+      for(int i=0; i<m_ColorAttachments.size(); i++)
+      {
+         m_ColorAttachments[i].handle = GLObjectPool::Create(GLObjectType::TEXTURE);
+         m_ColorAttachments[i].id = GLObjectPool::Name(m_ColorAttachments[i].handle);
+      }
+
+      if(createInfo.samples > 1)
+         std::cout << "SAMPLES DOESNT WORK" << std::endl;
+
+      for(int i = 0; i < m_ColorAttachments.size(); i++)
+      {
+         GLContext::BindTextureOnActiveUnit(GL_TEXTURE_2D, m_ColorAttachments[i].id);
+         glTexImage2D(GL_TEXTURE_2D, 0, // level
+               GetAttachmentInternalFormat(m_ColorAttachments[i].format), // internal format
+               createInfo.width, createInfo.height,
+               0, // border
+               GetAttachmentFormat(m_ColorAttachments[i].format), // format
+               GL_UNSIGNED_BYTE, // type
+               NULL); // pixels
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+         if(IsColorAttachment(createInfo.attachments[i]))
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+i, GL_TEXTURE_2D, m_ColorAttachments[i].id, 0);
+      }
+
+      if(hasDepthAttachment)
+      {
+         m_DepthAttachment.handle = GLObjectPool::Create(GLObjectType::RENDERBUFFER);
+         m_DepthAttachment.id = GLObjectPool::Name(m_DepthAttachment.handle);
+         glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment.id);
+         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, createInfo.width, createInfo.height);
+         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment.id);
+      }
+
+      GLenum framebufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+      if(framebufferStatus != GL_FRAMEBUFFER_COMPLETE)
+      {
+         std::cout << "Framebuffer Error: " << framebufferStatus << std::endl;
+      }
+   }
+
+
+   void Framebuffer::Bind()
+   {
+      glBindFramebuffer(GL_FRAMEBUFFER, m_BufferID);
+   }
+
+   void Framebuffer::Unbind()
+   {
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   }
+
+} // namespace EaseGL
+#endif
+/*-- File: src/Framebuffer.cpp end --*/
+/*-- File: src/GLBuffer.cpp start --*/
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+namespace EaseGL
+{
+   GLBuffer::GLBuffer(GLBufferType bufferType)
+      : m_BufferType(bufferType), m_BufferID(0), m_Size(0), m_Usage(GLBufferUsage::NONE),
+      m_UploadStrategy(GLBufferUploadStrategy::AUTO), m_RingHead(0), m_RingSegment(0), m_RingFences(), m_Immutable(false)
+   {
+      RecreateBuffer();
+   }
+
+   GLBuffer::GLBuffer() 
+      : m_BufferType(GLBufferType::NONE), m_BufferID(0), m_Size(0), m_Usage(GLBufferUsage::NONE),
+      m_UploadStrategy(GLBufferUploadStrategy::AUTO), m_RingHead(0), m_RingSegment(0), m_RingFences(), m_Immutable(false)
+   {
+   }
+      
+   GLBuffer::~GLBuffer()
+   {
+      DeleteRingFences();
+      GLObjectPool::Destroy(m_Handle);
+   }
+
+   GLBuffer::GLBuffer(GLBuffer&& other) noexcept
+      : m_BufferType(GLBufferType::NONE), m_BufferID(0), m_Size(0), m_Usage(GLBufferUsage::NONE),
+      m_UploadStrategy(GLBufferUploadStrategy::AUTO), m_RingHead(0), m_RingSegment(0), m_RingFences(), m_Immutable(false)
+   {
+      MoveFrom(other);
+   }
+
+   GLBuffer& GLBuffer::operator=(GLBuffer&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteRingFences();
+         GLObjectPool::Destroy(m_Handle);
+         MoveFrom(other);
+      }
+      return *this;
+   }
+
+   void GLBuffer::MoveFrom(GLBuffer& other)
+   {
+      m_BufferType = other.m_BufferType;
+      m_BufferID = other.m_BufferID;
+      m_Handle = other.m_Handle;
+      m_Size = other.m_Size;
+      m_Usage = other.m_Usage;
+      m_UploadStrategy = other.m_UploadStrategy;
+      m_Immutable = other.m_Immutable;
+      m_RingHead = other.m_RingHead;
+      m_RingSegment = other.m_RingSegment;
+      for(int i = 0; i < RING_SEGMENTS; i++)
+      {
+         m_RingFences[i] = other.m_RingFences[i];
+         other.m_RingFences[i] = nullptr;
+      }
+
+      other.m_BufferID = 0;
+      other.m_Handle = GLHandle();
+      other.m_Size = 0;
+      other.m_Immutable = false;
+      other.m_RingHead = 0;
+      other.m_RingSegment = 0;
+   }
+
+   void GLBuffer::RecreateBuffer() 
+   {
+      DeleteRingFences();
+      GLObjectPool::Destroy(m_Handle);
+      m_Size = 0;
+      m_Immutable = false;
+
+      m_Handle = GLObjectPool::Create(GLObjectType::BUFFER);
+      m_BufferID = GLObjectPool::Name(m_Handle);
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+   }
+
+   void GLBuffer::BufferData(const void* data, uint32_t size, GLBufferUsage usage)
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+      glBufferData(GetGLBufferType(), size, data, GetGLBufferUsage(usage));
+
+      m_Size = size;
+      m_Usage = usage;
+      // new storage isn't used by the GPU, ring can start over
+      DeleteRingFences();
+   }
+
+   void GLBuffer::BufferSubData(const void* data, GLintptr offset, GLsizeiptr size) const
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+      glBufferSubData(GetGLBufferType(), offset, size, data);
+   }
+
+   void GLBuffer::BufferStorage(const void* data, GLsizeiptr size, GLbitfield flags)
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+      glBufferStorage(GetGLBufferType(), size, data, flags);
+      m_Size = size;
+      m_Immutable = true;
+   }
+
+   GLBufferUploadStrategy GLBuffer::GetUploadStrategy() const
+   {
+      if(m_UploadStrategy != GLBufferUploadStrategy::AUTO)
+         return m_UploadStrategy;
+
+      // ORPHAN and MAP_UNSYNCHRONIZED change what 'offset' means, they have to be chosen explicitly
+      return m_Usage == GLBufferUsage::STREAM_DRAW ? GLBufferUploadStrategy::MAP_INVALIDATE
+         : m_Usage == GLBufferUsage::DYNAMIC_DRAW ? GLBufferUploadStrategy::MAP_INVALIDATE
+         : GLBufferUploadStrategy::SUB_DATA;
+   }
+
+   GLintptr GLBuffer::Upload(const void* data, GLsizeiptr size, GLintptr offset /* = 0*/)
+   {
+      GLBufferUploadStrategy strategy = GetUploadStrategy();
+
+      // data doesn't fit, storage has to be respecified anyway
+      if(offset + size > m_Size)
+      {
+         if(m_Immutable)
+         {
+            std::cout << "ERROR: Upload() of " << size << " bytes at offset " << offset
+               << " doesn't fit the " << m_Size << " byte immutable buffer storage" << std::endl;
+            return -1;
+         }
+
+         // the ring starts over on the new store and keeps its head, so the next upload is fenced properly
+         if(strategy == GLBufferUploadStrategy::MAP_UNSYNCHRONIZED)
+         {
+            Grow(size, 0);
+            return UploadUnsynchronized(data, size);
+         }
+
+         // orphaning drops old contents by definition, the other strategies keep them
+         Grow(offset + size, strategy == GLBufferUploadStrategy::ORPHAN ? 0 : offset);
+         BufferSubData(data, offset, size);
+         return offset;
+      }
+
+      if(strategy == GLBufferUploadStrategy::ORPHAN)
+      {
+         glBindBuffer(GetGLBufferType(), m_BufferID);
+         glBufferData(GetGLBufferType(), m_Size, nullptr, GetGLBufferUsage(m_Usage));
+         glBufferSubData(GetGLBufferType(), offset, size, data);
+         return offset;
+      }
+      else if(strategy == GLBufferUploadStrategy::MAP_INVALIDATE)
+      {
+         void* pointer = MapBufferRange(offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+         if(pointer != nullptr)
+         {
+            memcpy(pointer, data, size);
+            UnmapBuffer();
+         }
+         return offset;
+      }
+      else if(strategy == GLBufferUploadStrategy::MAP_UNSYNCHRONIZED)
+      {
+         return UploadUnsynchronized(data, size);
+      }
+
+      BufferSubData(data, offset, size);
+      return offset;
+   }
+
+   void GLBuffer::Grow(GLsizeiptr size, GLsizeiptr keepBytes)
+   {
+      GLBufferUsage usage = m_Usage != GLBufferUsage::NONE ? m_Usage : GLBufferUsage::DYNAMIC_DRAW;
+      if(keepBytes > m_Size)
+         keepBytes = m_Size;
+      if(keepBytes <= 0)
+      {
+         BufferData(nullptr, (uint32_t)size, usage);
+         return;
+      }
+
+      // glBufferData drops the old store, park the bytes that survive in a temporary buffer.
+      // The name stays the same, so vertex arrays and binding points referencing the buffer stay valid
+      GLHandle temp = GLObjectPool::Create(GLObjectType::BUFFER);
+      glBindBuffer(GL_COPY_READ_BUFFER, m_BufferID);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, GLObjectPool::Name(temp));
+      glBufferData(GL_COPY_WRITE_BUFFER, keepBytes, nullptr, GL_STREAM_COPY);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+
+      BufferData(nullptr, (uint32_t)size, usage);
+
+      glBindBuffer(GL_COPY_READ_BUFFER, GLObjectPool::Name(temp));
+      glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+      GLObjectPool::Destroy(temp);
+   }
+
+   GLintptr GLBuffer::UploadUnsynchronized(const void* data, GLsizeiptr size)
+   {
+      GLsizeiptr segmentSize = (m_Size + RING_SEGMENTS - 1) / RING_SEGMENTS;
+
+      GLintptr offset = ((m_RingHead + 15) / 16) * 16;
+      if(offset + size > m_Size)
+         offset = 0; // wrap
+
+      // entering a segment: fence the one that is left and wait for the GPU to release the new one
+      bool wrapped = offset == 0 && m_RingHead != 0;
+      int firstSegment = (int)(offset / segmentSize);
+      int lastSegment = (int)((offset + size - 1) / segmentSize);
+      for(int segment = firstSegment; segment <= lastSegment; segment++)
+      {
+         if(segment == m_RingSegment && !wrapped)
+            continue;
+         wrapped = false;
+
+         if(m_RingFences[m_RingSegment] != nullptr)
+            glDeleteSync(m_RingFences[m_RingSegment]);
+         m_RingFences[m_RingSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+         m_RingSegment = segment;
+
+         GLsync& fence = m_RingFences[segment];
+         if(fence != nullptr)
+         {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = nullptr;
+         }
+      }
+
+      void* pointer = MapBufferRange(offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+      if(pointer != nullptr)
+      {
+         memcpy(pointer, data, size);
+         UnmapBuffer();
+      }
+
+      m_RingHead = offset + size;
+      return offset;
+   }
+
+   void GLBuffer::DeleteRingFences()
+   {
+      for(int i = 0; i < RING_SEGMENTS; i++)
+      {
+         if(m_RingFences[i] != nullptr)
+            glDeleteSync(m_RingFences[i]);
+         m_RingFences[i] = nullptr;
+      }
+      m_RingHead = 0;
+      m_RingSegment = 0;
+   }
+
+   void* GLBuffer::MapBuffer() 
+   {
+      void* pointer = glMapBuffer(GetGLBufferType(), GL_READ_WRITE); 
+      return pointer;
+   }
+
+   void* GLBuffer::MapBufferRange(GLintptr offset, GLsizeiptr length, GLbitfield access)
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+      return glMapBufferRange(GetGLBufferType(), offset, length, access);
+   }
+
+   void GLBuffer::UnmapBuffer() 
+   {
+      glUnmapBuffer(GetGLBufferType());
+   }
+
+   void GLBuffer::BindBufferBase(GLuint bufferIndex)
+   {
+      glBindBufferBase(GetGLBufferType(), bufferIndex, m_BufferID);
+   }
+
+   void GLBuffer::BindBufferRange(GLuint bufferIndex, GLintptr offset, GLsizeiptr size)
+   {
+      glBindBufferRange(GetGLBufferType(), bufferIndex, m_BufferID, offset, size);
+   }
+
+
+   void GLBuffer::Bind()  const
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+   }
+
+   GLenum GLBuffer::GetGLBufferType() const
+   {
+      return m_BufferType == GLBufferType::ARRAY_BUFFER ? GL_ARRAY_BUFFER
+         : m_BufferType == GLBufferType::ELEMENT_ARRAY_BUFFER ? GL_ELEMENT_ARRAY_BUFFER
+         : m_BufferType == GLBufferType::UNIFORM_BUFFER ? GL_UNIFORM_BUFFER
+         : m_BufferType == GLBufferType::SHADER_STORAGE_BUFFER ? GL_SHADER_STORAGE_BUFFER
+         : m_BufferType == GLBufferType::DISPATCH_INDIRECT_BUFFER ? GL_DISPATCH_INDIRECT_BUFFER
+         : m_BufferType == GLBufferType::DRAW_INDIRECT_BUFFER ? GL_DRAW_INDIRECT_BUFFER
+         : m_BufferType == GLBufferType::PIXEL_UNPACK_BUFFER ? GL_PIXEL_UNPACK_BUFFER
+         : GL_NONE; 
+   }
+
+   GLenum GLBuffer::GetGLBufferUsage(GLBufferUsage usage) const 
+   {
+      return usage == GLBufferUsage::STATIC_DRAW ? GL_STATIC_DRAW
          : usage == GLBufferUsage::DYNAMIC_DRAW ? GL_DYNAMIC_DRAW
          : usage == GLBufferUsage::STREAM_DRAW ? GL_STREAM_DRAW
          : GL_NONE; 
@@ -540,13 +2502,5836 @@ namespace EaseGL
 
 } // namespace EaseGL
 #endif
-/*-- File: src/GLBuffer.cpp end --*/
-/*-- File: src/GLTexture.cpp start --*/
+/*-- File: src/GLBuffer.cpp end --*/
+/*-- File: src/GLContext.cpp start --*/
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <array>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace EaseGL
+{
+   struct GLContextCapabilities
+   {
+      bool loaded = false;
+      GLint majorVersion = 0;
+      GLint minorVersion = 0;
+      std::unordered_set<std::string> extensions;
+      std::string driverIdentity;
+   };
+
+   static GLContextCapabilities s_ContextCapabilities;
+   static uint32_t s_ContextResets = 0;
+
+   // names of what the driver has bound, UNKNOWN until EaseGL binds something or after an invalidation
+   static const GLuint TEXTURE_BINDING_UNKNOWN = 0xFFFFFFFF;
+   static const int TEXTURE_BINDING_TARGETS = 4;
+
+   struct TextureBindingCache
+   {
+      int activeUnit = -1; // -1 if unknown
+      std::vector<std::array<GLuint, TEXTURE_BINDING_TARGETS>> units;
+      TextureBindingStats stats;
+   };
+
+   static TextureBindingCache s_TextureBindings;
+
+   // targets other than these are bound without caching
+   int GetTextureBindingTarget(GLenum target)
+   {
+      return target == GL_TEXTURE_2D ? 0
+         : target == GL_TEXTURE_2D_ARRAY ? 1
+         : target == GL_TEXTURE_CUBE_MAP ? 2
+         : target == GL_TEXTURE_3D ? 3
+         : -1;
+   }
+
+   GLuint* GetCachedTextureBinding(int unit, GLenum target)
+   {
+      int index = GetTextureBindingTarget(target);
+      if(index < 0 || unit < 0)
+         return nullptr;
+      if((size_t)unit >= s_TextureBindings.units.size())
+      {
+         std::array<GLuint, TEXTURE_BINDING_TARGETS> unknown;
+         unknown.fill(TEXTURE_BINDING_UNKNOWN);
+         s_TextureBindings.units.resize(unit + 1, unknown);
+      }
+      return &s_TextureBindings.units[unit][index];
+   }
+
+   void SetActiveTextureUnit(int unit)
+   {
+      if(s_TextureBindings.activeUnit == unit)
+         return;
+      glActiveTexture(GL_TEXTURE0 + unit);
+      s_TextureBindings.activeUnit = unit;
+      s_TextureBindings.stats.activeUnitChanges++;
+   }
+
+   // BindTexture() without counting the request
+   void IssueTextureBind(int unit, GLenum target, GLuint texture)
+   {
+      GLuint* cached = GetCachedTextureBinding(unit, target);
+      if(cached != nullptr && *cached == texture)
+         return;
+
+      SetActiveTextureUnit(unit);
+      glBindTexture(target, texture);
+      s_TextureBindings.stats.issued++;
+      if(cached != nullptr)
+         *cached = texture;
+   }
+
+   bool IsUnitUnbound(int unit)
+   {
+      if((size_t)unit >= s_TextureBindings.units.size())
+         return false;
+      for(GLuint texture : s_TextureBindings.units[unit])
+      {
+         if(texture != 0)
+            return false;
+      }
+      return true;
+   }
+
+   // static
+   void GLContext::LoadCapabilities()
+   {
+      if(s_ContextCapabilities.loaded)
+         return;
+
+      glGetIntegerv(GL_MAJOR_VERSION, &s_ContextCapabilities.majorVersion);
+      glGetIntegerv(GL_MINOR_VERSION, &s_ContextCapabilities.minorVersion);
+
+      GLint extensionCount = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+      for(GLint i = 0; i < extensionCount; i++)
+      {
+         const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+         if(extension != nullptr)
+            s_ContextCapabilities.extensions.insert(extension);
+      }
+
+      const char* strings[] = {
+         (const char*)glGetString(GL_VENDOR),
+         (const char*)glGetString(GL_RENDERER),
+         (const char*)glGetString(GL_VERSION),
+      };
+      for(const char* str : strings)
+      {
+         if(str != nullptr)
+            s_ContextCapabilities.driverIdentity += str;
+         s_ContextCapabilities.driverIdentity += '\n';
+      }
+
+      s_ContextCapabilities.loaded = true;
+   }
+
+   // static
+   bool GLContext::HasVersion(int major, int minor)
+   {
+      LoadCapabilities();
+      return s_ContextCapabilities.majorVersion > major
+         || (s_ContextCapabilities.majorVersion == major && s_ContextCapabilities.minorVersion >= minor);
+   }
+
+   // static
+   bool GLContext::HasExtension(const char* extension)
+   {
+      LoadCapabilities();
+      return s_ContextCapabilities.extensions.count(extension) != 0;
+   }
+
+   // static
+   const std::string& GLContext::DriverIdentity()
+   {
+      LoadCapabilities();
+      return s_ContextCapabilities.driverIdentity;
+   }
+
+   // static
+   void GLContext::BindTexture(int unit, GLenum target, GLuint texture)
+   {
+      s_TextureBindings.stats.requested++;
+      IssueTextureBind(unit, target, texture);
+   }
+
+   // static
+   void GLContext::BindTextures(int firstUnit, int count, const GLenum* targets, const GLuint* textures)
+   {
+      s_TextureBindings.stats.requested += count;
+
+      // only the range that differs from what is bound goes to the driver
+      int first = count, last = -1;
+      for(int i = 0; i < count; i++)
+      {
+         GLuint* cached = GetCachedTextureBinding(firstUnit + i, targets[i]);
+         bool bound = textures[i] == 0 ? IsUnitUnbound(firstUnit + i) : cached != nullptr && *cached == textures[i];
+         if(!bound)
+         {
+            first = first < i ? first : i;
+            last = i;
+         }
+      }
+      if(last < 0)
+         return;
+
+      if(last > first && HasMultiBind())
+      {
+         // doesn't touch the active unit, 0 unbinds every target
+         glBindTextures(firstUnit + first, last - first + 1, textures + first);
+         s_TextureBindings.stats.issued++;
+         for(int i = first; i <= last; i++)
+         {
+            GLuint* cached = GetCachedTextureBinding(firstUnit + i, targets[i]);
+            if(textures[i] == 0)
+               s_TextureBindings.units[firstUnit + i].fill(0);
+            else if(cached != nullptr)
+               *cached = textures[i];
+         }
+         return;
+      }
+
+      for(int i = first; i <= last; i++)
+      {
+         if(textures[i] != 0)
+         {
+            IssueTextureBind(firstUnit + i, targets[i], textures[i]);
+            continue;
+         }
+         const GLenum allTargets[TEXTURE_BINDING_TARGETS] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D };
+         for(GLenum target : allTargets)
+            IssueTextureBind(firstUnit + i, target, 0);
+      }
+   }
+
+   // static
+   void GLContext::BindTextureOnActiveUnit(GLenum target, GLuint texture)
+   {
+      IssueTextureBind(GetActiveTextureUnit(), target, texture);
+   }
+
+   // static
+   int GLContext::GetActiveTextureUnit()
+   {
+      if(s_TextureBindings.activeUnit < 0)
+      {
+         GLint activeTexture = GL_TEXTURE0;
+         glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+         s_TextureBindings.activeUnit = activeTexture - GL_TEXTURE0;
+      }
+      return s_TextureBindings.activeUnit;
+   }
+
+   // static
+   bool GLContext::HasMultiBind()
+   {
+      return HasVersion(4, 4) || HasExtension("GL_ARB_multi_bind");
+   }
+
+   // static
+   void GLContext::InvalidateTexture(GLuint texture)
+   {
+      if(texture == 0)
+         return;
+      for(std::array<GLuint, TEXTURE_BINDING_TARGETS>& unit : s_TextureBindings.units)
+      {
+         for(GLuint& bound : unit)
+         {
+            if(bound == texture)
+               bound = 0;
+         }
+      }
+   }
+
+   // static
+   void GLContext::InvalidateTextureBindings()
+   {
+      s_TextureBindings.units.clear();
+      s_TextureBindings.activeUnit = -1;
+   }
+
+   // static
+   const TextureBindingStats& GLContext::GetTextureBindingStats()
+   {
+      return s_TextureBindings.stats;
+   }
+
+   // static
+   void GLContext::ResetTextureBindingStats()
+   {
+      s_TextureBindings.stats = TextureBindingStats();
+   }
+
+   // static
+   void GLContext::Reset()
+   {
+      s_ContextCapabilities = GLContextCapabilities();
+      InvalidateTextureBindings();
+      s_ContextResets++;
+   }
+
+   // static
+   uint32_t GLContext::ResetCount()
+   {
+      return s_ContextResets;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/GLContext.cpp end --*/
+/*-- File: src/GLObjectPool.cpp start --*/
+/*-- #include "src/GLObjectPool.hpp" start --*/
+/*-- #include "src/GLObjectPool.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <vector>
+
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   struct GLObjectSlot
+   {
+      GLuint name = 0;
+      uint32_t generation = 0;
+      GLObjectType type = GLObjectType::NONE;
+      bool alive = false;
+   };
+
+   struct GLObjectPoolData
+   {
+      std::vector<GLObjectSlot> slots;
+      std::vector<uint32_t> freeSlots;
+      std::vector<GLuint> names[(int)GLObjectType::SAMPLER + 1];
+      uint32_t batchSize = 32;
+      uint32_t liveCount = 0;
+   };
+
+   static GLObjectPoolData s_ObjectPool;
+
+   void GenGLObjectNames(GLObjectType type, GLsizei count, GLuint* names)
+   {
+      if(type == GLObjectType::BUFFER)
+         glGenBuffers(count, names);
+      else if(type == GLObjectType::TEXTURE)
+         glGenTextures(count, names);
+      else if(type == GLObjectType::VERTEX_ARRAY)
+         glGenVertexArrays(count, names);
+      else if(type == GLObjectType::FRAMEBUFFER)
+         glGenFramebuffers(count, names);
+      else if(type == GLObjectType::RENDERBUFFER)
+         glGenRenderbuffers(count, names);
+      else if(type == GLObjectType::SAMPLER)
+         glGenSamplers(count, names);
+   }
+
+   void DeleteGLObjectNames(GLObjectType type, GLsizei count, const GLuint* names)
+   {
+      if(type == GLObjectType::BUFFER)
+         glDeleteBuffers(count, names);
+      else if(type == GLObjectType::TEXTURE)
+         glDeleteTextures(count, names);
+      else if(type == GLObjectType::VERTEX_ARRAY)
+         glDeleteVertexArrays(count, names);
+      else if(type == GLObjectType::FRAMEBUFFER)
+         glDeleteFramebuffers(count, names);
+      else if(type == GLObjectType::RENDERBUFFER)
+         glDeleteRenderbuffers(count, names);
+      else if(type == GLObjectType::SAMPLER)
+         glDeleteSamplers(count, names);
+      else if(type == GLObjectType::PROGRAM)
+      {
+         for(GLsizei i = 0; i < count; i++)
+            glDeleteProgram(names[i]);
+      }
+   }
+
+   // static
+   GLuint GLObjectPool::TakeName(GLObjectType type)
+   {
+      // programs can't be generated ahead of time
+      if(type == GLObjectType::PROGRAM)
+         return glCreateProgram();
+
+      std::vector<GLuint>& names = s_ObjectPool.names[(int)type];
+      if(names.empty())
+      {
+         names.resize(s_ObjectPool.batchSize);
+         GenGLObjectNames(type, (GLsizei)names.size(), names.data());
+      }
+
+      GLuint name = names.back();
+      names.pop_back();
+      return name;
+   }
+
+   // static
+   GLHandle GLObjectPool::Create(GLObjectType type)
+   {
+      GLHandle handle;
+      if(type == GLObjectType::NONE)
+         return handle;
+
+      if(!s_ObjectPool.freeSlots.empty())
+      {
+         handle.index = s_ObjectPool.freeSlots.back();
+         s_ObjectPool.freeSlots.pop_back();
+      }
+      else
+      {
+         handle.index = (uint32_t)s_ObjectPool.slots.size();
+         s_ObjectPool.slots.emplace_back();
+      }
+
+      GLObjectSlot& slot = s_ObjectPool.slots[handle.index];
+      slot.name = TakeName(type);
+      slot.type = type;
+      slot.alive = true;
+      handle.generation = slot.generation;
+
+      s_ObjectPool.liveCount++;
+      return handle;
+   }
+
+   // static
+   void GLObjectPool::Destroy(GLHandle& handle)
+   {
+      if(!IsValid(handle))
+      {
+         handle = GLHandle();
+         return;
+      }
+
+      GLObjectSlot& slot = s_ObjectPool.slots[handle.index];
+      DeleteGLObjectNames(slot.type, 1, &slot.name);
+      // the name can come back from glGenTextures, it must not look bound
+      if(slot.type == GLObjectType::TEXTURE)
+         GLContext::InvalidateTexture(slot.name);
+
+      slot.name = 0;
+      slot.type = GLObjectType::NONE;
+      slot.alive = false;
+      slot.generation++;
+      s_ObjectPool.freeSlots.push_back(handle.index);
+      s_ObjectPool.liveCount--;
+
+      handle = GLHandle();
+   }
+
+   // static
+   bool GLObjectPool::IsValid(GLHandle handle)
+   {
+      return handle.index < s_ObjectPool.slots.size()
+         && s_ObjectPool.slots[handle.index].alive
+         && s_ObjectPool.slots[handle.index].generation == handle.generation;
+   }
+
+   // static
+   GLuint GLObjectPool::Name(GLHandle handle)
+   {
+      return IsValid(handle) ? s_ObjectPool.slots[handle.index].name : 0;
+   }
+
+   // static
+   GLObjectType GLObjectPool::Type(GLHandle handle)
+   {
+      return IsValid(handle) ? s_ObjectPool.slots[handle.index].type : GLObjectType::NONE;
+   }
+
+   // static
+   void GLObjectPool::SetBatchSize(uint32_t count)
+   {
+      s_ObjectPool.batchSize = count > 0 ? count : 1;
+   }
+
+   // static
+   void GLObjectPool::ReleaseUnusedNames()
+   {
+      for(int type = 0; type <= (int)GLObjectType::SAMPLER; type++)
+      {
+         std::vector<GLuint>& names = s_ObjectPool.names[type];
+         if(!names.empty())
+            DeleteGLObjectNames((GLObjectType)type, (GLsizei)names.size(), names.data());
+         names.clear();
+      }
+   }
+
+   // static
+   uint32_t GLObjectPool::LiveObjectCount()
+   {
+      return s_ObjectPool.liveCount;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/GLObjectPool.cpp end --*/
+/*-- File: src/GLTexture.cpp start --*/
+/*-- #include "src/GLTexture.hpp" start --*/
+/*-- #include "src/GLTexture.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+
+
+#ifdef STB_IMAGE_IMPLEMENTATION
+   #undef STB_IMAGE_IMPLEMENTATION
+   #include <stb/stb_image.h>
+   #define STB_IMAGE_IMPLEMENTATION
+#else
+   #include <stb/stb_image.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+/*-- #include "src/CompressedTexture.hpp" start --*/
+/*-- #include "src/CompressedTexture.hpp" end --*/
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   static TextureMemoryStats s_TextureMemory;
+
+   struct TextureStreamRing
+   {
+      std::vector<GLBuffer> buffers;
+      std::vector<GLsync> fences; // signaled once the GPU has read the buffer
+      std::vector<GLsizeiptr> sizes;
+      size_t next = 0;
+      uint64_t orphans = 0;
+
+      // between BeginUpdate() and EndUpdate()
+      int mapped = -1;
+      GLsizeiptr mappedSize = 0;
+      TextureRegion region;
+   };
+
+   GLTexture::~GLTexture()
+   {
+      DeleteStream();
+      DeleteTextures();
+      ReleasePixels();
+   }
+
+   GLTexture::GLTexture(GLTexture&& other) noexcept
+      : m_TextureID(0), m_TextureType(TextureType::NONE), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr)
+   {
+      MoveFrom(other);
+   }
+
+   GLTexture& GLTexture::operator=(GLTexture&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteStream();
+         DeleteTextures();
+         ReleasePixels();
+         MoveFrom(other);
+      }
+      return *this;
+   }
+
+   void GLTexture::MoveFrom(GLTexture& other)
+   {
+      m_TextureID = other.m_TextureID;
+      m_Handle = other.m_Handle;
+      m_TextureType = other.m_TextureType;
+      m_Width = other.m_Width;
+      m_Height = other.m_Height;
+      m_Channels = other.m_Channels;
+      m_Layers = other.m_Layers;
+      m_Pixels = other.m_Pixels;
+      m_PixelBytes = other.m_PixelBytes;
+      m_GpuBytes = other.m_GpuBytes;
+      m_Filepath = std::move(other.m_Filepath);
+      m_CreateInfo = other.m_CreateInfo;
+      m_StorageFormat = other.m_StorageFormat;
+      m_StorageLevels = other.m_StorageLevels;
+      m_Stream = other.m_Stream;
+
+      other.m_TextureID = 0;
+      other.m_Handle = GLHandle();
+      other.m_Pixels = nullptr;
+      other.m_PixelBytes = 0;
+      other.m_GpuBytes = 0;
+      other.m_StorageFormat = 0;
+      other.m_Stream = nullptr;
+   }
+
+   void GLTexture::LoadTexture(const char* filepath) 
+   {
+      int w,h,n,ok;
+      ok = stbi_info(filepath, &w, &h, &n);
+      if(ok == 1)
+         std::cout << "Texture loading " << filepath << " is ok [w:" << w << ", h:" << h << ", n:" << n << "]" << std::endl;
+
+      m_Filepath = filepath;
+      DecodePixels(filepath);
+      GenTextures();
+
+      if(m_CreateInfo.residency != TextureResidency::KEEP)
+         ReleasePixels();
+   }
+
+   bool GLTexture::DecodePixels(const char* filepath)
+   {
+      ReleasePixels();
+
+      int width = 0, height = 0, channels = 0;
+      if(GetPixelType() == GL_FLOAT)
+         m_Pixels = (unsigned char*)stbi_loadf(filepath, &width, &height, &channels, 0);
+      else
+         m_Pixels = stbi_load(filepath, &width, &height, &channels, 0);
+
+      if(m_Pixels == NULL)
+      {
+         std::cout << "ERROR on loading Texture " << filepath << std::endl;
+         return false;
+      }
+
+      m_Width = width;
+      m_Height = height;
+      m_Channels = channels;
+
+      m_PixelBytes = (size_t)width * height * channels * (GetPixelType() == GL_FLOAT ? sizeof(float) : 1);
+      s_TextureMemory.cpuBytes += m_PixelBytes;
+      return true;
+   }
+
+   const void* GLTexture::GetPixels()
+   {
+      if(m_Pixels != nullptr || m_CreateInfo.residency != TextureResidency::RELOAD_ON_DEMAND || m_Filepath.empty())
+         return m_Pixels;
+
+      int width = m_Width, height = m_Height, channels = m_Channels;
+      if(DecodePixels(m_Filepath.c_str()) && (m_Width != width || m_Height != height || m_Channels != channels))
+      {
+         // the file changed on disk, these pixels don't describe the uploaded texture anymore
+         std::cout << "ERROR: " << m_Filepath << " changed since it was uploaded" << std::endl;
+         ReleasePixels();
+         m_Width = width;
+         m_Height = height;
+         m_Channels = channels;
+      }
+      return m_Pixels;
+   }
+
+   void GLTexture::ReleasePixels()
+   {
+      if(m_Pixels == nullptr)
+         return;
+      stbi_image_free(m_Pixels);
+      m_Pixels = nullptr;
+      s_TextureMemory.cpuBytes -= m_PixelBytes;
+      m_PixelBytes = 0;
+   }
+
+   // static
+   const TextureMemoryStats& GLTexture::GetMemoryStats()
+   {
+      return s_TextureMemory;
+   }
+
+   GLTexture::GLTexture(TextureType type) 
+      : m_TextureID(0), m_TextureType(type), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath("")
+   {
+   }
+
+   GLTexture::GLTexture(TextureType type, const char* filepath)
+      : m_TextureID(0), m_TextureType(type), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath(filepath)
+   {
+      LoadTexture(filepath);
+   }
+
+   GLTexture::GLTexture(TextureType type, const TextureCreateInfo& createInfo)
+      : m_TextureID(0), m_TextureType(type), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath(""), m_CreateInfo(createInfo)
+   {
+   }
+
+   GLTexture::GLTexture(GLuint textureID, TextureType textureType)
+      : m_TextureID(textureID), m_TextureType(textureType), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr)
+   {
+   }
+   
+
+   GLenum GetTextureTarget(TextureType type)
+   {
+      return type == TextureType::TEXTURE2D ? GL_TEXTURE_2D
+         : type == TextureType::TEXTURE2D_ARRAY ? GL_TEXTURE_2D_ARRAY
+         : type == TextureType::TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP
+         : type == TextureType::TEXTURE3D ? GL_TEXTURE_3D
+         : GL_NONE;
+   }
+
+   GLenum GLTexture::GetGLTextureType() const
+   {
+      return GetTextureTarget(m_TextureType);
+   }
+
+   GLenum GLTexture::GetInternalFormat(int channels) const
+   {
+      switch(m_CreateInfo.format)
+      {
+         case TextureFormat::R8: return GL_R8;
+         case TextureFormat::RG8: return GL_RG8;
+         case TextureFormat::RGB8: return GL_RGB8;
+         case TextureFormat::RGBA8: return GL_RGBA8;
+         case TextureFormat::SRGB8: return GL_SRGB8;
+         case TextureFormat::SRGB8_ALPHA8: return GL_SRGB8_ALPHA8;
+         case TextureFormat::R16F: return GL_R16F;
+         case TextureFormat::RG16F: return GL_RG16F;
+         case TextureFormat::RGB16F: return GL_RGB16F;
+         case TextureFormat::RGBA16F: return GL_RGBA16F;
+         default:
+            return channels == 1 ? GL_R8
+               : channels == 2 ? GL_RG8
+               : channels == 3 ? (m_CreateInfo.srgb ? GL_SRGB8 : GL_RGB8)
+               : (m_CreateInfo.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8);
+      }
+   }
+
+   GLenum GLTexture::GetPixelType() const
+   {
+      return m_CreateInfo.format == TextureFormat::R16F || m_CreateInfo.format == TextureFormat::RG16F
+         || m_CreateInfo.format == TextureFormat::RGB16F || m_CreateInfo.format == TextureFormat::RGBA16F ? GL_FLOAT
+         : GL_UNSIGNED_BYTE;
+   }
+
+   // levels down to 1x1, what glGenerateMipmap fills
+   GLsizei GetTextureLevelCount(int width, int height, int depth)
+   {
+      int size = std::max(std::max(width, height), depth);
+      GLsizei levels = 1;
+      while(size > 1)
+      {
+         size >>= 1;
+         levels++;
+      }
+      return levels;
+   }
+
+   size_t GetTextureLevelBytes(GLenum internalFormat, int width, int height)
+   {
+      size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+      size_t texels = (size_t)width * height;
+      switch(internalFormat)
+      {
+         case GL_R8: return texels;
+         case GL_RG8: case GL_R16F: return texels * 2;
+         case GL_RGB8: case GL_SRGB8: return texels * 3;
+         case GL_RGBA8: case GL_SRGB8_ALPHA8: case GL_RG16F: return texels * 4;
+         case GL_RGB16F: return texels * 6;
+         case GL_RGBA16F: return texels * 8;
+         case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+         case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+         case GL_COMPRESSED_RED_RGTC1: case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+            return blocks * 8;
+         default: // remaining block compressed formats
+            return blocks * 16;
+      }
+   }
+
+   bool IsUnpackBufferBound()
+   {
+      GLint unpackBuffer = 0;
+      glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+      return unpackBuffer != 0;
+   }
+
+   // offset 0 into a bound unpack buffer is null too
+   bool HasTexturePixels(const void* pixels)
+   {
+      return pixels != nullptr || IsUnpackBufferBound();
+   }
+
+   GLenum GetTexturePixelFormat(int channels)
+   {
+      return channels == 4 ? GL_RGBA : channels == 3 ? GL_RGB : channels == 2 ? GL_RG : channels == 1 ? GL_RED : GL_NONE;
+   }
+
+   // returns the previous alignment, or 0 if it didn't need to change
+   GLint SetTextureUnpackAlignment(int channels)
+   {
+      GLint oldUnpackAlignment = 0;
+      glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldUnpackAlignment);
+      // if channels == 3 -> pixels should be aligned by 1, else(1, 2, 4) it can be aligned to channels itself
+      GLint alignment = channels == 3 ? 1 : channels;
+      if(alignment == oldUnpackAlignment || alignment <= 0)
+         return 0; // to prevent unnecessary GPU calls
+
+      glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+      return oldUnpackAlignment;
+   }
+
+   void GLTexture::CreateTexture()
+   {
+      DeleteTextures();
+
+      m_Handle = GLObjectPool::Create(GLObjectType::TEXTURE);
+      m_TextureID = GLObjectPool::Name(m_Handle);
+      BindForEdit();
+
+      glTexParameteri(GetGLTextureType(), GL_TEXTURE_WRAP_S, GL_REPEAT);	
+      glTexParameteri(GetGLTextureType(), GL_TEXTURE_WRAP_T, GL_REPEAT);
+      glTexParameteri(GetGLTextureType(), GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+      {
+         // repeating would filter across to the opposite edge of a face
+         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+      }
+      else if(m_TextureType == TextureType::TEXTURE3D)
+         glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+   }
+
+   bool GLTexture::AllocateStorage(GLenum internalFormat, int width, int height, int layers, GLsizei levels)
+   {
+      // glTexStorage* rejects empty images, which failed loads end up as
+      bool immutable = (GLContext::HasVersion(4, 2) || GLContext::HasExtension("GL_ARB_texture_storage"))
+         && width > 0 && height > 0 && layers > 0;
+      bool matches = m_StorageFormat == internalFormat && m_StorageLevels == levels
+         && m_Width == width && m_Height == height && m_Layers == layers;
+
+      m_Width = width;
+      m_Height = height;
+      m_Layers = layers;
+
+      size_t bytes = 0;
+      for(GLsizei level = 0; level < levels; level++)
+      {
+         int depth = m_TextureType == TextureType::TEXTURE3D ? std::max(layers >> level, 1) : layers;
+         bytes += GetTextureLevelBytes(internalFormat, std::max(width >> level, 1), std::max(height >> level, 1)) * depth;
+      }
+
+      if(m_TextureID != 0 && (!immutable || matches))
+      {
+         BindForEdit();
+         if(!immutable)
+            glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAX_LEVEL, levels - 1);
+         SetGpuBytes(bytes);
+         return immutable;
+      }
+
+      // immutable storage can't be respecified, it takes a new texture object
+      CreateTexture();
+      SetGpuBytes(bytes);
+      if(!immutable)
+      {
+         glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAX_LEVEL, levels - 1);
+         return false;
+      }
+
+      if(m_TextureType == TextureType::TEXTURE2D || m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+         glTexStorage2D(GetGLTextureType(), levels, internalFormat, width, height);
+      else
+         glTexStorage3D(GetGLTextureType(), levels, internalFormat, width, height, layers);
+      m_StorageFormat = internalFormat;
+      m_StorageLevels = levels;
+      return true;
+   }
+
+   void GLTexture::SetGpuBytes(size_t bytes)
+   {
+      if(m_GpuBytes == 0 && bytes != 0)
+         s_TextureMemory.textures++;
+      else if(m_GpuBytes != 0 && bytes == 0)
+         s_TextureMemory.textures--;
+      s_TextureMemory.gpuBytes += bytes;
+      s_TextureMemory.gpuBytes -= m_GpuBytes;
+      m_GpuBytes = bytes;
+   }
+
+   void GLTexture::GenTextures()
+   {
+      CreateTexture();
+      Upload(m_Width, m_Height, m_Channels, m_Pixels);
+   }
+
+   void GLTexture::Upload(int width, int height, int channels, const void* pixels)
+   {
+      if(m_TextureType != TextureType::TEXTURE2D)
+      {
+         SpecifyLayers(width, height, m_TextureType == TextureType::TEXTURE_CUBE_MAP ? 6 : 1, channels, pixels, 0);
+         return;
+      }
+
+      // pixels in client memory can be filtered here, an unpack buffer would have to be read back first
+      if(m_CreateInfo.mipmaps && m_CreateInfo.mipFilter != MipFilter::NONE && GetPixelType() == GL_UNSIGNED_BYTE
+         && pixels != nullptr && !IsUnpackBufferBound() && (width > 1 || height > 1))
+      {
+         MipChain chain;
+         if(MipGenerator::Build((const unsigned char*)pixels, width, height, channels, m_CreateInfo.mipFilter, m_CreateInfo.IsSRGB(channels), chain))
+         {
+            UploadMipChain(chain);
+            return;
+         }
+      }
+
+      m_Channels = channels;
+      GLenum internalFormat = GetInternalFormat(channels);
+      GLsizei levels = m_CreateInfo.mipmaps ? GetTextureLevelCount(width, height, 1) : 1;
+      bool immutable = AllocateStorage(internalFormat, width, height, 1, levels);
+      bool hasPixels = HasTexturePixels(pixels);
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(m_Channels);
+
+      if(immutable)
+      {
+         if(hasPixels)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+      }
+      else
+      {
+         glTexImage2D(GL_TEXTURE_2D, 0,
+            internalFormat, // store in GPU as
+            m_Width, m_Height,
+            0, // border
+            GetTexturePixelFormat(m_Channels), // which format does our image is, (can be found from 'm_Channels')
+            GetPixelType(),
+            pixels);
+      }
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+
+      if(levels > 1 && hasPixels)
+         glGenerateMipmap(GL_TEXTURE_2D);
+   }
+
+   void GLTexture::SubImage(int x, int y, int width, int height, int channels, const void* pixels)
+   {
+      BindForEdit();
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+
+      glTexSubImage2D(GetGLTextureType(), 0, x, y, width, height, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+   }
+
+   void GLTexture::SpecifyLayers(int width, int height, int layers, int channels, const void* pixels, size_t layerStride)
+   {
+      m_Channels = channels;
+      GLenum target = GetGLTextureType();
+      GLenum internalFormat = GetInternalFormat(channels);
+      // array layers and cube faces don't shrink down the chain, 3D slices do
+      GLsizei levels = m_CreateInfo.mipmaps ? GetTextureLevelCount(width, height, m_TextureType == TextureType::TEXTURE3D ? layers : 1) : 1;
+      bool immutable = AllocateStorage(internalFormat, width, height, layers, levels);
+      bool hasPixels = HasTexturePixels(pixels);
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+      GLenum format = GetTexturePixelFormat(channels);
+      GLenum type = GetPixelType();
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+      {
+         for(int face = 0; face < 6 && face < layers; face++)
+         {
+            const unsigned char* facePixels = hasPixels ? (const unsigned char*)pixels + layerStride * face : nullptr;
+            if(immutable && hasPixels)
+               glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, width, height, format, type, facePixels);
+            else if(!immutable)
+               glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, internalFormat, width, height, 0, format, type, facePixels);
+         }
+      }
+      else if(layerStride == 0 && layers > 1 && hasPixels)
+      {
+         if(!immutable)
+            glTexImage3D(target, 0, internalFormat, width, height, layers, 0, format, type, nullptr);
+         for(int layer = 0; layer < layers; layer++)
+            glTexSubImage3D(target, 0, 0, 0, layer, width, height, 1, format, type, pixels);
+      }
+      else if(immutable && hasPixels)
+         glTexSubImage3D(target, 0, 0, 0, 0, width, height, layers, format, type, pixels);
+      else if(!immutable)
+         glTexImage3D(target, 0, internalFormat, width, height, layers, 0, format, type, pixels);
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+
+      if(levels > 1 && hasPixels)
+         glGenerateMipmap(target);
+   }
+
+   void GLTexture::Update(const TextureRegion& region, const void* pixels)
+   {
+      void* pointer = BeginUpdate(region);
+      if(pointer == nullptr)
+         return;
+      memcpy(pointer, pixels, m_Stream->mappedSize);
+      EndUpdate();
+   }
+
+   void* GLTexture::BeginUpdate(const TextureRegion& region)
+   {
+      if(m_Stream != nullptr && m_Stream->mapped >= 0)
+      {
+         std::cout << "ERROR: BeginUpdate() called again before EndUpdate()" << std::endl;
+         return nullptr;
+      }
+
+      TextureRegion target = region;
+      if(target.width == 0)
+         target.width = m_Width - target.x;
+      if(target.height == 0)
+         target.height = m_Height - target.y;
+      if(m_TextureID == 0 || m_Channels == 0 || target.x < 0 || target.y < 0 || target.width <= 0 || target.height <= 0
+         || target.x + target.width > m_Width || target.y + target.height > m_Height || target.layer < 0 || target.layer >= m_Layers)
+      {
+         std::cout << "ERROR: Update() region " << target.x << ", " << target.y << " " << target.width << "x" << target.height
+            << " layer " << target.layer << " is outside of the " << m_Width << "x" << m_Height << " texture" << std::endl;
+         return nullptr;
+      }
+
+      if(m_Stream == nullptr)
+      {
+         uint32_t count = std::max(m_CreateInfo.updateBuffers, 1u);
+         m_Stream = new TextureStreamRing();
+         for(uint32_t i = 0; i < count; i++)
+            m_Stream->buffers.emplace_back(GLBufferType::PIXEL_UNPACK_BUFFER);
+         m_Stream->fences.assign(count, nullptr);
+         m_Stream->sizes.assign(count, 0);
+      }
+
+      size_t index = m_Stream->next;
+      GLBuffer& buffer = m_Stream->buffers[index];
+      GLsync& fence = m_Stream->fences[index];
+      GLsizeiptr size = (GLsizeiptr)target.width * target.height * m_Channels * (GetPixelType() == GL_FLOAT ? sizeof(float) : 1);
+
+      bool inUse = false;
+      if(fence != nullptr)
+      {
+         inUse = glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED;
+         glDeleteSync(fence);
+         fence = nullptr;
+      }
+      if(inUse || size > m_Stream->sizes[index])
+      {
+         // fresh storage, the driver keeps the old one alive until the GPU is done reading it
+         if(inUse)
+            m_Stream->orphans++;
+         m_Stream->sizes[index] = std::max(size, m_Stream->sizes[index]);
+         buffer.BufferData(nullptr, (uint32_t)m_Stream->sizes[index], GLBufferUsage::STREAM_DRAW);
+      }
+
+      // the fence or the new storage already guarantees the GPU isn't reading it
+      void* pointer = buffer.MapBufferRange(0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      // unbound until EndUpdate(), so client memory uploads in between don't read from the mapped buffer
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      if(pointer == nullptr)
+      {
+         std::cout << "ERROR: Failed to map " << size << " bytes for a texture update" << std::endl;
+         return nullptr;
+      }
+
+      m_Stream->mapped = (int)index;
+      m_Stream->mappedSize = size;
+      m_Stream->region = target;
+      return pointer;
+   }
+
+   void GLTexture::EndUpdate()
+   {
+      if(m_Stream == nullptr || m_Stream->mapped < 0)
+      {
+         std::cout << "ERROR: EndUpdate() called without BeginUpdate()" << std::endl;
+         return;
+      }
+
+      size_t index = (size_t)m_Stream->mapped;
+      GLBuffer& buffer = m_Stream->buffers[index];
+      buffer.Bind();
+      buffer.UnmapBuffer();
+
+      // offset 0 into the bound unpack buffer
+      const TextureRegion& region = m_Stream->region;
+      SubImageLayer(region.layer, region.x, region.y, region.width, region.height, m_Channels, nullptr);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      m_Stream->fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      m_Stream->next = (index + 1) % m_Stream->buffers.size();
+      m_Stream->mapped = -1;
+   }
+
+   uint64_t GLTexture::UpdateOrphanCount() const
+   {
+      return m_Stream != nullptr ? m_Stream->orphans : 0;
+   }
+
+   void GLTexture::DeleteStream()
+   {
+      if(m_Stream == nullptr)
+         return;
+
+      if(m_Stream->mapped >= 0)
+      {
+         m_Stream->buffers[m_Stream->mapped].Bind();
+         m_Stream->buffers[m_Stream->mapped].UnmapBuffer();
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      }
+      for(GLsync fence : m_Stream->fences)
+      {
+         if(fence != nullptr)
+            glDeleteSync(fence);
+      }
+      delete m_Stream;
+      m_Stream = nullptr;
+   }
+
+   void GLTexture::UploadLayers(int width, int height, int layers, int channels, const void* pixels)
+   {
+      if(m_TextureType == TextureType::TEXTURE2D)
+      {
+         std::cout << "ERROR: UploadLayers() on a 2D texture, use Upload()" << std::endl;
+         return;
+      }
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP && layers != 6)
+      {
+         std::cout << "ERROR: Cube maps need 6 faces, got " << layers << std::endl;
+         return;
+      }
+
+      size_t componentSize = GetPixelType() == GL_FLOAT ? sizeof(float) : 1;
+      SpecifyLayers(width, height, layers, channels, pixels, (size_t)width * height * channels * componentSize);
+   }
+
+   void GLTexture::SubImageLayer(int layer, int x, int y, int width, int height, int channels, const void* pixels)
+   {
+      if(m_TextureType == TextureType::TEXTURE2D)
+      {
+         SubImage(x, y, width, height, channels, pixels);
+         return;
+      }
+
+      BindForEdit();
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+         glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer, 0, x, y, width, height, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+      else
+         glTexSubImage3D(GetGLTextureType(), 0, x, y, layer, width, height, 1, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+   }
+
+   bool GLTexture::LoadLayers(const std::vector<std::string>& filepaths)
+   {
+      if(m_TextureType == TextureType::TEXTURE2D || filepaths.empty())
+      {
+         std::cout << "ERROR: LoadLayers() needs an array, cube map or 3D texture and at least one file" << std::endl;
+         return false;
+      }
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP && filepaths.size() != 6)
+      {
+         std::cout << "ERROR: Cube maps need 6 faces, got " << filepaths.size() << std::endl;
+         return false;
+      }
+
+      // storage is specified from the first file, the rest are decoded and uploaded one at a time
+      int width = 0, height = 0, channels = 0;
+      for(size_t layer = 0; layer < filepaths.size(); layer++)
+      {
+         int w, h, n;
+         void* decoded = GetPixelType() == GL_FLOAT ? (void*)stbi_loadf(filepaths[layer].c_str(), &w, &h, &n, 0)
+            : (void*)stbi_load(filepaths[layer].c_str(), &w, &h, &n, 0);
+         std::unique_ptr<void, void(*)(void*)> pixels(decoded, stbi_image_free);
+         if(pixels == nullptr)
+         {
+            std::cout << "ERROR on loading Texture " << filepaths[layer] << std::endl;
+            return false;
+         }
+
+         if(layer == 0)
+         {
+            width = w;
+            height = h;
+            channels = n;
+            SpecifyLayers(width, height, (int)filepaths.size(), channels, nullptr, 0);
+         }
+         else if(w != width || h != height || n != channels)
+         {
+            std::cout << "ERROR: " << filepaths[layer] << " is " << w << "x" << h << "x" << n
+               << ", other layers are " << width << "x" << height << "x" << channels << std::endl;
+            return false;
+         }
+
+         SubImageLayer((int)layer, 0, 0, w, h, n, pixels.get());
+      }
+
+      if(m_CreateInfo.mipmaps)
+         GenerateMipmaps();
+      return true;
+   }
+
+   bool GLTexture::LoadCompressed(const char* filepath)
+   {
+      CompressedImage image;
+      if(!CompressedTexture::Load(filepath, image))
+         return false;
+      return UploadCompressed(image);
+   }
+
+   bool GLTexture::UploadCompressed(const CompressedImage& image)
+   {
+      if(m_TextureType != TextureType::TEXTURE2D || image.levels.empty())
+      {
+         std::cout << "ERROR: Compressed images can only be uploaded to 2D textures" << std::endl;
+         return false;
+      }
+      // images built by hand skip the container checks
+      if((int)image.levels.size() > CompressedTexture::MaxLevelCount(image.width, image.height))
+      {
+         std::cout << "ERROR: Compressed image has " << image.levels.size() << " levels, a " << image.width << "x" << image.height
+            << " chain has " << CompressedTexture::MaxLevelCount(image.width, image.height) << std::endl;
+         return false;
+      }
+
+      // checked up front so a failed decode leaves the texture untouched
+      bool onGpu = CompressedTexture::IsSupported(image.format, image.srgb);
+      int channels = CompressedTexture::DecodedChannels(image.format);
+      if(!onGpu && channels == 0)
+      {
+         std::cout << "ERROR: Compressed format " << (int)image.format << " is not supported by the driver and has no CPU decoder" << std::endl;
+         return false;
+      }
+
+      m_Channels = channels != 0 ? channels : 4;
+      // decoded levels get a plain format of the same channel count
+      GLenum internalFormat = onGpu ? CompressedTexture::GetGLFormat(image.format, image.srgb)
+         : channels == 1 ? GL_R8 : channels == 2 ? GL_RG8 : image.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+      // compressed levels can't be generated, a file without a full chain only samples what it stores
+      GLsizei levels = (GLsizei)image.levels.size();
+      bool immutable = AllocateStorage(internalFormat, image.width, image.height, 1, levels);
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+      std::vector<unsigned char> pixels;
+      for(GLsizei level = 0; level < levels; level++)
+      {
+         const CompressedLevel& info = image.levels[level];
+         if(onGpu && immutable)
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, internalFormat, (GLsizei)info.size, image.LevelData(level));
+         else if(onGpu)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, info.width, info.height, 0, (GLsizei)info.size, image.LevelData(level));
+         else
+         {
+            pixels.resize((size_t)info.width * info.height * channels);
+            CompressedTexture::Decode(image.format, info.width, info.height, image.LevelData(level), pixels.data());
+            if(immutable)
+               glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, GetTexturePixelFormat(channels), GL_UNSIGNED_BYTE, pixels.data());
+            else
+               glTexImage2D(GL_TEXTURE_2D, level, internalFormat, info.width, info.height, 0, GetTexturePixelFormat(channels), GL_UNSIGNED_BYTE, pixels.data());
+         }
+      }
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+      return true;
+   }
+
+   bool GLTexture::UploadMipChain(const MipChain& chain, GLintptr unpackOffset /* = 0*/)
+   {
+      if(m_TextureType != TextureType::TEXTURE2D || chain.levels.empty() || GetPixelType() != GL_UNSIGNED_BYTE)
+      {
+         std::cout << "ERROR: Mip chains can only be uploaded to 2D textures with an 8 bit format" << std::endl;
+         return false;
+      }
+
+      m_Channels = chain.channels;
+      GLenum internalFormat = GetInternalFormat(chain.channels);
+      GLenum format = GetTexturePixelFormat(chain.channels);
+      bool immutable = AllocateStorage(internalFormat, chain.width, chain.height, 1, (GLsizei)chain.levels.size());
+      const unsigned char* base = IsUnpackBufferBound() ? (const unsigned char*)unpackOffset : chain.data.data();
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(chain.channels);
+      for(size_t level = 0; level < chain.levels.size(); level++)
+      {
+         const MipLevel& info = chain.levels[level];
+         if(immutable)
+            glTexSubImage2D(GL_TEXTURE_2D, (GLint)level, 0, 0, info.width, info.height, format, GL_UNSIGNED_BYTE, base + info.offset);
+         else
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, info.width, info.height, 0, format, GL_UNSIGNED_BYTE, base + info.offset);
+      }
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+      return true;
+   }
+
+   void GLTexture::GenerateMipmaps()
+   {
+      BindForEdit();
+      glGenerateMipmap(GetGLTextureType());
+   }
+
+   void GLTexture::DeleteTextures()
+   {
+      // textures that aren't owned have no handle
+      if(GLObjectPool::IsValid(m_Handle))
+         GLObjectPool::Destroy(m_Handle);
+      m_TextureID = 0;
+      m_StorageFormat = 0;
+      m_StorageLevels = 0;
+      SetGpuBytes(0);
+   }
+
+   void GLTexture::Bind(int slot /* = 0*/) const
+   {
+      GLContext::BindTexture(slot, GetGLTextureType(), m_TextureID);
+   }
+
+   void GLTexture::BindForEdit() const
+   {
+      GLContext::BindTextureOnActiveUnit(GetGLTextureType(), m_TextureID);
+   }
+
+   // static
+   void GLTexture::Unbind(TextureType type)
+   {
+      GLContext::BindTextureOnActiveUnit(GetTextureTarget(type), 0);
+   }
+
+   // static
+   void GLTexture::BindTextures(int firstSlot, std::initializer_list<const GLTexture*> textures)
+   {
+      GLenum targets[32];
+      GLuint names[32];
+      int count = 0;
+      for(const GLTexture* texture : textures)
+      {
+         targets[count] = texture != nullptr ? texture->GetGLTextureType() : GL_TEXTURE_2D;
+         names[count] = texture != nullptr ? texture->m_TextureID : 0;
+         if(++count == 32)
+         {
+            // more than a material uses, split up
+            GLContext::BindTextures(firstSlot, count, targets, names);
+            firstSlot += count;
+            count = 0;
+         }
+      }
+      if(count > 0)
+         GLContext::BindTextures(firstSlot, count, targets, names);
+   }
+} // namespace EaseGL
+
+#endif
+/*-- File: src/GLTexture.cpp end --*/
+/*-- File: src/MipChain.cpp start --*/
+/*-- #include "src/MipChain.hpp" start --*/
+/*-- #include "src/MipChain.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+/*-- #include "src/PixelConvert.hpp" start --*/
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace EaseGL
+{
+	/**
+	 * @brief Pixel format conversions for the upload path, so the driver is handed data already in its final layout.
+	 * The backend is picked at compile time: AVX2, SSSE3 or SSE2, with a scalar fallback for the rest (ARM included)
+	 * and for the tails. ToHalf() is only vectorized when F16C is enabled too (-mf16c, or -march=haswell and later).
+	 * Define EASEGL_PIXELCONVERT_SCALAR to force the fallback.
+	 * All kernels give the same results on every backend. Safe to call from any thread.
+	 */
+	class PixelConvert
+	{
+		private:
+			PixelConvert() {}
+		public:
+			/** @brief 3 bytes per pixel to 4, 'alpha' is written to the new channel. 'rgb' and 'rgba' can't overlap */
+			static void RGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha = 255);
+
+			/** @brief Multiplies color by alpha (rounded c * a / 255), alpha is kept. 'out' may be 'rgba' */
+			static void PremultiplyAlpha(const uint8_t* rgba, uint8_t* out, size_t pixelCount);
+
+			/** @brief Swaps the first and third channel, BGRA <-> RGBA. 'out' may be 'in' */
+			static void SwapRedBlue(const uint8_t* in, uint8_t* out, size_t pixelCount);
+
+			/** @brief 8 bit unorm values to half floats (value / 255), for 16F textures */
+			static void ToHalf(const uint8_t* in, uint16_t* out, size_t valueCount);
+
+			/** @brief 1 byte per pixel to 2, red is the gray value and green is 'green' */
+			static void GrayToRG(const uint8_t* gray, uint8_t* rg, size_t pixelCount, uint8_t green = 255);
+
+			/**
+			 * @brief Averages 2x2 blocks of 'channels' byte pixels (rounded), one mip level step of a box filter.
+			 * 'row0' and 'row1' hold 2 * 'outPixels' pixels each, 'out' gets 'outPixels'. Vectorized for 4 channels
+			 */
+			static void HalveBox(const uint8_t* row0, const uint8_t* row1, uint8_t* out, size_t outPixels, int channels);
+
+			/** @brief "AVX2", "SSSE3", "SSE2" or "scalar" */
+			static const char* Backend();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/PixelConvert.hpp" end --*/
+
+namespace EaseGL
+{
+   struct MipCacheHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t key;
+      int32_t width, height, channels;
+      uint32_t levelCount;
+      uint64_t dataSize;
+   };
+
+   static const uint32_t MIP_CACHE_MAGIC = 0x434D4745; // "EGMC"
+
+   struct MipCacheData
+   {
+      std::mutex mutex;
+      std::string directory;
+      MipCacheStats stats;
+   };
+   static MipCacheData s_MipCache;
+
+   // Kaiser window over a sinc, half width in destination texels and the window shape
+   static const float MIP_KAISER_WIDTH = 3.0f;
+   static const float MIP_KAISER_ALPHA = 4.0f;
+
+   struct MipTap
+   {
+      int index;
+      float weight;
+   };
+
+   // every destination texel has 'tapCount' taps, unused ones have weight 0
+   struct MipFilterTaps
+   {
+      int tapCount = 0;
+      std::vector<MipTap> taps;
+   };
+
+   struct MipColorTables
+   {
+      float unorm[256];
+      float srgbToLinear[256];
+      float srgbThresholds[255]; // linear value halfway between consecutive encoded values
+
+      MipColorTables()
+      {
+         for(int i = 0; i < 256; i++)
+         {
+            unorm[i] = i / 255.0f;
+            srgbToLinear[i] = (float)SRGBToLinear(i / 255.0);
+         }
+         for(int i = 0; i < 255; i++)
+            srgbThresholds[i] = (float)SRGBToLinear((i + 0.5) / 255.0);
+      }
+
+      static double SRGBToLinear(double value)
+      {
+         return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+      }
+   };
+
+   const MipColorTables& GetMipColorTables()
+   {
+      static MipColorTables tables;
+      return tables;
+   }
+
+   // same as rounding the encoded value, the encoding is monotonic
+   inline uint8_t EncodeMipSRGB(const MipColorTables& tables, float linear)
+   {
+      const float* end = tables.srgbThresholds + 255;
+      return (uint8_t)(std::upper_bound(tables.srgbThresholds, end, linear) - tables.srgbThresholds);
+   }
+
+   inline uint8_t EncodeMipUnorm(float value)
+   {
+      value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+      return (uint8_t)(value * 255.0f + 0.5f);
+   }
+
+   double MipBesselI0(double x)
+   {
+      double sum = 1.0, term = 1.0;
+      for(int k = 1; k < 32 && term > sum * 1e-12; k++)
+      {
+         term *= (x * 0.5 / k) * (x * 0.5 / k);
+         sum += term;
+      }
+      return sum;
+   }
+
+   float MipKaiserWeight(float t)
+   {
+      if(std::fabs(t) >= MIP_KAISER_WIDTH)
+         return 0.0f;
+      double x = t / MIP_KAISER_WIDTH;
+      double sinc = t == 0.0f ? 1.0 : std::sin(3.14159265358979 * t) / (3.14159265358979 * t);
+      return (float)(sinc * MipBesselI0(MIP_KAISER_ALPHA * std::sqrt(1.0 - x * x)) / MipBesselI0(MIP_KAISER_ALPHA));
+   }
+
+   // source texels and weights for each destination texel along one axis, edges are clamped
+   void ComputeMipTaps(int srcSize, int dstSize, MipFilter filter, MipFilterTaps& result)
+   {
+      float scale = (float)srcSize / dstSize;
+      std::vector<std::vector<MipTap>> texels(dstSize);
+      for(int x = 0; x < dstSize; x++)
+      {
+         std::vector<MipTap>& taps = texels[x];
+         if(filter == MipFilter::BOX)
+         {
+            // area of each source texel covered by the destination texel, odd sizes get fractional weights
+            float low = x * scale, high = low + scale;
+            for(int i = (int)low; i < srcSize && i < high; i++)
+            {
+               float weight = std::min(high, i + 1.0f) - std::max(low, (float)i);
+               if(weight > 0.0f)
+                  taps.push_back({ i, weight });
+            }
+         }
+         else
+         {
+            float center = (x + 0.5f) * scale;
+            float radius = MIP_KAISER_WIDTH * scale;
+            for(int i = (int)std::floor(center - radius); i <= (int)std::ceil(center + radius); i++)
+            {
+               float weight = MipKaiserWeight((i + 0.5f - center) / scale);
+               if(weight != 0.0f)
+                  taps.push_back({ std::min(std::max(i, 0), srcSize - 1), weight });
+            }
+         }
+
+         float sum = 0.0f;
+         for(const MipTap& tap : taps)
+            sum += tap.weight;
+         for(MipTap& tap : taps)
+            tap.weight /= sum;
+         result.tapCount = std::max(result.tapCount, (int)taps.size());
+      }
+
+      result.taps.assign((size_t)dstSize * result.tapCount, { 0, 0.0f });
+      for(int x = 0; x < dstSize; x++)
+         std::copy(texels[x].begin(), texels[x].end(), result.taps.begin() + (size_t)x * result.tapCount);
+   }
+
+   // separable filter of destination rows [rowBegin, rowEnd): columns first into a float row, then along it
+   void FilterMipRows(const unsigned char* src, int srcWidth, unsigned char* dst, int dstWidth, int channels, bool srgb,
+      const MipFilterTaps& xTaps, const MipFilterTaps& yTaps, int rowBegin, int rowEnd)
+   {
+      const MipColorTables& tables = GetMipColorTables();
+      int colorChannels = channels == 2 || channels == 4 ? channels - 1 : channels;
+      const float* decode[4];
+      for(int c = 0; c < channels; c++)
+         decode[c] = srgb && c < colorChannels ? tables.srgbToLinear : tables.unorm;
+
+      size_t srcRowSize = (size_t)srcWidth * channels;
+      std::vector<float> row(srcRowSize);
+      for(int y = rowBegin; y < rowEnd; y++)
+      {
+         std::fill(row.begin(), row.end(), 0.0f);
+         for(int t = 0; t < yTaps.tapCount; t++)
+         {
+            const MipTap& tap = yTaps.taps[(size_t)y * yTaps.tapCount + t];
+            if(tap.weight == 0.0f)
+               continue;
+            const unsigned char* srcRow = src + tap.index * srcRowSize;
+            if(!srgb)
+            {
+               float weight = tap.weight * (1.0f / 255.0f);
+               for(size_t i = 0; i < srcRowSize; i++)
+                  row[i] += weight * srcRow[i];
+            }
+            else
+            {
+               for(size_t i = 0; i < srcRowSize; i += channels)
+                  for(int c = 0; c < channels; c++)
+                     row[i + c] += tap.weight * decode[c][srcRow[i + c]];
+            }
+         }
+
+         unsigned char* dstRow = dst + (size_t)y * dstWidth * channels;
+         for(int x = 0; x < dstWidth; x++)
+         {
+            float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            const MipTap* taps = xTaps.taps.data() + (size_t)x * xTaps.tapCount;
+            for(int t = 0; t < xTaps.tapCount; t++)
+            {
+               const float* texel = row.data() + (size_t)taps[t].index * channels;
+               for(int c = 0; c < channels; c++)
+                  sums[c] += taps[t].weight * texel[c];
+            }
+            for(int c = 0; c < channels; c++)
+               dstRow[x * channels + c] = srgb && c < colorChannels ? EncodeMipSRGB(tables, sums[c]) : EncodeMipUnorm(sums[c]);
+         }
+      }
+   }
+
+   void HalveMipRows(const unsigned char* src, int srcWidth, unsigned char* dst, int dstWidth, int channels, int rowBegin, int rowEnd)
+   {
+      size_t srcRowSize = (size_t)srcWidth * channels;
+      for(int y = rowBegin; y < rowEnd; y++)
+         PixelConvert::HalveBox(src + y * 2 * srcRowSize, src + (y * 2 + 1) * srcRowSize, dst + (size_t)y * dstWidth * channels, dstWidth, channels);
+   }
+
+   void SetMipChainLayout(int width, int height, int channels, MipChain& chain)
+   {
+      chain.width = width;
+      chain.height = height;
+      chain.channels = channels;
+      chain.levels.clear();
+
+      size_t offset = 0;
+      while(true)
+      {
+         size_t size = (size_t)width * height * channels;
+         chain.levels.push_back({ width, height, offset, size });
+         offset += size;
+         if(width == 1 && height == 1)
+            break;
+         width = std::max(width / 2, 1);
+         height = std::max(height / 2, 1);
+      }
+      chain.data.resize(offset);
+   }
+
+   uint64_t HashMipBytes(uint64_t hash, const void* data, size_t size)
+   {
+      // 8 bytes per step, level 0 of a large texture is tens of megabytes
+      const unsigned char* bytes = (const unsigned char*)data;
+      size_t i = 0;
+      for(; i + 8 <= size; i += 8)
+      {
+         uint64_t word;
+         memcpy(&word, bytes + i, sizeof(word));
+         hash = (hash ^ word) * 0x100000001B3ull;
+         hash ^= hash >> 29;
+      }
+      for(; i < size; i++)
+         hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+      return hash;
+   }
+
+   // static
+   bool MipGenerator::Build(const unsigned char* pixels, int width, int height, int channels, MipFilter filter, bool srgb,
+      MipChain& chain, uint32_t threadCount /* = 0*/)
+   {
+      if(pixels == nullptr || width <= 0 || height <= 0 || channels < 1 || channels > 4 || filter == MipFilter::NONE)
+      {
+         std::cout << "ERROR: Can't build a mip chain for a " << width << "x" << height << "x" << channels << " image" << std::endl;
+         return false;
+      }
+
+      bool cached = !GetCacheDirectory().empty();
+      uint64_t key = 14695981039346656037ull;
+      if(cached)
+      {
+         int32_t description[6] = { (int32_t)FORMAT_VERSION, width, height, channels, (int32_t)filter, srgb ? 1 : 0 };
+         key = HashMipBytes(key, description, sizeof(description));
+         key = HashMipBytes(key, pixels, (size_t)width * height * channels);
+         if(LoadCached(key, width, height, channels, chain))
+            return true;
+      }
+
+      SetMipChainLayout(width, height, channels, chain);
+      memcpy(chain.data.data(), pixels, chain.levels[0].size);
+
+      if(threadCount == 0)
+         threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+      for(size_t level = 1; level < chain.levels.size(); level++)
+      {
+         const MipLevel& source = chain.levels[level - 1];
+         const MipLevel& target = chain.levels[level];
+         const unsigned char* src = chain.data.data() + source.offset;
+         unsigned char* dst = chain.data.data() + target.offset;
+
+         // exact halving of plain values is the integer kernel, everything else goes through the float filter
+         bool halve = filter == MipFilter::BOX && !srgb && source.width == target.width * 2 && source.height == target.height * 2;
+         MipFilterTaps xTaps, yTaps;
+         if(!halve)
+         {
+            ComputeMipTaps(source.width, target.width, filter, xTaps);
+            ComputeMipTaps(source.height, target.height, filter, yTaps);
+         }
+
+         auto filterRows = [&](int rowBegin, int rowEnd)
+         {
+            if(halve)
+               HalveMipRows(src, source.width, dst, target.width, channels, rowBegin, rowEnd);
+            else
+               FilterMipRows(src, source.width, dst, target.width, channels, srgb, xTaps, yTaps, rowBegin, rowEnd);
+         };
+
+         // bands of at least 32 rows, starting threads costs more than filtering small levels
+         uint32_t bands = std::min(threadCount, (uint32_t)std::max(target.height / 32, 1));
+         if((size_t)target.width * target.height < 128 * 128)
+            bands = 1;
+         int bandRows = (target.height + bands - 1) / bands;
+
+         std::vector<std::thread> workers;
+         for(uint32_t band = 1; band < bands; band++)
+         {
+            int rowBegin = band * bandRows;
+            workers.emplace_back(filterRows, rowBegin, std::min(rowBegin + bandRows, target.height));
+         }
+         filterRows(0, std::min(bandRows, target.height));
+         for(std::thread& worker : workers)
+            worker.join();
+      }
+
+      if(cached)
+         StoreCached(key, chain);
+      return true;
+   }
+
+   // static
+   void MipGenerator::SetCacheDirectory(const std::string& directory)
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      s_MipCache.directory.clear();
+      if(directory.empty())
+         return;
+
+      std::string versioned = directory + "/v" + std::to_string(FORMAT_VERSION);
+      std::error_code error;
+      std::filesystem::create_directories(versioned, error);
+      if(error)
+      {
+         std::cout << "ERROR: Failed to create mip cache directory " << versioned << ": " << error.message() << std::endl;
+         return;
+      }
+      s_MipCache.directory = versioned;
+   }
+
+   // static
+   std::string MipGenerator::GetCacheDirectory()
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      return s_MipCache.directory;
+   }
+
+   // static
+   std::string MipGenerator::FilePath(uint64_t key)
+   {
+      char name[32];
+      snprintf(name, sizeof(name), "%016llx.mips", (unsigned long long)key);
+      return GetCacheDirectory() + "/" + name;
+   }
+
+   // static
+   bool MipGenerator::LoadCached(uint64_t key, int width, int height, int channels, MipChain& chain)
+   {
+      std::ifstream file(FilePath(key), std::ios::binary);
+      bool valid = false;
+      if(file)
+      {
+         SetMipChainLayout(width, height, channels, chain);
+         MipCacheHeader header;
+         valid = (bool)file.read((char*)&header, sizeof(header))
+            && header.magic == MIP_CACHE_MAGIC && header.version == FORMAT_VERSION && header.key == key
+            && header.width == width && header.height == height && header.channels == channels
+            && header.levelCount == chain.levels.size() && header.dataSize == chain.data.size()
+            && (bool)file.read((char*)chain.data.data(), chain.data.size());
+      }
+
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      if(valid)
+         s_MipCache.stats.hits++;
+      else
+         s_MipCache.stats.misses++;
+      return valid;
+   }
+
+   // static
+   void MipGenerator::StoreCached(uint64_t key, const MipChain& chain)
+   {
+      MipCacheHeader header;
+      header.magic = MIP_CACHE_MAGIC;
+      header.version = FORMAT_VERSION;
+      header.key = key;
+      header.width = chain.width;
+      header.height = chain.height;
+      header.channels = chain.channels;
+      header.levelCount = (uint32_t)chain.levels.size();
+      header.dataSize = chain.data.size();
+
+      // written next to the target and renamed, so a crash or another thread never sees half a file
+      std::string path = FilePath(key);
+      std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if(!file)
+      {
+         std::cout << "ERROR: Failed to write mip chain " << tempPath << std::endl;
+         return;
+      }
+      file.write((const char*)&header, sizeof(header));
+      file.write((const char*)chain.data.data(), chain.data.size());
+      file.close();
+
+      std::error_code error;
+      std::filesystem::rename(tempPath, path, error);
+      if(error)
+      {
+         std::filesystem::remove(tempPath, error);
+         return;
+      }
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      s_MipCache.stats.stored++;
+   }
+
+   // static
+   MipCacheStats MipGenerator::GetStats()
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      return s_MipCache.stats;
+   }
+
+   // static
+   void MipGenerator::ResetStats()
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      s_MipCache.stats = MipCacheStats();
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/MipChain.cpp end --*/
+/*-- File: src/PixelConvert.cpp start --*/
+/*-- #include "src/PixelConvert.hpp" start --*/
+/*-- #include "src/PixelConvert.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <cstring>
+
+#if !defined(EASEGL_PIXELCONVERT_SCALAR)
+   #if defined(__AVX2__)
+      #define EASEGL_PIXELCONVERT_AVX2
+   #endif
+   // AVX2 doesn't imply F16C for the compiler (gcc -mavx2 alone), MSVC allows its intrinsics with /arch:AVX2
+   #if defined(EASEGL_PIXELCONVERT_AVX2) && (defined(__F16C__) || defined(_MSC_VER))
+      #define EASEGL_PIXELCONVERT_F16C
+   #endif
+   // MSVC doesn't define __SSSE3__, every AVX2 cpu has it
+   #if defined(__SSSE3__) || defined(EASEGL_PIXELCONVERT_AVX2)
+      #define EASEGL_PIXELCONVERT_SSSE3
+   #endif
+   #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+      #define EASEGL_PIXELCONVERT_SSE2
+   #endif
+#endif
+
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+   #include <immintrin.h>
+#elif defined(EASEGL_PIXELCONVERT_SSSE3)
+   #include <tmmintrin.h>
+#elif defined(EASEGL_PIXELCONVERT_SSE2)
+   #include <emmintrin.h>
+#endif
+
+namespace EaseGL
+{
+   // round(c * a / 255) without a division, exact for all 8 bit inputs
+   inline uint8_t PremultiplyChannel(uint32_t c, uint32_t a)
+   {
+      uint32_t t = c * a + 128;
+      return (uint8_t)((t + (t >> 8)) >> 8);
+   }
+
+   // round to nearest even, inputs here are never subnormal or out of half range
+   uint16_t FloatToHalfBits(float value)
+   {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      uint32_t sign = (bits >> 16) & 0x8000;
+      int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+      uint32_t mantissa = bits & 0x7FFFFF;
+      if(exponent <= 0)
+         return (uint16_t)sign;
+      if(exponent >= 31)
+         return (uint16_t)(sign | 0x7C00);
+
+      uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+      uint32_t rest = mantissa & 0x1FFF;
+      if(rest > 0x1000 || (rest == 0x1000 && (half & 1) != 0))
+         half++; // a carry out of the mantissa correctly bumps the exponent
+      return (uint16_t)half;
+   }
+
+   struct PixelConvertHalfTable
+   {
+      uint16_t values[256];
+
+      PixelConvertHalfTable()
+      {
+         // same expression as the vector paths so every backend rounds identically
+         for(int i = 0; i < 256; i++)
+            values[i] = FloatToHalfBits((float)i * (1.0f / 255.0f));
+      }
+   };
+
+   const uint16_t* GetHalfTable()
+   {
+      static PixelConvertHalfTable table;
+      return table.values;
+   }
+
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+   // 2 pixels widened to 16 bit lanes
+   inline __m128i PremultiplyWide(__m128i pixels, __m128i alphaLanes, __m128i c255, __m128i c128)
+   {
+      __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+      // alpha itself is multiplied by 255 so it comes out unchanged
+      alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, c255));
+      __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), c128);
+      return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+   }
+#endif
+
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+   inline __m256i PremultiplyWide256(__m256i pixels, __m256i alphaLanes, __m256i c255, __m256i c128)
+   {
+      __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+      alpha = _mm256_or_si256(_mm256_andnot_si256(alphaLanes, alpha), _mm256_and_si256(alphaLanes, c255));
+      __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), c128);
+      return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+   }
+#endif
+
+   // static
+   void PixelConvert::RGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha /* = 255*/)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+         __m256i alphas = _mm256_set1_epi32((int)((uint32_t)alpha << 24));
+         // each lane reads 16 bytes for 4 pixels, the last one may read 4 bytes past its 12
+         for(; i + 10 <= pixelCount; i += 8)
+         {
+            const uint8_t* src = rgb + i * 3;
+            __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)),
+               _mm_loadu_si128((const __m128i*)(src + 12)), 1);
+            _mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alphas));
+         }
+      }
+#elif defined(EASEGL_PIXELCONVERT_SSSE3)
+      {
+         __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+         __m128i alphas = _mm_set1_epi32((int)((uint32_t)alpha << 24));
+         for(; i + 6 <= pixelCount; i += 4)
+         {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(rgb + i * 3));
+            _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alphas));
+         }
+      }
+#endif
+      // SSE2 has no byte shuffle, a 3 -> 4 byte expansion with shifts is no faster than this
+      for(; i < pixelCount; i++)
+      {
+         rgba[i * 4 + 0] = rgb[i * 3 + 0];
+         rgba[i * 4 + 1] = rgb[i * 3 + 1];
+         rgba[i * 4 + 2] = rgb[i * 3 + 2];
+         rgba[i * 4 + 3] = alpha;
+      }
+   }
+
+   // static
+   void PixelConvert::PremultiplyAlpha(const uint8_t* rgba, uint8_t* out, size_t pixelCount)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i zero = _mm256_setzero_si256();
+         __m256i alphaLanes = _mm256_set1_epi64x((long long)0xFFFF000000000000ull);
+         __m256i c255 = _mm256_set1_epi16(255);
+         __m256i c128 = _mm256_set1_epi16(128);
+         for(; i + 8 <= pixelCount; i += 8)
+         {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(rgba + i * 4));
+            __m256i low = PremultiplyWide256(_mm256_unpacklo_epi8(pixels, zero), alphaLanes, c255, c128);
+            __m256i high = PremultiplyWide256(_mm256_unpackhi_epi8(pixels, zero), alphaLanes, c255, c128);
+            _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_packus_epi16(low, high));
+         }
+      }
+#endif
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+      {
+         __m128i zero = _mm_setzero_si128();
+         __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+         __m128i c255 = _mm_set1_epi16(255);
+         __m128i c128 = _mm_set1_epi16(128);
+         for(; i + 4 <= pixelCount; i += 4)
+         {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+            __m128i low = PremultiplyWide(_mm_unpacklo_epi8(pixels, zero), alphaLanes, c255, c128);
+            __m128i high = PremultiplyWide(_mm_unpackhi_epi8(pixels, zero), alphaLanes, c255, c128);
+            _mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(low, high));
+         }
+      }
+#endif
+      for(; i < pixelCount; i++)
+      {
+         uint8_t a = rgba[i * 4 + 3];
+         out[i * 4 + 0] = PremultiplyChannel(rgba[i * 4 + 0], a);
+         out[i * 4 + 1] = PremultiplyChannel(rgba[i * 4 + 1], a);
+         out[i * 4 + 2] = PremultiplyChannel(rgba[i * 4 + 2], a);
+         out[i * 4 + 3] = a;
+      }
+   }
+
+   // static
+   void PixelConvert::SwapRedBlue(const uint8_t* in, uint8_t* out, size_t pixelCount)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+         for(; i + 8 <= pixelCount; i += 8)
+         {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(in + i * 4));
+            _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+         }
+      }
+#endif
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+      {
+         // green and alpha stay, red and blue trade places within each 32 bit pixel
+         __m128i greenAlpha = _mm_set1_epi32((int)0xFF00FF00);
+         for(; i + 4 <= pixelCount; i += 4)
+         {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(in + i * 4));
+            __m128i redBlue = _mm_andnot_si128(greenAlpha, pixels);
+            __m128i swapped = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+            _mm_storeu_si128((__m128i*)(out + i * 4), _mm_or_si128(_mm_and_si128(greenAlpha, pixels), swapped));
+         }
+      }
+#endif
+      for(; i < pixelCount; i++)
+      {
+         uint8_t red = in[i * 4 + 0];
+         out[i * 4 + 0] = in[i * 4 + 2];
+         out[i * 4 + 1] = in[i * 4 + 1];
+         out[i * 4 + 2] = red;
+         out[i * 4 + 3] = in[i * 4 + 3];
+      }
+   }
+
+   // static
+   void PixelConvert::ToHalf(const uint8_t* in, uint16_t* out, size_t valueCount)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_F16C)
+      {
+         __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+         for(; i + 8 <= valueCount; i += 8)
+         {
+            __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(in + i))));
+            _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_mul_ps(values, scale), _MM_FROUND_TO_NEAREST_INT));
+         }
+      }
+#endif
+      // without a float -> half instruction a 256 entry table beats converting
+      const uint16_t* table = GetHalfTable();
+      for(; i < valueCount; i++)
+         out[i] = table[in[i]];
+   }
+
+   // static
+   void PixelConvert::GrayToRG(const uint8_t* gray, uint8_t* rg, size_t pixelCount, uint8_t green /* = 255*/)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i greens = _mm256_set1_epi8((char)green);
+         for(; i + 32 <= pixelCount; i += 32)
+         {
+            // unpack works per 128 bit lane, order the 64 bit halves so both outputs come out contiguous
+            __m256i values = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(gray + i)), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)(rg + i * 2), _mm256_unpacklo_epi8(values, greens));
+            _mm256_storeu_si256((__m256i*)(rg + i * 2 + 32), _mm256_unpackhi_epi8(values, greens));
+         }
+      }
+#endif
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+      {
+         __m128i greens = _mm_set1_epi8((char)green);
+         for(; i + 16 <= pixelCount; i += 16)
+         {
+            __m128i values = _mm_loadu_si128((const __m128i*)(gray + i));
+            _mm_storeu_si128((__m128i*)(rg + i * 2), _mm_unpacklo_epi8(values, greens));
+            _mm_storeu_si128((__m128i*)(rg + i * 2 + 16), _mm_unpackhi_epi8(values, greens));
+         }
+      }
+#endif
+      for(; i < pixelCount; i++)
+      {
+         rg[i * 2 + 0] = gray[i];
+         rg[i * 2 + 1] = green;
+      }
+   }
+
+   // static
+   void PixelConvert::HalveBox(const uint8_t* row0, const uint8_t* row1, uint8_t* out, size_t outPixels, int channels)
+   {
+      size_t i = 0;
+      if(channels == 4)
+      {
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+         __m128i zero = _mm_setzero_si128();
+         __m128i two = _mm_set1_epi16(2);
+         for(; i + 4 <= outPixels; i += 4)
+         {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + i * 8));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + i * 8 + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + i * 8));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + i * 8 + 16));
+            // vertical sums, two source pixels per register
+            __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+            __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+            __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+            __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+            // horizontal pairs are the two 64 bit halves
+            __m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+            __m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+            h0 = _mm_srli_epi16(_mm_add_epi16(h0, two), 2);
+            h1 = _mm_srli_epi16(_mm_add_epi16(h1, two), 2);
+            _mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(h0, h1));
+         }
+#endif
+      }
+      for(; i < outPixels; i++)
+      {
+         for(int c = 0; c < channels; c++)
+         {
+            size_t left = i * 2 * channels + c;
+            out[i * channels + c] = (uint8_t)((row0[left] + row0[left + channels] + row1[left] + row1[left + channels] + 2) >> 2);
+         }
+      }
+   }
+
+   // static
+   const char* PixelConvert::Backend()
+   {
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      return "AVX2";
+#elif defined(EASEGL_PIXELCONVERT_SSSE3)
+      return "SSSE3";
+#elif defined(EASEGL_PIXELCONVERT_SSE2)
+      return "SSE2";
+#else
+      return "scalar";
+#endif
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/PixelConvert.cpp end --*/
+/*-- File: src/ProgramBinaryCache.cpp start --*/
+/*-- #include "src/ProgramBinaryCache.hpp" start --*/
+#ifndef PROGRAMBINARYCACHE_H
+#define PROGRAMBINARYCACHE_H
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <string>
+
+namespace EaseGL
+{
+	struct ProgramBinaryCacheStats
+	{
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		uint32_t rejected = 0; // binaries the driver refused, recompiled from source
+		uint32_t stored = 0;
+	};
+
+	/**
+	 * @brief Stores linked programs on disk with glGetProgramBinary so the next launch can skip compiling.
+	 * Disabled until SetDirectory() is called. Binaries are keyed by the stage sources and GLContext::DriverIdentity(),
+	 * a driver update or a shader edit simply produces a new key.
+	 *
+	 * EaseGL::ProgramBinaryCache::SetDirectory("cache/shaders");
+	 * EaseGL::Shader shader("shader.glsl"); // loaded from cache/shaders/v1/ if possible
+	 */
+	class ProgramBinaryCache
+	{
+		private:
+			ProgramBinaryCache() {}
+
+			static std::string FilePath(uint64_t key);
+		public:
+			// bump when the file layout or key changes, old directories are left alone
+			static constexpr uint32_t FORMAT_VERSION = 1;
+
+			/** @brief Enables the cache, files are written to 'directory'/v<FORMAT_VERSION>. Empty string disables it */
+			static void SetDirectory(const std::string& directory);
+			static const std::string& GetDirectory();
+
+			/** @brief Enabled and the context can retrieve program binaries */
+			static bool IsAvailable();
+
+			/** @brief Key for a program made from 'stageCount' stage sources on the current driver */
+			static uint64_t Key(const std::string* stageSources, size_t stageCount);
+
+			/**
+			 * @brief Loads the binary stored under 'key' into 'program'. Returns false if there is none
+			 * or the driver rejects it, in which case the file is removed and 'program' should be linked from source.
+			 */
+			static bool Load(GLuint program, uint64_t key);
+
+			/** @brief 'program' must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set */
+			static void Store(GLuint program, uint64_t key);
+
+			static const ProgramBinaryCacheStats& GetStats();
+			static void ResetStats();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/ProgramBinaryCache.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   struct ProgramBinaryHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t key;
+      uint32_t format;
+      uint32_t length;
+   };
+
+   static const uint32_t PROGRAM_BINARY_MAGIC = 0x42504745; // "EGPB"
+
+   static std::string s_ProgramCacheDirectory;
+   static ProgramBinaryCacheStats s_ProgramCacheStats;
+
+   uint64_t HashProgramBytes(uint64_t hash, const void* data, size_t size)
+   {
+      const unsigned char* bytes = (const unsigned char*)data;
+      for(size_t i = 0; i < size; i++)
+         hash = (hash ^ bytes[i]) * 1099511628211ull;
+      return hash;
+   }
+
+   // static
+   void ProgramBinaryCache::SetDirectory(const std::string& directory)
+   {
+      s_ProgramCacheDirectory.clear();
+      if(directory.empty())
+         return;
+
+      std::string versioned = directory + "/v" + std::to_string(FORMAT_VERSION);
+      std::error_code error;
+      std::filesystem::create_directories(versioned, error);
+      if(error)
+      {
+         std::cout << "ERROR: Failed to create program cache directory " << versioned << ": " << error.message() << std::endl;
+         return;
+      }
+      s_ProgramCacheDirectory = versioned;
+   }
+
+   // static
+   const std::string& ProgramBinaryCache::GetDirectory()
+   {
+      return s_ProgramCacheDirectory;
+   }
+
+   // static
+   bool ProgramBinaryCache::IsAvailable()
+   {
+      if(s_ProgramCacheDirectory.empty())
+         return false;
+      if(!GLContext::HasVersion(4, 1) && !GLContext::HasExtension("GL_ARB_get_program_binary"))
+         return false;
+
+      GLint formatCount = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+      return formatCount > 0;
+   }
+
+   // static
+   uint64_t ProgramBinaryCache::Key(const std::string* stageSources, size_t stageCount)
+   {
+      const std::string& driver = GLContext::DriverIdentity();
+      uint64_t hash = 14695981039346656037ull;
+      hash = HashProgramBytes(hash, driver.data(), driver.size());
+      for(size_t i = 0; i < stageCount; i++)
+      {
+         // length prefix so moving text between stages changes the key
+         uint64_t length = stageSources[i].size();
+         hash = HashProgramBytes(hash, &length, sizeof(length));
+         hash = HashProgramBytes(hash, stageSources[i].data(), stageSources[i].size());
+      }
+      return hash;
+   }
+
+   // static
+   std::string ProgramBinaryCache::FilePath(uint64_t key)
+   {
+      char name[32];
+      snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+      return s_ProgramCacheDirectory + "/" + name;
+   }
+
+   // static
+   bool ProgramBinaryCache::Load(GLuint program, uint64_t key)
+   {
+      std::string path = FilePath(key);
+      std::ifstream file(path, std::ios::binary);
+      if(!file)
+      {
+         s_ProgramCacheStats.misses++;
+         return false;
+      }
+
+      // Store() writes the header and exactly 'length' bytes, anything else is a corrupt entry
+      file.seekg(0, std::ios::end);
+      std::streamoff fileSize = file.tellg();
+      file.seekg(0, std::ios::beg);
+
+      ProgramBinaryHeader header;
+      std::vector<char> binary;
+      bool valid = fileSize >= (std::streamoff)sizeof(header) && (bool)file.read((char*)&header, sizeof(header))
+         && header.magic == PROGRAM_BINARY_MAGIC && header.version == FORMAT_VERSION && header.key == key
+         && header.length > 0 && (std::streamoff)header.length == fileSize - (std::streamoff)sizeof(header);
+      if(valid)
+      {
+         binary.resize(header.length);
+         valid = (bool)file.read(binary.data(), header.length);
+      }
+      file.close();
+
+      GLint success = 0;
+      if(valid)
+      {
+         glProgramBinary(program, header.format, binary.data(), (GLsizei)header.length);
+         glGetProgramiv(program, GL_LINK_STATUS, &success);
+      }
+
+      if(!success)
+      {
+         s_ProgramCacheStats.rejected++;
+         std::error_code error;
+         std::filesystem::remove(path, error);
+         return false;
+      }
+
+      s_ProgramCacheStats.hits++;
+      return true;
+   }
+
+   // static
+   void ProgramBinaryCache::Store(GLuint program, uint64_t key)
+   {
+      GLint length = 0;
+      glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+      if(length <= 0)
+         return;
+
+      std::vector<char> binary(length);
+      GLenum format = 0;
+      glGetProgramBinary(program, length, &length, &format, binary.data());
+
+      ProgramBinaryHeader header;
+      header.magic = PROGRAM_BINARY_MAGIC;
+      header.version = FORMAT_VERSION;
+      header.key = key;
+      header.format = format;
+      header.length = (uint32_t)length;
+
+      // written next to the target and renamed, a crash never leaves a truncated binary behind
+      std::string path = FilePath(key);
+      std::string tempPath = path + ".tmp";
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if(!file)
+      {
+         std::cout << "ERROR: Failed to write program binary " << tempPath << std::endl;
+         return;
+      }
+      file.write((const char*)&header, sizeof(header));
+      file.write(binary.data(), length);
+      file.close();
+
+      std::error_code error;
+      std::filesystem::rename(tempPath, path, error);
+      if(error)
+      {
+         std::filesystem::remove(tempPath, error);
+         return;
+      }
+      s_ProgramCacheStats.stored++;
+   }
+
+   // static
+   const ProgramBinaryCacheStats& ProgramBinaryCache::GetStats()
+   {
+      return s_ProgramCacheStats;
+   }
+
+   // static
+   void ProgramBinaryCache::ResetStats()
+   {
+      s_ProgramCacheStats = ProgramBinaryCacheStats();
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/ProgramBinaryCache.cpp end --*/
+/*-- File: src/Sampler.cpp start --*/
+/*-- #include "src/Sampler.hpp" start --*/
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <glad/glad.h>
+#include <stdint.h>
+
+// core in 4.6, glad only has them when one of the anisotropic filtering extensions was selected
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+namespace EaseGL
+{
+	enum class SamplerFilter
+	{
+		NONE = 0,
+		NEAREST,
+		LINEAR,
+	};
+
+	enum class SamplerMipmapMode
+	{
+		NONE = 0, // only the base level is sampled
+		NEAREST,
+		LINEAR,
+	};
+
+	enum class SamplerWrap
+	{
+		NONE = 0,
+		REPEAT,
+		MIRRORED_REPEAT,
+		CLAMP_TO_EDGE,
+		CLAMP_TO_BORDER,
+	};
+
+	enum class SamplerCompare
+	{
+		NONE = 0, // plain sampling, shadow samplers need one of the others
+		LESS_EQUAL,
+		GREATER_EQUAL,
+		LESS,
+		GREATER,
+		EQUAL,
+		NOT_EQUAL,
+		ALWAYS,
+		NEVER,
+	};
+
+	/** @brief How a texture is sampled, independent of the texture itself. Equal descriptions share one GL sampler */
+	struct SamplerDesc
+	{
+		SamplerFilter minFilter = SamplerFilter::LINEAR;
+		SamplerFilter magFilter = SamplerFilter::LINEAR;
+		SamplerMipmapMode mipmapMode = SamplerMipmapMode::LINEAR;
+		SamplerWrap wrapS = SamplerWrap::REPEAT;
+		SamplerWrap wrapT = SamplerWrap::REPEAT;
+		SamplerWrap wrapR = SamplerWrap::REPEAT;
+		float maxAnisotropy = 1.0f; // 1 disables, clamped to what the driver supports
+		float lodBias = 0.0f;
+		float minLod = -1000.0f;
+		float maxLod = 1000.0f;
+		SamplerCompare compare = SamplerCompare::NONE;
+		float borderColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; // for CLAMP_TO_BORDER
+
+		bool operator==(const SamplerDesc& other) const;
+		bool operator!=(const SamplerDesc& other) const { return !(*this == other); }
+
+		static SamplerDesc Nearest(SamplerWrap wrap = SamplerWrap::REPEAT);
+		static SamplerDesc Trilinear(SamplerWrap wrap = SamplerWrap::REPEAT);
+		static SamplerDesc Anisotropic(float maxAnisotropy, SamplerWrap wrap = SamplerWrap::REPEAT);
+		// linear, clamped depth comparison for sampler2DShadow
+		static SamplerDesc Shadow();
+	};
+
+	/**
+	 * @brief GL sampler objects deduplicated by SamplerDesc, created on first use and kept until Clear().
+	 * A sampler bound to a texture unit overrides the parameters of whatever texture is bound there, so the
+	 * filtering of every texture using a description changes by binding another one, not by touching textures.
+	 *
+	 * shader.Uniform("u_Albedo", albedo, EaseGL::SamplerDesc::Anisotropic(8.0f), 0);
+	 *
+	 * Needs OpenGL 3.3 or GL_ARB_sampler_objects, otherwise nothing is bound and texture parameters apply.
+	 */
+	class SamplerCache
+	{
+		private:
+			SamplerCache() {}
+
+			static void Create(GLuint sampler, const SamplerDesc& desc);
+		public:
+			/** @brief Sampler object for 'desc', 0 if sampler objects aren't supported */
+			static GLuint Get(const SamplerDesc& desc);
+
+			/** @brief Binds the sampler for 'desc' to texture unit 'slot', skipped if it is already bound there */
+			static void Bind(int slot, const SamplerDesc& desc);
+			/** @brief Texture parameters apply again on 'slot' */
+			static void Unbind(int slot);
+
+			static bool IsSupported();
+			/** @brief Highest anisotropy the driver allows, 1 without anisotropic filtering */
+			static float MaxAnisotropy();
+
+			static uint32_t Count();
+			/** @brief Deletes every sampler, call before destroying the context. After GLContext::Reset() the cache starts over on its own */
+			static void Clear();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/Sampler.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+/*-- #include "src/GLObjectPool.hpp" start --*/
+/*-- #include "src/GLObjectPool.hpp" end --*/
+
+namespace EaseGL
+{
+   struct SamplerCacheData
+   {
+      std::vector<SamplerDesc> descs;
+      std::vector<GLHandle> handles; // same order as 'descs'
+      std::vector<GLuint> boundSamplers; // per texture unit, 0 where texture parameters apply
+      float maxAnisotropy = 0.0f;    // queried on first use
+      uint32_t contextResets = 0;    // GLContext::ResetCount() of the context the samplers belong to
+   };
+
+   static SamplerCacheData s_SamplerCache;
+
+   // samplers of a context that was reset are gone with it, only the cache entries are dropped
+   void DropStaleSamplerCache()
+   {
+      if(s_SamplerCache.contextResets == GLContext::ResetCount())
+         return;
+      s_SamplerCache = SamplerCacheData();
+      s_SamplerCache.contextResets = GLContext::ResetCount();
+   }
+
+   GLenum GetSamplerMinFilter(SamplerFilter filter, SamplerMipmapMode mipmapMode)
+   {
+      bool linear = filter == SamplerFilter::LINEAR;
+      return mipmapMode == SamplerMipmapMode::NEAREST ? (linear ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST)
+         : mipmapMode == SamplerMipmapMode::LINEAR ? (linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR)
+         : linear ? GL_LINEAR : GL_NEAREST;
+   }
+
+   GLenum GetSamplerWrap(SamplerWrap wrap)
+   {
+      return wrap == SamplerWrap::MIRRORED_REPEAT ? GL_MIRRORED_REPEAT
+         : wrap == SamplerWrap::CLAMP_TO_EDGE ? GL_CLAMP_TO_EDGE
+         : wrap == SamplerWrap::CLAMP_TO_BORDER ? GL_CLAMP_TO_BORDER
+         : GL_REPEAT;
+   }
+
+   GLenum GetSamplerCompareFunc(SamplerCompare compare)
+   {
+      return compare == SamplerCompare::GREATER_EQUAL ? GL_GEQUAL
+         : compare == SamplerCompare::LESS ? GL_LESS
+         : compare == SamplerCompare::GREATER ? GL_GREATER
+         : compare == SamplerCompare::EQUAL ? GL_EQUAL
+         : compare == SamplerCompare::NOT_EQUAL ? GL_NOTEQUAL
+         : compare == SamplerCompare::ALWAYS ? GL_ALWAYS
+         : compare == SamplerCompare::NEVER ? GL_NEVER
+         : GL_LEQUAL;
+   }
+
+   bool SamplerDesc::operator==(const SamplerDesc& other) const
+   {
+      return minFilter == other.minFilter && magFilter == other.magFilter && mipmapMode == other.mipmapMode
+         && wrapS == other.wrapS && wrapT == other.wrapT && wrapR == other.wrapR
+         && maxAnisotropy == other.maxAnisotropy && lodBias == other.lodBias && minLod == other.minLod && maxLod == other.maxLod
+         && compare == other.compare && memcmp(borderColor, other.borderColor, sizeof(borderColor)) == 0;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Nearest(SamplerWrap wrap /* = SamplerWrap::REPEAT*/)
+   {
+      SamplerDesc desc;
+      desc.minFilter = SamplerFilter::NEAREST;
+      desc.magFilter = SamplerFilter::NEAREST;
+      desc.mipmapMode = SamplerMipmapMode::NEAREST;
+      desc.wrapS = desc.wrapT = desc.wrapR = wrap;
+      return desc;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Trilinear(SamplerWrap wrap /* = SamplerWrap::REPEAT*/)
+   {
+      SamplerDesc desc;
+      desc.wrapS = desc.wrapT = desc.wrapR = wrap;
+      return desc;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Anisotropic(float maxAnisotropy, SamplerWrap wrap /* = SamplerWrap::REPEAT*/)
+   {
+      SamplerDesc desc = Trilinear(wrap);
+      desc.maxAnisotropy = maxAnisotropy;
+      return desc;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Shadow()
+   {
+      SamplerDesc desc = Trilinear(SamplerWrap::CLAMP_TO_EDGE);
+      desc.mipmapMode = SamplerMipmapMode::NONE;
+      desc.compare = SamplerCompare::LESS_EQUAL;
+      return desc;
+   }
+
+   // static
+   bool SamplerCache::IsSupported()
+   {
+      return GLContext::HasVersion(3, 3) || GLContext::HasExtension("GL_ARB_sampler_objects");
+   }
+
+   // static
+   float SamplerCache::MaxAnisotropy()
+   {
+      DropStaleSamplerCache();
+      if(s_SamplerCache.maxAnisotropy == 0.0f)
+      {
+         s_SamplerCache.maxAnisotropy = 1.0f;
+         if(GLContext::HasVersion(4, 6) || GLContext::HasExtension("GL_EXT_texture_filter_anisotropic")
+            || GLContext::HasExtension("GL_ARB_texture_filter_anisotropic"))
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &s_SamplerCache.maxAnisotropy);
+      }
+      return s_SamplerCache.maxAnisotropy;
+   }
+
+   // static
+   void SamplerCache::Create(GLuint sampler, const SamplerDesc& desc)
+   {
+      glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GetSamplerMinFilter(desc.minFilter, desc.mipmapMode));
+      glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, desc.magFilter == SamplerFilter::NEAREST ? GL_NEAREST : GL_LINEAR);
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, GetSamplerWrap(desc.wrapS));
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GetSamplerWrap(desc.wrapT));
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, GetSamplerWrap(desc.wrapR));
+      glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, desc.lodBias);
+      glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, desc.minLod);
+      glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, desc.maxLod);
+      glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, desc.borderColor);
+      if(desc.compare != SamplerCompare::NONE)
+      {
+         glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+         glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, GetSamplerCompareFunc(desc.compare));
+      }
+
+      // without the extension the description still gets its own sampler, just without anisotropy
+      float maxAnisotropy = MaxAnisotropy();
+      if(desc.maxAnisotropy > 1.0f && maxAnisotropy > 1.0f)
+         glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, desc.maxAnisotropy < maxAnisotropy ? desc.maxAnisotropy : maxAnisotropy);
+   }
+
+   // static
+   GLuint SamplerCache::Get(const SamplerDesc& desc)
+   {
+      if(!IsSupported())
+         return 0;
+      DropStaleSamplerCache();
+
+      // a handful of descriptions per application, a linear search beats hashing them
+      for(size_t i = 0; i < s_SamplerCache.descs.size(); i++)
+      {
+         if(s_SamplerCache.descs[i] == desc)
+            return GLObjectPool::Name(s_SamplerCache.handles[i]);
+      }
+
+      GLHandle handle = GLObjectPool::Create(GLObjectType::SAMPLER);
+      Create(GLObjectPool::Name(handle), desc);
+      s_SamplerCache.descs.push_back(desc);
+      s_SamplerCache.handles.push_back(handle);
+      return GLObjectPool::Name(handle);
+   }
+
+   // static
+   void SamplerCache::Bind(int slot, const SamplerDesc& desc)
+   {
+      GLuint sampler = Get(desc);
+      if(sampler == 0 || slot < 0)
+         return;
+
+      std::vector<GLuint>& bound = s_SamplerCache.boundSamplers;
+      if((size_t)slot >= bound.size())
+         bound.resize(slot + 1, 0);
+      if(bound[slot] == sampler)
+         return;
+      glBindSampler(slot, sampler);
+      bound[slot] = sampler;
+   }
+
+   // static
+   void SamplerCache::Unbind(int slot)
+   {
+      DropStaleSamplerCache();
+      std::vector<GLuint>& bound = s_SamplerCache.boundSamplers;
+      if(slot < 0 || (size_t)slot >= bound.size() || bound[slot] == 0)
+         return;
+      glBindSampler(slot, 0);
+      bound[slot] = 0;
+   }
+
+   // static
+   uint32_t SamplerCache::Count()
+   {
+      DropStaleSamplerCache();
+      return (uint32_t)s_SamplerCache.descs.size();
+   }
+
+   // static
+   void SamplerCache::Clear()
+   {
+      DropStaleSamplerCache();
+      for(size_t slot = 0; slot < s_SamplerCache.boundSamplers.size(); slot++)
+         Unbind((int)slot);
+      for(GLHandle& handle : s_SamplerCache.handles)
+         GLObjectPool::Destroy(handle);
+      s_SamplerCache = SamplerCacheData();
+      s_SamplerCache.contextResets = GLContext::ResetCount();
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/Sampler.cpp end --*/
+/*-- File: src/Shader.cpp start --*/
+/*-- #include "src/Shader.hpp" start --*/
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <glad/glad.h>
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+/*-- #include "src/GLObjectPool.hpp" start --*/
+/*-- #include "src/GLObjectPool.hpp" end --*/
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+/*-- #include "src/GLTexture.hpp" start --*/
+/*-- #include "src/GLTexture.hpp" end --*/
+/*-- #include "src/Sampler.hpp" start --*/
+/*-- #include "src/Sampler.hpp" end --*/
+/*-- #include "src/ShaderSource.hpp" start --*/
+#ifndef SHADERSOURCE_H
+#define SHADERSOURCE_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace EaseGL
+{
+	enum class ShaderType
+	{
+		NONE = 0,
+		VERTEX,
+		FRAGMENT,
+		GEOMETRY,
+		COMPUTE,
+	};
+
+	// Source of each stage, empty stages are skipped
+	struct ShaderSources
+	{
+		static constexpr int STAGE_COUNT = 4;
+		std::string stages[STAGE_COUNT];
+
+		// "source <id>: <path>" for every file used, printed with compile errors
+		std::string fileLegend;
+
+		std::string& operator[](ShaderType type) { return stages[(int)type - 1]; }
+		const std::string& operator[](ShaderType type) const { return stages[(int)type - 1]; }
+	};
+
+	struct ShaderSourceFile
+	{
+		std::string path; // canonical
+		std::string text;
+		uint64_t hash;
+		// source string number used in #line directives, derived from the path so it is stable between runs
+		uint32_t sourceId;
+	};
+
+	/**
+	 * @brief Process-wide cache of shader files, each included file is read from disk once no matter how many
+	 * programs #include it. Not thread safe.
+	 *
+	 * Preprocess() reads the file it is given from disk on every call, splits it into its '#shader <stage>' sections and expands
+	 * #include "file" (relative to the including file, then the include directories).
+	 * '#line <line> <sourceId>' is emitted around includes and after #version so compiler errors
+	 * point at the right file, sourceId -> path is in ShaderSources::fileLegend.
+	 */
+	class ShaderSourceCache
+	{
+		private:
+			ShaderSourceCache() {}
+
+			static void AppendSection(std::string& out, std::string_view section, const ShaderSourceFile& file,
+				uint32_t firstLine, int depth, std::vector<uint32_t>& usedFiles);
+		public:
+			static constexpr int MAX_INCLUDE_DEPTH = 32;
+
+			/** @brief Returns the cached file, reading it on first use. nullptr if it can't be read */
+			static const ShaderSourceFile* Load(const std::string& path);
+			/** @brief Reads the file from disk again and updates the cached entry, Generation() changes if the text did */
+			static const ShaderSourceFile* Reload(const std::string& path);
+			static const ShaderSourceFile* FindBySourceId(uint32_t sourceId);
+
+			/** @brief Throws std::runtime_error if the file or one of its includes can't be read */
+			static void Preprocess(const char* path, ShaderSources& sources);
+
+			static void AddIncludeDirectory(const std::string& directory);
+
+			/** @brief Drops a file so the next Load() reads it again (hot reload of included files) */
+			static void Invalidate(const std::string& path);
+			static void Clear();
+
+			// files actually read from disk
+			static uint32_t FileReadCount();
+			// changes on every Invalidate()/Clear(), anything derived from an older generation may be stale
+			static uint32_t Generation();
+	};
+
+	// line scanning shared by the shader preprocessors
+	std::string_view NextShaderLine(std::string_view text, size_t& pos);
+	std::string_view TrimShaderLine(std::string_view line);
+	bool StartsWithDirective(std::string_view line, std::string_view directive);
+
+	uint64_t HashShaderSource(std::string_view text, uint64_t hash = 14695981039346656037ull);
+	// hash of all stages ignoring the source ids of #line directives, equal hashes mean equal programs
+	uint64_t HashShaderSources(const ShaderSources& sources);
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/ShaderSource.hpp" end --*/
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace EaseGL
+{
+	enum class MemoryBarrierBits : GLbitfield
+	{
+		NONE = 0,
+		VERTEX_ATTRIB_ARRAY = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT,
+		ELEMENT_ARRAY = GL_ELEMENT_ARRAY_BARRIER_BIT,
+		UNIFORM = GL_UNIFORM_BARRIER_BIT,
+		TEXTURE_FETCH = GL_TEXTURE_FETCH_BARRIER_BIT,
+		SHADER_IMAGE_ACCESS = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT,
+		COMMAND = GL_COMMAND_BARRIER_BIT, // indirect draw/dispatch arguments
+		PIXEL_BUFFER = GL_PIXEL_BUFFER_BARRIER_BIT,
+		TEXTURE_UPDATE = GL_TEXTURE_UPDATE_BARRIER_BIT,
+		BUFFER_UPDATE = GL_BUFFER_UPDATE_BARRIER_BIT,
+		FRAMEBUFFER = GL_FRAMEBUFFER_BARRIER_BIT,
+		SHADER_STORAGE = GL_SHADER_STORAGE_BARRIER_BIT,
+		ALL = GL_ALL_BARRIER_BITS,
+	};
+
+	inline MemoryBarrierBits operator|(MemoryBarrierBits left, MemoryBarrierBits right)
+	{
+		return (MemoryBarrierBits)((GLbitfield)left | (GLbitfield)right);
+	}
+
+	// FNV-1a, constexpr so names in constant expressions are hashed at compile time
+	constexpr uint32_t HashUniformName(const char* name)
+	{
+		uint32_t hash = 2166136261u;
+		for(; *name != '\0'; name++)
+			hash = (hash ^ (uint32_t)(unsigned char)*name) * 16777619u;
+		return hash;
+	}
+
+	/**
+	 * @brief Uniform name with its hash, 'name' is only compared when the hash matches.
+	 * A literal passed straight to Uniform("u_Model", ...) is hashed at run time on every call (the optimizer may fold it,
+	 * nothing guarantees it). Only a constexpr object is hashed at compile time:
+	 *
+	 * static constexpr EaseGL::UniformName u_Model = "u_Model";
+	 * shader.Uniform(u_Model, model);
+	 *
+	 * The UniformHandle returned by GetUniformHandle() skips the hash and the lookup entirely.
+	 */
+	struct UniformName
+	{
+		uint32_t hash;
+		const char* name;
+
+		constexpr UniformName(const char* _name)
+			: hash(HashUniformName(_name)), name(_name)
+		{
+		}
+		UniformName(const std::string& _name)
+			: hash(HashUniformName(_name.c_str())), name(_name.c_str())
+		{
+		}
+	};
+
+	// Resolved uniform, valid for the program it was queried from until it is reloaded
+	struct UniformHandle
+	{
+		int32_t index = -1; // into Shader::GetUniforms()
+		GLint location = -1;
+
+		bool IsValid() const { return location != -1; }
+	};
+
+	struct UniformInfo
+	{
+		std::string name; // array uniforms are registered both as "name[0]" and "name"
+		uint32_t hash;
+		GLint location;
+		GLenum type;
+		GLint arraySize;
+		bool isSampler;
+
+		// last value sent to the program, only the first element of arrays is shadowed
+		uint32_t shadowOffset;
+		uint32_t shadowSize; // 0 if the type is unknown
+		bool shadowValid;
+	};
+
+	struct UniformShadowStats
+	{
+		uint64_t hits = 0;   // writes that were dropped because the program already had the value
+		uint64_t misses = 0; // writes that reached the driver
+	};
+
+	struct UniformBlockInfo
+	{
+		std::string name;
+		GLuint index;
+		GLint dataSize;
+		bool isStorageBlock;
+	};
+
+	class Shader  
+	{
+		private:
+			GLuint m_VertexShaderID;
+			GLuint m_FragmentShaderID;
+			GLuint m_GeometryShaderID;
+			GLuint m_ComputeShaderID;
+
+			GLuint m_ProgramID;
+			GLHandle m_Handle;
+
+			// filled once after linking
+			std::vector<UniformInfo> m_Uniforms;
+			std::vector<UniformBlockInfo> m_UniformBlocks;
+			// open addressing table of indices into m_Uniforms, keyed by UniformInfo::hash
+			std::vector<int32_t> m_UniformTable;
+
+			std::vector<unsigned char> m_UniformShadow;
+			bool m_UniformShadowing;
+			UniformShadowStats m_ShadowStats;
+
+			int m_MaxTextureSlots;
+
+			// state between BeginLink() and FinishLink()
+			bool m_LinkPending;
+			std::string m_LinkPath;
+			bool m_StoreBinary;
+			uint64_t m_LinkCacheKey;
+
+			static void ParseShaderFile(const char* shaderPath, ShaderSources& sources);
+			// 'shaderPath' is only used in error messages
+			void BeginLink(const ShaderSources& sources, const char* shaderPath);
+			void FinishLink();
+			void DeleteStageShaders();
+
+			void ReflectUniforms();
+			int32_t AddUniform(UniformInfo&& info);
+			void RebuildUniformTable();
+			int32_t FindUniform(UniformName name);
+			// slot range and sampler type of a texture bound to 'handle'
+			void CheckTextureUniform(UniformHandle handle, const GLTexture& texture, int slot) const;
+			bool UpdateUniformShadow(UniformHandle handle, const void* value, uint32_t size);
+		public:
+
+			Shader();
+			Shader(const char* shaderPath);
+			~Shader();
+
+			Shader(const Shader&) = delete;
+			Shader& operator=(const Shader&) = delete;
+			Shader(Shader&& other) noexcept;
+			Shader& operator=(Shader&& other) noexcept;
+
+			/** @brief Compiles and links the file, or loads it from ProgramBinaryCache if enabled */
+			void LoadShader(const char* shaderPath);
+
+			/**
+			 * @brief LoadShader() in two halves. BeginLoad() submits the compile and link without querying
+			 * their status, FinishLoad() checks for errors (throws std::runtime_error) and reflects uniforms.
+			 * IsLoadComplete() never blocks if SupportsParallelCompile(), otherwise it always returns true
+			 * and FinishLoad() waits for the driver. See ShaderBatch
+			 */
+			void BeginLoad(const char* shaderPath);
+			bool IsLoadComplete() const;
+			void FinishLoad();
+			bool IsLoadPending() const { return m_LinkPending; }
+
+			/** @brief Same as LoadShader()/BeginLoad() with already preprocessed sources, 'name' is used in error messages */
+			void LoadSources(const ShaderSources& sources, const char* name);
+			void BeginLoadSources(const ShaderSources& sources, const char* name);
+
+			// GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile
+			static bool SupportsParallelCompile();
+
+
+			void Bind();
+
+			operator GLuint() const { return m_ProgramID; }
+			GLHandle Handle() const { return m_Handle; }
+
+			/**
+			 * @brief Binds the program and runs its '#shader compute' stage
+			 */
+			void Dispatch(GLuint groupsX, GLuint groupsY = 1, GLuint groupsZ = 1);
+			/**
+			 * @brief Same as Dispatch() but group counts are read by the GPU from a DispatchIndirectCommand
+			 * 
+			 * @param offset byte offset of the DispatchIndirectCommand, must be a multiple of 4
+			 */
+			void DispatchIndirect(const GLBuffer& indirectBuffer, GLintptr offset = 0);
+
+			/**
+			 * @brief Makes writes of previous dispatches visible to the operations in 'barriers',
+			 * e.g. SHADER_STORAGE | VERTEX_ATTRIB_ARRAY before drawing particles simulated in a compute shader
+			 */
+			static void Barrier(MemoryBarrierBits barriers);
+
+			GLint GetUniformLocation(UniformName name);
+			UniformHandle GetUniformHandle(UniformName name);
+
+			const std::vector<UniformInfo>& GetUniforms() const { return m_Uniforms; }
+			const std::vector<UniformBlockInfo>& GetUniformBlocks() const { return m_UniformBlocks; }
+
+
+			void Uniform(UniformName name, const glm::mat4& uniform);
+			void Uniform(UniformName name, const GLTexture& uniform, int slot);
+			void Uniform(UniformName name, const GLTexture& uniform, const SamplerDesc& sampler, int slot);
+			void Uniform(UniformName name, int uniform);
+
+			void Uniform(UniformHandle handle, const glm::mat4& uniform);
+			// without a SamplerDesc the texture's own parameters are used
+			void Uniform(UniformHandle handle, const GLTexture& uniform, int slot);
+			/** @brief Binds 'uniform' with the cached sampler object for 'sampler' to 'slot', see SamplerCache */
+			void Uniform(UniformHandle handle, const GLTexture& uniform, const SamplerDesc& sampler, int slot);
+			void Uniform(UniformHandle handle, int uniform);
+
+			/**
+			 * @brief Uniform writes are compared (with memcmp) against the last value written through this
+			 * Shader and dropped if they match. Enabled by default.
+			 */
+			void SetUniformShadowing(bool enabled) { m_UniformShadowing = enabled; }
+			// Call after changing uniforms of this program without going through Shader
+			void InvalidateUniformShadow();
+
+			const UniformShadowStats& GetUniformShadowStats() const { return m_ShadowStats; }
+			void ResetUniformShadowStats() { m_ShadowStats = UniformShadowStats(); }
+			// Sum of all shaders
+			static const UniformShadowStats& GetGlobalUniformShadowStats();
+			static void ResetGlobalUniformShadowStats();
+
+
+			/**
+			 * @brief 
+			 * 
+			 * @param uniformBuffer 
+			 * @param bufferIndex between 0 and GL_MAX_UNIFORM_BUFFER_BINDINGS, similar to glActiveTexture
+			 * @param uniformName
+			 */
+			void BindUBO(const GLBuffer& uniformBuffer, int bufferIndex, const char* uniformName);
+	};
+} // namespace EaseGL
+
+#endif
+/*-- #include "src/Shader.hpp" end --*/
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string.h>
+
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+/*-- #include "src/ProgramBinaryCache.hpp" start --*/
+/*-- #include "src/ProgramBinaryCache.hpp" end --*/
+
+namespace EaseGL
+{
+   void GetShaderError(GLuint shader, const char* filename, const char* type)
+   {
+      int  success;
+      glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+      if(!success)
+      {
+         GLint length = 0;
+         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+         std::string infoLog(length > 1 ? length : 1, '\0');
+         glGetShaderInfoLog(shader, (GLsizei)infoLog.size(), NULL, &infoLog[0]);
+         infoLog.resize(strlen(infoLog.c_str()));
+         std::cout << "ERROR::SHADER::" << type << "::COMPILATION_FAILED\n" << infoLog << '\n' << filename << std::endl;
+         // the log is part of the message, callers that catch (ShaderBatch, variants) have nothing else to show
+         throw std::runtime_error(std::string("Shader compilation failed: ") + type + "\n" + infoLog + '\n' + filename);
+      }
+   }
+   void GetProgramError(GLuint shader, const char* filename)
+   {
+      int  success;
+      glGetProgramiv(shader, GL_LINK_STATUS, &success);
+      if(!success)
+      {
+         GLint length = 0;
+         glGetProgramiv(shader, GL_INFO_LOG_LENGTH, &length);
+         std::string infoLog(length > 1 ? length : 1, '\0');
+         glGetProgramInfoLog(shader, (GLsizei)infoLog.size(), NULL, &infoLog[0]);
+         infoLog.resize(strlen(infoLog.c_str()));
+         std::cout << "ERROR::SHADER::PROGRAM::COMPILATION_FAILED\n" << infoLog << '\n' << filename << std::endl;
+         throw std::runtime_error(std::string("Shader program linking failed\n") + infoLog + '\n' + filename);
+      }
+   }
+
+   static UniformShadowStats s_GlobalShadowStats;
+
+   Shader::Shader()
+      : m_VertexShaderID(0), m_FragmentShaderID(0), m_GeometryShaderID(0), m_ComputeShaderID(0), m_ProgramID(0),
+      m_UniformShadowing(true), m_MaxTextureSlots(0), m_LinkPending(false), m_StoreBinary(false), m_LinkCacheKey(0)
+   {
+   }
+
+   Shader::Shader(const char* shaderPath)
+      : m_VertexShaderID(0), m_FragmentShaderID(0), m_GeometryShaderID(0), m_ComputeShaderID(0), m_ProgramID(0),
+      m_UniformShadowing(true), m_MaxTextureSlots(0), m_LinkPending(false), m_StoreBinary(false), m_LinkCacheKey(0)
+   {
+      LoadShader(shaderPath);
+   }
+
+   Shader::Shader(Shader&& other) noexcept
+      : m_VertexShaderID(other.m_VertexShaderID), m_FragmentShaderID(other.m_FragmentShaderID),
+      m_GeometryShaderID(other.m_GeometryShaderID), m_ComputeShaderID(other.m_ComputeShaderID),
+      m_ProgramID(other.m_ProgramID), m_Handle(other.m_Handle),
+      m_Uniforms(std::move(other.m_Uniforms)), m_UniformBlocks(std::move(other.m_UniformBlocks)),
+      m_UniformTable(std::move(other.m_UniformTable)), m_UniformShadow(std::move(other.m_UniformShadow)),
+      m_UniformShadowing(other.m_UniformShadowing), m_ShadowStats(other.m_ShadowStats), m_MaxTextureSlots(other.m_MaxTextureSlots),
+      m_LinkPending(other.m_LinkPending), m_LinkPath(std::move(other.m_LinkPath)),
+      m_StoreBinary(other.m_StoreBinary), m_LinkCacheKey(other.m_LinkCacheKey)
+   {
+      other.m_VertexShaderID = 0;
+      other.m_FragmentShaderID = 0;
+      other.m_GeometryShaderID = 0;
+      other.m_ComputeShaderID = 0;
+      other.m_ProgramID = 0;
+      other.m_Handle = GLHandle();
+      other.m_LinkPending = false;
+   }
+
+   Shader& Shader::operator=(Shader&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteStageShaders();
+         GLObjectPool::Destroy(m_Handle);
+
+         m_VertexShaderID = other.m_VertexShaderID;
+         m_FragmentShaderID = other.m_FragmentShaderID;
+         m_GeometryShaderID = other.m_GeometryShaderID;
+         m_ComputeShaderID = other.m_ComputeShaderID;
+         m_ProgramID = other.m_ProgramID;
+         m_Handle = other.m_Handle;
+         m_Uniforms = std::move(other.m_Uniforms);
+         m_UniformBlocks = std::move(other.m_UniformBlocks);
+         m_UniformTable = std::move(other.m_UniformTable);
+         m_UniformShadow = std::move(other.m_UniformShadow);
+         m_UniformShadowing = other.m_UniformShadowing;
+         m_ShadowStats = other.m_ShadowStats;
+         m_MaxTextureSlots = other.m_MaxTextureSlots;
+         m_LinkPending = other.m_LinkPending;
+         m_LinkPath = std::move(other.m_LinkPath);
+         m_StoreBinary = other.m_StoreBinary;
+         m_LinkCacheKey = other.m_LinkCacheKey;
+
+         other.m_VertexShaderID = 0;
+         other.m_FragmentShaderID = 0;
+         other.m_GeometryShaderID = 0;
+         other.m_ComputeShaderID = 0;
+         other.m_ProgramID = 0;
+         other.m_Handle = GLHandle();
+         other.m_LinkPending = false;
+      }
+      return *this;
+   }
+
+   void Shader::LoadShader(const char* shaderPath)
+   {
+      BeginLoad(shaderPath);
+      FinishLoad();
+   }
+
+   void Shader::BeginLoad(const char* shaderPath)
+   {
+      ShaderSources sources;
+      ParseShaderFile(shaderPath, sources);
+      BeginLink(sources, shaderPath);
+   }
+
+   void Shader::LoadSources(const ShaderSources& sources, const char* name)
+   {
+      BeginLink(sources, name);
+      FinishLink();
+   }
+
+   void Shader::BeginLoadSources(const ShaderSources& sources, const char* name)
+   {
+      BeginLink(sources, name);
+   }
+
+   bool Shader::IsLoadComplete() const
+   {
+      if(!m_LinkPending || !SupportsParallelCompile())
+         return true;
+
+      GLint complete = GL_FALSE;
+      glGetProgramiv(m_ProgramID, GL_COMPLETION_STATUS_KHR, &complete);
+      return complete == GL_TRUE;
+   }
+
+   void Shader::FinishLoad()
+   {
+      FinishLink();
+   }
+
+   // static
+   bool Shader::SupportsParallelCompile()
+   {
+      return GLContext::HasExtension("GL_KHR_parallel_shader_compile")
+         || GLContext::HasExtension("GL_ARB_parallel_shader_compile");
+   }
+
+   // static
+   void Shader::ParseShaderFile(const char* shaderPath, ShaderSources& sources)
+   {
+      ShaderSourceCache::Preprocess(shaderPath, sources);
+   }
+
+   GLuint CompileShaderStage(GLenum type, const std::string& source)
+   {
+      GLuint shader = glCreateShader(type);
+      const char* src = source.c_str();
+      glShaderSource(shader, 1, &src, NULL);
+      glCompileShader(shader);
+      return shader;
+   }
+
+   void Shader::BeginLink(const ShaderSources& sources, const char* shaderPath)
+   {
+      // GL_MAX_TEXTURE_UNITS is the fixed function limit, an invalid enum in core profiles
+      glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &m_MaxTextureSlots);
+
+      DeleteStageShaders();
+      GLObjectPool::Destroy(m_Handle);
+      m_ProgramID = 0;
+      m_Uniforms.clear();
+      m_UniformBlocks.clear();
+      m_UniformTable.clear();
+      m_UniformShadow.clear();
+
+      m_Handle = GLObjectPool::Create(GLObjectType::PROGRAM);
+      m_ProgramID = GLObjectPool::Name(m_Handle);
+
+      m_LinkPending = true;
+      m_LinkPath = shaderPath + sources.fileLegend;
+      m_StoreBinary = false;
+
+      if(ProgramBinaryCache::IsAvailable())
+      {
+         m_LinkCacheKey = ProgramBinaryCache::Key(sources.stages, ShaderSources::STAGE_COUNT);
+         if(ProgramBinaryCache::Load(m_ProgramID, m_LinkCacheKey))
+            return;
+         glProgramParameteri(m_ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+         m_StoreBinary = true;
+      }
+
+      // statuses are not queried here, the driver is free to compile in the background until FinishLink()
+      if(sources[ShaderType::VERTEX] != "")
+         m_VertexShaderID = CompileShaderStage(GL_VERTEX_SHADER, sources[ShaderType::VERTEX]);
+      if(sources[ShaderType::FRAGMENT] != "")
+         m_FragmentShaderID = CompileShaderStage(GL_FRAGMENT_SHADER, sources[ShaderType::FRAGMENT]);
+      if(sources[ShaderType::GEOMETRY] != "")
+         m_GeometryShaderID = CompileShaderStage(GL_GEOMETRY_SHADER, sources[ShaderType::GEOMETRY]);
+      if(sources[ShaderType::COMPUTE] != "")
+         m_ComputeShaderID = CompileShaderStage(GL_COMPUTE_SHADER, sources[ShaderType::COMPUTE]);
+
+      if(m_VertexShaderID != 0)
+         glAttachShader(m_ProgramID, m_VertexShaderID);
+      if(m_FragmentShaderID != 0)
+         glAttachShader(m_ProgramID, m_FragmentShaderID);
+      if(m_GeometryShaderID != 0)
+         glAttachShader(m_ProgramID, m_GeometryShaderID);
+      if(m_ComputeShaderID != 0)
+         glAttachShader(m_ProgramID, m_ComputeShaderID);
+      glLinkProgram(m_ProgramID);
+   }
+
+   void Shader::FinishLink()
+   {
+      if(!m_LinkPending)
+         return;
+      m_LinkPending = false;
+
+      try
+      {
+         const char* shaderPath = m_LinkPath.c_str();
+         if(m_VertexShaderID != 0)
+            GetShaderError(m_VertexShaderID, shaderPath, "VERTEX");
+         if(m_FragmentShaderID != 0)
+            GetShaderError(m_FragmentShaderID, shaderPath, "FRAGMENT");
+         if(m_GeometryShaderID != 0)
+            GetShaderError(m_GeometryShaderID, shaderPath, "GEOMETRY");
+         if(m_ComputeShaderID != 0)
+            GetShaderError(m_ComputeShaderID, shaderPath, "COMPUTE");
+         GetProgramError(m_ProgramID, shaderPath);
+      }
+      catch(...)
+      {
+         DeleteStageShaders();
+         throw;
+      }
+
+      DeleteStageShaders();
+      if(m_StoreBinary)
+         ProgramBinaryCache::Store(m_ProgramID, m_LinkCacheKey);
+      ReflectUniforms();
+   }
+
+   void Shader::DeleteStageShaders()
+   {
+      if(m_VertexShaderID != 0)
+         glDeleteShader(m_VertexShaderID);
+      if(m_FragmentShaderID != 0)
+         glDeleteShader(m_FragmentShaderID);
+      if(m_GeometryShaderID != 0)
+         glDeleteShader(m_GeometryShaderID);
+      if(m_ComputeShaderID != 0)
+         glDeleteShader(m_ComputeShaderID);
+      m_VertexShaderID = 0;
+      m_FragmentShaderID = 0;
+      m_GeometryShaderID = 0;
+      m_ComputeShaderID = 0;
+   }
+      
+   Shader::~Shader()
+   {
+      DeleteStageShaders();
+      GLObjectPool::Destroy(m_Handle);
+   }
+
+   void Shader::Bind() 
+   {
+      glUseProgram(m_ProgramID);
+   }
+
+   void Shader::Dispatch(GLuint groupsX, GLuint groupsY /* = 1*/, GLuint groupsZ /* = 1*/)
+   {
+      glUseProgram(m_ProgramID);
+      glDispatchCompute(groupsX, groupsY, groupsZ);
+   }
+
+   void Shader::DispatchIndirect(const GLBuffer& indirectBuffer, GLintptr offset /* = 0*/)
+   {
+      glUseProgram(m_ProgramID);
+      glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, indirectBuffer.m_BufferID);
+      glDispatchComputeIndirect(offset);
+   }
+
+   // static
+   void Shader::Barrier(MemoryBarrierBits barriers)
+   {
+      glMemoryBarrier((GLbitfield)barriers);
+   }
+
+   bool IsSamplerUniformType(GLenum type)
+   {
+      return type == GL_SAMPLER_1D || type == GL_SAMPLER_2D || type == GL_SAMPLER_3D || type == GL_SAMPLER_CUBE
+         || type == GL_SAMPLER_1D_SHADOW || type == GL_SAMPLER_2D_SHADOW || type == GL_SAMPLER_CUBE_SHADOW
+         || type == GL_SAMPLER_1D_ARRAY || type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_1D_ARRAY_SHADOW || type == GL_SAMPLER_2D_ARRAY_SHADOW
+         || type == GL_SAMPLER_CUBE_MAP_ARRAY || type == GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW
+         || type == GL_SAMPLER_2D_MULTISAMPLE || type == GL_SAMPLER_2D_MULTISAMPLE_ARRAY || type == GL_SAMPLER_BUFFER || type == GL_SAMPLER_2D_RECT
+         || type == GL_INT_SAMPLER_2D || type == GL_INT_SAMPLER_3D || type == GL_INT_SAMPLER_CUBE || type == GL_INT_SAMPLER_2D_ARRAY
+         || type == GL_UNSIGNED_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_3D || type == GL_UNSIGNED_INT_SAMPLER_CUBE || type == GL_UNSIGNED_INT_SAMPLER_2D_ARRAY;
+   }
+
+   // texture type a sampler uniform reads from, NONE for the ones GLTexture can't be
+   TextureType GetSamplerTextureType(GLenum type)
+   {
+      return type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_SHADOW || type == GL_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_2D ? TextureType::TEXTURE2D
+         : type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_ARRAY_SHADOW || type == GL_INT_SAMPLER_2D_ARRAY || type == GL_UNSIGNED_INT_SAMPLER_2D_ARRAY ? TextureType::TEXTURE2D_ARRAY
+         : type == GL_SAMPLER_CUBE || type == GL_SAMPLER_CUBE_SHADOW || type == GL_INT_SAMPLER_CUBE || type == GL_UNSIGNED_INT_SAMPLER_CUBE ? TextureType::TEXTURE_CUBE_MAP
+         : type == GL_SAMPLER_3D || type == GL_INT_SAMPLER_3D || type == GL_UNSIGNED_INT_SAMPLER_3D ? TextureType::TEXTURE3D
+         : TextureType::NONE;
+   }
+
+   uint32_t GetUniformTypeSize(GLenum type)
+   {
+      return type == GL_FLOAT || type == GL_INT || type == GL_UNSIGNED_INT || type == GL_BOOL ? 4
+         : type == GL_FLOAT_VEC2 || type == GL_INT_VEC2 || type == GL_UNSIGNED_INT_VEC2 || type == GL_BOOL_VEC2 ? 8
+         : type == GL_FLOAT_VEC3 || type == GL_INT_VEC3 || type == GL_UNSIGNED_INT_VEC3 || type == GL_BOOL_VEC3 ? 12
+         : type == GL_FLOAT_VEC4 || type == GL_INT_VEC4 || type == GL_UNSIGNED_INT_VEC4 || type == GL_BOOL_VEC4 ? 16
+         : type == GL_FLOAT_MAT2 ? 16
+         : type == GL_FLOAT_MAT3 ? 36
+         : type == GL_FLOAT_MAT4 ? 64
+         : type == GL_FLOAT_MAT2x3 || type == GL_FLOAT_MAT3x2 ? 24
+         : type == GL_FLOAT_MAT2x4 || type == GL_FLOAT_MAT4x2 ? 32
+         : type == GL_FLOAT_MAT3x4 || type == GL_FLOAT_MAT4x3 ? 48
+         : IsSamplerUniformType(type) ? 4
+         : 0;
+   }
+
+   void Shader::ReflectUniforms()
+   {
+      GLint uniformCount = 0;
+      GLint maxNameLength = 0;
+      glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORMS, &uniformCount);
+      glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+      std::vector<char> nameBuffer(maxNameLength + 1);
+      for(GLint i = 0; i < uniformCount; i++)
+      {
+         GLsizei length = 0;
+         UniformInfo info;
+         glGetActiveUniform(m_ProgramID, i, (GLsizei)nameBuffer.size(), &length, &info.arraySize, &info.type, nameBuffer.data());
+         info.name.assign(nameBuffer.data(), length);
+         info.location = glGetUniformLocation(m_ProgramID, info.name.c_str());
+
+         // members of uniform blocks have no location, they are set through buffers
+         if(info.location == -1)
+            continue;
+
+         info.isSampler = IsSamplerUniformType(info.type);
+         info.hash = HashUniformName(info.name.c_str());
+
+         // "name" and "name[0]" share the same shadow
+         info.shadowSize = GetUniformTypeSize(info.type);
+         info.shadowOffset = (uint32_t)m_UniformShadow.size();
+         info.shadowValid = false;
+         m_UniformShadow.resize(m_UniformShadow.size() + info.shadowSize);
+
+         std::string arrayName;
+         if(info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+            arrayName = info.name.substr(0, info.name.size() - 3);
+
+         UniformInfo arrayInfo = info;
+         AddUniform(std::move(info));
+         if(!arrayName.empty())
+         {
+            arrayInfo.name = arrayName;
+            arrayInfo.hash = HashUniformName(arrayName.c_str());
+            AddUniform(std::move(arrayInfo));
+         }
+      }
+
+      GLint blockCount = 0;
+      glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+      for(GLint i = 0; i < blockCount; i++)
+      {
+         GLint length = 0;
+         glGetActiveUniformBlockiv(m_ProgramID, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &length);
+
+         UniformBlockInfo block;
+         std::vector<char> blockName(length + 1);
+         glGetActiveUniformBlockName(m_ProgramID, i, (GLsizei)blockName.size(), NULL, blockName.data());
+         block.name = blockName.data();
+         block.index = i;
+         glGetActiveUniformBlockiv(m_ProgramID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+         block.isStorageBlock = false;
+         m_UniformBlocks.push_back(block);
+      }
+
+      if(GLContext::HasVersion(4, 3))
+      {
+         GLint storageBlockCount = 0;
+         glGetProgramInterfaceiv(m_ProgramID, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &storageBlockCount);
+         for(GLint i = 0; i < storageBlockCount; i++)
+         {
+            const GLenum properties[] = { GL_NAME_LENGTH, GL_BUFFER_DATA_SIZE };
+            GLint values[2] = { 0, 0 };
+            glGetProgramResourceiv(m_ProgramID, GL_SHADER_STORAGE_BLOCK, i, 2, properties, 2, NULL, values);
+
+            UniformBlockInfo block;
+            std::vector<char> blockName(values[0] + 1);
+            glGetProgramResourceName(m_ProgramID, GL_SHADER_STORAGE_BLOCK, i, (GLsizei)blockName.size(), NULL, blockName.data());
+            block.name = blockName.data();
+            block.index = i;
+            block.dataSize = values[1];
+            block.isStorageBlock = true;
+            m_UniformBlocks.push_back(block);
+         }
+      }
+
+      RebuildUniformTable();
+   }
+
+   int32_t Shader::AddUniform(UniformInfo&& info)
+   {
+      m_Uniforms.push_back(std::move(info));
+      return (int32_t)m_Uniforms.size() - 1;
+   }
+
+   void Shader::RebuildUniformTable()
+   {
+      // keep the load factor at or below 50%
+      size_t tableSize = 8;
+      while(tableSize < m_Uniforms.size() * 2)
+         tableSize *= 2;
+
+      m_UniformTable.assign(tableSize, -1);
+      for(int32_t i = 0; i < (int32_t)m_Uniforms.size(); i++)
+      {
+         size_t slot = m_Uniforms[i].hash & (tableSize - 1);
+         while(m_UniformTable[slot] != -1)
+            slot = (slot + 1) & (tableSize - 1);
+         m_UniformTable[slot] = i;
+      }
+   }
+
+   int32_t Shader::FindUniform(UniformName name)
+   {
+      if(!m_UniformTable.empty())
+      {
+         size_t mask = m_UniformTable.size() - 1;
+         for(size_t slot = name.hash & mask; m_UniformTable[slot] != -1; slot = (slot + 1) & mask)
+         {
+            // names with the same hash share a probe chain, the hash only saves most string compares
+            const UniformInfo& uniform = m_Uniforms[m_UniformTable[slot]];
+            if(uniform.hash == name.hash && uniform.name == name.name)
+               return m_UniformTable[slot];
+         }
+      }
+
+      // not reported by reflection (e.g. "lights[3]"), ask the driver once and remember the answer
+      UniformInfo info;
+      info.name = name.name;
+      info.hash = name.hash;
+      info.location = glGetUniformLocation(m_ProgramID, name.name);
+      info.type = GL_NONE;
+      info.arraySize = 1;
+      info.isSampler = false;
+      info.shadowOffset = 0;
+      info.shadowSize = 0;
+      info.shadowValid = false;
+      if(info.location == -1)
+      {
+         std::cout << "ERROR: Uniform " << name.name << " not found!\n";
+      }
+
+      int32_t index = AddUniform(std::move(info));
+      RebuildUniformTable();
+      return index;
+   }
+
+   GLint Shader::GetUniformLocation(UniformName name) 
+   {
+      return m_Uniforms[FindUniform(name)].location;
+   }
+
+   UniformHandle Shader::GetUniformHandle(UniformName name)
+   {
+      UniformHandle handle;
+      handle.index = FindUniform(name);
+      handle.location = m_Uniforms[handle.index].location;
+      return handle;
+   }
+
+   void Shader::BindUBO(const GLBuffer& uniformBuffer, int bufferIndex, const char* uniformName) 
+   {
+      glBindBufferBase(GL_UNIFORM_BUFFER, bufferIndex, uniformBuffer.m_BufferID);
+
+      GLuint uniformIndex = glGetUniformBlockIndex(m_ProgramID, uniformName);
+      if(uniformIndex == GL_INVALID_INDEX)
+      {
+         std::cout << "ERROR: Uniform block " << uniformName << " not found!\n";
+         return;
+      }
+      glUniformBlockBinding(m_ProgramID, uniformIndex, bufferIndex);
+   }
+
+
+
+   void Shader::Uniform(UniformName name, const glm::mat4& uniform)
+   {
+      Uniform(GetUniformHandle(name), uniform);
+   }
+
+   void Shader::Uniform(UniformName name, const GLTexture& uniform, int slot) 
+   {
+      Uniform(GetUniformHandle(name), uniform, slot);
+   }
+
+   void Shader::Uniform(UniformName name, const GLTexture& uniform, const SamplerDesc& sampler, int slot)
+   {
+      Uniform(GetUniformHandle(name), uniform, sampler, slot);
+   }
+
+   void Shader::Uniform(UniformName name, int uniform) 
+   {
+      Uniform(GetUniformHandle(name), uniform);
+   }
+
+   bool Shader::UpdateUniformShadow(UniformHandle handle, const void* value, uint32_t size)
+   {
+      if(!m_UniformShadowing || handle.index < 0)
+         return true;
+
+      UniformInfo& info = m_Uniforms[handle.index];
+      if(info.shadowSize != size)
+         return true;
+
+      unsigned char* shadow = m_UniformShadow.data() + info.shadowOffset;
+      if(info.shadowValid && memcmp(shadow, value, size) == 0)
+      {
+         m_ShadowStats.hits++;
+         s_GlobalShadowStats.hits++;
+         return false;
+      }
+
+      memcpy(shadow, value, size);
+      info.shadowValid = true;
+      m_ShadowStats.misses++;
+      s_GlobalShadowStats.misses++;
+      return true;
+   }
+
+   void Shader::InvalidateUniformShadow()
+   {
+      for(UniformInfo& info : m_Uniforms)
+         info.shadowValid = false;
+   }
+
+   // static
+   const UniformShadowStats& Shader::GetGlobalUniformShadowStats()
+   {
+      return s_GlobalShadowStats;
+   }
+
+   // static
+   void Shader::ResetGlobalUniformShadowStats()
+   {
+      s_GlobalShadowStats = UniformShadowStats();
+   }
+
+   void Shader::Uniform(UniformHandle handle, const glm::mat4& uniform)
+   {
+      if(UpdateUniformShadow(handle, &uniform[0][0], sizeof(float) * 16))
+         glUniformMatrix4fv(handle.location, 1, GL_FALSE, &uniform[0][0]);
+   }
+
+   void Shader::CheckTextureUniform(UniformHandle handle, const GLTexture& texture, int slot) const
+   {
+      if(slot >= m_MaxTextureSlots)
+      {
+         std::cout << "TEXTURE SLOT " << slot << " NOT EXISTS! MAX: " << m_MaxTextureSlots - 1 << std::endl;
+      }
+      if(handle.index >= 0)
+      {
+         // binding a cube map to a sampler2D leaves the sampler incomplete and it silently reads black
+         const UniformInfo& info = m_Uniforms[handle.index];
+         TextureType samplerType = GetSamplerTextureType(info.type);
+         if(samplerType != TextureType::NONE && samplerType != texture.Type())
+            std::cout << "ERROR: Texture bound to " << info.name << " doesn't match the sampler type" << std::endl;
+      }
+   }
+
+   void Shader::Uniform(UniformHandle handle, const GLTexture& uniform, int slot) 
+   {
+      CheckTextureUniform(handle, uniform, slot);
+      uniform.Bind(slot);
+      // a sampler left on the unit by an earlier pair would override the texture parameters
+      SamplerCache::Unbind(slot);
+      Uniform(handle, slot);
+   }
+
+   void Shader::Uniform(UniformHandle handle, const GLTexture& uniform, const SamplerDesc& sampler, int slot)
+   {
+      CheckTextureUniform(handle, uniform, slot);
+      if(handle.index >= 0)
+      {
+         // without a compare mode shadow lookups are undefined
+         GLenum type = m_Uniforms[handle.index].type;
+         bool shadowSampler = type == GL_SAMPLER_2D_SHADOW || type == GL_SAMPLER_2D_ARRAY_SHADOW || type == GL_SAMPLER_CUBE_SHADOW;
+         if(shadowSampler != (sampler.compare != SamplerCompare::NONE))
+            std::cout << "ERROR: Sampler compare mode doesn't match " << m_Uniforms[handle.index].name << std::endl;
+      }
+      uniform.Bind(slot);
+      SamplerCache::Bind(slot, sampler);
+      Uniform(handle, slot);
+   }
+
+   void Shader::Uniform(UniformHandle handle, int uniform) 
+   {
+      if(UpdateUniformShadow(handle, &uniform, sizeof(int)))
+         glUniform1i(handle.location, uniform);
+   }
+} // namespace EaseGL
+
+#endif
+/*-- File: src/Shader.cpp end --*/
+/*-- File: src/ShaderBatch.cpp start --*/
+/*-- #include "src/ShaderBatch.hpp" start --*/
+#ifndef SHADERBATCH_H
+#define SHADERBATCH_H
+
+#include <glad/glad.h>
+/*-- #include "src/Shader.hpp" start --*/
+/*-- #include "src/Shader.hpp" end --*/
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EaseGL
+{
+	typedef uint32_t ShaderBatchHandle;
+
+	enum class ShaderLoadStatus
+	{
+		NONE = 0,
+		PENDING,
+		READY,
+		FAILED,
+	};
+
+	/**
+	 * @brief Loads many shaders without waiting on each compile. Add() submits compile and link,
+	 * Poll() finishes the ones the driver is done with. With GL_KHR_parallel_shader_compile the driver
+	 * compiles on its own threads and Poll() never blocks, so loading can overlap other startup work.
+	 *
+	 * ShaderBatch batch;
+	 * ShaderBatchHandle sprite = batch.Add("sprite.glsl");
+	 * ...
+	 * while(!batch.IsDone())
+	 * {
+	 *    batch.Poll();
+	 *    // decode textures, draw a loading screen, ...
+	 * }
+	 * if(batch.GetStatus(sprite) == ShaderLoadStatus::READY)
+	 *    batch.GetShader(sprite).Bind();
+	 *
+	 * Without the extension Poll() finishes everything submitted, which waits for the driver.
+	 */
+	class ShaderBatch
+	{
+		private:
+			struct Entry
+			{
+				std::unique_ptr<Shader> shader;
+				ShaderLoadStatus status = ShaderLoadStatus::NONE;
+				std::string error;
+			};
+
+			std::vector<Entry> m_Entries;
+			uint32_t m_PendingCount;
+
+			void Finish(Entry& entry);
+		public:
+			ShaderBatch();
+
+			ShaderBatch(const ShaderBatch&) = delete;
+			ShaderBatch& operator=(const ShaderBatch&) = delete;
+
+			/** @brief Parses the file and submits its compile and link. Failures are reported through GetStatus() */
+			ShaderBatchHandle Add(const char* shaderPath);
+
+			/** @brief Finishes every shader whose link has completed. Returns how many are still pending */
+			uint32_t Poll();
+			/** @brief Blocks until everything is finished */
+			void Wait();
+			bool IsDone() const { return m_PendingCount == 0; }
+
+			ShaderLoadStatus GetStatus(ShaderBatchHandle handle) const;
+			/** @brief Why the shader FAILED, with the stage, the path and the driver's compile or link log */
+			const std::string& GetError(ShaderBatchHandle handle) const;
+
+			/** @brief Only valid once the status is READY. The Shader stays owned by the batch */
+			Shader& GetShader(ShaderBatchHandle handle);
+			/** @brief Moves a READY shader out of the batch, returns an empty Shader if it isn't READY */
+			Shader TakeShader(ShaderBatchHandle handle);
+
+			size_t Count() const { return m_Entries.size(); }
+
+			/** @brief Lets the driver use as many compiler threads as it wants, called by the first ShaderBatch */
+			static void EnableParallelCompile();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/ShaderBatch.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <iostream>
+#include <stdexcept>
+
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   static bool s_ParallelCompileEnabled = false;
+
+   ShaderBatch::ShaderBatch()
+      : m_PendingCount(0)
+   {
+      EnableParallelCompile();
+   }
+
+   // static
+   void ShaderBatch::EnableParallelCompile()
+   {
+      if(s_ParallelCompileEnabled)
+         return;
+      s_ParallelCompileEnabled = true;
+
+#ifdef GL_KHR_parallel_shader_compile
+      // 0xFFFFFFFF leaves the thread count to the implementation
+      if(GLContext::HasExtension("GL_KHR_parallel_shader_compile"))
+         glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
+   }
+
+   ShaderBatchHandle ShaderBatch::Add(const char* shaderPath)
+   {
+      ShaderBatchHandle handle = (ShaderBatchHandle)m_Entries.size();
+      m_Entries.emplace_back();
+      Entry& entry = m_Entries.back();
+      entry.shader = std::make_unique<Shader>();
+
+      try
+      {
+         entry.shader->BeginLoad(shaderPath);
+         entry.status = ShaderLoadStatus::PENDING;
+         m_PendingCount++;
+      }
+      catch(const std::exception& e)
+      {
+         entry.status = ShaderLoadStatus::FAILED;
+         entry.error = e.what();
+      }
+      return handle;
+   }
+
+   void ShaderBatch::Finish(Entry& entry)
+   {
+      try
+      {
+         entry.shader->FinishLoad();
+         entry.status = ShaderLoadStatus::READY;
+      }
+      catch(const std::exception& e)
+      {
+         entry.status = ShaderLoadStatus::FAILED;
+         entry.error = e.what();
+      }
+      m_PendingCount--;
+   }
+
+   uint32_t ShaderBatch::Poll()
+   {
+      if(m_PendingCount == 0)
+         return 0;
+
+      for(Entry& entry : m_Entries)
+      {
+         if(entry.status == ShaderLoadStatus::PENDING && entry.shader->IsLoadComplete())
+            Finish(entry);
+      }
+      return m_PendingCount;
+   }
+
+   void ShaderBatch::Wait()
+   {
+      for(Entry& entry : m_Entries)
+      {
+         if(entry.status == ShaderLoadStatus::PENDING)
+            Finish(entry);
+      }
+   }
+
+   ShaderLoadStatus ShaderBatch::GetStatus(ShaderBatchHandle handle) const
+   {
+      if(handle >= m_Entries.size())
+         return ShaderLoadStatus::NONE;
+      return m_Entries[handle].status;
+   }
+
+   const std::string& ShaderBatch::GetError(ShaderBatchHandle handle) const
+   {
+      static const std::string empty;
+      if(handle >= m_Entries.size())
+         return empty;
+      return m_Entries[handle].error;
+   }
+
+   Shader& ShaderBatch::GetShader(ShaderBatchHandle handle)
+   {
+      if(GetStatus(handle) != ShaderLoadStatus::READY)
+         std::cout << "ERROR: ShaderBatch::GetShader(" << handle << ") is not ready" << std::endl;
+      return *m_Entries.at(handle).shader;
+   }
+
+   Shader ShaderBatch::TakeShader(ShaderBatchHandle handle)
+   {
+      // a shader that is still compiling or failed stays with the batch
+      if(GetStatus(handle) != ShaderLoadStatus::READY)
+      {
+         std::cout << "ERROR: ShaderBatch::TakeShader(" << handle << ") is not ready" << std::endl;
+         return Shader();
+      }
+
+      Shader shader = std::move(*m_Entries[handle].shader);
+      m_Entries[handle].status = ShaderLoadStatus::NONE;
+      return shader;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/ShaderBatch.cpp end --*/
+/*-- File: src/ShaderRegistry.cpp start --*/
+/*-- #include "src/ShaderRegistry.hpp" start --*/
+#ifndef SHADERREGISTRY_H
+#define SHADERREGISTRY_H
+
+#include <glad/glad.h>
+/*-- #include "src/Shader.hpp" start --*/
+/*-- #include "src/Shader.hpp" end --*/
+#include <memory>
+#include <string>
+
+namespace EaseGL
+{
+	/**
+	 * @brief Process-wide registry of loaded shader files. Load() returns the same program for the same
+	 * canonical path, and for different files whose preprocessed source is identical apart from the
+	 * source ids in #line directives.
+	 * The registry only keeps weak references, a program is deleted when the last shared_ptr is released.
+	 *
+	 * std::shared_ptr<EaseGL::Shader> shader = EaseGL::ShaderRegistry::Load("shader.glsl");
+	 *
+	 * Edited files are picked up after ShaderSourceCache::Invalidate(path). Not thread safe.
+	 */
+	class ShaderRegistry
+	{
+		private:
+			ShaderRegistry() {}
+		public:
+			/** @brief Throws std::runtime_error if the file can't be read or compiled */
+			static std::shared_ptr<Shader> Load(const char* shaderPath);
+
+			/** @brief Forgets entries whose programs were released */
+			static void Prune();
+			// programs still referenced
+			static size_t LiveCount();
+			// Load() calls that compiled a program
+			static uint32_t CompileCount();
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/ShaderRegistry.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+/*-- #include "src/ShaderSource.hpp" start --*/
+/*-- #include "src/ShaderSource.hpp" end --*/
+
+namespace EaseGL
+{
+   struct ShaderRegistryEntry
+   {
+      std::weak_ptr<Shader> shader;
+      // ShaderSourceCache::Generation() when the entry was made, a newer one means files may have changed
+      uint32_t generation = 0;
+   };
+
+   struct ShaderRegistryData
+   {
+      std::unordered_map<std::string, ShaderRegistryEntry> byPath;
+      std::unordered_map<uint64_t, std::weak_ptr<Shader>> bySource;
+      uint32_t compileCount = 0;
+   };
+
+   static ShaderRegistryData s_ShaderRegistry;
+
+   // static
+   std::shared_ptr<Shader> ShaderRegistry::Load(const char* shaderPath)
+   {
+      const ShaderSourceFile* file = ShaderSourceCache::Load(shaderPath);
+      if(file == nullptr)
+      {
+         std::cout << shaderPath;
+         throw std::runtime_error("Failed to load file");
+      }
+
+      ShaderRegistryEntry& entry = s_ShaderRegistry.byPath[file->path];
+      if(entry.generation == ShaderSourceCache::Generation())
+      {
+         if(std::shared_ptr<Shader> shader = entry.shader.lock())
+            return shader;
+      }
+
+      ShaderSources sources;
+      ShaderSourceCache::Preprocess(shaderPath, sources);
+      // Copies of a file share one program, the hash skips the source ids in #line directives but not the line numbers.
+      // The trade-off: compile errors and the file legend of a shared program name the files of the first one loaded
+      uint64_t sourceHash = HashShaderSources(sources);
+
+      std::weak_ptr<Shader>& sameSource = s_ShaderRegistry.bySource[sourceHash];
+      std::shared_ptr<Shader> shader = sameSource.lock();
+      if(shader == nullptr)
+      {
+         shader = std::make_shared<Shader>();
+         shader->LoadSources(sources, file->path.c_str());
+         sameSource = shader;
+         s_ShaderRegistry.compileCount++;
+      }
+
+      entry.shader = shader;
+      entry.generation = ShaderSourceCache::Generation();
+      return shader;
+   }
+
+   // static
+   void ShaderRegistry::Prune()
+   {
+      for(auto it = s_ShaderRegistry.byPath.begin(); it != s_ShaderRegistry.byPath.end();)
+         it = it->second.shader.expired() ? s_ShaderRegistry.byPath.erase(it) : std::next(it);
+      for(auto it = s_ShaderRegistry.bySource.begin(); it != s_ShaderRegistry.bySource.end();)
+         it = it->second.expired() ? s_ShaderRegistry.bySource.erase(it) : std::next(it);
+   }
+
+   // static
+   size_t ShaderRegistry::LiveCount()
+   {
+      size_t count = 0;
+      for(const auto& it : s_ShaderRegistry.bySource)
+      {
+         if(!it.second.expired())
+            count++;
+      }
+      return count;
+   }
+
+   // static
+   uint32_t ShaderRegistry::CompileCount()
+   {
+      return s_ShaderRegistry.compileCount;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/ShaderRegistry.cpp end --*/
+/*-- File: src/ShaderSource.cpp start --*/
+/*-- #include "src/ShaderSource.hpp" start --*/
+/*-- #include "src/ShaderSource.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string.h>
+
+namespace EaseGL
+{
+   struct ShaderSourceCacheData
+   {
+      std::unordered_map<std::string, std::unique_ptr<ShaderSourceFile>> files;
+      std::unordered_map<uint32_t, const ShaderSourceFile*> filesById;
+      std::vector<std::string> includeDirectories;
+      uint32_t fileReads = 0;
+      uint32_t generation = 0;
+   };
+
+   static ShaderSourceCacheData s_ShaderSourceCache;
+
+   uint64_t HashShaderSource(std::string_view text, uint64_t hash /* = 14695981039346656037ull*/)
+   {
+      for(char c : text)
+         hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+      return hash;
+   }
+
+   std::string CanonicalShaderPath(const std::string& path)
+   {
+      std::error_code error;
+      std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+      return error ? path : canonical.generic_string();
+   }
+
+   // 'line' without leading whitespace and trailing '\r'
+   std::string_view TrimShaderLine(std::string_view line)
+   {
+      size_t start = line.find_first_not_of(" \t");
+      if(start == std::string_view::npos)
+         return std::string_view();
+      line.remove_prefix(start);
+      if(!line.empty() && line.back() == '\r')
+         line.remove_suffix(1);
+      return line;
+   }
+
+   bool StartsWithDirective(std::string_view line, std::string_view directive)
+   {
+      return line.size() >= directive.size() && line.compare(0, directive.size(), directive) == 0
+         && (line.size() == directive.size() || line[directive.size()] == ' ' || line[directive.size()] == '\t');
+   }
+
+   // returns the next line of 'text' starting at 'pos' and moves 'pos' past it
+   std::string_view NextShaderLine(std::string_view text, size_t& pos)
+   {
+      size_t end = text.find('\n', pos);
+      if(end == std::string_view::npos)
+         end = text.size();
+      std::string_view line = text.substr(pos, end - pos);
+      pos = end + 1;
+      return line;
+   }
+
+   // comments may come before #version, so the whole section is searched, not just its first line
+   bool HasVersionDirective(std::string_view section)
+   {
+      size_t pos = 0;
+      while(pos < section.size())
+      {
+         if(StartsWithDirective(TrimShaderLine(NextShaderLine(section, pos)), "#version"))
+            return true;
+      }
+      return false;
+   }
+
+   uint64_t HashShaderSources(const ShaderSources& sources)
+   {
+      uint64_t hash = 14695981039346656037ull;
+      for(const std::string& stage : sources.stages)
+      {
+         // separator so moving text between stages changes the hash
+         hash = HashShaderSource(std::string_view("\0", 1), hash);
+
+         // the source id of a #line directive is left out so copies of a file in different places still hash equal,
+         // the line number is kept, the same text arriving from different line layouts is a different program
+         std::string_view text = stage;
+         size_t pos = 0;
+         while(pos < text.size())
+         {
+            size_t lineStart = pos;
+            std::string_view line = NextShaderLine(text, pos);
+            size_t lineEnd = std::min(pos, text.size());
+            if(line.compare(0, 6, "#line ") == 0)
+            {
+               lineEnd = line.find_first_not_of("0123456789", 6);
+               lineEnd = lineStart + (lineEnd == std::string_view::npos ? line.size() : lineEnd);
+            }
+            hash = HashShaderSource(text.substr(lineStart, lineEnd - lineStart), hash);
+         }
+      }
+      return hash;
+   }
+
+   void AppendLineDirective(std::string& out, uint32_t line, uint32_t sourceId)
+   {
+      char directive[32];
+      snprintf(directive, sizeof(directive), "#line %u %u\n", line, sourceId);
+      out += directive;
+   }
+
+   bool ReadShaderFile(const std::string& path, std::string& text)
+   {
+      FILE* fp = fopen(path.c_str(), "rb");
+      if(fp == nullptr)
+         return false;
+
+      fseek(fp, 0, SEEK_END);
+      long size = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      text.resize(size > 0 ? (size_t)size : 0);
+      size_t read = fread(&text[0], 1, text.size(), fp);
+      fclose(fp);
+      text.resize(read);
+      s_ShaderSourceCache.fileReads++;
+      return true;
+   }
+
+   // static
+   const ShaderSourceFile* ShaderSourceCache::Load(const std::string& path)
+   {
+      std::string canonical = CanonicalShaderPath(path);
+      auto it = s_ShaderSourceCache.files.find(canonical);
+      if(it != s_ShaderSourceCache.files.end())
+         return it->second.get();
+
+      std::unique_ptr<ShaderSourceFile> file = std::make_unique<ShaderSourceFile>();
+      if(!ReadShaderFile(canonical, file->text))
+         return nullptr;
+
+      file->path = canonical;
+      file->hash = HashShaderSource(file->text);
+
+      // GLSL source string numbers are plain integers, keep them small and derived from the path
+      uint32_t sourceId = 1 + (uint32_t)(HashShaderSource(canonical) % 99999);
+      while(s_ShaderSourceCache.filesById.count(sourceId) != 0)
+         sourceId = sourceId % 99999 + 1;
+      file->sourceId = sourceId;
+
+      const ShaderSourceFile* result = file.get();
+      s_ShaderSourceCache.filesById[sourceId] = result;
+      s_ShaderSourceCache.files[canonical] = std::move(file);
+      return result;
+   }
+
+   // static
+   const ShaderSourceFile* ShaderSourceCache::Reload(const std::string& path)
+   {
+      auto it = s_ShaderSourceCache.files.find(CanonicalShaderPath(path));
+      if(it == s_ShaderSourceCache.files.end())
+         return Load(path);
+
+      std::string text;
+      if(!ReadShaderFile(it->second->path, text))
+         return nullptr;
+
+      // updated in place, the entry keeps its source id
+      ShaderSourceFile& file = *it->second;
+      if(text != file.text)
+      {
+         file.text = std::move(text);
+         file.hash = HashShaderSource(file.text);
+         s_ShaderSourceCache.generation++;
+      }
+      return &file;
+   }
+
+   // static
+   const ShaderSourceFile* ShaderSourceCache::FindBySourceId(uint32_t sourceId)
+   {
+      auto it = s_ShaderSourceCache.filesById.find(sourceId);
+      return it != s_ShaderSourceCache.filesById.end() ? it->second : nullptr;
+   }
+
+   // static
+   void ShaderSourceCache::AppendSection(std::string& out, std::string_view section, const ShaderSourceFile& file,
+      uint32_t firstLine, int depth, std::vector<uint32_t>& usedFiles)
+   {
+      if(std::find(usedFiles.begin(), usedFiles.end(), file.sourceId) == usedFiles.end())
+         usedFiles.push_back(file.sourceId);
+
+      size_t pos = 0;
+      uint32_t lineNumber = firstLine;
+      while(pos < section.size())
+      {
+         std::string_view rawLine = NextShaderLine(section, pos);
+         std::string_view line = TrimShaderLine(rawLine);
+         lineNumber++;
+
+         if(StartsWithDirective(line, "#include"))
+         {
+            std::string_view name = TrimShaderLine(line.substr(strlen("#include")));
+            char close = !name.empty() && name[0] == '<' ? '>' : '"';
+            size_t end = name.size() > 1 ? name.find(close, 1) : std::string_view::npos;
+            if(name.empty() || (name[0] != '"' && name[0] != '<') || end == std::string_view::npos)
+            {
+               std::cout << "ERROR: Malformed #include in " << file.path << ":" << lineNumber << std::endl;
+               throw std::runtime_error("Malformed #include");
+            }
+            name = name.substr(1, end - 1);
+            if(depth >= MAX_INCLUDE_DEPTH)
+            {
+               std::cout << "ERROR: #include depth exceeds " << MAX_INCLUDE_DEPTH << " in " << file.path << ":" << lineNumber << std::endl;
+               throw std::runtime_error("#include depth exceeded");
+            }
+
+            std::filesystem::path relative = std::filesystem::path(file.path).parent_path() / std::string(name);
+            const ShaderSourceFile* included = Load(relative.string());
+            for(size_t i = 0; included == nullptr && i < s_ShaderSourceCache.includeDirectories.size(); i++)
+               included = Load(s_ShaderSourceCache.includeDirectories[i] + "/" + std::string(name));
+            if(included == nullptr)
+            {
+               std::cout << "ERROR: Can't find #include \"" << name << "\" from " << file.path << ":" << lineNumber << std::endl;
+               throw std::runtime_error("Failed to load file");
+            }
+
+            AppendLineDirective(out, 1, included->sourceId);
+            AppendSection(out, included->text, *included, 0, depth + 1, usedFiles);
+            AppendLineDirective(out, lineNumber + 1, file.sourceId);
+            continue;
+         }
+
+         out.append(rawLine.data(), rawLine.size());
+         out += '\n';
+
+         // #line is not allowed before #version
+         if(StartsWithDirective(line, "#version"))
+            AppendLineDirective(out, lineNumber + 1, file.sourceId);
+      }
+   }
+
+   // static
+   void ShaderSourceCache::Preprocess(const char* path, ShaderSources& sources)
+   {
+      // the file itself is read every time so edits are picked up, only its includes come from the cache
+      const ShaderSourceFile* file = Reload(path);
+      if(file == nullptr)
+      {
+         std::cout << path;
+         throw std::runtime_error("Failed to load file");
+      }
+
+      struct Section
+      {
+         ShaderType type;
+         size_t begin;
+         size_t end;
+         uint32_t firstLine; // line of the '#shader' directive
+      };
+      std::vector<Section> sections;
+
+      // split by reference into the cached text, nothing is copied until the stages are assembled
+      std::string_view text = file->text;
+      size_t pos = 0;
+      uint32_t lineNumber = 0;
+      while(pos < text.size())
+      {
+         size_t lineStart = pos;
+         std::string_view line = TrimShaderLine(NextShaderLine(text, pos));
+         lineNumber++;
+         if(!StartsWithDirective(line, "#shader"))
+            continue;
+
+         std::string_view stage = TrimShaderLine(line.substr(strlen("#shader")));
+         ShaderType type = stage.compare(0, 6, "vertex") == 0 ? ShaderType::VERTEX
+            : stage.compare(0, 8, "fragment") == 0 ? ShaderType::FRAGMENT
+            : stage.compare(0, 8, "geometry") == 0 ? ShaderType::GEOMETRY
+            : stage.compare(0, 7, "compute") == 0 ? ShaderType::COMPUTE
+            : ShaderType::NONE;
+
+         if(!sections.empty())
+            sections.back().end = lineStart;
+         sections.push_back({ type, std::min(pos, text.size()), text.size(), lineNumber });
+      }
+
+      std::vector<uint32_t> usedFiles;
+      for(const Section& section : sections)
+      {
+         std::string_view sectionText = text.substr(section.begin, section.end - section.begin);
+         if(section.type == ShaderType::NONE || sectionText.empty())
+            continue;
+
+         std::string& out = sources[section.type];
+         out.reserve(out.size() + sectionText.size() + 64);
+
+         // without a #version line the first #line directive can go at the top, otherwise AppendSection() puts it after #version
+         if(!HasVersionDirective(sectionText))
+            AppendLineDirective(out, section.firstLine + 1, file->sourceId);
+         AppendSection(out, sectionText, *file, section.firstLine, 0, usedFiles);
+      }
+
+      for(uint32_t sourceId : usedFiles)
+         sources.fileLegend += "\n  source " + std::to_string(sourceId) + ": " + FindBySourceId(sourceId)->path;
+   }
+
+   // static
+   void ShaderSourceCache::AddIncludeDirectory(const std::string& directory)
+   {
+      s_ShaderSourceCache.includeDirectories.push_back(directory);
+   }
+
+   // static
+   void ShaderSourceCache::Invalidate(const std::string& path)
+   {
+      auto it = s_ShaderSourceCache.files.find(CanonicalShaderPath(path));
+      if(it == s_ShaderSourceCache.files.end())
+         return;
+      s_ShaderSourceCache.filesById.erase(it->second->sourceId);
+      s_ShaderSourceCache.files.erase(it);
+      s_ShaderSourceCache.generation++;
+   }
+
+   // static
+   void ShaderSourceCache::Clear()
+   {
+      s_ShaderSourceCache.files.clear();
+      s_ShaderSourceCache.filesById.clear();
+      s_ShaderSourceCache.generation++;
+   }
+
+   // static
+   uint32_t ShaderSourceCache::FileReadCount()
+   {
+      return s_ShaderSourceCache.fileReads;
+   }
+
+   // static
+   uint32_t ShaderSourceCache::Generation()
+   {
+      return s_ShaderSourceCache.generation;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/ShaderSource.cpp end --*/
+/*-- File: src/ShaderVariants.cpp start --*/
+/*-- #include "src/ShaderVariants.hpp" start --*/
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <glad/glad.h>
+/*-- #include "src/Shader.hpp" start --*/
+/*-- #include "src/Shader.hpp" end --*/
+/*-- #include "src/ShaderSource.hpp" start --*/
+/*-- #include "src/ShaderSource.hpp" end --*/
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace EaseGL
+{
+	typedef uint64_t ShaderKeywordMask;
+
+	/**
+	 * @brief One shader file compiled with different sets of '#define' keywords, each set is a bit mask.
+	 * Variants are compiled on first Get() (or by Prewarm()) and looked up in an open addressing table.
+	 *
+	 * #ifdef / #ifndef / #if defined(...) on keywords are resolved before compiling, and keywords that are
+	 * not referenced afterwards are not defined, so keyword sets that end up with the same source share one program.
+	 *
+	 * ShaderVariants lit("lit.glsl", { "NORMAL_MAP", "SHADOWS", "FOG" });
+	 * lit.Get(lit.Mask({ "NORMAL_MAP", "FOG" })).Bind();
+	 */
+	class ShaderVariants
+	{
+		private:
+			struct Slot
+			{
+				ShaderKeywordMask mask;
+				int32_t program; // -1 for empty slots
+			};
+
+			ShaderSources m_Sources;
+			std::string m_Path;
+			std::vector<std::string> m_Keywords;
+
+			std::vector<std::unique_ptr<Shader>> m_Programs;
+			std::unordered_map<uint64_t, int32_t> m_ProgramsBySource;
+
+			std::vector<Slot> m_Table;
+			uint32_t m_VariantCount;
+
+			int32_t FindVariant(ShaderKeywordMask mask) const;
+			void InsertVariant(ShaderKeywordMask mask, int32_t program);
+			// returns the program of an equivalent variant, or a new one that BeginLoadSources() was called on
+			int32_t SubmitVariant(ShaderKeywordMask mask, bool& submitted);
+			void BuildVariantSources(ShaderKeywordMask mask, ShaderSources& out) const;
+		public:
+			static constexpr size_t MAX_KEYWORDS = 64;
+
+			ShaderVariants(const char* shaderPath, const std::vector<std::string>& keywords);
+
+			ShaderVariants(const ShaderVariants&) = delete;
+			ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+			ShaderKeywordMask Keyword(const char* keyword) const;
+			ShaderKeywordMask Mask(std::initializer_list<const char*> keywords) const;
+
+			/** @brief Compiles the variant if it doesn't exist yet, throws std::runtime_error if that fails */
+			Shader& Get(ShaderKeywordMask mask);
+
+			/** @brief Compiles the variants up front, all links are submitted before any status is checked */
+			void Prewarm(const std::vector<ShaderKeywordMask>& masks);
+			/** @brief One variant per line, keywords separated by spaces, '#' starts a comment and '-' alone is the variant without keywords */
+			void Prewarm(const char* manifestPath);
+
+			const std::vector<std::string>& GetKeywords() const { return m_Keywords; }
+			uint32_t VariantCount() const { return m_VariantCount; }
+			// unique programs, at most VariantCount()
+			uint32_t ProgramCount() const { return (uint32_t)m_ProgramsBySource.size(); }
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/ShaderVariants.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace EaseGL
+{
+   int32_t FindShaderKeyword(const std::vector<std::string>& keywords, std::string_view name)
+   {
+      for(size_t i = 0; i < keywords.size(); i++)
+      {
+         if(keywords[i] == name)
+            return (int32_t)i;
+      }
+      return -1;
+   }
+
+   std::string_view TrimKeywordExpression(std::string_view text)
+   {
+      size_t start = text.find_first_not_of(" \t\r");
+      if(start == std::string_view::npos)
+         return std::string_view();
+      size_t end = text.find_last_not_of(" \t\r");
+      return text.substr(start, end - start + 1);
+   }
+
+   // 1 or 0 if 'expression' only tests one keyword, -1 if it has to be left to the GLSL preprocessor
+   int EvaluateKeywordCondition(std::string_view directive, std::string_view expression,
+      const std::vector<std::string>& keywords, ShaderKeywordMask mask)
+   {
+      expression = TrimKeywordExpression(expression);
+      bool negate = directive == "ifndef";
+      if(directive == "if" || directive == "elif")
+      {
+         if(!expression.empty() && expression[0] == '!')
+         {
+            negate = true;
+            expression = TrimKeywordExpression(expression.substr(1));
+         }
+         if(expression.compare(0, 7, "defined") != 0)
+            return -1;
+         expression = TrimKeywordExpression(expression.substr(7));
+         if(!expression.empty() && expression.front() == '(' && expression.back() == ')')
+            expression = TrimKeywordExpression(expression.substr(1, expression.size() - 2));
+      }
+
+      int32_t keyword = FindShaderKeyword(keywords, expression);
+      if(keyword < 0)
+         return -1;
+      bool defined = (mask & ((ShaderKeywordMask)1 << keyword)) != 0;
+      return defined != negate ? 1 : 0;
+   }
+
+   /**
+    * Resolves conditionals that only test keywords, everything else is left to the GLSL preprocessor.
+    * Removed lines are kept as empty lines so the #line directives of the source stay correct.
+    */
+   void ResolveKeywordConditionals(const std::string& source, const std::vector<std::string>& keywords,
+      ShaderKeywordMask mask, std::string& out)
+   {
+      struct Frame
+      {
+         bool known;       // resolved here, its directives are not emitted
+         bool parentEmit;
+         bool branchTaken;
+         bool emit;
+      };
+      std::vector<Frame> frames;
+
+      out.reserve(source.size());
+      std::string_view text = source;
+      size_t pos = 0;
+      while(pos < text.size())
+      {
+         size_t end = text.find('\n', pos);
+         if(end == std::string_view::npos)
+            end = text.size();
+         std::string_view line = text.substr(pos, end - pos);
+         pos = end + 1;
+
+         bool emit = frames.empty() || frames.back().emit;
+         std::string_view trimmed = TrimKeywordExpression(line);
+         if(trimmed.empty() || trimmed[0] != '#')
+         {
+            if(emit)
+               out.append(line.data(), line.size());
+            out += '\n';
+            continue;
+         }
+
+         std::string_view directive = TrimKeywordExpression(trimmed.substr(1));
+         size_t nameEnd = directive.find_first_of(" \t(");
+         std::string_view name = directive.substr(0, nameEnd);
+         std::string_view expression = nameEnd == std::string_view::npos ? std::string_view() : directive.substr(nameEnd);
+
+         bool keepLine = emit;
+         if(name == "if" || name == "ifdef" || name == "ifndef")
+         {
+            int value = EvaluateKeywordCondition(name, expression, keywords, mask);
+            if(value < 0)
+               frames.push_back({ false, emit, false, emit });
+            else
+            {
+               frames.push_back({ true, emit, value == 1, emit && value == 1 });
+               keepLine = false;
+            }
+         }
+         else if((name == "elif" || name == "else" || name == "endif") && !frames.empty())
+         {
+            Frame& frame = frames.back();
+            keepLine = frame.parentEmit && !frame.known;
+            if(name == "endif")
+               frames.pop_back();
+            else if(frame.known && name == "else")
+            {
+               frame.emit = frame.parentEmit && !frame.branchTaken;
+               frame.branchTaken = true;
+            }
+            else if(frame.known && frame.branchTaken)
+               frame.emit = false;
+            else if(frame.known)
+            {
+               int value = EvaluateKeywordCondition(name, expression, keywords, mask);
+               if(value >= 0)
+               {
+                  frame.branchTaken = value == 1;
+                  frame.emit = frame.parentEmit && value == 1;
+               }
+               else
+               {
+                  // every branch before was false, the rest of the chain becomes a plain #if
+                  frame.known = false;
+                  frame.emit = frame.parentEmit;
+                  if(frame.parentEmit)
+                  {
+                     out += "#if";
+                     out.append(expression.data(), expression.size());
+                  }
+                  keepLine = false;
+               }
+            }
+         }
+
+         if(keepLine)
+            out.append(line.data(), line.size());
+         out += '\n';
+      }
+   }
+
+   bool ContainsKeywordToken(const std::string& text, const std::string& keyword)
+   {
+      auto isIdentifier = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; };
+      for(size_t pos = text.find(keyword); pos != std::string::npos; pos = text.find(keyword, pos + 1))
+      {
+         size_t end = pos + keyword.size();
+         if((pos == 0 || !isIdentifier(text[pos - 1])) && (end == text.size() || !isIdentifier(text[end])))
+            return true;
+      }
+      return false;
+   }
+
+   ShaderVariants::ShaderVariants(const char* shaderPath, const std::vector<std::string>& keywords)
+      : m_Path(shaderPath), m_Keywords(keywords), m_VariantCount(0)
+   {
+      if(m_Keywords.size() > MAX_KEYWORDS)
+      {
+         std::cout << "ERROR: ShaderVariants supports up to " << MAX_KEYWORDS << " keywords, " << shaderPath << " has " << m_Keywords.size() << std::endl;
+         m_Keywords.resize(MAX_KEYWORDS);
+      }
+      ShaderSourceCache::Preprocess(shaderPath, m_Sources);
+   }
+
+   ShaderKeywordMask ShaderVariants::Keyword(const char* keyword) const
+   {
+      int32_t index = FindShaderKeyword(m_Keywords, keyword);
+      if(index < 0)
+      {
+         std::cout << "ERROR: Unknown shader keyword " << keyword << " in " << m_Path << std::endl;
+         return 0;
+      }
+      return (ShaderKeywordMask)1 << index;
+   }
+
+   ShaderKeywordMask ShaderVariants::Mask(std::initializer_list<const char*> keywords) const
+   {
+      ShaderKeywordMask mask = 0;
+      for(const char* keyword : keywords)
+         mask |= Keyword(keyword);
+      return mask;
+   }
+
+   int32_t ShaderVariants::FindVariant(ShaderKeywordMask mask) const
+   {
+      if(m_Table.empty())
+         return -1;
+
+      size_t tableMask = m_Table.size() - 1;
+      for(size_t i = (size_t)(mask * 0x9E3779B97F4A7C15ull >> 32) & tableMask;; i = (i + 1) & tableMask)
+      {
+         if(m_Table[i].program < 0)
+            return -1;
+         if(m_Table[i].mask == mask)
+            return m_Table[i].program;
+      }
+   }
+
+   void ShaderVariants::InsertVariant(ShaderKeywordMask mask, int32_t program)
+   {
+      // keep the load factor at or below 50%
+      if((m_VariantCount + 1) * 2 > m_Table.size())
+      {
+         std::vector<Slot> old = std::move(m_Table);
+         m_Table.assign(old.empty() ? 16 : old.size() * 2, Slot{ 0, -1 });
+         m_VariantCount = 0;
+         for(const Slot& slot : old)
+         {
+            if(slot.program >= 0)
+               InsertVariant(slot.mask, slot.program);
+         }
+      }
+
+      size_t tableMask = m_Table.size() - 1;
+      size_t i = (size_t)(mask * 0x9E3779B97F4A7C15ull >> 32) & tableMask;
+      while(m_Table[i].program >= 0)
+         i = (i + 1) & tableMask;
+      m_Table[i] = Slot{ mask, program };
+      m_VariantCount++;
+   }
+
+   void ShaderVariants::BuildVariantSources(ShaderKeywordMask mask, ShaderSources& out) const
+   {
+      out.fileLegend = m_Sources.fileLegend;
+      for(int stage = 0; stage < ShaderSources::STAGE_COUNT; stage++)
+      {
+         const std::string& source = m_Sources.stages[stage];
+         if(source.empty())
+            continue;
+
+         std::string resolved;
+         ResolveKeywordConditionals(source, m_Keywords, mask, resolved);
+
+         // only keywords the remaining source still mentions are defined
+         std::string defines;
+         for(size_t i = 0; i < m_Keywords.size(); i++)
+         {
+            if((mask & ((ShaderKeywordMask)1 << i)) != 0 && ContainsKeywordToken(resolved, m_Keywords[i]))
+               defines += "#define " + m_Keywords[i] + " 1\n";
+         }
+
+         // defines have to follow #version, the #line directive after it keeps line numbers right
+         size_t insert = 0;
+         size_t pos = 0;
+         while(pos < resolved.size())
+         {
+            std::string_view line = NextShaderLine(resolved, pos);
+            if(StartsWithDirective(TrimShaderLine(line), "#version"))
+            {
+               insert = std::min(pos, resolved.size());
+               break;
+            }
+         }
+         if(!defines.empty() && insert > 0 && resolved[insert - 1] != '\n')
+            defines.insert(0, 1, '\n');
+         resolved.insert(insert, defines);
+
+         out.stages[stage] = std::move(resolved);
+      }
+   }
+
+   int32_t ShaderVariants::SubmitVariant(ShaderKeywordMask mask, bool& submitted)
+   {
+      submitted = false;
+
+      ShaderSources sources;
+      BuildVariantSources(mask, sources);
+
+      uint64_t hash = HashShaderSources(sources);
+
+      auto it = m_ProgramsBySource.find(hash);
+      if(it != m_ProgramsBySource.end())
+         return it->second;
+
+      std::string name = m_Path + " [";
+      for(size_t i = 0; i < m_Keywords.size(); i++)
+      {
+         if((mask & ((ShaderKeywordMask)1 << i)) != 0)
+            name += " " + m_Keywords[i];
+      }
+      name += " ]";
+
+      int32_t program = (int32_t)m_Programs.size();
+      m_Programs.push_back(std::make_unique<Shader>());
+      m_ProgramsBySource[hash] = program;
+      m_Programs.back()->BeginLoadSources(sources, name.c_str());
+      submitted = true;
+      return program;
+   }
+
+   Shader& ShaderVariants::Get(ShaderKeywordMask mask)
+   {
+      if(m_Keywords.size() < MAX_KEYWORDS)
+         mask &= ((ShaderKeywordMask)1 << m_Keywords.size()) - 1;
+
+      int32_t program = FindVariant(mask);
+      if(program >= 0)
+         return *m_Programs[program];
+
+      // throws if the variant fails to compile
+      Prewarm(std::vector<ShaderKeywordMask>{ mask });
+      return *m_Programs[FindVariant(mask)];
+   }
+
+   void ShaderVariants::Prewarm(const std::vector<ShaderKeywordMask>& masks)
+   {
+      struct Pending
+      {
+         ShaderKeywordMask mask;
+         int32_t program;
+         bool submitted;
+      };
+      std::vector<Pending> pending;
+
+      for(ShaderKeywordMask mask : masks)
+      {
+         if(m_Keywords.size() < MAX_KEYWORDS)
+            mask &= ((ShaderKeywordMask)1 << m_Keywords.size()) - 1;
+         if(FindVariant(mask) >= 0)
+            continue;
+
+         bool submitted = false;
+         int32_t program = SubmitVariant(mask, submitted);
+         pending.push_back({ mask, program, submitted });
+      }
+
+      // every link is submitted before the first status check so drivers can compile them in parallel
+      std::string error;
+      for(const Pending& variant : pending)
+      {
+         if(!variant.submitted)
+            continue;
+         try
+         {
+            m_Programs[variant.program]->FinishLoad();
+         }
+         catch(const std::exception& e)
+         {
+            // dropped so the next Get() compiles it again
+            for(auto it = m_ProgramsBySource.begin(); it != m_ProgramsBySource.end(); ++it)
+            {
+               if(it->second == variant.program)
+               {
+                  m_ProgramsBySource.erase(it);
+                  break;
+               }
+            }
+            m_Programs[variant.program].reset();
+            error = e.what();
+         }
+      }
+
+      for(const Pending& variant : pending)
+      {
+         if(m_Programs[variant.program] != nullptr && FindVariant(variant.mask) < 0)
+            InsertVariant(variant.mask, variant.program);
+      }
+
+      if(!error.empty())
+         throw std::runtime_error(error);
+   }
+
+   void ShaderVariants::Prewarm(const char* manifestPath)
+   {
+      std::ifstream manifest(manifestPath);
+      if(!manifest)
+      {
+         std::cout << "ERROR: Failed to open shader variant manifest " << manifestPath << std::endl;
+         return;
+      }
+
+      std::vector<ShaderKeywordMask> masks;
+      std::string line;
+      while(std::getline(manifest, line))
+      {
+         line = line.substr(0, line.find('#'));
+         std::istringstream keywords(line);
+         std::string keyword;
+         ShaderKeywordMask mask = 0;
+         bool empty = true;
+         while(keywords >> keyword)
+         {
+            empty = false;
+            if(keyword != "-")
+               mask |= Keyword(keyword.c_str());
+         }
+         if(!empty)
+            masks.push_back(mask);
+      }
+      Prewarm(masks);
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/ShaderVariants.cpp end --*/
+/*-- File: src/StreamBuffer.cpp start --*/
+/*-- #include "src/StreamBuffer.hpp" start --*/
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <glad/glad.h>
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+#include <vector>
+
+namespace EaseGL
+{
+	struct StreamAllocation
+	{
+		void* pointer = nullptr; // CPU pointer, write only
+		GLintptr offset = 0;     // offset inside the GL buffer
+		GLsizeiptr size = 0;
+
+		operator bool() const { return pointer != nullptr; }
+	};
+
+	/**
+	 * @brief Persistently mapped buffer that is split into 'regionCount' frame regions.
+	 * Each frame allocates from one region, regions are fenced at EndFrame() and
+	 * BeginFrame() only waits if the GPU is still reading the region that is about to be reused.
+	 * 
+	 * StreamBuffer stream(GLBufferType::ARRAY_BUFFER, 4 * 1024 * 1024);
+	 * 
+	 * stream.BeginFrame();
+	 * StreamAllocation vertices = stream.Allocate(sizeof(Vertex) * count, sizeof(Vertex));
+	 * memcpy(vertices.pointer, data, vertices.size);
+	 * glDrawArrays(GL_TRIANGLES, vertices.offset / sizeof(Vertex), count);
+	 * stream.EndFrame();
+	 * 
+	 * Requires OpenGL 4.4 or GL_ARB_buffer_storage. IsMapped() is false if that is missing or the
+	 * region size or count is zero, the frame calls do nothing then and Allocate() returns empty allocations
+	 */
+	class StreamBuffer  
+	{
+		private:
+			GLBuffer m_Buffer;
+			unsigned char* m_MappedPointer;
+
+			GLsizeiptr m_RegionSize;
+			uint32_t m_RegionCount;
+			uint32_t m_CurrentRegion;
+			GLsizeiptr m_RegionHead; // bump allocation offset inside current region
+
+			std::vector<GLsync> m_RegionFences;
+
+			uint64_t m_StallCount;
+
+			void WaitRegion(uint32_t region);
+		public:
+			StreamBuffer(GLBufferType bufferType, GLsizeiptr regionSize, uint32_t regionCount = 3);
+			~StreamBuffer();
+
+			StreamBuffer(const StreamBuffer&) = delete;
+			StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+			/**
+			 * @brief Waits until GPU is done with the current region, call before the first Allocate() of the frame
+			 */
+			void BeginFrame();
+			/**
+			 * @brief Fences the current region and moves to the next one, call after the last draw that uses this frame's allocations
+			 */
+			void EndFrame();
+
+			/**
+			 * @brief Bump allocates from current region, returns empty allocation if the region is full
+			 * 
+			 * @param alignment doesn't have to be a power of two, vertex stride can be used to get a valid base vertex
+			 */
+			StreamAllocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+
+			void Bind() const;
+			void BindRange(GLuint bufferIndex, const StreamAllocation& allocation);
+
+			bool IsMapped() const { return m_MappedPointer != nullptr; }
+			GLsizeiptr RegionSize() const { return m_RegionSize; }
+			GLsizeiptr RegionUsed() const { return m_RegionHead; }
+			// Count of BeginFrame() calls that had to wait for the GPU
+			uint64_t StallCount() const { return m_StallCount; }
+
+			GLBuffer& Buffer() { return m_Buffer; }
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/StreamBuffer.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <iostream>
+
+/*-- #include "src/GLContext.hpp" start --*/
+/*-- #include "src/GLContext.hpp" end --*/
+
+namespace EaseGL
+{
+   StreamBuffer::StreamBuffer(GLBufferType bufferType, GLsizeiptr regionSize, uint32_t regionCount /* = 3*/)
+      : m_Buffer(bufferType), m_MappedPointer(nullptr), m_RegionSize(regionSize), m_RegionCount(regionCount),
+      m_CurrentRegion(0), m_RegionHead(0), m_RegionFences(regionCount, nullptr), m_StallCount(0)
+   {
+      if(regionSize <= 0 || regionCount == 0)
+      {
+         std::cout << "ERROR: StreamBuffer needs at least one region of at least one byte, got "
+            << regionCount << " regions of " << regionSize << " bytes" << std::endl;
+         return;
+      }
+
+      if(!GLContext::HasVersion(4, 4) && !GLContext::HasExtension("GL_ARB_buffer_storage"))
+      {
+         std::cout << "ERROR: StreamBuffer requires OpenGL 4.4 or GL_ARB_buffer_storage" << std::endl;
+         return;
+      }
+
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      m_Buffer.BufferStorage(nullptr, m_RegionSize * m_RegionCount, flags);
+      m_MappedPointer = (unsigned char*)m_Buffer.MapBufferRange(0, m_RegionSize * m_RegionCount, flags);
+
+      if(m_MappedPointer == nullptr)
+         std::cout << "ERROR: StreamBuffer failed to map " << m_RegionSize * m_RegionCount << " bytes" << std::endl;
+   }
+
+   StreamBuffer::~StreamBuffer()
+   {
+      for(GLsync fence : m_RegionFences)
+      {
+         if(fence != nullptr)
+            glDeleteSync(fence);
+      }
+
+      if(m_MappedPointer != nullptr)
+      {
+         m_Buffer.Bind();
+         m_Buffer.UnmapBuffer();
+      }
+   }
+
+   void StreamBuffer::WaitRegion(uint32_t region)
+   {
+      GLsync& fence = m_RegionFences[region];
+      if(fence == nullptr)
+         return;
+
+      GLenum result = glClientWaitSync(fence, 0, 0);
+      if(result == GL_TIMEOUT_EXPIRED)
+      {
+         m_StallCount++;
+         // flush once so the fence is guaranteed to be signaled eventually
+         GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+         do
+         {
+            result = glClientWaitSync(fence, waitFlags, 1000000); // 1ms
+            waitFlags = 0;
+         } while(result == GL_TIMEOUT_EXPIRED);
+      }
+
+      if(result == GL_WAIT_FAILED)
+         std::cout << "ERROR: StreamBuffer fence wait failed" << std::endl;
+
+      glDeleteSync(fence);
+      fence = nullptr;
+   }
+
+   void StreamBuffer::BeginFrame()
+   {
+      if(m_MappedPointer == nullptr)
+         return;
+
+      WaitRegion(m_CurrentRegion);
+      m_RegionHead = 0;
+   }
+
+   void StreamBuffer::EndFrame()
+   {
+      if(m_MappedPointer == nullptr)
+         return;
+
+      if(m_RegionFences[m_CurrentRegion] != nullptr)
+         glDeleteSync(m_RegionFences[m_CurrentRegion]);
+      m_RegionFences[m_CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+      m_CurrentRegion = (m_CurrentRegion + 1) % m_RegionCount;
+      m_RegionHead = 0;
+   }
+
+   StreamAllocation StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment /* = 4*/)
+   {
+      StreamAllocation allocation;
+      if(m_MappedPointer == nullptr || size <= 0)
+         return allocation;
+
+      if(alignment <= 0)
+         alignment = 1;
+
+      // align the absolute offset, region base isn't necessarily a multiple of 'alignment'
+      GLintptr regionBase = (GLintptr)m_CurrentRegion * m_RegionSize;
+      GLintptr offset = regionBase + m_RegionHead;
+      offset = ((offset + alignment - 1) / alignment) * alignment;
+
+      if(offset + size > regionBase + m_RegionSize)
+      {
+         std::cout << "ERROR: StreamBuffer region is full, requested " << size << " bytes, "
+            << m_RegionSize - m_RegionHead << " left" << std::endl;
+         return allocation;
+      }
+
+      m_RegionHead = offset + size - regionBase;
+
+      allocation.pointer = m_MappedPointer + offset;
+      allocation.offset = offset;
+      allocation.size = size;
+      return allocation;
+   }
+
+   void StreamBuffer::Bind() const
+   {
+      m_Buffer.Bind();
+   }
+
+   void StreamBuffer::BindRange(GLuint bufferIndex, const StreamAllocation& allocation)
+   {
+      m_Buffer.BindBufferRange(bufferIndex, allocation.offset, allocation.size);
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/StreamBuffer.cpp end --*/
+/*-- File: src/Texture.cpp start --*/
+/*-- #include "src/Texture.hpp" start --*/
+/*-- #include "src/Texture.hpp" end --*/
+#ifdef EASEGL_IMPLEMENTATION
+
+namespace EaseGL
+{
+   
+} // namespace EaseGL
+
+#endif
+/*-- File: src/Texture.cpp end --*/
+/*-- File: src/TextureAtlas.cpp start --*/
+/*-- #include "src/TextureAtlas.hpp" start --*/
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <glad/glad.h>
+/*-- #include "src/GLTexture.hpp" start --*/
+/*-- #include "src/GLTexture.hpp" end --*/
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace EaseGL
+{
+	struct AtlasRegion
+	{
+		std::string name;
+		uint32_t page = 0;
+		int x = 0, y = 0;          // in pixels, padding excluded
+		int width = 0, height = 0;
+
+		// uv in the image's own 0..1 space -> uv in the page
+		glm::vec2 uvOffset = glm::vec2(0.0f);
+		glm::vec2 uvScale = glm::vec2(1.0f);
+
+		glm::vec2 TransformUV(glm::vec2 uv) const { return uvOffset + uv * uvScale; }
+	};
+
+	/**
+	 * @brief Packs many images into a few RGBA8 pages so sprites can be batched with one texture bound.
+	 * Images are placed with a bottom-left skyline packer, each surrounded by 'padding' pixels that repeat
+	 * its edge pixels so filtering and lower mip levels don't bleed neighbours in.
+	 *
+	 * TextureAtlas atlas(2048, 2048, 2);
+	 * atlas.LoadLayout("sprites.atlas");      // optional, reuses last run's placement
+	 * atlas.InsertFiles({ "a.png", "b.png" }); // packed tallest first
+	 * atlas.GenerateMipmaps();
+	 * atlas.SaveLayout("sprites.atlas");
+	 *
+	 * const AtlasRegion* region = atlas.Find("a.png");
+	 * atlas.GetPage(region->page).Bind();
+	 * uv = region->TransformUV(uv);
+	 *
+	 * Images can be inserted at any time, pages are added when the current ones are full.
+	 */
+	class TextureAtlas
+	{
+		private:
+			struct SkylineNode
+			{
+				int x, y, width;
+			};
+
+			struct Page
+			{
+				GLTexture texture;
+				std::vector<SkylineNode> skyline;
+				bool dirty = false;
+			};
+
+			// every packed rectangle in packing order, replaying them rebuilds the skylines exactly
+			struct Placement
+			{
+				std::string name; // empty once the image moved to another placement
+				uint32_t page;
+				int x, y, width, height;
+			};
+
+			int m_PageWidth, m_PageHeight;
+			int m_Padding;
+			std::vector<Page> m_Pages;
+			std::vector<AtlasRegion> m_Regions;
+			std::unordered_map<std::string, int32_t> m_RegionsByName;
+
+			std::vector<Placement> m_Placements;
+			std::unordered_map<std::string, size_t> m_PlacementsByName;
+
+			void AddPage();
+			int FitSkyline(const Page& page, size_t index, int width, int height) const;
+			bool FindPosition(const Page& page, int width, int height, int& x, int& y) const;
+			void AddSkylineLevel(Page& page, int x, int y, int width, int height);
+			// false if it doesn't fit in an empty page
+			bool PackPlacement(const std::string& name, int width, int height, Placement& placement);
+			void UploadRegion(const AtlasRegion& region, int channels, const unsigned char* pixels);
+		public:
+			TextureAtlas(int pageWidth = 2048, int pageHeight = 2048, int padding = 2);
+
+			TextureAtlas(const TextureAtlas&) = delete;
+			TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+			/**
+			 * @brief Packs and uploads one image with 1-4 channels (expanded like glTexImage2D would).
+			 * @return region index, -1 if it doesn't fit in an empty page. Inserting an existing name replaces its pixels
+			 */
+			int32_t Insert(const std::string& name, int width, int height, int channels, const unsigned char* pixels);
+			/** @brief Decodes with stb_image, the path is the region name */
+			int32_t InsertFile(const char* filepath);
+			/** @brief Decodes all files first and packs them tallest first, which packs tighter than one by one */
+			void InsertFiles(const std::vector<std::string>& filepaths);
+
+			const AtlasRegion* Find(const std::string& name) const;
+			const AtlasRegion& GetRegion(int32_t index) const { return m_Regions[index]; }
+			size_t RegionCount() const { return m_Regions.size(); }
+
+			GLTexture& GetPage(uint32_t page) { return m_Pages[page].texture; }
+			size_t PageCount() const { return m_Pages.size(); }
+
+			/** @brief Regenerates the mipmaps of pages changed since the last call */
+			void GenerateMipmaps();
+
+			/** @brief Writes page size, padding and every placement in insertion order */
+			bool SaveLayout(const char* filepath) const;
+			/**
+			 * @brief Reads a layout written by SaveLayout(). Images inserted afterwards with a stored name and size
+			 * are placed where they were without packing. Has to be called before anything is inserted.
+			 * A file for other page settings, or with placements outside the pages, is rejected as a whole
+			 */
+			bool LoadLayout(const char* filepath);
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/TextureAtlas.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#ifdef STB_IMAGE_IMPLEMENTATION
+   #undef STB_IMAGE_IMPLEMENTATION
+   #include <stb/stb_image.h>
+   #define STB_IMAGE_IMPLEMENTATION
+#else
+   #include <stb/stb_image.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace EaseGL
+{
+   TextureAtlas::TextureAtlas(int pageWidth /* = 2048*/, int pageHeight /* = 2048*/, int padding /* = 2*/)
+      : m_PageWidth(pageWidth), m_PageHeight(pageHeight), m_Padding(padding)
+   {
+   }
+
+   void TextureAtlas::AddPage()
+   {
+      m_Pages.emplace_back();
+      Page& page = m_Pages.back();
+      page.texture.Upload(m_PageWidth, m_PageHeight, 4, nullptr);
+      page.skyline.push_back({ 0, 0, m_PageWidth });
+   }
+
+   // y the rectangle would sit at when its left edge is at skyline node 'index', -1 if it doesn't fit
+   int TextureAtlas::FitSkyline(const Page& page, size_t index, int width, int height) const
+   {
+      int x = page.skyline[index].x;
+      if(x + width > m_PageWidth)
+         return -1;
+
+      int y = 0;
+      int widthLeft = width;
+      for(size_t i = index; widthLeft > 0; i++)
+      {
+         y = std::max(y, page.skyline[i].y);
+         if(y + height > m_PageHeight)
+            return -1;
+         widthLeft -= page.skyline[i].width;
+      }
+      return y;
+   }
+
+   bool TextureAtlas::FindPosition(const Page& page, int width, int height, int& x, int& y) const
+   {
+      // bottom-left: lowest top edge, then leftmost
+      int bestTop = m_PageHeight + 1;
+      for(size_t i = 0; i < page.skyline.size(); i++)
+      {
+         int fitY = FitSkyline(page, i, width, height);
+         if(fitY >= 0 && fitY + height < bestTop)
+         {
+            bestTop = fitY + height;
+            x = page.skyline[i].x;
+            y = fitY;
+         }
+      }
+      return bestTop <= m_PageHeight;
+   }
+
+   void TextureAtlas::AddSkylineLevel(Page& page, int x, int y, int width, int height)
+   {
+      std::vector<SkylineNode>& skyline = page.skyline;
+      int top = y + height;
+      int end = x + width;
+
+      size_t i = 0;
+      while(i < skyline.size() && skyline[i].x + skyline[i].width <= x)
+         i++;
+      if(i < skyline.size() && skyline[i].x < x)
+      {
+         SkylineNode left = { skyline[i].x, skyline[i].y, x - skyline[i].x };
+         skyline[i].x = x;
+         skyline[i].width -= left.width;
+         skyline.insert(skyline.begin() + i, left);
+         i++;
+      }
+
+      // nodes under the new level are replaced, the level never drops below them
+      while(i < skyline.size() && skyline[i].x < end)
+      {
+         top = std::max(top, skyline[i].y);
+         if(skyline[i].x + skyline[i].width <= end)
+            skyline.erase(skyline.begin() + i);
+         else
+         {
+            skyline[i].width -= end - skyline[i].x;
+            skyline[i].x = end;
+            break;
+         }
+      }
+      skyline.insert(skyline.begin() + i, { x, top, width });
+
+      for(size_t j = 1; j < skyline.size();)
+      {
+         if(skyline[j - 1].y == skyline[j].y)
+         {
+            skyline[j - 1].width += skyline[j].width;
+            skyline.erase(skyline.begin() + j);
+         }
+         else
+            j++;
+      }
+   }
+
+   bool TextureAtlas::PackPlacement(const std::string& name, int width, int height, Placement& placement)
+   {
+      int packedWidth = width + m_Padding * 2;
+      int packedHeight = height + m_Padding * 2;
+      if(packedWidth > m_PageWidth || packedHeight > m_PageHeight)
+         return false;
+
+      int x = 0, y = 0;
+      uint32_t pageIndex = 0;
+      while(pageIndex < m_Pages.size() && !FindPosition(m_Pages[pageIndex], packedWidth, packedHeight, x, y))
+         pageIndex++;
+      if(pageIndex == m_Pages.size())
+      {
+         AddPage();
+         x = 0;
+         y = 0;
+      }
+
+      AddSkylineLevel(m_Pages[pageIndex], x, y, packedWidth, packedHeight);
+      placement = { name, pageIndex, x + m_Padding, y + m_Padding, width, height };
+      return true;
+   }
+
+   void TextureAtlas::UploadRegion(const AtlasRegion& region, int channels, const unsigned char* pixels)
+   {
+      int packedWidth = region.width + m_Padding * 2;
+      int packedHeight = region.height + m_Padding * 2;
+
+      // RGBA with the padding filled by clamping to the nearest edge pixel
+      std::vector<unsigned char> extruded((size_t)packedWidth * packedHeight * 4);
+      for(int dy = 0; dy < packedHeight; dy++)
+      {
+         int sy = std::min(std::max(dy - m_Padding, 0), region.height - 1);
+         for(int dx = 0; dx < packedWidth; dx++)
+         {
+            int sx = std::min(std::max(dx - m_Padding, 0), region.width - 1);
+            const unsigned char* src = pixels + ((size_t)sy * region.width + sx) * channels;
+            unsigned char* dst = &extruded[((size_t)dy * packedWidth + dx) * 4];
+            // same expansion as glTexImage2D with GL_RED/GL_RG/GL_RGB
+            dst[0] = src[0];
+            dst[1] = channels >= 2 ? src[1] : 0;
+            dst[2] = channels >= 3 ? src[2] : 0;
+            dst[3] = channels == 4 ? src[3] : 255;
+         }
+      }
+
+      Page& page = m_Pages[region.page];
+      page.texture.SubImage(region.x - m_Padding, region.y - m_Padding, packedWidth, packedHeight, 4, extruded.data());
+      page.dirty = true;
+   }
+
+   int32_t TextureAtlas::Insert(const std::string& name, int width, int height, int channels, const unsigned char* pixels)
+   {
+      if(width <= 0 || height <= 0 || channels < 1 || channels > 4 || pixels == nullptr)
+      {
+         std::cout << "ERROR: Invalid image for texture atlas " << name << std::endl;
+         return -1;
+      }
+
+      // reuse the stored placement if the image still has the same size
+      auto stored = m_PlacementsByName.find(name);
+      size_t placementIndex = stored != m_PlacementsByName.end() ? stored->second : m_Placements.size();
+      if(placementIndex == m_Placements.size()
+         || m_Placements[placementIndex].width != width || m_Placements[placementIndex].height != height)
+      {
+         Placement placement;
+         if(!PackPlacement(name, width, height, placement))
+         {
+            std::cout << "ERROR: " << name << " (" << width << "x" << height << ") doesn't fit in a "
+               << m_PageWidth << "x" << m_PageHeight << " atlas page" << std::endl;
+            return -1;
+         }
+         if(stored != m_PlacementsByName.end())
+            m_Placements[stored->second].name.clear();
+         placementIndex = m_Placements.size();
+         m_Placements.push_back(placement);
+         m_PlacementsByName[name] = placementIndex;
+      }
+
+      int32_t index;
+      auto existing = m_RegionsByName.find(name);
+      if(existing != m_RegionsByName.end())
+         index = existing->second;
+      else
+      {
+         index = (int32_t)m_Regions.size();
+         m_Regions.emplace_back();
+         m_RegionsByName[name] = index;
+      }
+
+      const Placement& placement = m_Placements[placementIndex];
+      AtlasRegion& region = m_Regions[index];
+      region.name = name;
+      region.page = placement.page;
+      region.x = placement.x;
+      region.y = placement.y;
+      region.width = placement.width;
+      region.height = placement.height;
+      region.uvOffset = glm::vec2((float)placement.x / m_PageWidth, (float)placement.y / m_PageHeight);
+      region.uvScale = glm::vec2((float)placement.width / m_PageWidth, (float)placement.height / m_PageHeight);
+
+      UploadRegion(region, channels, pixels);
+      return index;
+   }
+
+   int32_t TextureAtlas::InsertFile(const char* filepath)
+   {
+      int width, height, channels;
+      unsigned char* pixels = stbi_load(filepath, &width, &height, &channels, 0);
+      if(pixels == NULL)
+      {
+         std::cout << "ERROR on loading Texture " << filepath << std::endl;
+         return -1;
+      }
+
+      int32_t index = Insert(filepath, width, height, channels, pixels);
+      stbi_image_free(pixels);
+      return index;
+   }
+
+   void TextureAtlas::InsertFiles(const std::vector<std::string>& filepaths)
+   {
+      struct Image
+      {
+         const std::string* path;
+         unsigned char* pixels;
+         int width, height, channels;
+      };
+      std::vector<Image> images;
+      images.reserve(filepaths.size());
+
+      for(const std::string& path : filepaths)
+      {
+         Image image = { &path, nullptr, 0, 0, 0 };
+         image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+         if(image.pixels == NULL)
+         {
+            std::cout << "ERROR on loading Texture " << path << std::endl;
+            continue;
+         }
+         images.push_back(image);
+      }
+
+      std::stable_sort(images.begin(), images.end(), [](const Image& a, const Image& b) { return a.height > b.height; });
+      for(Image& image : images)
+      {
+         Insert(*image.path, image.width, image.height, image.channels, image.pixels);
+         stbi_image_free(image.pixels);
+      }
+   }
+
+   const AtlasRegion* TextureAtlas::Find(const std::string& name) const
+   {
+      auto it = m_RegionsByName.find(name);
+      return it != m_RegionsByName.end() ? &m_Regions[it->second] : nullptr;
+   }
+
+   void TextureAtlas::GenerateMipmaps()
+   {
+      for(Page& page : m_Pages)
+      {
+         if(!page.dirty)
+            continue;
+         page.texture.GenerateMipmaps();
+         page.dirty = false;
+      }
+   }
+
+   bool TextureAtlas::SaveLayout(const char* filepath) const
+   {
+      std::ofstream file(filepath, std::ios::trunc);
+      if(!file)
+      {
+         std::cout << "ERROR: Failed to write atlas layout " << filepath << std::endl;
+         return false;
+      }
+
+      file << "easegl-atlas 1\n";
+      file << m_PageWidth << ' ' << m_PageHeight << ' ' << m_Padding << ' ' << m_Placements.size() << '\n';
+      // the name goes last so it can contain spaces
+      for(const Placement& placement : m_Placements)
+         file << placement.page << ' ' << placement.x << ' ' << placement.y << ' ' << placement.width << ' ' << placement.height << ' ' << placement.name << '\n';
+      return (bool)file;
+   }
+
+   bool TextureAtlas::LoadLayout(const char* filepath)
+   {
+      if(!m_Placements.empty())
+      {
+         std::cout << "ERROR: TextureAtlas::LoadLayout has to be called before inserting images" << std::endl;
+         return false;
+      }
+
+      std::ifstream file(filepath);
+      std::string magic;
+      int version = 0, pageWidth = 0, pageHeight = 0, padding = 0;
+      size_t count = 0;
+      if(!(file >> magic >> version >> pageWidth >> pageHeight >> padding >> count) || magic != "easegl-atlas" || version != 1)
+         return false;
+
+      // a layout for other page settings would have to be packed again anyway
+      if(pageWidth != m_PageWidth || pageHeight != m_PageHeight || padding != m_Padding)
+         return false;
+
+      // every placement takes at least "0 0 0 0 0\n", a count the rest of the file can't hold is corrupt
+      std::streamoff dataStart = file.tellg();
+      file.seekg(0, std::ios::end);
+      std::streamoff remaining = file.tellg() - dataStart;
+      file.seekg(dataStart);
+      if(remaining < 0 || count > (size_t)remaining / 10)
+         return false;
+
+      // nothing is applied until the whole file checked out
+      std::vector<Placement> placements(count);
+      size_t pageCount = m_Pages.size();
+      for(Placement& placement : placements)
+      {
+         if(!(file >> placement.page >> placement.x >> placement.y >> placement.width >> placement.height))
+            return false;
+         std::getline(file, placement.name);
+         if(!placement.name.empty() && placement.name[0] == ' ')
+            placement.name.erase(0, 1);
+
+         // pages are filled in order, a layout can't skip ahead
+         if(placement.page > pageCount)
+            return false;
+         if(placement.page == pageCount)
+            pageCount++;
+
+         // the padded rectangle has to lie inside the page
+         int64_t left = (int64_t)placement.x - m_Padding, top = (int64_t)placement.y - m_Padding;
+         int64_t right = (int64_t)placement.x + placement.width + m_Padding, bottom = (int64_t)placement.y + placement.height + m_Padding;
+         if(placement.width <= 0 || placement.height <= 0 || left < 0 || top < 0 || right > m_PageWidth || bottom > m_PageHeight)
+            return false;
+      }
+
+      for(size_t i = 0; i < placements.size(); i++)
+      {
+         const Placement& placement = placements[i];
+         while(m_Pages.size() <= placement.page)
+            AddPage();
+         AddSkylineLevel(m_Pages[placement.page], placement.x - m_Padding, placement.y - m_Padding,
+            placement.width + m_Padding * 2, placement.height + m_Padding * 2);
+         if(!placement.name.empty())
+            m_PlacementsByName[placement.name] = i;
+      }
+      m_Placements = std::move(placements);
+      return true;
+   }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/TextureAtlas.cpp end --*/
+/*-- File: src/TextureLoader.cpp start --*/
+/*-- #include "src/TextureLoader.hpp" start --*/
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <glad/glad.h>
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
 /*-- #include "src/GLTexture.hpp" start --*/
 /*-- #include "src/GLTexture.hpp" end --*/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
-#ifdef EASEGL_IMPLEMENTATION
+namespace EaseGL
+{
+	struct TextureLoaderStats
+	{
+		uint32_t requested = 0;
+		uint32_t uploaded = 0;
+		uint32_t failed = 0;
+		uint32_t pboStalls = 0;     // Update() calls that stopped early because the next PBO was still in use
+		uint32_t directUploads = 0; // images larger than a PBO, uploaded from client memory
+	};
+
+	/**
+	 * @brief Decodes image files on worker threads and uploads them on the GL thread under a time budget.
+	 * Load() returns a texture holding a 1x1 placeholder right away, the same GLTexture is
+	 * respecified with the real image once it is uploaded, so it can be bound and drawn at any time
+	 * (with immutable storage that swaps the GL name underneath, don't keep the raw GLuint).
+	 *
+	 * EaseGL::TextureLoader loader;
+	 * std::shared_ptr<EaseGL::GLTexture> albedo = loader.Load("albedo.png");
+	 * while(running)
+	 * {
+	 *    loader.Update(2.0); // at most ~2ms of uploads per frame
+	 *    albedo->Bind();
+	 *    ...
+	 * }
+	 *
+	 * Workers also expand RGB images to RGBA (see PixelConvert), so rows are 4 byte aligned and the
+	 * driver doesn't repack them on the GL thread. They build mip chains too when TextureCreateInfo::mipFilter is set.
+	 * Decoded images are copied into a ring of pixel unpack buffers and uploaded from there, each PBO is
+	 * fenced when the ring moves past it and only reused once the GPU has read it.
+	 * Everything except the worker threads must be called from the GL thread.
+	 */
+	class TextureLoader
+	{
+		private:
+			struct Job
+			{
+				std::string path;
+				std::weak_ptr<GLTexture> texture;
+				TextureCreateInfo createInfo;
+			};
+
+			struct DecodedImage
+			{
+				std::weak_ptr<GLTexture> texture;
+				unsigned char* pixels; // from stb_image
+				std::vector<unsigned char> converted; // replaces 'pixels' when not empty
+				int width, height, channels;
+				MipChain mips; // every level, built on the worker when TextureCreateInfo::mipFilter asks for it
+
+				const unsigned char* Data() const { return !mips.data.empty() ? mips.data.data() : converted.empty() ? pixels : converted.data(); }
+				size_t Size() const { return !mips.data.empty() ? mips.data.size() : (size_t)width * height * channels; }
+			};
+
+			std::vector<std::thread> m_Workers;
+			std::mutex m_Mutex;
+			std::condition_variable m_JobAvailable;
+			std::deque<Job> m_Jobs;
+			std::deque<DecodedImage> m_Decoded;
+			std::atomic<uint32_t> m_InFlight; // queued or decoding or waiting for upload
+			std::atomic<bool> m_PremultiplyAlpha;
+			bool m_Stop;
+
+			// GL thread only
+			std::deque<DecodedImage> m_Uploads;
+			std::vector<GLBuffer> m_Pbos;
+			std::vector<GLsync> m_PboFences;
+			GLsizeiptr m_PboSize;
+			GLintptr m_PboHead;
+			size_t m_PboIndex;
+
+			unsigned char m_Placeholder[4];
+			TextureLoaderStats m_Stats;
+
+			void WorkerLoop();
+			// runs on the workers, brings 'image' into the layout that is uploaded
+			void ConvertImage(DecodedImage& image, const TextureCreateInfo& createInfo);
+			// false if the image has to wait for a PBO
+			bool UploadImage(const DecodedImage& image, GLTexture& texture);
+		public:
+			/**
+			 * @param workerCount decoding threads, 0 uses one less than the hardware threads
+			 * @param pboCount, pboSize ring of pixel unpack buffers, images larger than 'pboSize' are uploaded directly.
+			 *        With a single PBO every wrap waits until the GPU has read it, 0 uploads everything directly
+			 */
+			TextureLoader(uint32_t workerCount = 0, uint32_t pboCount = 3, GLsizeiptr pboSize = 16 * 1024 * 1024);
+			~TextureLoader();
+
+			TextureLoader(const TextureLoader&) = delete;
+			TextureLoader& operator=(const TextureLoader&) = delete;
+
+			/** @brief Queues 'filepath' for decoding, the returned texture shows the placeholder until it is uploaded */
+			std::shared_ptr<GLTexture> Load(const char* filepath);
+			/**
+			 * @brief Same with storage options for the texture. With a TextureCreateInfo::mipFilter the mip chain is
+			 * built on the worker too, images are decoded to 8 bits so 16F formats are not supported
+			 */
+			std::shared_ptr<GLTexture> Load(const char* filepath, const TextureCreateInfo& createInfo);
+
+			/**
+			 * @brief Uploads decoded images until 'budgetMilliseconds' is used up, at least one per call.
+			 * Call once per frame on the GL thread
+			 */
+			void Update(double budgetMilliseconds);
+
+			/** @brief Blocks until every queued texture is uploaded */
+			void Finish();
+
+			// textures that are not uploaded yet
+			uint32_t PendingCount() const { return m_InFlight.load(); }
+			uint32_t WorkerCount() const { return (uint32_t)m_Workers.size(); }
 
+			/** @brief Premultiplies color by alpha on the workers, for images decoded after the call */
+			void SetPremultiplyAlpha(bool enabled) { m_PremultiplyAlpha = enabled; }
+
+			/** @brief Color of textures that are still loading, and of the ones that failed */
+			void SetPlaceholderColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+
+			const TextureLoaderStats& GetStats() const { return m_Stats; }
+	};
+} // namespace EaseGL
+
+#endif
+
+/*-- #include "src/TextureLoader.hpp" end --*/
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
 
 #ifdef STB_IMAGE_IMPLEMENTATION
    #undef STB_IMAGE_IMPLEMENTATION
@@ -556,411 +8341,912 @@ namespace EaseGL
    #include <stb/stb_image.h>
 #endif
 
+/*-- #include "src/PixelConvert.hpp" start --*/
+/*-- #include "src/PixelConvert.hpp" end --*/
+
+#include <chrono>
+#include <cstring>
 #include <iostream>
 
 namespace EaseGL
 {
-   GLTexture::~GLTexture()
+   TextureLoader::TextureLoader(uint32_t workerCount /* = 0*/, uint32_t pboCount /* = 3*/, GLsizeiptr pboSize /* = 16 * 1024 * 1024*/)
+      : m_InFlight(0), m_PremultiplyAlpha(false), m_Stop(false), m_PboSize(pboSize), m_PboHead(0), m_PboIndex(0)
    {
+      SetPlaceholderColor(128, 128, 128, 255);
+
+      for(uint32_t i = 0; i < pboCount && pboSize > 0; i++)
+      {
+         m_Pbos.emplace_back(GLBufferType::PIXEL_UNPACK_BUFFER);
+         m_Pbos.back().BufferData(nullptr, (uint32_t)pboSize, GLBufferUsage::STREAM_DRAW);
+      }
+      m_PboFences.assign(m_Pbos.size(), nullptr);
+      // a bound unpack buffer would turn every later client memory upload into an offset
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      if(workerCount == 0)
+      {
+         unsigned int hardwareThreads = std::thread::hardware_concurrency();
+         workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+      }
+      for(uint32_t i = 0; i < workerCount; i++)
+         m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
    }
 
-   void GLTexture::LoadTexture(const char* filepath) 
+   TextureLoader::~TextureLoader()
    {
-      if(m_Pixels != nullptr)
-         stbi_image_free(m_Pixels);
-      
-      int w,h,n,ok;
-      ok = stbi_info(filepath, &w, &h, &n);
-      if(ok == 1)
-         std::cout << "Texture loading " << filepath << " is ok [w:" << w << ", h:" << h << ", n:" << n << "]" << std::endl;
+      {
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         m_Stop = true;
+      }
+      m_JobAvailable.notify_all();
+      for(std::thread& worker : m_Workers)
+         worker.join();
 
-      m_Pixels = stbi_load(filepath, &m_Width, &m_Height, &m_Channels, 0);
-      
-      if(m_Pixels == NULL)
-         std::cout << "ERROR on loading Texture " << filepath << std::endl;
-      
-      GenTextures();
+      for(DecodedImage& image : m_Decoded)
+      {
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+      }
+      for(DecodedImage& image : m_Uploads)
+      {
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+      }
+      for(GLsync fence : m_PboFences)
+      {
+         if(fence != nullptr)
+            glDeleteSync(fence);
+      }
+   }
+
+   void TextureLoader::SetPlaceholderColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+   {
+      m_Placeholder[0] = r;
+      m_Placeholder[1] = g;
+      m_Placeholder[2] = b;
+      m_Placeholder[3] = a;
+   }
+
+   std::shared_ptr<GLTexture> TextureLoader::Load(const char* filepath)
+   {
+      return Load(filepath, TextureCreateInfo());
+   }
+
+   std::shared_ptr<GLTexture> TextureLoader::Load(const char* filepath, const TextureCreateInfo& createInfo)
+   {
+      TextureCreateInfo info = createInfo;
+      if(info.format >= TextureFormat::R16F)
+      {
+         std::cout << "ERROR: TextureLoader decodes 8 bit images, " << filepath << " is loaded with an 8 bit format" << std::endl;
+         info.format = TextureFormat::NONE;
+      }
+
+      std::shared_ptr<GLTexture> texture = std::make_shared<GLTexture>(TextureType::TEXTURE2D, info);
+      texture->Upload(1, 1, 4, m_Placeholder);
+
+      m_Stats.requested++;
+      m_InFlight++;
+      {
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         m_Jobs.push_back({ filepath, texture, info });
+      }
+      m_JobAvailable.notify_one();
+      return texture;
+   }
+
+   void TextureLoader::WorkerLoop()
+   {
+      while(true)
+      {
+         Job job;
+         {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobAvailable.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+            if(m_Stop)
+               return;
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+         }
+
+         DecodedImage image = { job.texture, nullptr, {}, 0, 0, 0, {} };
+         // nobody holds the texture anymore, skip the decode
+         if(!job.texture.expired())
+         {
+            image.pixels = stbi_load(job.path.c_str(), &image.width, &image.height, &image.channels, 0);
+            if(image.pixels == nullptr)
+               std::cout << "ERROR on loading Texture " << job.path << std::endl;
+            else
+               ConvertImage(image, job.createInfo);
+         }
+
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         m_Decoded.push_back(std::move(image));
+      }
+   }
+
+   void TextureLoader::ConvertImage(DecodedImage& image, const TextureCreateInfo& createInfo)
+   {
+      size_t pixelCount = (size_t)image.width * image.height;
+      if(image.channels == 3)
+      {
+         image.converted.resize(pixelCount * 4);
+         PixelConvert::RGBToRGBA(image.pixels, image.converted.data(), pixelCount);
+         image.channels = 4;
+         stbi_image_free(image.pixels);
+         image.pixels = nullptr;
+      }
+      else if(image.channels == 4 && m_PremultiplyAlpha)
+         PixelConvert::PremultiplyAlpha(image.pixels, image.pixels, pixelCount);
+
+      // one thread per image, the other workers are busy with their own
+      if(createInfo.mipmaps && createInfo.mipFilter != MipFilter::NONE && pixelCount > 1
+         && MipGenerator::Build(image.Data(), image.width, image.height, image.channels, createInfo.mipFilter,
+            createInfo.IsSRGB(image.channels), image.mips, 1))
+      {
+         // level 0 is in the chain now
+         image.converted = std::vector<unsigned char>();
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+         image.pixels = nullptr;
+      }
+   }
+
+   bool TextureLoader::UploadImage(const DecodedImage& image, GLTexture& texture)
+   {
+      GLsizeiptr size = (GLsizeiptr)image.Size();
+      if(m_Pbos.empty() || size > m_PboSize)
+      {
+         if(!image.mips.levels.empty())
+            texture.UploadMipChain(image.mips);
+         else
+            texture.Upload(image.width, image.height, image.channels, image.Data());
+         m_Stats.directUploads++;
+         return true;
+      }
+
+      if(m_PboHead + size > m_PboSize)
+      {
+         // fence the PBO that is left first, with a single PBO it is also the next one.
+         // A stalled call already fenced it, the retry must not fence it again
+         if(m_PboFences[m_PboIndex] == nullptr)
+            m_PboFences[m_PboIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+         // the next PBO may still be read by uploads from the last time around the ring
+         size_t next = (m_PboIndex + 1) % m_Pbos.size();
+         GLsync& fence = m_PboFences[next];
+         if(fence != nullptr)
+         {
+            if(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+               return false;
+            glDeleteSync(fence);
+            fence = nullptr;
+         }
+
+         m_PboIndex = next;
+         m_PboHead = 0;
+      }
+
+      GLBuffer& pbo = m_Pbos[m_PboIndex];
+      void* pointer = pbo.MapBufferRange(m_PboHead, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      if(pointer == nullptr)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+         if(!image.mips.levels.empty())
+            texture.UploadMipChain(image.mips);
+         else
+            texture.Upload(image.width, image.height, image.channels, image.Data());
+         m_Stats.directUploads++;
+         return true;
+      }
+      memcpy(pointer, image.Data(), size);
+      pbo.UnmapBuffer();
+
+      if(!image.mips.levels.empty())
+         texture.UploadMipChain(image.mips, m_PboHead);
+      else
+         texture.Upload(image.width, image.height, image.channels, (const void*)m_PboHead);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      m_PboHead = ((m_PboHead + size + 15) / 16) * 16;
+      return true;
+   }
+
+   void TextureLoader::Update(double budgetMilliseconds)
+   {
+      auto start = std::chrono::steady_clock::now();
+      {
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         while(!m_Decoded.empty())
+         {
+            m_Uploads.push_back(std::move(m_Decoded.front()));
+            m_Decoded.pop_front();
+         }
+      }
+
+      bool uploadedAny = false;
+      while(!m_Uploads.empty())
+      {
+         std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+         if(uploadedAny && elapsed.count() >= budgetMilliseconds)
+            break;
+
+         DecodedImage& image = m_Uploads.front();
+         std::shared_ptr<GLTexture> texture = image.texture.lock();
+         if(image.Data() != nullptr && texture != nullptr)
+         {
+            if(!UploadImage(image, *texture))
+            {
+               m_Stats.pboStalls++;
+               break;
+            }
+            m_Stats.uploaded++;
+            uploadedAny = true;
+         }
+         else if(texture != nullptr)
+            m_Stats.failed++; // keeps the placeholder
+
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+         m_Uploads.pop_front();
+         m_InFlight--;
+      }
+   }
+
+   void TextureLoader::Finish()
+   {
+      while(m_InFlight.load() != 0)
+      {
+         Update(1000.0);
+         if(m_InFlight.load() != 0)
+            std::this_thread::yield();
+      }
    }
+} // namespace EaseGL
+#endif
+
+/*-- File: src/TextureLoader.cpp end --*/
+/*-- File: src/UniformBlock.cpp start --*/
+/*-- #include "src/UniformBlock.hpp" start --*/
+#ifndef UNIFORMBLOCK_H
+#define UNIFORMBLOCK_H
+
+#include <glad/glad.h>
+/*-- #include "src/GLBuffer.hpp" start --*/
+/*-- #include "src/GLBuffer.hpp" end --*/
+/*-- #include "src/Shader.hpp" start --*/
+/*-- #include "src/Shader.hpp" end --*/
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+
+namespace EaseGL
+{
+	enum class BlockLayout
+	{
+		STD140, // uniform blocks
+		STD430, // shader storage blocks
+	};
+
+	constexpr size_t AlignBlockOffset(size_t offset, size_t alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	 * @brief Base alignment, size and CPU -> GPU copy of a field type.
+	 * Specialized for 32 bit scalars, glm vectors, glm matrices and arrays of them.
+	 */
+	template<typename T>
+	struct BlockFieldTraits;
+
+	template<typename T>
+	struct BlockScalarTraits
+	{
+		static_assert(sizeof(T) == 4, "block scalars have to be 32 bit, use int32_t instead of bool");
+
+		static constexpr size_t Alignment(BlockLayout) { return 4; }
+		static constexpr size_t Size(BlockLayout) { return 4; }
+		static void Write(unsigned char* destination, const T& value, BlockLayout) { memcpy(destination, &value, 4); }
+	};
+
+	template<> struct BlockFieldTraits<float> : BlockScalarTraits<float> {};
+	template<> struct BlockFieldTraits<int32_t> : BlockScalarTraits<int32_t> {};
+	template<> struct BlockFieldTraits<uint32_t> : BlockScalarTraits<uint32_t> {};
+
+	template<glm::length_t L, typename T, glm::qualifier Q>
+	struct BlockFieldTraits<glm::vec<L, T, Q>>
+	{
+		static_assert(sizeof(T) == 4, "block vectors have to have 32 bit components");
+
+		// vec3 is aligned like vec4 but only takes 12 bytes
+		static constexpr size_t Alignment(BlockLayout) { return L == 1 ? 4 : L == 2 ? 8 : 16; }
+		static constexpr size_t Size(BlockLayout) { return L * 4; }
+		static void Write(unsigned char* destination, const glm::vec<L, T, Q>& value, BlockLayout) { memcpy(destination, &value[0], L * 4); }
+	};
+
+	// Matrices are laid out as an array of column vectors
+	template<glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+	struct BlockFieldTraits<glm::mat<C, R, T, Q>>
+	{
+		typedef BlockFieldTraits<glm::vec<R, T, Q>> ColumnTraits;
+
+		static constexpr size_t ColumnStride(BlockLayout layout)
+		{
+			return layout == BlockLayout::STD140 ? AlignBlockOffset(ColumnTraits::Alignment(layout), 16) : ColumnTraits::Alignment(layout);
+		}
+		static constexpr size_t Alignment(BlockLayout layout) { return ColumnStride(layout); }
+		static constexpr size_t Size(BlockLayout layout) { return C * ColumnStride(layout); }
+		static void Write(unsigned char* destination, const glm::mat<C, R, T, Q>& value, BlockLayout layout)
+		{
+			for(glm::length_t column = 0; column < C; column++)
+				memcpy(destination + column * ColumnStride(layout), &value[column][0], R * 4);
+		}
+	};
+
+	// std140 rounds array element alignment and stride up to 16 bytes, std430 doesn't
+	template<typename T, size_t N>
+	struct BlockArrayTraits
+	{
+		typedef BlockFieldTraits<T> ElementTraits;
+
+		static constexpr size_t Alignment(BlockLayout layout)
+		{
+			return layout == BlockLayout::STD140 ? AlignBlockOffset(ElementTraits::Alignment(layout), 16) : ElementTraits::Alignment(layout);
+		}
+		static constexpr size_t Stride(BlockLayout layout) { return AlignBlockOffset(ElementTraits::Size(layout), Alignment(layout)); }
+		static constexpr size_t Size(BlockLayout layout) { return N * Stride(layout); }
+
+		template<typename Array>
+		static void WriteArray(unsigned char* destination, const Array& value, BlockLayout layout)
+		{
+			for(size_t i = 0; i < N; i++)
+				ElementTraits::Write(destination + i * Stride(layout), value[i], layout);
+		}
+	};
+
+	template<typename T, size_t N>
+	struct BlockFieldTraits<T[N]> : BlockArrayTraits<T, N>
+	{
+		static void Write(unsigned char* destination, const T (&value)[N], BlockLayout layout) { BlockArrayTraits<T, N>::WriteArray(destination, value, layout); }
+	};
+
+	template<typename T, size_t N>
+	struct BlockFieldTraits<std::array<T, N>> : BlockArrayTraits<T, N>
+	{
+		static void Write(unsigned char* destination, const std::array<T, N>& value, BlockLayout layout) { BlockArrayTraits<T, N>::WriteArray(destination, value, layout); }
+	};
+
+	template<BlockLayout L, typename... Fields>
+	constexpr std::array<size_t, sizeof...(Fields)> ComputeBlockOffsets()
+	{
+		const size_t alignments[] = { BlockFieldTraits<Fields>::Alignment(L)... };
+		const size_t sizes[] = { BlockFieldTraits<Fields>::Size(L)... };
+
+		std::array<size_t, sizeof...(Fields)> offsets = {};
+		size_t offset = 0;
+		for(size_t i = 0; i < sizeof...(Fields); i++)
+		{
+			offset = AlignBlockOffset(offset, alignments[i]);
+			offsets[i] = offset;
+			offset += sizes[i];
+		}
+		return offsets;
+	}
+
+	template<BlockLayout L, typename... Fields>
+	constexpr size_t ComputeBlockSize()
+	{
+		const size_t alignments[] = { BlockFieldTraits<Fields>::Alignment(L)... };
+		const size_t sizes[] = { BlockFieldTraits<Fields>::Size(L)... };
+
+		size_t offset = 0;
+		size_t blockAlignment = L == BlockLayout::STD140 ? 16 : 4;
+		for(size_t i = 0; i < sizeof...(Fields); i++)
+		{
+			offset = AlignBlockOffset(offset, alignments[i]) + sizes[i];
+			blockAlignment = alignments[i] > blockAlignment ? alignments[i] : blockAlignment;
+		}
+		return AlignBlockOffset(offset, blockAlignment);
+	}
+
+	/**
+	 * @brief Field description of a uniform/shader storage block, offsets and size are computed at compile time
+	 * 
+	 * typedef UniformLayout<BlockLayout::STD140, glm::mat4, glm::mat4, glm::vec3, float> CameraLayout;
+	 * static_assert(CameraLayout::Offsets[3] == 140);
+	 */
+	template<BlockLayout L, typename... Fields>
+	struct UniformLayout
+	{
+		static_assert(sizeof...(Fields) > 0, "UniformLayout needs at least one field");
+
+		static constexpr BlockLayout Layout = L;
+		static constexpr size_t FieldCount = sizeof...(Fields);
+
+		template<size_t I>
+		using FieldType = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+		static constexpr std::array<size_t, sizeof...(Fields)> Offsets = ComputeBlockOffsets<L, Fields...>();
+		static constexpr std::array<size_t, sizeof...(Fields)> Sizes = { BlockFieldTraits<Fields>::Size(L)... };
+		static constexpr size_t Size = ComputeBlockSize<L, Fields...>();
+	};
+
+	/**
+	 * @brief Compares 'offsets' with the offsets the linker assigned and sets the block's binding index.
+	 * Used by UniformBlock::Attach
+	 */
+	bool ValidateBlockLayout(GLuint program, BlockLayout layout, const char* blockName, GLuint bindingIndex,
+		const char* const* fieldNames, const size_t* offsets, size_t fieldCount, size_t size);
+
+	/**
+	 * @brief Typed uniform (STD140) or shader storage (STD430) block, Upload() only sends fields that changed
+	 * 
+	 * UniformBlock<CameraLayout> camera;
+	 * camera.Attach(shader, "Camera", 0, { "u_View", "u_Projection", "u_CameraPosition", "u_Time" });
+	 * 
+	 * camera.Set<0>(view);
+	 * camera.Set<3>(time);
+	 * camera.Upload();
+	 * camera.Bind(0);
+	 */
+	template<typename Layout>
+	class UniformBlock  
+	{
+		private:
+			static_assert(Layout::FieldCount <= 64, "UniformBlock supports up to 64 fields");
+
+			GLBuffer m_Buffer;
+			std::array<unsigned char, Layout::Size> m_Data;
+			uint64_t m_DirtyFields;
+			bool m_Allocated;
+		public:
+			UniformBlock()
+				: m_Buffer(Layout::Layout == BlockLayout::STD140 ? GLBufferType::UNIFORM_BUFFER : GLBufferType::SHADER_STORAGE_BUFFER),
+				m_Data(), m_DirtyFields(0), m_Allocated(false)
+			{
+			}
+
+			template<size_t I>
+			void Set(const typename Layout::template FieldType<I>& value)
+			{
+				constexpr size_t offset = Layout::Offsets[I];
+				constexpr size_t size = Layout::Sizes[I];
+
+				unsigned char field[size] = {};
+				BlockFieldTraits<typename Layout::template FieldType<I>>::Write(field, value, Layout::Layout);
+				if(memcmp(m_Data.data() + offset, field, size) != 0)
+				{
+					memcpy(m_Data.data() + offset, field, size);
+					m_DirtyFields |= (uint64_t)1 << I;
+				}
+			}
+
+			/**
+			 * @brief Uploads changed fields, neighbouring changed fields are sent with a single call
+			 */
+			void Upload()
+			{
+				if(!m_Allocated)
+				{
+					m_Buffer.BufferData(m_Data.data(), (uint32_t)Layout::Size, GLBufferUsage::DYNAMIC_DRAW);
+					m_Allocated = true;
+					m_DirtyFields = 0;
+					return;
+				}
 
-   GLTexture::GLTexture(TextureType type) 
-      : m_TextureType(type), m_Pixels(nullptr), m_Width(0), m_Height(0), m_Channels(0), m_TextureID(0), m_Filepath("")
-   {
-   }
+				for(size_t i = 0; i < Layout::FieldCount && m_DirtyFields != 0; i++)
+				{
+					if((m_DirtyFields & ((uint64_t)1 << i)) == 0)
+						continue;
 
-   GLTexture::GLTexture(TextureType type, const char* filepath)
-      : m_TextureType(type), m_Filepath(filepath), m_Pixels(nullptr), m_Width(0), m_Height(0), m_Channels(0), m_TextureID(0)
-   {
-      LoadTexture(filepath);
-   }
+					size_t first = i;
+					while(i + 1 < Layout::FieldCount && (m_DirtyFields & ((uint64_t)1 << (i + 1))) != 0)
+						i++;
 
-   GLTexture::GLTexture(GLuint textureID, TextureType textureType)
-      : m_TextureID(textureID), m_TextureType(textureType)
-   {
-   }
-   
+					size_t begin = Layout::Offsets[first];
+					size_t end = Layout::Offsets[i] + Layout::Sizes[i];
+					m_Buffer.BufferSubData(m_Data.data() + begin, begin, end - begin);
+				}
+				m_DirtyFields = 0;
+			}
 
-   GLenum GLTexture::GetGLTextureType() const
-   {
-      return m_TextureType == TextureType::TEXTURE2D ? GL_TEXTURE_2D
-         : GL_NONE;
-   }
+			/**
+			 * @brief Checks the C++ layout against the linked program and assigns 'bindingIndex' to the block
+			 * 
+			 * @param fieldNames names as seen by glGetUniformIndices, prefixed with the instance name if the block has one
+			 * @return false if the block or a field is missing or an offset doesn't match
+			 */
+			bool Attach(const Shader& shader, const char* blockName, GLuint bindingIndex, const std::array<const char*, Layout::FieldCount>& fieldNames)
+			{
+				return ValidateBlockLayout(shader, Layout::Layout, blockName, bindingIndex,
+					fieldNames.data(), Layout::Offsets.data(), Layout::FieldCount, Layout::Size);
+			}
 
-   void GLTexture::GenTextures()
-   {
-      DeleteTextures();
+			void Bind(GLuint bindingIndex) { m_Buffer.BindBufferBase(bindingIndex); }
 
-      glGenTextures(1, &m_TextureID);
-      Bind();
+			GLBuffer& Buffer() { return m_Buffer; }
+	};
+} // namespace EaseGL
 
-      glTexParameteri(GetGLTextureType(), GL_TEXTURE_WRAP_S, GL_REPEAT);	
-      glTexParameteri(GetGLTextureType(), GL_TEXTURE_WRAP_T, GL_REPEAT);
-      glTexParameteri(GetGLTextureType(), GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-      glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+#endif
 
-      
-      int oldUnpackAlignment = 0;
-      glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldUnpackAlignment);
-      bool changeAlignment = false; // to prevent unnecessary GPU calls
-      // if m_Channels == 3 -> pixels should be aligned by 1, else(1, 2, 4) it can be aligned to m_Channels itself
-      if(m_Channels == 3 && oldUnpackAlignment != 1)
-      {
-         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-         changeAlignment = true;
-      }
-      else if(oldUnpackAlignment != m_Channels)
-      {
-         glPixelStorei(GL_UNPACK_ALIGNMENT, m_Channels);
-         changeAlignment = true;
-      }
+/*-- #include "src/UniformBlock.hpp" end --*/
 
-      glTexImage2D(GetGLTextureType(), 0,
-         GL_RGBA8, // store in GPU as
-         m_Width, m_Height,
-         0, // border
-         m_Channels == 4 ? GL_RGBA : m_Channels == 3 ? GL_RGB : m_Channels == 2 ? GL_RG : m_Channels == 1 ? GL_RED : GL_NONE, // which format does our image is, (can be found from 'm_Channels')
-         GL_UNSIGNED_BYTE,
-         m_Pixels);
-      glGenerateMipmap(GetGLTextureType());
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+
+namespace EaseGL
+{
+   bool ValidateBlockLayout(GLuint program, BlockLayout layout, const char* blockName, GLuint bindingIndex,
+      const char* const* fieldNames, const size_t* offsets, size_t fieldCount, size_t size)
+   {
+      const char* layoutName = layout == BlockLayout::STD140 ? "std140" : "std430";
 
-      if(changeAlignment)
+      GLint dataSize = 0;
+      std::vector<GLint> linkedOffsets(fieldCount, -1);
+      if(layout == BlockLayout::STD140)
       {
-         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+         GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+         if(blockIndex == GL_INVALID_INDEX)
+         {
+            std::cout << "ERROR: Uniform block " << blockName << " not found!" << std::endl;
+            return false;
+         }
+         glUniformBlockBinding(program, blockIndex, bindingIndex);
+         glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+
+         std::vector<GLuint> indices(fieldCount, GL_INVALID_INDEX);
+         glGetUniformIndices(program, (GLsizei)fieldCount, fieldNames, indices.data());
+         for(size_t i = 0; i < fieldCount; i++)
+         {
+            if(indices[i] != GL_INVALID_INDEX)
+               glGetActiveUniformsiv(program, 1, &indices[i], GL_UNIFORM_OFFSET, &linkedOffsets[i]);
+         }
       }
+      else
+      {
+         GLuint blockIndex = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, blockName);
+         if(blockIndex == GL_INVALID_INDEX)
+         {
+            std::cout << "ERROR: Shader storage block " << blockName << " not found!" << std::endl;
+            return false;
+         }
+         glShaderStorageBlockBinding(program, blockIndex, bindingIndex);
 
-   }
+         const GLenum dataSizeProperty = GL_BUFFER_DATA_SIZE;
+         glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, blockIndex, 1, &dataSizeProperty, 1, NULL, &dataSize);
 
-   void GLTexture::DeleteTextures()
-   {
-      if(m_TextureID != 0)
-         glDeleteTextures(1, &m_TextureID);
+         const GLenum offsetProperty = GL_OFFSET;
+         for(size_t i = 0; i < fieldCount; i++)
+         {
+            GLuint index = glGetProgramResourceIndex(program, GL_BUFFER_VARIABLE, fieldNames[i]);
+            if(index != GL_INVALID_INDEX)
+               glGetProgramResourceiv(program, GL_BUFFER_VARIABLE, index, 1, &offsetProperty, 1, NULL, &linkedOffsets[i]);
+         }
+      }
 
-      //if(m_Pixels != nullptr)
-         //stbi_image_free(m_Pixels);
-   }
+      bool valid = true;
+      for(size_t i = 0; i < fieldCount; i++)
+      {
+         if(linkedOffsets[i] == -1)
+         {
+            std::cout << "ERROR: Block " << blockName << " has no field " << fieldNames[i] << std::endl;
+            valid = false;
+         }
+         else if((size_t)linkedOffsets[i] != offsets[i])
+         {
+            std::cout << "ERROR: Block " << blockName << " field " << fieldNames[i] << " is at offset " << linkedOffsets[i]
+               << " but " << layoutName << " layout puts it at " << offsets[i] << std::endl;
+            valid = false;
+         }
+      }
 
-   void GLTexture::Bind(int slot /* = 0*/) const
-   {
-      glActiveTexture(GL_TEXTURE0 + slot);
-      glBindTexture(GetGLTextureType(), m_TextureID);
+      if((size_t)dataSize > size)
+      {
+         std::cout << "ERROR: Block " << blockName << " is " << dataSize << " bytes but its " << layoutName
+            << " layout only has " << size << " bytes" << std::endl;
+         valid = false;
+      }
+      return valid;
    }
 } // namespace EaseGL
-
 #endif
-/*-- File: src/GLTexture.cpp end --*/
-/*-- File: src/Shader.cpp start --*/
-/*-- #include "src/Shader.hpp" start --*/
-#ifndef SHADER_H
-#define SHADER_H
+
+/*-- File: src/UniformBlock.cpp end --*/
+/*-- File: src/UploadQueue.cpp start --*/
+/*-- #include "src/UploadQueue.hpp" start --*/
+#ifndef UPLOADQUEUE_H
+#define UPLOADQUEUE_H
 
 #include <glad/glad.h>
 /*-- #include "src/GLBuffer.hpp" start --*/
 /*-- #include "src/GLBuffer.hpp" end --*/
-#include <unordered_map>
-#include <glm/glm.hpp>
-/*-- #include "src/GLTexture.hpp" start --*/
-/*-- #include "src/GLTexture.hpp" end --*/
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
 
 namespace EaseGL
 {
-	enum class ShaderType
+	struct UploadQueueStats
 	{
-		NONE = 0,
-		VERTEX,
-		FRAGMENT,
-		GEOMETRY,
+		uint64_t rangesRecorded = 0;
+		uint64_t rangesUploaded = 0; // after merging
+		uint64_t glCalls = 0;        // binds, uploads and copies issued by Flush()
+		uint64_t bytesRecorded = 0;
+		uint64_t bytesUploaded = 0;  // includes gap bytes of merged MarkDirty() ranges
 	};
-	class Shader  
+
+	/**
+	 * @brief Defers buffer updates to a single Flush() per frame.
+	 * Overlapping and adjacent ranges of the same buffer are merged into a single upload.
+	 * 
+	 * Record() copies the data into a CPU staging arena right away.
+	 * MarkDirty() only remembers a range of 'mirror', a CPU copy of the whole buffer that has to stay
+	 * alive until Flush(). Since gap bytes can be read from the mirror, MarkDirty() ranges that are
+	 * at most SetMergeGap() bytes apart are merged too.
+	 * 
+	 * Record() and MarkDirty() ranges of the same buffer shouldn't overlap in the same frame,
+	 * Record() ranges are uploaded first.
+	 */
+	class UploadQueue  
 	{
 		private:
-			GLuint m_VertexShaderID;
-			GLuint m_FragmentShaderID;
-			GLuint m_GeometryShaderID;
-
-			GLuint m_ProgramID;
-
-			std::unordered_map<std::string, GLint> m_UniformLocations;
-
-			int m_MaxTextureSlots;
-		public:
+			struct Range
+			{
+				GLuint buffer;
+				const unsigned char* mirror; // nullptr for Record() ranges
+				GLintptr offset;
+				GLsizeiptr size;
+				size_t stagingOffset;
+				uint32_t sequence;
+			};
 
-			Shader() = default;
-			Shader(const char* shaderPath);
-			~Shader();
+			struct Span
+			{
+				GLuint buffer;
+				GLintptr offset;
+				GLsizeiptr size;
+				size_t packedOffset;
+			};
 
-			void LoadShader(const char* shaderPath);
+			std::vector<Range> m_Ranges;
+			std::vector<unsigned char> m_Staging;
 
+			// merged spans packed back to back, uploaded with one call when staging copy is used
+			std::vector<Span> m_Spans;
+			std::vector<unsigned char> m_Packed;
+			std::vector<uint32_t> m_SortedRanges;
+			std::vector<uint32_t> m_MergedRanges;
+			std::vector<uint32_t> m_SpanRanges;
 
-			void Bind();
+			GLBuffer m_StagingBuffer;
+			bool m_UseStagingCopy;
+			GLsizeiptr m_MergeGap;
 
-			GLuint GetUniformLocation(const std::string& name);
+			UploadQueueStats m_Stats;
 
+			void PackSpan(const Span& span, const std::vector<uint32_t>& ranges, const unsigned char* mirror);
+		public:
+			UploadQueue();
+			~UploadQueue();
 
+			UploadQueue(const UploadQueue&) = delete;
+			UploadQueue& operator=(const UploadQueue&) = delete;
 
-			void Uniform(const std::string& name, const glm::mat4& uniform);
-			void Uniform(const std::string& name, const GLTexture& uniform, int slot);
-			void Uniform(const std::string& name, int uniform);
+			void Record(const GLBuffer& buffer, GLintptr offset, const void* data, GLsizeiptr size);
+			void MarkDirty(const GLBuffer& buffer, const void* mirror, GLintptr offset, GLsizeiptr size);
 
+			/**
+			 * @brief Uploads all recorded ranges and clears the queue
+			 */
+			void Flush();
 
 			/**
-			 * @brief 
-			 * 
-			 * @param uniformBuffer 
-			 * @param bufferIndex between 0 and GL_MAX_UNIFORM_BUFFER_BINDINGS, similar to glActiveTexture
-			 * @param uniformName
+			 * @param bytes MarkDirty() ranges that are at most 'bytes' apart are uploaded as one range
+			 */
+			void SetMergeGap(GLsizeiptr bytes) { m_MergeGap = bytes; }
+			/**
+			 * @brief When enabled, Flush() uploads everything into one staging buffer with a single call
+			 * and then copies each range with glCopyBufferSubData, instead of a glBufferSubData per range
 			 */
-			void BindUBO(GLBuffer uniformBuffer, int bufferIndex, const char* uniformName);
+			void SetStagingCopy(bool enabled) { m_UseStagingCopy = enabled; }
+
+			size_t PendingRanges() const { return m_Ranges.size(); }
+
+			const UploadQueueStats& Stats() const { return m_Stats; }
+			void ResetStats() { m_Stats = UploadQueueStats(); }
 	};
 } // namespace EaseGL
 
 #endif
-/*-- #include "src/Shader.hpp" end --*/
-#ifdef EASEGL_IMPLEMENTATION
 
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <string.h>
+/*-- #include "src/UploadQueue.hpp" end --*/
 
-/*-- #include "src/GLBuffer.hpp" start --*/
-/*-- #include "src/GLBuffer.hpp" end --*/
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
 
 namespace EaseGL
 {
-   void GetShaderError(GLuint shader, const char* filename, const char* type)
+   UploadQueue::UploadQueue()
+      : m_StagingBuffer(GLBufferType::ARRAY_BUFFER), m_UseStagingCopy(false), m_MergeGap(0)
    {
-      int  success;
-      char infoLog[512];
-      glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-      if(!success)
-      {
-         glGetShaderInfoLog(shader, 512, NULL, infoLog);
-         std::cout << "ERROR::SHADER::" << type << "::COMPILATION_FAILED\n" << infoLog << '\n' << filename << std::endl;
-         throw;
-      }
    }
-   void GetProgramError(GLuint shader, const char* filename)
+
+   UploadQueue::~UploadQueue()
    {
-      int  success;
-      char infoLog[512];
-      glGetProgramiv(shader, GL_LINK_STATUS, &success);
-      if(!success)
-      {
-         glGetProgramInfoLog(shader, 512, NULL, infoLog);
-         std::cout << "ERROR::SHADER::PROGRAM::COMPILATION_FAILED\n" << infoLog << '\n' << filename << std::endl;
-         throw;
-      }
    }
 
-   Shader::Shader(const char* shaderPath)
-      : m_ProgramID(0)
+   void UploadQueue::Record(const GLBuffer& buffer, GLintptr offset, const void* data, GLsizeiptr size)
    {
-      LoadShader(shaderPath);
+      if(size <= 0)
+         return;
+
+      Range range;
+      range.buffer = buffer;
+      range.mirror = nullptr;
+      range.offset = offset;
+      range.size = size;
+      range.stagingOffset = m_Staging.size();
+      range.sequence = (uint32_t)m_Ranges.size();
+      m_Ranges.push_back(range);
+
+      m_Staging.insert(m_Staging.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+
+      m_Stats.rangesRecorded++;
+      m_Stats.bytesRecorded += size;
    }
 
-   void Shader::LoadShader(const char* shaderPath)
+   void UploadQueue::MarkDirty(const GLBuffer& buffer, const void* mirror, GLintptr offset, GLsizeiptr size)
    {
-      glGetIntegerv(GL_MAX_TEXTURE_UNITS, &m_MaxTextureSlots);
-
-      ShaderType currentType = ShaderType::NONE;
-      std::ifstream ifstream;
-      ifstream.open(shaderPath);
-      if(!ifstream)
-      {
-         std::cout << shaderPath;
-         throw std::runtime_error("Failed to load file");
-      }
-
-      std::string vertexShaderStr = "";
-      std::string fragmentShaderStr = "";
-      std::string geometryShaderStr = "";
+      if(size <= 0)
+         return;
+
+      Range range;
+      range.buffer = buffer;
+      range.mirror = (const unsigned char*)mirror;
+      range.offset = offset;
+      range.size = size;
+      range.stagingOffset = 0;
+      range.sequence = (uint32_t)m_Ranges.size();
+      m_Ranges.push_back(range);
+
+      m_Stats.rangesRecorded++;
+      m_Stats.bytesRecorded += size;
+   }
 
-      std::string line;
-      while (std::getline(ifstream, line))
+   void UploadQueue::PackSpan(const Span& span, const std::vector<uint32_t>& ranges, const unsigned char* mirror)
+   {
+      unsigned char* destination = m_Packed.data() + span.packedOffset;
+      if(mirror != nullptr)
       {
-         if(strncmp(line.c_str(), "#shader vertex", strlen("#shader vertex")) == 0)
-         {
-            currentType = ShaderType::VERTEX;
-         }
-         else if(strncmp(line.c_str(), "#shader fragment", strlen("#shader fragment")) == 0)
-         {
-            currentType = ShaderType::FRAGMENT;
-         }
-         else if(strncmp(line.c_str(), "#shader geometry", strlen("#shader geometry")) == 0)
-         {
-            currentType = ShaderType::GEOMETRY;
-         }
-         else
-         {
-            // 'line' is shader code
-            if(currentType == ShaderType::VERTEX)
-            {
-               vertexShaderStr += line + '\n';
-            }
-            else if(currentType == ShaderType::FRAGMENT)
-            {
-               fragmentShaderStr += line + '\n';
-            }
-            else if(currentType == ShaderType::GEOMETRY)
-            {
-               geometryShaderStr += line + '\n';
-            }
-         }
-         
+         memcpy(destination, mirror + span.offset, span.size);
+         return;
       }
-      ifstream.close();
 
-
-      if(vertexShaderStr != "")
+      // ranges are sorted by offset, overlapping bytes have to be written in recording order
+      if(ranges.size() > 1)
       {
-         m_VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-         const char* vertexShaderSrc = vertexShaderStr.c_str();
-         glShaderSource(m_VertexShaderID, 1, &vertexShaderSrc, NULL);
-         glCompileShader(m_VertexShaderID);
-         GetShaderError(m_VertexShaderID, shaderPath, "VERTEX");
+         m_SpanRanges = ranges;
+         std::sort(m_SpanRanges.begin(), m_SpanRanges.end(), [this](uint32_t a, uint32_t b) {
+            return m_Ranges[a].sequence < m_Ranges[b].sequence;
+         });
       }
+      const std::vector<uint32_t>& ordered = ranges.size() > 1 ? m_SpanRanges : ranges;
 
-      if(fragmentShaderStr != "")
+      for(uint32_t index : ordered)
       {
-         m_FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-         const char* fragmentShaderSrc = fragmentShaderStr.c_str();
-         glShaderSource(m_FragmentShaderID, 1, &fragmentShaderSrc, NULL);
-         glCompileShader(m_FragmentShaderID);
-         GetShaderError(m_FragmentShaderID, shaderPath, "FRAGMENT");
+         const Range& range = m_Ranges[index];
+         memcpy(destination + (range.offset - span.offset), m_Staging.data() + range.stagingOffset, range.size);
       }
+   }
 
-      if(geometryShaderStr != "")
+   void UploadQueue::Flush()
+   {
+      if(m_Ranges.empty())
+         return;
+
+      m_SortedRanges.resize(m_Ranges.size());
+      for(uint32_t i = 0; i < m_SortedRanges.size(); i++)
+         m_SortedRanges[i] = i;
+
+      std::sort(m_SortedRanges.begin(), m_SortedRanges.end(), [this](uint32_t a, uint32_t b) {
+         const Range& left = m_Ranges[a];
+         const Range& right = m_Ranges[b];
+         if(left.buffer != right.buffer)
+            return left.buffer < right.buffer;
+         if(left.mirror != right.mirror)
+            return left.mirror < right.mirror;
+         if(left.offset != right.offset)
+            return left.offset < right.offset;
+         return left.sequence < right.sequence;
+      });
+
+      // merge sorted ranges into spans and pack their bytes
+      m_Spans.clear();
+      m_Packed.clear();
+      size_t i = 0;
+      while(i < m_SortedRanges.size())
       {
-         m_GeometryShaderID = glCreateShader(GL_GEOMETRY_SHADER);
-         const char* geometryShaderSrc = geometryShaderStr.c_str();
-         glShaderSource(m_GeometryShaderID, 1, &geometryShaderSrc, NULL);
-         glCompileShader(m_GeometryShaderID);
-         GetShaderError(m_GeometryShaderID, shaderPath, "GEOMETRY");
-      }
-
-
-      
-      m_ProgramID = glCreateProgram();
+         const Range& first = m_Ranges[m_SortedRanges[i]];
+         GLsizeiptr gap = first.mirror != nullptr ? m_MergeGap : 0;
 
-      if(vertexShaderStr != "")
-         glAttachShader(m_ProgramID, m_VertexShaderID);
-      if(fragmentShaderStr != "")
-         glAttachShader(m_ProgramID, m_FragmentShaderID);
-      if(geometryShaderStr != "")
-         glAttachShader(m_ProgramID, m_GeometryShaderID);
-      glLinkProgram(m_ProgramID);
+         Span span;
+         span.buffer = first.buffer;
+         span.offset = first.offset;
+         GLintptr end = first.offset + first.size;
 
-      GetProgramError(m_ProgramID, shaderPath);
+         m_MergedRanges.clear();
+         m_MergedRanges.push_back(m_SortedRanges[i]);
+         i++;
 
+         while(i < m_SortedRanges.size())
+         {
+            const Range& next = m_Ranges[m_SortedRanges[i]];
+            if(next.buffer != first.buffer || next.mirror != first.mirror || next.offset > end + gap)
+               break;
 
-      if(m_VertexShaderID != 0)
-         glDeleteShader(m_VertexShaderID);
-      if(m_FragmentShaderID != 0)
-         glDeleteShader(m_FragmentShaderID);
-      if(m_GeometryShaderID != 0)
-         glDeleteShader(m_GeometryShaderID);
-   }
-      
-   Shader::~Shader()
-   {
-      if(m_ProgramID != 0)
-         glDeleteProgram(m_ProgramID);
-   }
+            end = std::max(end, (GLintptr)(next.offset + next.size));
+            m_MergedRanges.push_back(m_SortedRanges[i]);
+            i++;
+         }
 
-   void Shader::Bind() 
-   {
-      glUseProgram(m_ProgramID);
-   }
+         span.size = end - span.offset;
+         span.packedOffset = m_Packed.size();
+         m_Packed.resize(m_Packed.size() + span.size);
+         PackSpan(span, m_MergedRanges, first.mirror);
+         m_Spans.push_back(span);
 
-   GLuint Shader::GetUniformLocation(const std::string& name) 
-   {
-      for(const auto& uniform : m_UniformLocations)
-      {
-         if(uniform.first == name)
-            return uniform.second;
+         m_Stats.rangesUploaded++;
+         m_Stats.bytesUploaded += span.size;
       }
 
-      GLint loc = glGetUniformLocation(m_ProgramID, name.c_str());
-      if(loc == -1)
+      if(m_UseStagingCopy)
       {
-         std::cout << "ERROR: Uniform " << name << " not found!\n";
+         // glBufferData also orphans last frame's staging storage, so there is no need to wait on it
+         glBindBuffer(GL_COPY_READ_BUFFER, m_StagingBuffer);
+         glBufferData(GL_COPY_READ_BUFFER, m_Packed.size(), m_Packed.data(), GL_STREAM_DRAW);
+         m_Stats.glCalls += 2;
       }
-      m_UniformLocations[name] = loc;
-      return loc;
-   }
-
-   void Shader::BindUBO(GLBuffer uniformBuffer, int bufferIndex, const char* uniformName) 
-   {
-      std::cout << "DONT USE UNIFORM BUFFERS YET!" << std::endl;
-      
-      glBindBufferBase(GL_UNIFORM_BUFFER, bufferIndex, uniformBuffer.m_BufferID);
-
-      int uniformIndex = glGetUniformBlockIndex(m_ProgramID, uniformName);
-      glUniformBlockBinding(m_ProgramID, uniformIndex, bufferIndex);
-   }
 
-
-
-   void Shader::Uniform(const std::string& name, const glm::mat4& uniform)
-   {
-      glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &uniform[0][0]);
-   }
-
-   void Shader::Uniform(const std::string& name, const GLTexture& uniform, int slot) 
-   {
-      if(slot >= m_MaxTextureSlots)
+      GLuint boundBuffer = 0;
+      for(const Span& span : m_Spans)
       {
-         std::cout << "TEXTURE SLOT " << slot << " NOT EXISTS! MAX: " << m_MaxTextureSlots - 1 << std::endl;
+         if(span.buffer != boundBuffer)
+         {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, span.buffer);
+            boundBuffer = span.buffer;
+            m_Stats.glCalls++;
+         }
+
+         if(m_UseStagingCopy)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, span.packedOffset, span.offset, span.size);
+         else
+            glBufferSubData(GL_COPY_WRITE_BUFFER, span.offset, span.size, m_Packed.data() + span.packedOffset);
+         m_Stats.glCalls++;
       }
-      uniform.Bind(slot);
-      Uniform(name, slot);
-   }
 
-   void Shader::Uniform(const std::string& name, int uniform) 
-   {
-      glUniform1i(GetUniformLocation(name), uniform);
+      m_Ranges.clear();
+      m_Staging.clear();
    }
 } // namespace EaseGL
-
 #endif
-/*-- File: src/Shader.cpp end --*/
-/*-- File: src/Texture.cpp start --*/
-/*-- #include "src/Texture.hpp" start --*/
-/*-- #include "src/Texture.hpp" end --*/
-#ifdef EASEGL_IMPLEMENTATION
-
-namespace EaseGL
-{
-   
-} // namespace EaseGL
 
-#endif
-/*-- File: src/Texture.cpp end --*/
+/*-- File: src/UploadQueue.cpp end --*/
 /*-- File: src/VertexArray.cpp start --*/
 /*-- #include "src/VertexArray.hpp" start --*/
 #ifndef VERTEXARRAY_H
 #define VERTEXARRAY_H
 
 #include <glad/glad.h>
+/*-- #include "src/GLObjectPool.hpp" start --*/
+/*-- #include "src/GLObjectPool.hpp" end --*/
 #include <vector>
 
 namespace EaseGL
@@ -978,6 +9264,7 @@ namespace EaseGL
 		private:
 
 			GLuint m_VertexArrayID;
+			GLHandle m_Handle;
 		public:
 			VertexArray();
 			// creating a vertex array automatically binds it
@@ -986,6 +9273,13 @@ namespace EaseGL
 
 			~VertexArray();
 
+			VertexArray(const VertexArray&) = delete;
+			VertexArray& operator=(const VertexArray&) = delete;
+			VertexArray(VertexArray&& other) noexcept;
+			VertexArray& operator=(VertexArray&& other) noexcept;
+
+			GLHandle Handle() const { return m_Handle; }
+
 			void Bind() const;
 			static void Unbind();
 
@@ -1030,10 +9324,38 @@ namespace EaseGL
    VertexArray::VertexArray()
       : m_VertexArrayID(0)
    {
-      glGenVertexArrays(1, &m_VertexArrayID);
+      m_Handle = GLObjectPool::Create(GLObjectType::VERTEX_ARRAY);
+      m_VertexArrayID = GLObjectPool::Name(m_Handle);
       glBindVertexArray(m_VertexArrayID);
    }
 
+   VertexArray::VertexArray(VertexArray&& other) noexcept
+      : m_VertexArrayID(other.m_VertexArrayID), m_Handle(other.m_Handle),
+      m_AttributeSizeInBytes(other.m_AttributeSizeInBytes), m_UsedAttributes(std::move(other.m_UsedAttributes))
+   {
+      other.m_VertexArrayID = 0;
+      other.m_Handle = GLHandle();
+      other.m_AttributeSizeInBytes = 0;
+   }
+
+   VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+   {
+      if(this != &other)
+      {
+         GLObjectPool::Destroy(m_Handle);
+
+         m_VertexArrayID = other.m_VertexArrayID;
+         m_Handle = other.m_Handle;
+         m_AttributeSizeInBytes = other.m_AttributeSizeInBytes;
+         m_UsedAttributes = std::move(other.m_UsedAttributes);
+
+         other.m_VertexArrayID = 0;
+         other.m_Handle = GLHandle();
+         other.m_AttributeSizeInBytes = 0;
+      }
+      return *this;
+   }
+
    // static
    VertexArray VertexArray::New() 
    {
@@ -1042,8 +9364,7 @@ namespace EaseGL
       
    VertexArray::~VertexArray()
    {
-      if(m_VertexArrayID != 0)
-         glDeleteVertexArrays(1, &m_VertexArrayID);
+      GLObjectPool::Destroy(m_Handle);
    }
 
    void VertexArray::Bind() const
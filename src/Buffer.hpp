@@ -49,7 +49,6 @@ namespace EaseGL
 		public:
 			static GLBuffer New()
 			{
-				std::cout << "DONT USE UNIFORM BUFFERS YET!" << std::endl;
 				return GLBuffer(GLBufferType::UNIFORM_BUFFER);
 			}
 			static void Unbind()
@@ -62,6 +61,105 @@ namespace EaseGL
 		public:
 			~UniformBuffer() {}
 	};
+
+	struct ShaderStorageBuffer
+	{
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::SHADER_STORAGE_BUFFER);
+			}
+			static void Unbind()
+			{
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			}
+
+		private:
+			ShaderStorageBuffer() {}
+		public:
+			~ShaderStorageBuffer() {}
+	};
+
+	struct DispatchIndirectCommand
+	{
+		GLuint numGroupsX;
+		GLuint numGroupsY;
+		GLuint numGroupsZ;
+	};
+
+	struct DrawArraysIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint first;
+		GLuint baseInstance;
+	};
+
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// Holds DispatchIndirectCommand structs, see Shader::DispatchIndirect
+	struct DispatchIndirectBuffer
+	{
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::DISPATCH_INDIRECT_BUFFER);
+			}
+			static void Unbind()
+			{
+				glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+			}
+
+		private:
+			DispatchIndirectBuffer() {}
+		public:
+			~DispatchIndirectBuffer() {}
+	};
+
+	// Holds DrawArraysIndirectCommand/DrawElementsIndirectCommand structs for glDraw*Indirect
+	struct DrawIndirectBuffer
+	{
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::DRAW_INDIRECT_BUFFER);
+			}
+			static void Unbind()
+			{
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			}
+
+		private:
+			DrawIndirectBuffer() {}
+		public:
+			~DrawIndirectBuffer() {}
+	};
+
+	// Source of glTexImage*/glTexSubImage* while bound, the pixel pointer becomes an offset into the buffer
+	struct PixelUnpackBuffer
+	{
+		public:
+			static GLBuffer New()
+			{
+				return GLBuffer(GLBufferType::PIXEL_UNPACK_BUFFER);
+			}
+			static void Unbind()
+			{
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+
+		private:
+			PixelUnpackBuffer() {}
+		public:
+			~PixelUnpackBuffer() {}
+	};
 } // namespace EaseGL
 
 #endif
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "BufferArena.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <iostream>
+
+namespace EaseGL
+{
+   GLintptr AlignArenaOffset(GLintptr offset, GLsizeiptr alignment)
+   {
+      return ((offset + alignment - 1) / alignment) * alignment;
+   }
+
+   BufferArena::BufferArena(GLBufferType bufferType, GLsizeiptr pageSize, GLBufferUsage usage /* = GLBufferUsage::STATIC_DRAW*/)
+      : m_BufferType(bufferType), m_Usage(usage), m_PageSize(pageSize), m_CopyBufferSize(0), m_Version(0)
+   {
+   }
+
+   BufferArena::~BufferArena()
+   {
+   }
+
+   uint32_t BufferArena::CreatePage(GLsizeiptr minimumSize)
+   {
+      Page page;
+      page.capacity = minimumSize > m_PageSize ? minimumSize : m_PageSize;
+      page.buffer = std::make_unique<GLBuffer>(m_BufferType);
+      page.buffer->BufferData(nullptr, (uint32_t)page.capacity, m_Usage);
+      InsertFreeRange(page, 0, page.capacity);
+
+      m_Pages.push_back(std::move(page));
+      return (uint32_t)m_Pages.size() - 1;
+   }
+
+   void BufferArena::EraseFreeRange(Page& page, std::map<GLintptr, GLsizeiptr>::iterator it)
+   {
+      auto range = page.freeBySize.equal_range(it->second);
+      for(auto sizeIt = range.first; sizeIt != range.second; ++sizeIt)
+      {
+         if(sizeIt->second == it->first)
+         {
+            page.freeBySize.erase(sizeIt);
+            break;
+         }
+      }
+      page.freeByOffset.erase(it);
+   }
+
+   void BufferArena::InsertFreeRange(Page& page, GLintptr offset, GLsizeiptr size)
+   {
+      // coalesce with the following range
+      auto next = page.freeByOffset.lower_bound(offset);
+      if(next != page.freeByOffset.end() && offset + size == next->first)
+      {
+         size += next->second;
+         EraseFreeRange(page, next);
+      }
+
+      // coalesce with the previous range
+      auto it = page.freeByOffset.lower_bound(offset);
+      if(it != page.freeByOffset.begin())
+      {
+         auto prev = std::prev(it);
+         if(prev->first + prev->second == offset)
+         {
+            offset = prev->first;
+            size += prev->second;
+            EraseFreeRange(page, prev);
+         }
+      }
+
+      page.freeByOffset[offset] = size;
+      page.freeBySize.emplace(size, offset);
+   }
+
+   void BufferArena::RebuildFreeRanges(Page& page)
+   {
+      page.freeByOffset.clear();
+      page.freeBySize.clear();
+
+      GLintptr cursor = 0;
+      for(const auto& allocation : page.allocations)
+      {
+         if(allocation.first > cursor)
+         {
+            page.freeByOffset[cursor] = allocation.first - cursor;
+            page.freeBySize.emplace(allocation.first - cursor, cursor);
+         }
+         cursor = allocation.first + m_Blocks[allocation.second].size;
+      }
+
+      if(cursor < page.capacity)
+      {
+         page.freeByOffset[cursor] = page.capacity - cursor;
+         page.freeBySize.emplace(page.capacity - cursor, cursor);
+      }
+   }
+
+   bool BufferArena::AllocateFromPage(uint32_t pageIndex, GLsizeiptr size, GLsizeiptr alignment, GLintptr& outOffset)
+   {
+      Page& page = m_Pages[pageIndex];
+      if(page.capacity - page.used < size)
+         return false;
+
+      // best fit, smallest free range that still fits after alignment
+      for(auto it = page.freeBySize.lower_bound(size); it != page.freeBySize.end(); ++it)
+      {
+         GLintptr start = it->second;
+         GLintptr end = start + it->first;
+         GLintptr offset = AlignArenaOffset(start, alignment);
+         if(offset + size > end)
+            continue;
+
+         EraseFreeRange(page, page.freeByOffset.find(start));
+         if(offset > start)
+            InsertFreeRange(page, start, offset - start);
+         if(offset + size < end)
+            InsertFreeRange(page, offset + size, end - (offset + size));
+
+         outOffset = offset;
+         return true;
+      }
+      return false;
+   }
+
+   BufferArenaHandle BufferArena::Allocate(GLsizeiptr size, GLsizeiptr alignment /* = 4*/)
+   {
+      if(size <= 0)
+         return INVALID_HANDLE;
+      if(alignment <= 0)
+         alignment = 1;
+
+      uint32_t pageIndex = 0;
+      GLintptr offset = 0;
+      bool found = false;
+      for(; pageIndex < m_Pages.size(); pageIndex++)
+      {
+         if(AllocateFromPage(pageIndex, size, alignment, offset))
+         {
+            found = true;
+            break;
+         }
+      }
+
+      if(!found)
+      {
+         pageIndex = CreatePage(size + alignment - 1);
+         if(!AllocateFromPage(pageIndex, size, alignment, offset))
+         {
+            std::cout << "ERROR: BufferArena failed to allocate " << size << " bytes" << std::endl;
+            return INVALID_HANDLE;
+         }
+      }
+
+      BufferArenaHandle handle;
+      if(!m_FreeHandles.empty())
+      {
+         handle = m_FreeHandles.back();
+         m_FreeHandles.pop_back();
+      }
+      else
+      {
+         handle = (BufferArenaHandle)m_Blocks.size();
+         m_Blocks.emplace_back();
+      }
+
+      Page& page = m_Pages[pageIndex];
+      BufferArenaBlock& block = m_Blocks[handle];
+      block.buffer = page.buffer.get();
+      block.page = pageIndex;
+      block.offset = offset;
+      block.size = size;
+      block.alignment = alignment;
+
+      page.allocations[offset] = handle;
+      page.used += size;
+      return handle;
+   }
+
+   void BufferArena::Free(BufferArenaHandle handle)
+   {
+      if(handle >= m_Blocks.size() || m_Blocks[handle].buffer == nullptr)
+      {
+         std::cout << "ERROR: BufferArena::Free invalid handle " << handle << std::endl;
+         return;
+      }
+
+      BufferArenaBlock& block = m_Blocks[handle];
+      Page& page = m_Pages[block.page];
+      page.allocations.erase(block.offset);
+      page.used -= block.size;
+      InsertFreeRange(page, block.offset, block.size);
+
+      block = BufferArenaBlock();
+      m_FreeHandles.push_back(handle);
+   }
+
+   void BufferArena::Upload(BufferArenaHandle handle, const void* data, GLsizeiptr size, GLintptr offset /* = 0*/)
+   {
+      if(handle >= m_Blocks.size() || m_Blocks[handle].buffer == nullptr)
+      {
+         std::cout << "ERROR: BufferArena::Upload invalid handle " << handle << std::endl;
+         return;
+      }
+
+      const BufferArenaBlock& block = m_Blocks[handle];
+      if(offset < 0 || size < 0 || offset + size > block.size)
+      {
+         std::cout << "ERROR: BufferArena upload of " << size << " bytes at offset " << offset
+            << " is outside of the block of " << block.size << " bytes" << std::endl;
+         return;
+      }
+      block.buffer->BufferSubData(data, block.offset + offset, size);
+   }
+
+   void BufferArena::MoveBlock(BufferArenaBlock& block, GLintptr newOffset)
+   {
+      GLuint bufferID = *block.buffer;
+
+      // glCopyBufferSubData doesn't allow overlapping ranges inside the same buffer
+      if(newOffset + block.size > block.offset)
+      {
+         if(m_CopyBufferSize < block.size)
+         {
+            m_CopyBuffer = std::make_unique<GLBuffer>(GLBufferType::ARRAY_BUFFER);
+            m_CopyBuffer->BufferData(nullptr, (uint32_t)block.size, GLBufferUsage::STREAM_DRAW);
+            m_CopyBufferSize = block.size;
+         }
+
+         glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+         glBindBuffer(GL_COPY_WRITE_BUFFER, *m_CopyBuffer);
+         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, block.offset, 0, block.size);
+
+         glBindBuffer(GL_COPY_READ_BUFFER, *m_CopyBuffer);
+         glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, newOffset, block.size);
+      }
+      else
+      {
+         glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+         glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+         glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, block.offset, newOffset, block.size);
+      }
+
+      block.offset = newOffset;
+   }
+
+   GLsizeiptr BufferArena::Compact(GLsizeiptr maxBytes)
+   {
+      GLsizeiptr movedBytes = 0;
+      bool budgetLeft = true;
+
+      for(uint32_t pageIndex = 0; pageIndex < m_Pages.size() && budgetLeft; pageIndex++)
+      {
+         Page& page = m_Pages[pageIndex];
+         bool changed = false;
+
+         GLintptr cursor = 0;
+         for(auto it = page.allocations.begin(); it != page.allocations.end(); )
+         {
+            BufferArenaHandle handle = it->second;
+            BufferArenaBlock& block = m_Blocks[handle];
+
+            GLintptr target = AlignArenaOffset(cursor, block.alignment);
+            if(target >= block.offset)
+            {
+               cursor = block.offset + block.size;
+               ++it;
+               continue;
+            }
+
+            // always allow one move so blocks larger than the budget still get compacted
+            if(movedBytes > 0 && movedBytes + block.size > maxBytes)
+            {
+               budgetLeft = false;
+               break;
+            }
+
+            MoveBlock(block, target);
+            it = page.allocations.erase(it);
+            page.allocations.emplace_hint(it, target, handle);
+
+            cursor = target + block.size;
+            movedBytes += block.size;
+            changed = true;
+         }
+
+         if(changed)
+         {
+            RebuildFreeRanges(page);
+            m_Version++;
+         }
+      }
+
+      return movedBytes;
+   }
+
+   GLsizeiptr BufferArena::BytesUsed() const
+   {
+      GLsizeiptr used = 0;
+      for(const Page& page : m_Pages)
+         used += page.used;
+      return used;
+   }
+
+   GLsizeiptr BufferArena::BytesReserved() const
+   {
+      GLsizeiptr reserved = 0;
+      for(const Page& page : m_Pages)
+         reserved += page.capacity;
+      return reserved;
+   }
+} // namespace EaseGL
+#endif
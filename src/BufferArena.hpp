@@ -0,0 +1,115 @@
+#ifndef BUFFERARENA_H
+#define BUFFERARENA_H
+#pragma once
+
+#include <glad/glad.h>
+#include "GLBuffer.hpp"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace EaseGL
+{
+	typedef uint32_t BufferArenaHandle;
+
+	struct BufferArenaBlock
+	{
+		GLBuffer* buffer = nullptr;
+		uint32_t page = 0;
+		GLintptr offset = 0;
+		GLsizeiptr size = 0;
+		GLsizeiptr alignment = 1;
+
+		// Valid as base vertex / first index when the block was allocated with alignment == elementSize
+		GLint FirstElement(GLsizeiptr elementSize) const { return (GLint)(offset / elementSize); }
+	};
+
+	/**
+	 * @brief Sub-allocates ranges of a few large GLBuffers so many meshes can share one bound buffer.
+	 * Free ranges are kept sorted by offset (for coalescing on free) and by size (for best fit).
+	 * 
+	 * BufferArena arena(GLBufferType::ARRAY_BUFFER, 64 * 1024 * 1024);
+	 * BufferArenaHandle mesh = arena.Allocate(sizeof(Vertex) * count, sizeof(Vertex));
+	 * arena.Upload(mesh, vertices, sizeof(Vertex) * count);
+	 * 
+	 * const BufferArenaBlock& block = arena.Get(mesh);
+	 * block.buffer->Bind();
+	 * glDrawArrays(GL_TRIANGLES, block.FirstElement(sizeof(Vertex)), count);
+	 * 
+	 * Offsets can change after Compact(), query them with Get() instead of caching them.
+	 */
+	class BufferArena  
+	{
+		private:
+			struct Page
+			{
+				std::unique_ptr<GLBuffer> buffer;
+				GLsizeiptr capacity = 0;
+				GLsizeiptr used = 0;
+
+				std::map<GLintptr, GLsizeiptr> freeByOffset;
+				std::multimap<GLsizeiptr, GLintptr> freeBySize;
+				std::map<GLintptr, BufferArenaHandle> allocations; // offset -> handle
+			};
+
+			GLBufferType m_BufferType;
+			GLBufferUsage m_Usage;
+			GLsizeiptr m_PageSize;
+
+			std::vector<Page> m_Pages;
+
+			std::vector<BufferArenaBlock> m_Blocks; // indexed by handle
+			std::vector<BufferArenaHandle> m_FreeHandles;
+
+			// temporary storage for moves where source and destination overlap
+			std::unique_ptr<GLBuffer> m_CopyBuffer;
+			GLsizeiptr m_CopyBufferSize;
+
+			uint64_t m_Version;
+
+			uint32_t CreatePage(GLsizeiptr minimumSize);
+			bool AllocateFromPage(uint32_t pageIndex, GLsizeiptr size, GLsizeiptr alignment, GLintptr& outOffset);
+
+			void InsertFreeRange(Page& page, GLintptr offset, GLsizeiptr size);
+			void EraseFreeRange(Page& page, std::map<GLintptr, GLsizeiptr>::iterator it);
+			void RebuildFreeRanges(Page& page);
+
+			void MoveBlock(BufferArenaBlock& block, GLintptr newOffset);
+		public:
+			static constexpr BufferArenaHandle INVALID_HANDLE = 0xFFFFFFFF;
+
+			BufferArena(GLBufferType bufferType, GLsizeiptr pageSize, GLBufferUsage usage = GLBufferUsage::STATIC_DRAW);
+			~BufferArena();
+
+			BufferArena(const BufferArena&) = delete;
+			BufferArena& operator=(const BufferArena&) = delete;
+
+			/**
+			 * @param alignment doesn't have to be a power of two, use vertex size to be able to draw with a base vertex
+			 */
+			BufferArenaHandle Allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+			void Free(BufferArenaHandle handle);
+
+			const BufferArenaBlock& Get(BufferArenaHandle handle) const { return m_Blocks[handle]; }
+
+			void Upload(BufferArenaHandle handle, const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+			/**
+			 * @brief Incrementally slides allocations towards the start of their page with GPU side copies.
+			 * Call once per frame with a small budget to compact in the background.
+			 * 
+			 * @param maxBytes upper limit of bytes to move in this call
+			 * @return bytes moved, 0 if the arena is already compact
+			 */
+			GLsizeiptr Compact(GLsizeiptr maxBytes);
+
+			// Changes every time Compact() moves a block
+			uint64_t Version() const { return m_Version; }
+
+			size_t PageCount() const { return m_Pages.size(); }
+			GLsizeiptr BytesUsed() const;
+			GLsizeiptr BytesReserved() const;
+	};
+} // namespace EaseGL
+
+#endif
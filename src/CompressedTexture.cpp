@@ -0,0 +1,465 @@
+#include "CompressedTexture.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "GLContext.hpp"
+
+namespace EaseGL
+{
+   // containers are little endian, like every platform EaseGL runs on
+   uint32_t ReadContainerU32(const unsigned char* data)
+   {
+      uint32_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+   }
+
+   uint64_t ReadContainerU64(const unsigned char* data)
+   {
+      uint64_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+   }
+
+   // static
+   bool CompressedTexture::Load(const char* filepath, CompressedImage& image)
+   {
+      FILE* fp = fopen(filepath, "rb");
+      if(fp == nullptr)
+      {
+         std::cout << "ERROR on loading Texture " << filepath << std::endl;
+         return false;
+      }
+
+      std::vector<unsigned char> file;
+      fseek(fp, 0, SEEK_END);
+      long size = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      file.resize(size > 0 ? (size_t)size : 0);
+      file.resize(fread(file.data(), 1, file.size(), fp));
+      fclose(fp);
+
+      if(!LoadFromMemory(file.data(), file.size(), image))
+      {
+         std::cout << "ERROR: " << filepath << " is not a supported KTX, KTX2 or DDS texture" << std::endl;
+         return false;
+      }
+      return true;
+   }
+
+   // static
+   bool CompressedTexture::LoadFromMemory(const unsigned char* file, size_t size, CompressedImage& image)
+   {
+      static const unsigned char ktxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+      static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+      image = CompressedImage();
+      bool parsed = size >= 12 && memcmp(file, ktxIdentifier, 12) == 0 ? ParseKTX(file, size, image)
+         : size >= 12 && memcmp(file, ktx2Identifier, 12) == 0 ? ParseKTX2(file, size, image)
+         : size >= 4 && memcmp(file, "DDS ", 4) == 0 ? ParseDDS(file, size, image)
+         : false;
+      if(!parsed || image.format == CompressedFormat::NONE || image.levels.empty())
+      {
+         image = CompressedImage();
+         return false;
+      }
+
+      // the levels were located in 'file', copy only what they cover
+      size_t begin = image.levels.front().offset;
+      size_t end = image.levels.back().offset + image.levels.back().size;
+      for(const CompressedLevel& level : image.levels)
+      {
+         begin = std::min(begin, level.offset);
+         end = std::max(end, level.offset + level.size);
+      }
+      image.data.assign(file + begin, file + end);
+      for(CompressedLevel& level : image.levels)
+         level.offset -= begin;
+      return true;
+   }
+
+   // static
+   bool CompressedTexture::AddLevel(CompressedImage& image, size_t offset, size_t fileSize)
+   {
+      // a file claiming more levels than the size allows is corrupt, and shifting by 32 or more is undefined
+      int level = (int)image.levels.size();
+      if(level >= MaxLevelCount(image.width, image.height))
+         return false;
+      int width = std::max(image.width >> level, 1);
+      int height = std::max(image.height >> level, 1);
+      size_t size = LevelSize(image.format, width, height);
+      if(offset > fileSize || size > fileSize - offset)
+         return false;
+
+      image.levels.push_back({ width, height, offset, size });
+      return true;
+   }
+
+   // static
+   bool CompressedTexture::ParseKTX(const unsigned char* file, size_t size, CompressedImage& image)
+   {
+      if(size < 64 || ReadContainerU32(file + 12) != 0x04030201)
+         return false;
+
+      GLenum internalFormat = ReadContainerU32(file + 28);
+      image.width = (int)ReadContainerU32(file + 36);
+      image.height = (int)ReadContainerU32(file + 40);
+      uint32_t depth = ReadContainerU32(file + 44);
+      uint32_t arrayElements = ReadContainerU32(file + 48);
+      uint32_t faces = ReadContainerU32(file + 52);
+      uint32_t levelCount = std::max(ReadContainerU32(file + 56), 1u);
+      uint32_t keyValueBytes = ReadContainerU32(file + 60);
+      if(image.width <= 0 || image.height <= 0 || depth > 1 || arrayElements > 1 || faces != 1)
+         return false;
+
+      struct { GLenum gl; CompressedFormat format; bool srgb; } formats[] = {
+         { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, CompressedFormat::BC1_RGB, false },
+         { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, CompressedFormat::BC1_RGB, true },
+         { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, CompressedFormat::BC1_RGBA, false },
+         { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, CompressedFormat::BC1_RGBA, true },
+         { GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, CompressedFormat::BC2, false },
+         { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, CompressedFormat::BC2, true },
+         { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, CompressedFormat::BC3, false },
+         { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, CompressedFormat::BC3, true },
+         { GL_COMPRESSED_RED_RGTC1, CompressedFormat::BC4, false },
+         { GL_COMPRESSED_RG_RGTC2, CompressedFormat::BC5, false },
+         { GL_COMPRESSED_RGBA_BPTC_UNORM, CompressedFormat::BC7, false },
+         { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, CompressedFormat::BC7, true },
+         { GL_COMPRESSED_RGB8_ETC2, CompressedFormat::ETC2_RGB, false },
+         { GL_COMPRESSED_SRGB8_ETC2, CompressedFormat::ETC2_RGB, true },
+         { GL_COMPRESSED_RGBA8_ETC2_EAC, CompressedFormat::ETC2_RGBA, false },
+         { GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, CompressedFormat::ETC2_RGBA, true },
+      };
+      for(const auto& it : formats)
+      {
+         if(it.gl == internalFormat)
+         {
+            image.format = it.format;
+            image.srgb = it.srgb;
+         }
+      }
+      if(image.format == CompressedFormat::NONE)
+         return false;
+
+      // every level is prefixed with its size, block sizes keep everything 4 byte aligned
+      size_t offset = 64 + (size_t)keyValueBytes;
+      for(uint32_t level = 0; level < levelCount; level++)
+      {
+         if(offset + 4 > size)
+            return false;
+         offset += 4;
+         if(!AddLevel(image, offset, size))
+            return false;
+         offset += image.levels.back().size;
+      }
+      return true;
+   }
+
+   // static
+   bool CompressedTexture::ParseKTX2(const unsigned char* file, size_t size, CompressedImage& image)
+   {
+      if(size < 80)
+         return false;
+
+      uint32_t vkFormat = ReadContainerU32(file + 12);
+      image.width = (int)ReadContainerU32(file + 20);
+      image.height = (int)ReadContainerU32(file + 24);
+      uint32_t depth = ReadContainerU32(file + 28);
+      uint32_t layers = ReadContainerU32(file + 32);
+      uint32_t faces = ReadContainerU32(file + 36);
+      uint32_t levelCount = std::max(ReadContainerU32(file + 40), 1u);
+      uint32_t supercompression = ReadContainerU32(file + 44);
+      // Basis and zstd supercompressed files need a transcoder first
+      if(image.width <= 0 || image.height <= 0 || depth > 1 || layers > 1 || faces != 1 || supercompression != 0)
+         return false;
+      if(80 + (size_t)levelCount * 24 > size)
+         return false;
+
+      // VkFormat values, the _SRGB variant always follows the _UNORM one
+      switch(vkFormat)
+      {
+         case 131: case 132: image.format = CompressedFormat::BC1_RGB; image.srgb = vkFormat == 132; break;
+         case 133: case 134: image.format = CompressedFormat::BC1_RGBA; image.srgb = vkFormat == 134; break;
+         case 135: case 136: image.format = CompressedFormat::BC2; image.srgb = vkFormat == 136; break;
+         case 137: case 138: image.format = CompressedFormat::BC3; image.srgb = vkFormat == 138; break;
+         case 139: image.format = CompressedFormat::BC4; break;
+         case 141: image.format = CompressedFormat::BC5; break;
+         case 145: case 146: image.format = CompressedFormat::BC7; image.srgb = vkFormat == 146; break;
+         case 147: case 148: image.format = CompressedFormat::ETC2_RGB; image.srgb = vkFormat == 148; break;
+         case 151: case 152: image.format = CompressedFormat::ETC2_RGBA; image.srgb = vkFormat == 152; break;
+         default: return false;
+      }
+
+      // the level index follows the 80 byte header, level 0 first (the data itself is stored smallest first)
+      for(uint32_t level = 0; level < levelCount; level++)
+      {
+         uint64_t offset = ReadContainerU64(file + 80 + level * 24);
+         if(offset > size || !AddLevel(image, (size_t)offset, size))
+            return false;
+      }
+      return true;
+   }
+
+   // static
+   bool CompressedTexture::ParseDDS(const unsigned char* file, size_t size, CompressedImage& image)
+   {
+      if(size < 128)
+         return false;
+
+      const unsigned char* header = file + 4;
+      image.height = (int)ReadContainerU32(header + 8);
+      image.width = (int)ReadContainerU32(header + 12);
+      uint32_t flags = ReadContainerU32(header + 4);
+      uint32_t levelCount = (flags & 0x20000) != 0 ? std::max(ReadContainerU32(header + 24), 1u) : 1; // DDSD_MIPMAPCOUNT
+      uint32_t pixelFormatFlags = ReadContainerU32(header + 76);
+      uint32_t fourCC = ReadContainerU32(header + 80);
+      uint32_t caps2 = ReadContainerU32(header + 108);
+      if(image.width <= 0 || image.height <= 0 || (pixelFormatFlags & 0x4) == 0 || (caps2 & 0x200000 /* volume */) != 0 || (caps2 & 0x200 /* cube map */) != 0)
+         return false;
+
+      auto FourCC = [](const char* code) { return ReadContainerU32((const unsigned char*)code); };
+      size_t offset = 128;
+      if(fourCC == FourCC("DX10"))
+      {
+         if(size < 148)
+            return false;
+         uint32_t dxgiFormat = ReadContainerU32(file + 128);
+         uint32_t dimension = ReadContainerU32(file + 132);
+         uint32_t miscFlags = ReadContainerU32(file + 136);
+         uint32_t arraySize = ReadContainerU32(file + 140);
+         if(dimension != 3 /* TEXTURE2D */ || arraySize > 1 || (miscFlags & 0x4 /* cube map */) != 0)
+            return false;
+         offset = 148;
+
+         // DXGI_FORMAT values, _UNORM_SRGB follows _UNORM
+         switch(dxgiFormat)
+         {
+            case 71: case 72: image.format = CompressedFormat::BC1_RGBA; image.srgb = dxgiFormat == 72; break;
+            case 74: case 75: image.format = CompressedFormat::BC2; image.srgb = dxgiFormat == 75; break;
+            case 77: case 78: image.format = CompressedFormat::BC3; image.srgb = dxgiFormat == 78; break;
+            case 80: image.format = CompressedFormat::BC4; break;
+            case 83: image.format = CompressedFormat::BC5; break;
+            case 98: case 99: image.format = CompressedFormat::BC7; image.srgb = dxgiFormat == 99; break;
+            default: return false;
+         }
+      }
+      // DXT1 may use its transparent mode, decode it as RGBA to keep that
+      else if(fourCC == FourCC("DXT1"))
+         image.format = CompressedFormat::BC1_RGBA;
+      else if(fourCC == FourCC("DXT3"))
+         image.format = CompressedFormat::BC2;
+      else if(fourCC == FourCC("DXT5"))
+         image.format = CompressedFormat::BC3;
+      else if(fourCC == FourCC("ATI1") || fourCC == FourCC("BC4U"))
+         image.format = CompressedFormat::BC4;
+      else if(fourCC == FourCC("ATI2") || fourCC == FourCC("BC5U"))
+         image.format = CompressedFormat::BC5;
+      else
+         return false;
+
+      for(uint32_t level = 0; level < levelCount; level++)
+      {
+         if(!AddLevel(image, offset, size))
+            return false;
+         offset += image.levels.back().size;
+      }
+      return true;
+   }
+
+   // static
+   int CompressedTexture::MaxLevelCount(int width, int height)
+   {
+      int levels = 1;
+      for(int size = std::max(width, height); size > 1; size >>= 1)
+         levels++;
+      return levels;
+   }
+
+   // static
+   GLenum CompressedTexture::GetGLFormat(CompressedFormat format, bool srgb)
+   {
+      switch(format)
+      {
+         case CompressedFormat::BC1_RGB: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+         case CompressedFormat::BC1_RGBA: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+         case CompressedFormat::BC2: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT : GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+         case CompressedFormat::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+         case CompressedFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+         case CompressedFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+         case CompressedFormat::BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+         case CompressedFormat::ETC2_RGB: return srgb ? GL_COMPRESSED_SRGB8_ETC2 : GL_COMPRESSED_RGB8_ETC2;
+         case CompressedFormat::ETC2_RGBA: return srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC : GL_COMPRESSED_RGBA8_ETC2_EAC;
+         default: return GL_NONE;
+      }
+   }
+
+   // static
+   bool CompressedTexture::IsSupported(CompressedFormat format, bool srgb)
+   {
+      switch(format)
+      {
+         case CompressedFormat::BC1_RGB:
+         case CompressedFormat::BC1_RGBA:
+         case CompressedFormat::BC2:
+         case CompressedFormat::BC3:
+            if(!GLContext::HasExtension("GL_EXT_texture_compression_s3tc"))
+               return false;
+            return !srgb || GLContext::HasExtension("GL_EXT_texture_sRGB") || GLContext::HasExtension("GL_EXT_texture_compression_s3tc_srgb");
+         case CompressedFormat::BC4:
+         case CompressedFormat::BC5:
+            return GLContext::HasVersion(3, 0) || GLContext::HasExtension("GL_ARB_texture_compression_rgtc");
+         case CompressedFormat::BC7:
+            return GLContext::HasVersion(4, 2) || GLContext::HasExtension("GL_ARB_texture_compression_bptc");
+         case CompressedFormat::ETC2_RGB:
+         case CompressedFormat::ETC2_RGBA:
+            return GLContext::HasVersion(4, 3) || GLContext::HasExtension("GL_ARB_ES3_compatibility");
+         default:
+            return false;
+      }
+   }
+
+   // static
+   int CompressedTexture::BlockSize(CompressedFormat format)
+   {
+      return format == CompressedFormat::BC1_RGB || format == CompressedFormat::BC1_RGBA || format == CompressedFormat::BC4 || format == CompressedFormat::ETC2_RGB ? 8
+         : format == CompressedFormat::NONE ? 0
+         : 16;
+   }
+
+   // static
+   size_t CompressedTexture::LevelSize(CompressedFormat format, int width, int height)
+   {
+      return (size_t)((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+   }
+
+   // static
+   int CompressedTexture::DecodedChannels(CompressedFormat format)
+   {
+      return format == CompressedFormat::BC1_RGB || format == CompressedFormat::BC1_RGBA || format == CompressedFormat::BC2 || format == CompressedFormat::BC3 ? 4
+         : format == CompressedFormat::BC4 ? 1
+         : format == CompressedFormat::BC5 ? 2
+         : 0;
+   }
+
+   // 4x4 RGBA from a BC1 color block. BC2/BC3 color blocks always use the 4 color mode ('fourColors').
+   // BC1 switches to 3 colors plus black when c0 <= c1, 'punchThroughAlpha' makes that black transparent (BC1_RGBA)
+   void DecodeBC1Block(const unsigned char* block, unsigned char* rgba, bool fourColors, bool punchThroughAlpha)
+   {
+      uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+      uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+      uint32_t indices = ReadContainerU32(block + 4);
+
+      unsigned char colors[4][4];
+      for(int i = 0; i < 2; i++)
+      {
+         uint16_t c = i == 0 ? c0 : c1;
+         int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+         colors[i][0] = (unsigned char)((r << 3) | (r >> 2));
+         colors[i][1] = (unsigned char)((g << 2) | (g >> 4));
+         colors[i][2] = (unsigned char)((b << 3) | (b >> 2));
+         colors[i][3] = 255;
+      }
+      for(int channel = 0; channel < 3; channel++)
+      {
+         int a = colors[0][channel], b = colors[1][channel];
+         if(c0 > c1 || fourColors)
+         {
+            colors[2][channel] = (unsigned char)((2 * a + b + 1) / 3);
+            colors[3][channel] = (unsigned char)((a + 2 * b + 1) / 3);
+         }
+         else
+         {
+            colors[2][channel] = (unsigned char)((a + b + 1) / 2);
+            colors[3][channel] = 0;
+         }
+      }
+      colors[2][3] = 255;
+      colors[3][3] = c0 > c1 || fourColors || !punchThroughAlpha ? 255 : 0;
+
+      for(int i = 0; i < 16; i++)
+         memcpy(rgba + i * 4, colors[(indices >> (i * 2)) & 3], 4);
+   }
+
+   // 4x4 values from a BC4 block (also BC3 alpha and both BC5 channels), written 'stride' bytes apart
+   void DecodeBC4Block(const unsigned char* block, unsigned char* out, int stride)
+   {
+      int v0 = block[0], v1 = block[1];
+      unsigned char values[8] = { (unsigned char)v0, (unsigned char)v1 };
+      if(v0 > v1)
+      {
+         for(int i = 1; i < 7; i++)
+            values[i + 1] = (unsigned char)(((7 - i) * v0 + i * v1 + 3) / 7);
+      }
+      else
+      {
+         for(int i = 1; i < 5; i++)
+            values[i + 1] = (unsigned char)(((5 - i) * v0 + i * v1 + 2) / 5);
+         values[6] = 0;
+         values[7] = 255;
+      }
+
+      uint64_t indices = 0;
+      for(int i = 0; i < 6; i++)
+         indices |= (uint64_t)block[2 + i] << (i * 8);
+      for(int i = 0; i < 16; i++)
+         out[i * stride] = values[(indices >> (i * 3)) & 7];
+   }
+
+   // static
+   bool CompressedTexture::Decode(CompressedFormat format, int width, int height, const unsigned char* blocks, unsigned char* pixels)
+   {
+      int channels = DecodedChannels(format);
+      if(channels == 0)
+         return false;
+
+      int blockSize = BlockSize(format);
+      unsigned char texels[16 * 4];
+      for(int by = 0; by < (height + 3) / 4; by++)
+      {
+         for(int bx = 0; bx < (width + 3) / 4; bx++, blocks += blockSize)
+         {
+            switch(format)
+            {
+               case CompressedFormat::BC1_RGB:
+               case CompressedFormat::BC1_RGBA:
+                  DecodeBC1Block(blocks, texels, false, format == CompressedFormat::BC1_RGBA);
+                  break;
+               case CompressedFormat::BC2:
+                  DecodeBC1Block(blocks + 8, texels, true, false);
+                  for(int i = 0; i < 16; i++)
+                     texels[i * 4 + 3] = (unsigned char)(((blocks[i / 2] >> ((i & 1) * 4)) & 15) * 17);
+                  break;
+               case CompressedFormat::BC3:
+                  DecodeBC1Block(blocks + 8, texels, true, false);
+                  DecodeBC4Block(blocks, texels + 3, 4);
+                  break;
+               case CompressedFormat::BC4:
+                  DecodeBC4Block(blocks, texels, 1);
+                  break;
+               case CompressedFormat::BC5:
+                  DecodeBC4Block(blocks, texels, 2);
+                  DecodeBC4Block(blocks + 8, texels + 1, 2);
+                  break;
+               default:
+                  return false;
+            }
+
+            // blocks on the right and bottom edge can hang over the image
+            int copyWidth = std::min(4, width - bx * 4);
+            for(int y = 0; y < 4 && by * 4 + y < height; y++)
+            {
+               unsigned char* row = pixels + ((size_t)(by * 4 + y) * width + bx * 4) * channels;
+               memcpy(row, texels + y * 4 * channels, (size_t)copyWidth * channels);
+            }
+         }
+      }
+      return true;
+   }
+} // namespace EaseGL
+#endif
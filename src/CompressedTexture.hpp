@@ -0,0 +1,93 @@
+#ifndef COMPRESSEDTEXTURE_H
+#define COMPRESSEDTEXTURE_H
+#pragma once
+
+#include <glad/glad.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Not core in any GL version, glad only has them when the extensions were selected
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace EaseGL
+{
+	enum class CompressedFormat
+	{
+		NONE = 0,
+		BC1_RGB,   // DXT1
+		BC1_RGBA,  // DXT1 with 1 bit alpha
+		BC2,       // DXT3
+		BC3,       // DXT5
+		BC4,       // RGTC1, single channel
+		BC5,       // RGTC2, two channels
+		BC7,       // BPTC
+		ETC2_RGB,
+		ETC2_RGBA, // ETC2 + EAC alpha
+	};
+
+	struct CompressedLevel
+	{
+		int width, height;
+		size_t offset; // into CompressedImage::data
+		size_t size;
+	};
+
+	struct CompressedImage
+	{
+		CompressedFormat format = CompressedFormat::NONE;
+		bool srgb = false;
+		int width = 0, height = 0;
+		std::vector<CompressedLevel> levels; // level 0 first, as many as the file stores
+		std::vector<unsigned char> data;
+
+		const unsigned char* LevelData(size_t level) const { return data.data() + levels[level].offset; }
+	};
+
+	/**
+	 * @brief Reads block compressed 2D images from KTX, KTX2 and DDS containers, see GLTexture::LoadCompressed().
+	 * Formats the driver can't sample are decoded on the CPU where a decoder exists (BC1-BC5).
+	 */
+	class CompressedTexture
+	{
+		private:
+			CompressedTexture() {}
+
+			static bool ParseKTX(const unsigned char* file, size_t size, CompressedImage& image);
+			static bool ParseKTX2(const unsigned char* file, size_t size, CompressedImage& image);
+			static bool ParseDDS(const unsigned char* file, size_t size, CompressedImage& image);
+			// fills 'image.levels' from level sizes, false if a level runs past 'size' or the chain is longer than MaxLevelCount()
+			static bool AddLevel(CompressedImage& image, size_t offset, size_t fileSize);
+		public:
+			/** @brief Detects the container from its header, false if it is unknown, not 2D or holds an unsupported format */
+			static bool Load(const char* filepath, CompressedImage& image);
+			static bool LoadFromMemory(const unsigned char* file, size_t size, CompressedImage& image);
+
+			static GLenum GetGLFormat(CompressedFormat format, bool srgb);
+			/** @brief The context can upload 'format' with glCompressedTexImage2D */
+			static bool IsSupported(CompressedFormat format, bool srgb);
+
+			/** @brief Levels of a full chain down to 1x1, floor(log2(max(width, height))) + 1 */
+			static int MaxLevelCount(int width, int height);
+			static int BlockSize(CompressedFormat format);
+			static size_t LevelSize(CompressedFormat format, int width, int height);
+
+			/** @brief Channels Decode() writes, 0 if there is no CPU decoder for 'format' */
+			static int DecodedChannels(CompressedFormat format);
+			/** @brief Decodes one level to 8 bit pixels with DecodedChannels() channels */
+			static bool Decode(CompressedFormat format, int width, int height, const unsigned char* blocks, unsigned char* pixels);
+	};
+} // namespace EaseGL
+
+#endif
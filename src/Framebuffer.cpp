@@ -4,6 +4,8 @@
 #include <glad/glad.h>
 #include <iostream>
 
+#include "GLContext.hpp"
+
 namespace EaseGL
 {
    Framebuffer::Framebuffer()
@@ -14,7 +16,49 @@ namespace EaseGL
       
    Framebuffer::~Framebuffer()
    {
-      
+      DeleteBuffer();
+   }
+
+   Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+      : m_BufferID(other.m_BufferID), m_Handle(other.m_Handle),
+      m_ColorAttachments(std::move(other.m_ColorAttachments)), m_DepthAttachment(other.m_DepthAttachment)
+   {
+      other.m_BufferID = 0;
+      other.m_Handle = GLHandle();
+      other.m_ColorAttachments.clear();
+      other.m_DepthAttachment = Attachment();
+   }
+
+   Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteBuffer();
+
+         m_BufferID = other.m_BufferID;
+         m_Handle = other.m_Handle;
+         m_ColorAttachments = std::move(other.m_ColorAttachments);
+         m_DepthAttachment = other.m_DepthAttachment;
+
+         other.m_BufferID = 0;
+         other.m_Handle = GLHandle();
+         other.m_ColorAttachments.clear();
+         other.m_DepthAttachment = Attachment();
+      }
+      return *this;
+   }
+
+   void Framebuffer::DeleteBuffer()
+   {
+      for(Attachment& attachment : m_ColorAttachments)
+         GLObjectPool::Destroy(attachment.handle);
+      m_ColorAttachments.clear();
+
+      GLObjectPool::Destroy(m_DepthAttachment.handle);
+      m_DepthAttachment = Attachment();
+
+      GLObjectPool::Destroy(m_Handle);
+      m_BufferID = 0;
    }
    
    bool IsColorAttachment(FramebufferAttachmentFormat format)
@@ -51,13 +95,10 @@ namespace EaseGL
 
    void Framebuffer::RecreateBuffer(const FrameBufferCreateInfo& createInfo)
    {
-      if(m_BufferID != 0)
-      {
-         glDeleteFramebuffers(1, &m_BufferID);
-         m_BufferID = 0;
-      }
+      DeleteBuffer();
 
-      glGenFramebuffers(1, &m_BufferID);
+      m_Handle = GLObjectPool::Create(GLObjectType::FRAMEBUFFER);
+      m_BufferID = GLObjectPool::Name(m_Handle);
       glBindFramebuffer(GL_FRAMEBUFFER, m_BufferID);
 
       bool hasDepthAttachment = false;
@@ -71,14 +112,17 @@ namespace EaseGL
       }
       
       for(int i=0; i<m_ColorAttachments.size(); i++)
-         glGenTextures(1, &m_ColorAttachments[i].id);
+      {
+         m_ColorAttachments[i].handle = GLObjectPool::Create(GLObjectType::TEXTURE);
+         m_ColorAttachments[i].id = GLObjectPool::Name(m_ColorAttachments[i].handle);
+      }
 
       if(createInfo.samples > 1)
          std::cout << "SAMPLES DOESNT WORK" << std::endl;
 
       for(int i = 0; i < m_ColorAttachments.size(); i++)
       {
-         glBindTexture(GL_TEXTURE_2D, m_ColorAttachments[i].id);
+         GLContext::BindTextureOnActiveUnit(GL_TEXTURE_2D, m_ColorAttachments[i].id);
          glTexImage2D(GL_TEXTURE_2D, 0, // level
                GetAttachmentInternalFormat(m_ColorAttachments[i].format), // internal format
                createInfo.width, createInfo.height,
@@ -96,7 +140,8 @@ namespace EaseGL
 
       if(hasDepthAttachment)
       {
-         glGenRenderbuffers(1, &m_DepthAttachment.id);
+         m_DepthAttachment.handle = GLObjectPool::Create(GLObjectType::RENDERBUFFER);
+         m_DepthAttachment.id = GLObjectPool::Name(m_DepthAttachment.handle);
          glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment.id);
          glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, createInfo.width, createInfo.height);
          glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment.id);
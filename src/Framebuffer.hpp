@@ -4,6 +4,7 @@
 
 #include <glad/glad.h>
 #include "Texture.hpp"
+#include "GLObjectPool.hpp"
 #include <vector>
 
 namespace EaseGL
@@ -36,10 +37,12 @@ namespace EaseGL
 	{
 		private:
 			GLuint m_BufferID;
+			GLHandle m_Handle;
 			
 			struct Attachment
 			{
 				GLuint id;
+				GLHandle handle;
 				FramebufferAttachmentFormat format;
 
 				Attachment()
@@ -48,16 +51,23 @@ namespace EaseGL
 				}
 
 				Attachment(GLuint _id, FramebufferAttachmentFormat _format)
-					: id(id), format(_format)
+					: id(_id), format(_format)
 				{
 				}
 			};
 			std::vector<Attachment> m_ColorAttachments; // Texture2D
 			Attachment m_DepthAttachment;// RenderBufferObject
+
+			void DeleteBuffer();
 		public:
 			Framebuffer();
 			~Framebuffer();
 
+			Framebuffer(const Framebuffer&) = delete;
+			Framebuffer& operator=(const Framebuffer&) = delete;
+			Framebuffer(Framebuffer&& other) noexcept;
+			Framebuffer& operator=(Framebuffer&& other) noexcept;
+
 			// Create/Recreate framebuffer
 			void RecreateBuffer(const FrameBufferCreateInfo& createInfo);
 
@@ -65,6 +75,7 @@ namespace EaseGL
 			void Unbind();
 
 			operator GLuint() { return m_BufferID; }
+			GLHandle Handle() const { return m_Handle; }
 
 			GLuint GetColorAttachment(int at = 0) const { return m_ColorAttachments[at].id; }
 	};
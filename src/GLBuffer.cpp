@@ -4,40 +4,94 @@
 #include <glad/glad.h>
 
 #include <cassert>
+#include <cstring>
+#include <iostream>
 
 namespace EaseGL
 {
    GLBuffer::GLBuffer(GLBufferType bufferType)
-      : m_BufferType(bufferType), m_BufferID(0)
+      : m_BufferType(bufferType), m_BufferID(0), m_Size(0), m_Usage(GLBufferUsage::NONE),
+      m_UploadStrategy(GLBufferUploadStrategy::AUTO), m_RingHead(0), m_RingSegment(0), m_RingFences(), m_Immutable(false)
    {
       RecreateBuffer();
    }
 
    GLBuffer::GLBuffer() 
-      : m_BufferType(GLBufferType::NONE), m_BufferID(0)
+      : m_BufferType(GLBufferType::NONE), m_BufferID(0), m_Size(0), m_Usage(GLBufferUsage::NONE),
+      m_UploadStrategy(GLBufferUploadStrategy::AUTO), m_RingHead(0), m_RingSegment(0), m_RingFences(), m_Immutable(false)
    {
    }
       
    GLBuffer::~GLBuffer()
    {
-      if(m_BufferID != 0)
-         glDeleteBuffers(1, &m_BufferID);
+      DeleteRingFences();
+      GLObjectPool::Destroy(m_Handle);
    }
 
-   void GLBuffer::RecreateBuffer() 
+   GLBuffer::GLBuffer(GLBuffer&& other) noexcept
+      : m_BufferType(GLBufferType::NONE), m_BufferID(0), m_Size(0), m_Usage(GLBufferUsage::NONE),
+      m_UploadStrategy(GLBufferUploadStrategy::AUTO), m_RingHead(0), m_RingSegment(0), m_RingFences(), m_Immutable(false)
    {
-      if(m_BufferID != 0) {
-         glDeleteBuffers(1, &m_BufferID);
+      MoveFrom(other);
+   }
+
+   GLBuffer& GLBuffer::operator=(GLBuffer&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteRingFences();
+         GLObjectPool::Destroy(m_Handle);
+         MoveFrom(other);
       }
+      return *this;
+   }
 
-      glGenBuffers(1, &m_BufferID);
+   void GLBuffer::MoveFrom(GLBuffer& other)
+   {
+      m_BufferType = other.m_BufferType;
+      m_BufferID = other.m_BufferID;
+      m_Handle = other.m_Handle;
+      m_Size = other.m_Size;
+      m_Usage = other.m_Usage;
+      m_UploadStrategy = other.m_UploadStrategy;
+      m_Immutable = other.m_Immutable;
+      m_RingHead = other.m_RingHead;
+      m_RingSegment = other.m_RingSegment;
+      for(int i = 0; i < RING_SEGMENTS; i++)
+      {
+         m_RingFences[i] = other.m_RingFences[i];
+         other.m_RingFences[i] = nullptr;
+      }
+
+      other.m_BufferID = 0;
+      other.m_Handle = GLHandle();
+      other.m_Size = 0;
+      other.m_Immutable = false;
+      other.m_RingHead = 0;
+      other.m_RingSegment = 0;
+   }
+
+   void GLBuffer::RecreateBuffer() 
+   {
+      DeleteRingFences();
+      GLObjectPool::Destroy(m_Handle);
+      m_Size = 0;
+      m_Immutable = false;
+
+      m_Handle = GLObjectPool::Create(GLObjectType::BUFFER);
+      m_BufferID = GLObjectPool::Name(m_Handle);
       glBindBuffer(GetGLBufferType(), m_BufferID);
    }
 
-   void GLBuffer::BufferData(const void* data, uint32_t size, GLBufferUsage usage) const
+   void GLBuffer::BufferData(const void* data, uint32_t size, GLBufferUsage usage)
    {
       glBindBuffer(GetGLBufferType(), m_BufferID);
       glBufferData(GetGLBufferType(), size, data, GetGLBufferUsage(usage));
+
+      m_Size = size;
+      m_Usage = usage;
+      // new storage isn't used by the GPU, ring can start over
+      DeleteRingFences();
    }
 
    void GLBuffer::BufferSubData(const void* data, GLintptr offset, GLsizeiptr size) const
@@ -46,17 +100,187 @@ namespace EaseGL
       glBufferSubData(GetGLBufferType(), offset, size, data);
    }
 
+   void GLBuffer::BufferStorage(const void* data, GLsizeiptr size, GLbitfield flags)
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+      glBufferStorage(GetGLBufferType(), size, data, flags);
+      m_Size = size;
+      m_Immutable = true;
+   }
+
+   GLBufferUploadStrategy GLBuffer::GetUploadStrategy() const
+   {
+      if(m_UploadStrategy != GLBufferUploadStrategy::AUTO)
+         return m_UploadStrategy;
+
+      // ORPHAN and MAP_UNSYNCHRONIZED change what 'offset' means, they have to be chosen explicitly
+      return m_Usage == GLBufferUsage::STREAM_DRAW ? GLBufferUploadStrategy::MAP_INVALIDATE
+         : m_Usage == GLBufferUsage::DYNAMIC_DRAW ? GLBufferUploadStrategy::MAP_INVALIDATE
+         : GLBufferUploadStrategy::SUB_DATA;
+   }
+
+   GLintptr GLBuffer::Upload(const void* data, GLsizeiptr size, GLintptr offset /* = 0*/)
+   {
+      GLBufferUploadStrategy strategy = GetUploadStrategy();
+
+      // data doesn't fit, storage has to be respecified anyway
+      if(offset + size > m_Size)
+      {
+         if(m_Immutable)
+         {
+            std::cout << "ERROR: Upload() of " << size << " bytes at offset " << offset
+               << " doesn't fit the " << m_Size << " byte immutable buffer storage" << std::endl;
+            return -1;
+         }
+
+         // the ring starts over on the new store and keeps its head, so the next upload is fenced properly
+         if(strategy == GLBufferUploadStrategy::MAP_UNSYNCHRONIZED)
+         {
+            Grow(size, 0);
+            return UploadUnsynchronized(data, size);
+         }
+
+         // orphaning drops old contents by definition, the other strategies keep them
+         Grow(offset + size, strategy == GLBufferUploadStrategy::ORPHAN ? 0 : offset);
+         BufferSubData(data, offset, size);
+         return offset;
+      }
+
+      if(strategy == GLBufferUploadStrategy::ORPHAN)
+      {
+         glBindBuffer(GetGLBufferType(), m_BufferID);
+         glBufferData(GetGLBufferType(), m_Size, nullptr, GetGLBufferUsage(m_Usage));
+         glBufferSubData(GetGLBufferType(), offset, size, data);
+         return offset;
+      }
+      else if(strategy == GLBufferUploadStrategy::MAP_INVALIDATE)
+      {
+         void* pointer = MapBufferRange(offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+         if(pointer != nullptr)
+         {
+            memcpy(pointer, data, size);
+            UnmapBuffer();
+         }
+         return offset;
+      }
+      else if(strategy == GLBufferUploadStrategy::MAP_UNSYNCHRONIZED)
+      {
+         return UploadUnsynchronized(data, size);
+      }
+
+      BufferSubData(data, offset, size);
+      return offset;
+   }
+
+   void GLBuffer::Grow(GLsizeiptr size, GLsizeiptr keepBytes)
+   {
+      GLBufferUsage usage = m_Usage != GLBufferUsage::NONE ? m_Usage : GLBufferUsage::DYNAMIC_DRAW;
+      if(keepBytes > m_Size)
+         keepBytes = m_Size;
+      if(keepBytes <= 0)
+      {
+         BufferData(nullptr, (uint32_t)size, usage);
+         return;
+      }
+
+      // glBufferData drops the old store, park the bytes that survive in a temporary buffer.
+      // The name stays the same, so vertex arrays and binding points referencing the buffer stay valid
+      GLHandle temp = GLObjectPool::Create(GLObjectType::BUFFER);
+      glBindBuffer(GL_COPY_READ_BUFFER, m_BufferID);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, GLObjectPool::Name(temp));
+      glBufferData(GL_COPY_WRITE_BUFFER, keepBytes, nullptr, GL_STREAM_COPY);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+
+      BufferData(nullptr, (uint32_t)size, usage);
+
+      glBindBuffer(GL_COPY_READ_BUFFER, GLObjectPool::Name(temp));
+      glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+      GLObjectPool::Destroy(temp);
+   }
+
+   GLintptr GLBuffer::UploadUnsynchronized(const void* data, GLsizeiptr size)
+   {
+      GLsizeiptr segmentSize = (m_Size + RING_SEGMENTS - 1) / RING_SEGMENTS;
+
+      GLintptr offset = ((m_RingHead + 15) / 16) * 16;
+      if(offset + size > m_Size)
+         offset = 0; // wrap
+
+      // entering a segment: fence the one that is left and wait for the GPU to release the new one
+      bool wrapped = offset == 0 && m_RingHead != 0;
+      int firstSegment = (int)(offset / segmentSize);
+      int lastSegment = (int)((offset + size - 1) / segmentSize);
+      for(int segment = firstSegment; segment <= lastSegment; segment++)
+      {
+         if(segment == m_RingSegment && !wrapped)
+            continue;
+         wrapped = false;
+
+         if(m_RingFences[m_RingSegment] != nullptr)
+            glDeleteSync(m_RingFences[m_RingSegment]);
+         m_RingFences[m_RingSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+         m_RingSegment = segment;
+
+         GLsync& fence = m_RingFences[segment];
+         if(fence != nullptr)
+         {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = nullptr;
+         }
+      }
+
+      void* pointer = MapBufferRange(offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+      if(pointer != nullptr)
+      {
+         memcpy(pointer, data, size);
+         UnmapBuffer();
+      }
+
+      m_RingHead = offset + size;
+      return offset;
+   }
+
+   void GLBuffer::DeleteRingFences()
+   {
+      for(int i = 0; i < RING_SEGMENTS; i++)
+      {
+         if(m_RingFences[i] != nullptr)
+            glDeleteSync(m_RingFences[i]);
+         m_RingFences[i] = nullptr;
+      }
+      m_RingHead = 0;
+      m_RingSegment = 0;
+   }
+
    void* GLBuffer::MapBuffer() 
    {
       void* pointer = glMapBuffer(GetGLBufferType(), GL_READ_WRITE); 
       return pointer;
    }
 
+   void* GLBuffer::MapBufferRange(GLintptr offset, GLsizeiptr length, GLbitfield access)
+   {
+      glBindBuffer(GetGLBufferType(), m_BufferID);
+      return glMapBufferRange(GetGLBufferType(), offset, length, access);
+   }
+
    void GLBuffer::UnmapBuffer() 
    {
       glUnmapBuffer(GetGLBufferType());
    }
 
+   void GLBuffer::BindBufferBase(GLuint bufferIndex)
+   {
+      glBindBufferBase(GetGLBufferType(), bufferIndex, m_BufferID);
+   }
+
+   void GLBuffer::BindBufferRange(GLuint bufferIndex, GLintptr offset, GLsizeiptr size)
+   {
+      glBindBufferRange(GetGLBufferType(), bufferIndex, m_BufferID, offset, size);
+   }
+
 
    void GLBuffer::Bind()  const
    {
@@ -68,6 +292,10 @@ namespace EaseGL
       return m_BufferType == GLBufferType::ARRAY_BUFFER ? GL_ARRAY_BUFFER
          : m_BufferType == GLBufferType::ELEMENT_ARRAY_BUFFER ? GL_ELEMENT_ARRAY_BUFFER
          : m_BufferType == GLBufferType::UNIFORM_BUFFER ? GL_UNIFORM_BUFFER
+         : m_BufferType == GLBufferType::SHADER_STORAGE_BUFFER ? GL_SHADER_STORAGE_BUFFER
+         : m_BufferType == GLBufferType::DISPATCH_INDIRECT_BUFFER ? GL_DISPATCH_INDIRECT_BUFFER
+         : m_BufferType == GLBufferType::DRAW_INDIRECT_BUFFER ? GL_DRAW_INDIRECT_BUFFER
+         : m_BufferType == GLBufferType::PIXEL_UNPACK_BUFFER ? GL_PIXEL_UNPACK_BUFFER
          : GL_NONE; 
    }
 
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <glad/glad.h>
+#include "GLObjectPool.hpp"
 
 namespace EaseGL
 {
@@ -12,6 +13,10 @@ namespace EaseGL
 		ARRAY_BUFFER,
 		ELEMENT_ARRAY_BUFFER,
 		UNIFORM_BUFFER,
+		SHADER_STORAGE_BUFFER,
+		DISPATCH_INDIRECT_BUFFER,
+		DRAW_INDIRECT_BUFFER,
+		PIXEL_UNPACK_BUFFER,
 	};
 
 	enum class GLBufferUsage
@@ -22,6 +27,15 @@ namespace EaseGL
 		STREAM_DRAW,
 	};
 
+	enum class GLBufferUploadStrategy
+	{
+		AUTO = 0,           // picked from GLBufferUsage
+		SUB_DATA,           // glBufferSubData
+		ORPHAN,             // respecify storage with glBufferData(NULL) then glBufferSubData, previous contents are lost
+		MAP_INVALIDATE,     // glMapBufferRange with GL_MAP_INVALIDATE_RANGE_BIT
+		MAP_UNSYNCHRONIZED, // appends to a ring inside the buffer with GL_MAP_UNSYNCHRONIZED_BIT, guarded by fences
+	};
+
 	class GLBuffer  
 	{
 		private:
@@ -31,6 +45,26 @@ namespace EaseGL
 			GLenum GetGLBufferUsage(GLBufferUsage usage) const;
 
 			GLuint m_BufferID;
+			GLHandle m_Handle;
+
+			GLsizeiptr m_Size;
+			GLBufferUsage m_Usage;
+			GLBufferUploadStrategy m_UploadStrategy;
+
+			// MAP_UNSYNCHRONIZED ring state, the buffer is split into RING_SEGMENTS fenced segments
+			static constexpr int RING_SEGMENTS = 4;
+			GLintptr m_RingHead;
+			int m_RingSegment;
+			GLsync m_RingFences[RING_SEGMENTS];
+
+			// set by BufferStorage(), the store can't be respecified
+			bool m_Immutable;
+
+			// respecifies the store with 'size' bytes, the first 'keepBytes' of the old store are copied over
+			void Grow(GLsizeiptr size, GLsizeiptr keepBytes);
+			GLintptr UploadUnsynchronized(const void* data, GLsizeiptr size);
+			void DeleteRingFences();
+			void MoveFrom(GLBuffer& other);
 
 			friend class Shader;
 		public:
@@ -39,19 +73,52 @@ namespace EaseGL
 			GLBuffer(GLBufferType bufferType);
 			~GLBuffer();
 
+			GLBuffer(const GLBuffer&) = delete;
+			GLBuffer& operator=(const GLBuffer&) = delete;
+			GLBuffer(GLBuffer&& other) noexcept;
+			GLBuffer& operator=(GLBuffer&& other) noexcept;
+
 			/**
 			 * @brief Call when buffer objects needs to be created/recreated
 			 */
 			void RecreateBuffer();
 
-			void BufferData(const void* data, uint32_t size, GLBufferUsage usage) const;
+			void BufferData(const void* data, uint32_t size, GLBufferUsage usage);
 			void BufferSubData(const void* data, GLintptr offset, GLsizeiptr size) const;
 
+			/**
+			 * @brief Writes 'size' bytes with the buffer's upload strategy, BufferData() has to be called first.
+			 * Writing past the end grows the buffer, bytes before 'offset' are kept (except for ORPHAN and MAP_UNSYNCHRONIZED)
+			 * 
+			 * @return offset the data was written to. Same as 'offset', except for MAP_UNSYNCHRONIZED
+			 *         which ignores 'offset' and appends to a ring, with 16 byte alignment.
+			 *         -1 if the data doesn't fit storage allocated with BufferStorage()
+			 */
+			GLintptr Upload(const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+			void SetUploadStrategy(GLBufferUploadStrategy strategy) { m_UploadStrategy = strategy; }
+			// AUTO is resolved from the usage of the last BufferData() call
+			GLBufferUploadStrategy GetUploadStrategy() const;
+
+			GLsizeiptr Size() const { return m_Size; }
+
+			/**
+			 * @brief Allocates immutable storage, size can't be changed afterwards
+			 * 
+			 * @param flags combination of GL_MAP_*_BIT and GL_DYNAMIC_STORAGE_BIT
+			 */
+			void BufferStorage(const void* data, GLsizeiptr size, GLbitfield flags);
+
 			void* MapBuffer();
+			void* MapBufferRange(GLintptr offset, GLsizeiptr length, GLbitfield access);
 			void UnmapBuffer();
 			void BindBufferBase(GLuint bufferIndex);
+			void BindBufferRange(GLuint bufferIndex, GLintptr offset, GLsizeiptr size);
 
 			void Bind() const;
+
+			operator GLuint() const { return m_BufferID; }
+			GLHandle Handle() const { return m_Handle; }
 	};
 } // namespace EaseGL
 #endif
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "GLContext.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <array>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace EaseGL
+{
+   struct GLContextCapabilities
+   {
+      bool loaded = false;
+      GLint majorVersion = 0;
+      GLint minorVersion = 0;
+      std::unordered_set<std::string> extensions;
+      std::string driverIdentity;
+   };
+
+   static GLContextCapabilities s_ContextCapabilities;
+   static uint32_t s_ContextResets = 0;
+
+   // names of what the driver has bound, UNKNOWN until EaseGL binds something or after an invalidation
+   static const GLuint TEXTURE_BINDING_UNKNOWN = 0xFFFFFFFF;
+   static const int TEXTURE_BINDING_TARGETS = 4;
+
+   struct TextureBindingCache
+   {
+      int activeUnit = -1; // -1 if unknown
+      std::vector<std::array<GLuint, TEXTURE_BINDING_TARGETS>> units;
+      TextureBindingStats stats;
+   };
+
+   static TextureBindingCache s_TextureBindings;
+
+   // targets other than these are bound without caching
+   int GetTextureBindingTarget(GLenum target)
+   {
+      return target == GL_TEXTURE_2D ? 0
+         : target == GL_TEXTURE_2D_ARRAY ? 1
+         : target == GL_TEXTURE_CUBE_MAP ? 2
+         : target == GL_TEXTURE_3D ? 3
+         : -1;
+   }
+
+   GLuint* GetCachedTextureBinding(int unit, GLenum target)
+   {
+      int index = GetTextureBindingTarget(target);
+      if(index < 0 || unit < 0)
+         return nullptr;
+      if((size_t)unit >= s_TextureBindings.units.size())
+      {
+         std::array<GLuint, TEXTURE_BINDING_TARGETS> unknown;
+         unknown.fill(TEXTURE_BINDING_UNKNOWN);
+         s_TextureBindings.units.resize(unit + 1, unknown);
+      }
+      return &s_TextureBindings.units[unit][index];
+   }
+
+   void SetActiveTextureUnit(int unit)
+   {
+      if(s_TextureBindings.activeUnit == unit)
+         return;
+      glActiveTexture(GL_TEXTURE0 + unit);
+      s_TextureBindings.activeUnit = unit;
+      s_TextureBindings.stats.activeUnitChanges++;
+   }
+
+   // BindTexture() without counting the request
+   void IssueTextureBind(int unit, GLenum target, GLuint texture)
+   {
+      GLuint* cached = GetCachedTextureBinding(unit, target);
+      if(cached != nullptr && *cached == texture)
+         return;
+
+      SetActiveTextureUnit(unit);
+      glBindTexture(target, texture);
+      s_TextureBindings.stats.issued++;
+      if(cached != nullptr)
+         *cached = texture;
+   }
+
+   bool IsUnitUnbound(int unit)
+   {
+      if((size_t)unit >= s_TextureBindings.units.size())
+         return false;
+      for(GLuint texture : s_TextureBindings.units[unit])
+      {
+         if(texture != 0)
+            return false;
+      }
+      return true;
+   }
+
+   // static
+   void GLContext::LoadCapabilities()
+   {
+      if(s_ContextCapabilities.loaded)
+         return;
+
+      glGetIntegerv(GL_MAJOR_VERSION, &s_ContextCapabilities.majorVersion);
+      glGetIntegerv(GL_MINOR_VERSION, &s_ContextCapabilities.minorVersion);
+
+      GLint extensionCount = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+      for(GLint i = 0; i < extensionCount; i++)
+      {
+         const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+         if(extension != nullptr)
+            s_ContextCapabilities.extensions.insert(extension);
+      }
+
+      const char* strings[] = {
+         (const char*)glGetString(GL_VENDOR),
+         (const char*)glGetString(GL_RENDERER),
+         (const char*)glGetString(GL_VERSION),
+      };
+      for(const char* str : strings)
+      {
+         if(str != nullptr)
+            s_ContextCapabilities.driverIdentity += str;
+         s_ContextCapabilities.driverIdentity += '\n';
+      }
+
+      s_ContextCapabilities.loaded = true;
+   }
+
+   // static
+   bool GLContext::HasVersion(int major, int minor)
+   {
+      LoadCapabilities();
+      return s_ContextCapabilities.majorVersion > major
+         || (s_ContextCapabilities.majorVersion == major && s_ContextCapabilities.minorVersion >= minor);
+   }
+
+   // static
+   bool GLContext::HasExtension(const char* extension)
+   {
+      LoadCapabilities();
+      return s_ContextCapabilities.extensions.count(extension) != 0;
+   }
+
+   // static
+   const std::string& GLContext::DriverIdentity()
+   {
+      LoadCapabilities();
+      return s_ContextCapabilities.driverIdentity;
+   }
+
+   // static
+   void GLContext::BindTexture(int unit, GLenum target, GLuint texture)
+   {
+      s_TextureBindings.stats.requested++;
+      IssueTextureBind(unit, target, texture);
+   }
+
+   // static
+   void GLContext::BindTextures(int firstUnit, int count, const GLenum* targets, const GLuint* textures)
+   {
+      s_TextureBindings.stats.requested += count;
+
+      // only the range that differs from what is bound goes to the driver
+      int first = count, last = -1;
+      for(int i = 0; i < count; i++)
+      {
+         GLuint* cached = GetCachedTextureBinding(firstUnit + i, targets[i]);
+         bool bound = textures[i] == 0 ? IsUnitUnbound(firstUnit + i) : cached != nullptr && *cached == textures[i];
+         if(!bound)
+         {
+            first = first < i ? first : i;
+            last = i;
+         }
+      }
+      if(last < 0)
+         return;
+
+      if(last > first && HasMultiBind())
+      {
+         // doesn't touch the active unit, 0 unbinds every target
+         glBindTextures(firstUnit + first, last - first + 1, textures + first);
+         s_TextureBindings.stats.issued++;
+         for(int i = first; i <= last; i++)
+         {
+            GLuint* cached = GetCachedTextureBinding(firstUnit + i, targets[i]);
+            if(textures[i] == 0)
+               s_TextureBindings.units[firstUnit + i].fill(0);
+            else if(cached != nullptr)
+               *cached = textures[i];
+         }
+         return;
+      }
+
+      for(int i = first; i <= last; i++)
+      {
+         if(textures[i] != 0)
+         {
+            IssueTextureBind(firstUnit + i, targets[i], textures[i]);
+            continue;
+         }
+         const GLenum allTargets[TEXTURE_BINDING_TARGETS] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D };
+         for(GLenum target : allTargets)
+            IssueTextureBind(firstUnit + i, target, 0);
+      }
+   }
+
+   // static
+   void GLContext::BindTextureOnActiveUnit(GLenum target, GLuint texture)
+   {
+      IssueTextureBind(GetActiveTextureUnit(), target, texture);
+   }
+
+   // static
+   int GLContext::GetActiveTextureUnit()
+   {
+      if(s_TextureBindings.activeUnit < 0)
+      {
+         GLint activeTexture = GL_TEXTURE0;
+         glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+         s_TextureBindings.activeUnit = activeTexture - GL_TEXTURE0;
+      }
+      return s_TextureBindings.activeUnit;
+   }
+
+   // static
+   bool GLContext::HasMultiBind()
+   {
+      return HasVersion(4, 4) || HasExtension("GL_ARB_multi_bind");
+   }
+
+   // static
+   void GLContext::InvalidateTexture(GLuint texture)
+   {
+      if(texture == 0)
+         return;
+      for(std::array<GLuint, TEXTURE_BINDING_TARGETS>& unit : s_TextureBindings.units)
+      {
+         for(GLuint& bound : unit)
+         {
+            if(bound == texture)
+               bound = 0;
+         }
+      }
+   }
+
+   // static
+   void GLContext::InvalidateTextureBindings()
+   {
+      s_TextureBindings.units.clear();
+      s_TextureBindings.activeUnit = -1;
+   }
+
+   // static
+   const TextureBindingStats& GLContext::GetTextureBindingStats()
+   {
+      return s_TextureBindings.stats;
+   }
+
+   // static
+   void GLContext::ResetTextureBindingStats()
+   {
+      s_TextureBindings.stats = TextureBindingStats();
+   }
+
+   // static
+   void GLContext::Reset()
+   {
+      s_ContextCapabilities = GLContextCapabilities();
+      InvalidateTextureBindings();
+      s_ContextResets++;
+   }
+
+   // static
+   uint32_t GLContext::ResetCount()
+   {
+      return s_ContextResets;
+   }
+} // namespace EaseGL
+#endif
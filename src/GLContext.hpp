@@ -0,0 +1,69 @@
+#ifndef GLCONTEXT_H
+#define GLCONTEXT_H
+#pragma once
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <string>
+
+namespace EaseGL
+{
+	struct TextureBindingStats
+	{
+		uint64_t requested = 0;         // textures asked to be bound to a unit
+		uint64_t issued = 0;            // glBindTexture and glBindTextures calls that reached the driver
+		uint64_t activeUnitChanges = 0; // glActiveTexture calls
+	};
+
+	/**
+	 * @brief Queries about the current OpenGL context, cached on first use.
+	 * EaseGL assumes a single context, call Reset() if the context is recreated.
+	 *
+	 * Also mirrors the texture bound to each target of each texture unit and the active unit, so binds that
+	 * change nothing never reach the driver. Textures bound with raw GL calls bypass the mirror, call
+	 * InvalidateTextureBindings() afterwards.
+	 */
+	class GLContext
+	{
+		private:
+			GLContext() {}
+
+			static void LoadCapabilities();
+		public:
+			static bool HasVersion(int major, int minor);
+			static bool HasExtension(const char* extension);
+			// GL_VENDOR, GL_RENDERER and GL_VERSION joined, changes whenever the driver does
+			static const std::string& DriverIdentity();
+
+			/**
+			 * @brief Binds 'texture' to 'target' of 'unit' for sampling, skipped if it is bound there already.
+			 * The active unit is only changed when the bind is issued
+			 */
+			static void BindTexture(int unit, GLenum target, GLuint texture);
+			/**
+			 * @brief Binds 'count' textures to the units from 'firstUnit' on, with a single glBindTextures if the
+			 * context has it and more than one unit changes. Texture 0 unbinds every target of its unit
+			 */
+			static void BindTextures(int firstUnit, int count, const GLenum* targets, const GLuint* textures);
+			/** @brief Binds 'texture' on whichever unit is active, for uploads and parameter changes */
+			static void BindTextureOnActiveUnit(GLenum target, GLuint texture);
+			static int GetActiveTextureUnit();
+			/** @brief OpenGL 4.4 or GL_ARB_multi_bind */
+			static bool HasMultiBind();
+
+			/** @brief Call when 'texture' is deleted, GL unbinds it everywhere and may hand out the name again */
+			static void InvalidateTexture(GLuint texture);
+			static void InvalidateTextureBindings();
+
+			static const TextureBindingStats& GetTextureBindingStats();
+			/** @brief Call once per frame to get per frame counts */
+			static void ResetTextureBindingStats();
+
+			// also forgets every texture binding, SamplerCache drops its samplers on next use
+			static void Reset();
+			// changes on every Reset(), caches of GL objects compare it to notice their objects are gone
+			static uint32_t ResetCount();
+	};
+} // namespace EaseGL
+
+#endif
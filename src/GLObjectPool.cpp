@@ -0,0 +1,183 @@
+#include "GLObjectPool.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <vector>
+
+#include "GLContext.hpp"
+
+namespace EaseGL
+{
+   struct GLObjectSlot
+   {
+      GLuint name = 0;
+      uint32_t generation = 0;
+      GLObjectType type = GLObjectType::NONE;
+      bool alive = false;
+   };
+
+   struct GLObjectPoolData
+   {
+      std::vector<GLObjectSlot> slots;
+      std::vector<uint32_t> freeSlots;
+      std::vector<GLuint> names[(int)GLObjectType::SAMPLER + 1];
+      uint32_t batchSize = 32;
+      uint32_t liveCount = 0;
+   };
+
+   static GLObjectPoolData s_ObjectPool;
+
+   void GenGLObjectNames(GLObjectType type, GLsizei count, GLuint* names)
+   {
+      if(type == GLObjectType::BUFFER)
+         glGenBuffers(count, names);
+      else if(type == GLObjectType::TEXTURE)
+         glGenTextures(count, names);
+      else if(type == GLObjectType::VERTEX_ARRAY)
+         glGenVertexArrays(count, names);
+      else if(type == GLObjectType::FRAMEBUFFER)
+         glGenFramebuffers(count, names);
+      else if(type == GLObjectType::RENDERBUFFER)
+         glGenRenderbuffers(count, names);
+      else if(type == GLObjectType::SAMPLER)
+         glGenSamplers(count, names);
+   }
+
+   void DeleteGLObjectNames(GLObjectType type, GLsizei count, const GLuint* names)
+   {
+      if(type == GLObjectType::BUFFER)
+         glDeleteBuffers(count, names);
+      else if(type == GLObjectType::TEXTURE)
+         glDeleteTextures(count, names);
+      else if(type == GLObjectType::VERTEX_ARRAY)
+         glDeleteVertexArrays(count, names);
+      else if(type == GLObjectType::FRAMEBUFFER)
+         glDeleteFramebuffers(count, names);
+      else if(type == GLObjectType::RENDERBUFFER)
+         glDeleteRenderbuffers(count, names);
+      else if(type == GLObjectType::SAMPLER)
+         glDeleteSamplers(count, names);
+      else if(type == GLObjectType::PROGRAM)
+      {
+         for(GLsizei i = 0; i < count; i++)
+            glDeleteProgram(names[i]);
+      }
+   }
+
+   // static
+   GLuint GLObjectPool::TakeName(GLObjectType type)
+   {
+      // programs can't be generated ahead of time
+      if(type == GLObjectType::PROGRAM)
+         return glCreateProgram();
+
+      std::vector<GLuint>& names = s_ObjectPool.names[(int)type];
+      if(names.empty())
+      {
+         names.resize(s_ObjectPool.batchSize);
+         GenGLObjectNames(type, (GLsizei)names.size(), names.data());
+      }
+
+      GLuint name = names.back();
+      names.pop_back();
+      return name;
+   }
+
+   // static
+   GLHandle GLObjectPool::Create(GLObjectType type)
+   {
+      GLHandle handle;
+      if(type == GLObjectType::NONE)
+         return handle;
+
+      if(!s_ObjectPool.freeSlots.empty())
+      {
+         handle.index = s_ObjectPool.freeSlots.back();
+         s_ObjectPool.freeSlots.pop_back();
+      }
+      else
+      {
+         handle.index = (uint32_t)s_ObjectPool.slots.size();
+         s_ObjectPool.slots.emplace_back();
+      }
+
+      GLObjectSlot& slot = s_ObjectPool.slots[handle.index];
+      slot.name = TakeName(type);
+      slot.type = type;
+      slot.alive = true;
+      handle.generation = slot.generation;
+
+      s_ObjectPool.liveCount++;
+      return handle;
+   }
+
+   // static
+   void GLObjectPool::Destroy(GLHandle& handle)
+   {
+      if(!IsValid(handle))
+      {
+         handle = GLHandle();
+         return;
+      }
+
+      GLObjectSlot& slot = s_ObjectPool.slots[handle.index];
+      DeleteGLObjectNames(slot.type, 1, &slot.name);
+      // the name can come back from glGenTextures, it must not look bound
+      if(slot.type == GLObjectType::TEXTURE)
+         GLContext::InvalidateTexture(slot.name);
+
+      slot.name = 0;
+      slot.type = GLObjectType::NONE;
+      slot.alive = false;
+      slot.generation++;
+      s_ObjectPool.freeSlots.push_back(handle.index);
+      s_ObjectPool.liveCount--;
+
+      handle = GLHandle();
+   }
+
+   // static
+   bool GLObjectPool::IsValid(GLHandle handle)
+   {
+      return handle.index < s_ObjectPool.slots.size()
+         && s_ObjectPool.slots[handle.index].alive
+         && s_ObjectPool.slots[handle.index].generation == handle.generation;
+   }
+
+   // static
+   GLuint GLObjectPool::Name(GLHandle handle)
+   {
+      return IsValid(handle) ? s_ObjectPool.slots[handle.index].name : 0;
+   }
+
+   // static
+   GLObjectType GLObjectPool::Type(GLHandle handle)
+   {
+      return IsValid(handle) ? s_ObjectPool.slots[handle.index].type : GLObjectType::NONE;
+   }
+
+   // static
+   void GLObjectPool::SetBatchSize(uint32_t count)
+   {
+      s_ObjectPool.batchSize = count > 0 ? count : 1;
+   }
+
+   // static
+   void GLObjectPool::ReleaseUnusedNames()
+   {
+      for(int type = 0; type <= (int)GLObjectType::SAMPLER; type++)
+      {
+         std::vector<GLuint>& names = s_ObjectPool.names[type];
+         if(!names.empty())
+            DeleteGLObjectNames((GLObjectType)type, (GLsizei)names.size(), names.data());
+         names.clear();
+      }
+   }
+
+   // static
+   uint32_t GLObjectPool::LiveObjectCount()
+   {
+      return s_ObjectPool.liveCount;
+   }
+} // namespace EaseGL
+#endif
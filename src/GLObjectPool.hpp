@@ -0,0 +1,64 @@
+#ifndef GLOBJECTPOOL_H
+#define GLOBJECTPOOL_H
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+namespace EaseGL
+{
+	enum class GLObjectType
+	{
+		NONE = 0,
+		BUFFER,
+		TEXTURE,
+		VERTEX_ARRAY,
+		FRAMEBUFFER,
+		RENDERBUFFER,
+		PROGRAM,
+		SAMPLER,
+	};
+
+	/**
+	 * @brief Generational reference to a GL object owned by GLObjectPool.
+	 * A handle becomes stale once its object is destroyed, even if the slot or the GL name gets reused.
+	 */
+	struct GLHandle
+	{
+		uint32_t index = 0xFFFFFFFF;
+		uint32_t generation = 0;
+
+		bool operator==(const GLHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const GLHandle& other) const { return !(*this == other); }
+	};
+
+	/**
+	 * @brief Table of every GL object created by EaseGL.
+	 * Names are generated in batches (one glGen* call per SetBatchSize() objects) and handed out from per type pools.
+	 * GLBuffer, GLTexture, VertexArray, Shader and Framebuffer are move-only owners of a GLHandle.
+	 */
+	class GLObjectPool
+	{
+		private:
+			GLObjectPool() {}
+
+			static GLuint TakeName(GLObjectType type);
+		public:
+			static GLHandle Create(GLObjectType type);
+			// Deletes the GL object, 'handle' and its copies become invalid
+			static void Destroy(GLHandle& handle);
+
+			static bool IsValid(GLHandle handle);
+			// 0 if the handle is stale
+			static GLuint Name(GLHandle handle);
+			static GLObjectType Type(GLHandle handle);
+
+			static void SetBatchSize(uint32_t count);
+			// Deletes pre-generated names that were never handed out
+			static void ReleaseUnusedNames();
+
+			static uint32_t LiveObjectCount();
+	};
+} // namespace EaseGL
+
+#endif
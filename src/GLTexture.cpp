@@ -11,112 +11,837 @@
    #include <stb/stb_image.h>
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <memory>
+
+#include "CompressedTexture.hpp"
+#include "GLBuffer.hpp"
+#include "GLContext.hpp"
 
 namespace EaseGL
 {
+   static TextureMemoryStats s_TextureMemory;
+
+   struct TextureStreamRing
+   {
+      std::vector<GLBuffer> buffers;
+      std::vector<GLsync> fences; // signaled once the GPU has read the buffer
+      std::vector<GLsizeiptr> sizes;
+      size_t next = 0;
+      uint64_t orphans = 0;
+
+      // between BeginUpdate() and EndUpdate()
+      int mapped = -1;
+      GLsizeiptr mappedSize = 0;
+      TextureRegion region;
+   };
+
    GLTexture::~GLTexture()
    {
+      DeleteStream();
+      DeleteTextures();
+      ReleasePixels();
+   }
+
+   GLTexture::GLTexture(GLTexture&& other) noexcept
+      : m_TextureID(0), m_TextureType(TextureType::NONE), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr)
+   {
+      MoveFrom(other);
+   }
+
+   GLTexture& GLTexture::operator=(GLTexture&& other) noexcept
+   {
+      if(this != &other)
+      {
+         DeleteStream();
+         DeleteTextures();
+         ReleasePixels();
+         MoveFrom(other);
+      }
+      return *this;
+   }
+
+   void GLTexture::MoveFrom(GLTexture& other)
+   {
+      m_TextureID = other.m_TextureID;
+      m_Handle = other.m_Handle;
+      m_TextureType = other.m_TextureType;
+      m_Width = other.m_Width;
+      m_Height = other.m_Height;
+      m_Channels = other.m_Channels;
+      m_Layers = other.m_Layers;
+      m_Pixels = other.m_Pixels;
+      m_PixelBytes = other.m_PixelBytes;
+      m_GpuBytes = other.m_GpuBytes;
+      m_Filepath = std::move(other.m_Filepath);
+      m_CreateInfo = other.m_CreateInfo;
+      m_StorageFormat = other.m_StorageFormat;
+      m_StorageLevels = other.m_StorageLevels;
+      m_Stream = other.m_Stream;
+
+      other.m_TextureID = 0;
+      other.m_Handle = GLHandle();
+      other.m_Pixels = nullptr;
+      other.m_PixelBytes = 0;
+      other.m_GpuBytes = 0;
+      other.m_StorageFormat = 0;
+      other.m_Stream = nullptr;
    }
 
    void GLTexture::LoadTexture(const char* filepath) 
    {
-      if(m_Pixels != nullptr)
-         stbi_image_free(m_Pixels);
-      
       int w,h,n,ok;
       ok = stbi_info(filepath, &w, &h, &n);
       if(ok == 1)
          std::cout << "Texture loading " << filepath << " is ok [w:" << w << ", h:" << h << ", n:" << n << "]" << std::endl;
 
-      m_Pixels = stbi_load(filepath, &m_Width, &m_Height, &m_Channels, 0);
-      
+      m_Filepath = filepath;
+      DecodePixels(filepath);
+      GenTextures();
+
+      if(m_CreateInfo.residency != TextureResidency::KEEP)
+         ReleasePixels();
+   }
+
+   bool GLTexture::DecodePixels(const char* filepath)
+   {
+      ReleasePixels();
+
+      int width = 0, height = 0, channels = 0;
+      if(GetPixelType() == GL_FLOAT)
+         m_Pixels = (unsigned char*)stbi_loadf(filepath, &width, &height, &channels, 0);
+      else
+         m_Pixels = stbi_load(filepath, &width, &height, &channels, 0);
+
       if(m_Pixels == NULL)
+      {
          std::cout << "ERROR on loading Texture " << filepath << std::endl;
-      
-      GenTextures();
+         return false;
+      }
+
+      m_Width = width;
+      m_Height = height;
+      m_Channels = channels;
+
+      m_PixelBytes = (size_t)width * height * channels * (GetPixelType() == GL_FLOAT ? sizeof(float) : 1);
+      s_TextureMemory.cpuBytes += m_PixelBytes;
+      return true;
+   }
+
+   const void* GLTexture::GetPixels()
+   {
+      if(m_Pixels != nullptr || m_CreateInfo.residency != TextureResidency::RELOAD_ON_DEMAND || m_Filepath.empty())
+         return m_Pixels;
+
+      int width = m_Width, height = m_Height, channels = m_Channels;
+      if(DecodePixels(m_Filepath.c_str()) && (m_Width != width || m_Height != height || m_Channels != channels))
+      {
+         // the file changed on disk, these pixels don't describe the uploaded texture anymore
+         std::cout << "ERROR: " << m_Filepath << " changed since it was uploaded" << std::endl;
+         ReleasePixels();
+         m_Width = width;
+         m_Height = height;
+         m_Channels = channels;
+      }
+      return m_Pixels;
+   }
+
+   void GLTexture::ReleasePixels()
+   {
+      if(m_Pixels == nullptr)
+         return;
+      stbi_image_free(m_Pixels);
+      m_Pixels = nullptr;
+      s_TextureMemory.cpuBytes -= m_PixelBytes;
+      m_PixelBytes = 0;
+   }
+
+   // static
+   const TextureMemoryStats& GLTexture::GetMemoryStats()
+   {
+      return s_TextureMemory;
    }
 
    GLTexture::GLTexture(TextureType type) 
-      : m_TextureType(type), m_Pixels(nullptr), m_Width(0), m_Height(0), m_Channels(0), m_TextureID(0), m_Filepath("")
+      : m_TextureID(0), m_TextureType(type), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath("")
    {
    }
 
    GLTexture::GLTexture(TextureType type, const char* filepath)
-      : m_TextureType(type), m_Filepath(filepath), m_Pixels(nullptr), m_Width(0), m_Height(0), m_Channels(0), m_TextureID(0)
+      : m_TextureID(0), m_TextureType(type), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath(filepath)
    {
       LoadTexture(filepath);
    }
 
+   GLTexture::GLTexture(TextureType type, const TextureCreateInfo& createInfo)
+      : m_TextureID(0), m_TextureType(type), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath(""), m_CreateInfo(createInfo)
+   {
+   }
+
    GLTexture::GLTexture(GLuint textureID, TextureType textureType)
-      : m_TextureID(textureID), m_TextureType(textureType)
+      : m_TextureID(textureID), m_TextureType(textureType), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr)
    {
    }
    
 
-   GLenum GLTexture::GetGLTextureType() const
+   GLenum GetTextureTarget(TextureType type)
    {
-      return m_TextureType == TextureType::TEXTURE2D ? GL_TEXTURE_2D
+      return type == TextureType::TEXTURE2D ? GL_TEXTURE_2D
+         : type == TextureType::TEXTURE2D_ARRAY ? GL_TEXTURE_2D_ARRAY
+         : type == TextureType::TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP
+         : type == TextureType::TEXTURE3D ? GL_TEXTURE_3D
          : GL_NONE;
    }
 
-   void GLTexture::GenTextures()
+   GLenum GLTexture::GetGLTextureType() const
+   {
+      return GetTextureTarget(m_TextureType);
+   }
+
+   GLenum GLTexture::GetInternalFormat(int channels) const
+   {
+      switch(m_CreateInfo.format)
+      {
+         case TextureFormat::R8: return GL_R8;
+         case TextureFormat::RG8: return GL_RG8;
+         case TextureFormat::RGB8: return GL_RGB8;
+         case TextureFormat::RGBA8: return GL_RGBA8;
+         case TextureFormat::SRGB8: return GL_SRGB8;
+         case TextureFormat::SRGB8_ALPHA8: return GL_SRGB8_ALPHA8;
+         case TextureFormat::R16F: return GL_R16F;
+         case TextureFormat::RG16F: return GL_RG16F;
+         case TextureFormat::RGB16F: return GL_RGB16F;
+         case TextureFormat::RGBA16F: return GL_RGBA16F;
+         default:
+            return channels == 1 ? GL_R8
+               : channels == 2 ? GL_RG8
+               : channels == 3 ? (m_CreateInfo.srgb ? GL_SRGB8 : GL_RGB8)
+               : (m_CreateInfo.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8);
+      }
+   }
+
+   GLenum GLTexture::GetPixelType() const
+   {
+      return m_CreateInfo.format == TextureFormat::R16F || m_CreateInfo.format == TextureFormat::RG16F
+         || m_CreateInfo.format == TextureFormat::RGB16F || m_CreateInfo.format == TextureFormat::RGBA16F ? GL_FLOAT
+         : GL_UNSIGNED_BYTE;
+   }
+
+   // levels down to 1x1, what glGenerateMipmap fills
+   GLsizei GetTextureLevelCount(int width, int height, int depth)
+   {
+      int size = std::max(std::max(width, height), depth);
+      GLsizei levels = 1;
+      while(size > 1)
+      {
+         size >>= 1;
+         levels++;
+      }
+      return levels;
+   }
+
+   size_t GetTextureLevelBytes(GLenum internalFormat, int width, int height)
+   {
+      size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+      size_t texels = (size_t)width * height;
+      switch(internalFormat)
+      {
+         case GL_R8: return texels;
+         case GL_RG8: case GL_R16F: return texels * 2;
+         case GL_RGB8: case GL_SRGB8: return texels * 3;
+         case GL_RGBA8: case GL_SRGB8_ALPHA8: case GL_RG16F: return texels * 4;
+         case GL_RGB16F: return texels * 6;
+         case GL_RGBA16F: return texels * 8;
+         case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+         case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+         case GL_COMPRESSED_RED_RGTC1: case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+            return blocks * 8;
+         default: // remaining block compressed formats
+            return blocks * 16;
+      }
+   }
+
+   bool IsUnpackBufferBound()
+   {
+      GLint unpackBuffer = 0;
+      glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+      return unpackBuffer != 0;
+   }
+
+   // offset 0 into a bound unpack buffer is null too
+   bool HasTexturePixels(const void* pixels)
+   {
+      return pixels != nullptr || IsUnpackBufferBound();
+   }
+
+   GLenum GetTexturePixelFormat(int channels)
+   {
+      return channels == 4 ? GL_RGBA : channels == 3 ? GL_RGB : channels == 2 ? GL_RG : channels == 1 ? GL_RED : GL_NONE;
+   }
+
+   // returns the previous alignment, or 0 if it didn't need to change
+   GLint SetTextureUnpackAlignment(int channels)
+   {
+      GLint oldUnpackAlignment = 0;
+      glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldUnpackAlignment);
+      // if channels == 3 -> pixels should be aligned by 1, else(1, 2, 4) it can be aligned to channels itself
+      GLint alignment = channels == 3 ? 1 : channels;
+      if(alignment == oldUnpackAlignment || alignment <= 0)
+         return 0; // to prevent unnecessary GPU calls
+
+      glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+      return oldUnpackAlignment;
+   }
+
+   void GLTexture::CreateTexture()
    {
       DeleteTextures();
 
-      glGenTextures(1, &m_TextureID);
-      Bind();
+      m_Handle = GLObjectPool::Create(GLObjectType::TEXTURE);
+      m_TextureID = GLObjectPool::Name(m_Handle);
+      BindForEdit();
 
       glTexParameteri(GetGLTextureType(), GL_TEXTURE_WRAP_S, GL_REPEAT);	
       glTexParameteri(GetGLTextureType(), GL_TEXTURE_WRAP_T, GL_REPEAT);
       glTexParameteri(GetGLTextureType(), GL_TEXTURE_MIN_FILTER, GL_NEAREST);
       glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+      {
+         // repeating would filter across to the opposite edge of a face
+         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+      }
+      else if(m_TextureType == TextureType::TEXTURE3D)
+         glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+   }
 
-      
-      int oldUnpackAlignment = 0;
-      glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldUnpackAlignment);
-      bool changeAlignment = false; // to prevent unnecessary GPU calls
-      // if m_Channels == 3 -> pixels should be aligned by 1, else(1, 2, 4) it can be aligned to m_Channels itself
-      if(m_Channels == 3 && oldUnpackAlignment != 1)
+   bool GLTexture::AllocateStorage(GLenum internalFormat, int width, int height, int layers, GLsizei levels)
+   {
+      // glTexStorage* rejects empty images, which failed loads end up as
+      bool immutable = (GLContext::HasVersion(4, 2) || GLContext::HasExtension("GL_ARB_texture_storage"))
+         && width > 0 && height > 0 && layers > 0;
+      bool matches = m_StorageFormat == internalFormat && m_StorageLevels == levels
+         && m_Width == width && m_Height == height && m_Layers == layers;
+
+      m_Width = width;
+      m_Height = height;
+      m_Layers = layers;
+
+      size_t bytes = 0;
+      for(GLsizei level = 0; level < levels; level++)
       {
-         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-         changeAlignment = true;
+         int depth = m_TextureType == TextureType::TEXTURE3D ? std::max(layers >> level, 1) : layers;
+         bytes += GetTextureLevelBytes(internalFormat, std::max(width >> level, 1), std::max(height >> level, 1)) * depth;
       }
-      else if(oldUnpackAlignment != m_Channels)
+
+      if(m_TextureID != 0 && (!immutable || matches))
       {
-         glPixelStorei(GL_UNPACK_ALIGNMENT, m_Channels);
-         changeAlignment = true;
+         BindForEdit();
+         if(!immutable)
+            glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAX_LEVEL, levels - 1);
+         SetGpuBytes(bytes);
+         return immutable;
       }
 
-      glTexImage2D(GetGLTextureType(), 0,
-         GL_RGBA8, // store in GPU as
-         m_Width, m_Height,
-         0, // border
-         m_Channels == 4 ? GL_RGBA : m_Channels == 3 ? GL_RGB : m_Channels == 2 ? GL_RG : m_Channels == 1 ? GL_RED : GL_NONE, // which format does our image is, (can be found from 'm_Channels')
-         GL_UNSIGNED_BYTE,
-         m_Pixels);
-      glGenerateMipmap(GetGLTextureType());
+      // immutable storage can't be respecified, it takes a new texture object
+      CreateTexture();
+      SetGpuBytes(bytes);
+      if(!immutable)
+      {
+         glTexParameteri(GetGLTextureType(), GL_TEXTURE_MAX_LEVEL, levels - 1);
+         return false;
+      }
 
-      if(changeAlignment)
+      if(m_TextureType == TextureType::TEXTURE2D || m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+         glTexStorage2D(GetGLTextureType(), levels, internalFormat, width, height);
+      else
+         glTexStorage3D(GetGLTextureType(), levels, internalFormat, width, height, layers);
+      m_StorageFormat = internalFormat;
+      m_StorageLevels = levels;
+      return true;
+   }
+
+   void GLTexture::SetGpuBytes(size_t bytes)
+   {
+      if(m_GpuBytes == 0 && bytes != 0)
+         s_TextureMemory.textures++;
+      else if(m_GpuBytes != 0 && bytes == 0)
+         s_TextureMemory.textures--;
+      s_TextureMemory.gpuBytes += bytes;
+      s_TextureMemory.gpuBytes -= m_GpuBytes;
+      m_GpuBytes = bytes;
+   }
+
+   void GLTexture::GenTextures()
+   {
+      CreateTexture();
+      Upload(m_Width, m_Height, m_Channels, m_Pixels);
+   }
+
+   void GLTexture::Upload(int width, int height, int channels, const void* pixels)
+   {
+      if(m_TextureType != TextureType::TEXTURE2D)
+      {
+         SpecifyLayers(width, height, m_TextureType == TextureType::TEXTURE_CUBE_MAP ? 6 : 1, channels, pixels, 0);
+         return;
+      }
+
+      // pixels in client memory can be filtered here, an unpack buffer would have to be read back first
+      if(m_CreateInfo.mipmaps && m_CreateInfo.mipFilter != MipFilter::NONE && GetPixelType() == GL_UNSIGNED_BYTE
+         && pixels != nullptr && !IsUnpackBufferBound() && (width > 1 || height > 1))
       {
+         MipChain chain;
+         if(MipGenerator::Build((const unsigned char*)pixels, width, height, channels, m_CreateInfo.mipFilter, m_CreateInfo.IsSRGB(channels), chain))
+         {
+            UploadMipChain(chain);
+            return;
+         }
+      }
+
+      m_Channels = channels;
+      GLenum internalFormat = GetInternalFormat(channels);
+      GLsizei levels = m_CreateInfo.mipmaps ? GetTextureLevelCount(width, height, 1) : 1;
+      bool immutable = AllocateStorage(internalFormat, width, height, 1, levels);
+      bool hasPixels = HasTexturePixels(pixels);
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(m_Channels);
+
+      if(immutable)
+      {
+         if(hasPixels)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+      }
+      else
+      {
+         glTexImage2D(GL_TEXTURE_2D, 0,
+            internalFormat, // store in GPU as
+            m_Width, m_Height,
+            0, // border
+            GetTexturePixelFormat(m_Channels), // which format does our image is, (can be found from 'm_Channels')
+            GetPixelType(),
+            pixels);
+      }
+
+      if(oldUnpackAlignment != 0)
          glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+
+      if(levels > 1 && hasPixels)
+         glGenerateMipmap(GL_TEXTURE_2D);
+   }
+
+   void GLTexture::SubImage(int x, int y, int width, int height, int channels, const void* pixels)
+   {
+      BindForEdit();
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+
+      glTexSubImage2D(GetGLTextureType(), 0, x, y, width, height, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+   }
+
+   void GLTexture::SpecifyLayers(int width, int height, int layers, int channels, const void* pixels, size_t layerStride)
+   {
+      m_Channels = channels;
+      GLenum target = GetGLTextureType();
+      GLenum internalFormat = GetInternalFormat(channels);
+      // array layers and cube faces don't shrink down the chain, 3D slices do
+      GLsizei levels = m_CreateInfo.mipmaps ? GetTextureLevelCount(width, height, m_TextureType == TextureType::TEXTURE3D ? layers : 1) : 1;
+      bool immutable = AllocateStorage(internalFormat, width, height, layers, levels);
+      bool hasPixels = HasTexturePixels(pixels);
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+      GLenum format = GetTexturePixelFormat(channels);
+      GLenum type = GetPixelType();
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+      {
+         for(int face = 0; face < 6 && face < layers; face++)
+         {
+            const unsigned char* facePixels = hasPixels ? (const unsigned char*)pixels + layerStride * face : nullptr;
+            if(immutable && hasPixels)
+               glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, width, height, format, type, facePixels);
+            else if(!immutable)
+               glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, internalFormat, width, height, 0, format, type, facePixels);
+         }
+      }
+      else if(layerStride == 0 && layers > 1 && hasPixels)
+      {
+         if(!immutable)
+            glTexImage3D(target, 0, internalFormat, width, height, layers, 0, format, type, nullptr);
+         for(int layer = 0; layer < layers; layer++)
+            glTexSubImage3D(target, 0, 0, 0, layer, width, height, 1, format, type, pixels);
       }
+      else if(immutable && hasPixels)
+         glTexSubImage3D(target, 0, 0, 0, 0, width, height, layers, format, type, pixels);
+      else if(!immutable)
+         glTexImage3D(target, 0, internalFormat, width, height, layers, 0, format, type, pixels);
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
 
+      if(levels > 1 && hasPixels)
+         glGenerateMipmap(target);
    }
 
-   void GLTexture::DeleteTextures()
+   void GLTexture::Update(const TextureRegion& region, const void* pixels)
+   {
+      void* pointer = BeginUpdate(region);
+      if(pointer == nullptr)
+         return;
+      memcpy(pointer, pixels, m_Stream->mappedSize);
+      EndUpdate();
+   }
+
+   void* GLTexture::BeginUpdate(const TextureRegion& region)
+   {
+      if(m_Stream != nullptr && m_Stream->mapped >= 0)
+      {
+         std::cout << "ERROR: BeginUpdate() called again before EndUpdate()" << std::endl;
+         return nullptr;
+      }
+
+      TextureRegion target = region;
+      if(target.width == 0)
+         target.width = m_Width - target.x;
+      if(target.height == 0)
+         target.height = m_Height - target.y;
+      if(m_TextureID == 0 || m_Channels == 0 || target.x < 0 || target.y < 0 || target.width <= 0 || target.height <= 0
+         || target.x + target.width > m_Width || target.y + target.height > m_Height || target.layer < 0 || target.layer >= m_Layers)
+      {
+         std::cout << "ERROR: Update() region " << target.x << ", " << target.y << " " << target.width << "x" << target.height
+            << " layer " << target.layer << " is outside of the " << m_Width << "x" << m_Height << " texture" << std::endl;
+         return nullptr;
+      }
+
+      if(m_Stream == nullptr)
+      {
+         uint32_t count = std::max(m_CreateInfo.updateBuffers, 1u);
+         m_Stream = new TextureStreamRing();
+         for(uint32_t i = 0; i < count; i++)
+            m_Stream->buffers.emplace_back(GLBufferType::PIXEL_UNPACK_BUFFER);
+         m_Stream->fences.assign(count, nullptr);
+         m_Stream->sizes.assign(count, 0);
+      }
+
+      size_t index = m_Stream->next;
+      GLBuffer& buffer = m_Stream->buffers[index];
+      GLsync& fence = m_Stream->fences[index];
+      GLsizeiptr size = (GLsizeiptr)target.width * target.height * m_Channels * (GetPixelType() == GL_FLOAT ? sizeof(float) : 1);
+
+      bool inUse = false;
+      if(fence != nullptr)
+      {
+         inUse = glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED;
+         glDeleteSync(fence);
+         fence = nullptr;
+      }
+      if(inUse || size > m_Stream->sizes[index])
+      {
+         // fresh storage, the driver keeps the old one alive until the GPU is done reading it
+         if(inUse)
+            m_Stream->orphans++;
+         m_Stream->sizes[index] = std::max(size, m_Stream->sizes[index]);
+         buffer.BufferData(nullptr, (uint32_t)m_Stream->sizes[index], GLBufferUsage::STREAM_DRAW);
+      }
+
+      // the fence or the new storage already guarantees the GPU isn't reading it
+      void* pointer = buffer.MapBufferRange(0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      // unbound until EndUpdate(), so client memory uploads in between don't read from the mapped buffer
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      if(pointer == nullptr)
+      {
+         std::cout << "ERROR: Failed to map " << size << " bytes for a texture update" << std::endl;
+         return nullptr;
+      }
+
+      m_Stream->mapped = (int)index;
+      m_Stream->mappedSize = size;
+      m_Stream->region = target;
+      return pointer;
+   }
+
+   void GLTexture::EndUpdate()
+   {
+      if(m_Stream == nullptr || m_Stream->mapped < 0)
+      {
+         std::cout << "ERROR: EndUpdate() called without BeginUpdate()" << std::endl;
+         return;
+      }
+
+      size_t index = (size_t)m_Stream->mapped;
+      GLBuffer& buffer = m_Stream->buffers[index];
+      buffer.Bind();
+      buffer.UnmapBuffer();
+
+      // offset 0 into the bound unpack buffer
+      const TextureRegion& region = m_Stream->region;
+      SubImageLayer(region.layer, region.x, region.y, region.width, region.height, m_Channels, nullptr);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      m_Stream->fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      m_Stream->next = (index + 1) % m_Stream->buffers.size();
+      m_Stream->mapped = -1;
+   }
+
+   uint64_t GLTexture::UpdateOrphanCount() const
+   {
+      return m_Stream != nullptr ? m_Stream->orphans : 0;
+   }
+
+   void GLTexture::DeleteStream()
+   {
+      if(m_Stream == nullptr)
+         return;
+
+      if(m_Stream->mapped >= 0)
+      {
+         m_Stream->buffers[m_Stream->mapped].Bind();
+         m_Stream->buffers[m_Stream->mapped].UnmapBuffer();
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      }
+      for(GLsync fence : m_Stream->fences)
+      {
+         if(fence != nullptr)
+            glDeleteSync(fence);
+      }
+      delete m_Stream;
+      m_Stream = nullptr;
+   }
+
+   void GLTexture::UploadLayers(int width, int height, int layers, int channels, const void* pixels)
+   {
+      if(m_TextureType == TextureType::TEXTURE2D)
+      {
+         std::cout << "ERROR: UploadLayers() on a 2D texture, use Upload()" << std::endl;
+         return;
+      }
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP && layers != 6)
+      {
+         std::cout << "ERROR: Cube maps need 6 faces, got " << layers << std::endl;
+         return;
+      }
+
+      size_t componentSize = GetPixelType() == GL_FLOAT ? sizeof(float) : 1;
+      SpecifyLayers(width, height, layers, channels, pixels, (size_t)width * height * channels * componentSize);
+   }
+
+   void GLTexture::SubImageLayer(int layer, int x, int y, int width, int height, int channels, const void* pixels)
+   {
+      if(m_TextureType == TextureType::TEXTURE2D)
+      {
+         SubImage(x, y, width, height, channels, pixels);
+         return;
+      }
+
+      BindForEdit();
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP)
+         glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer, 0, x, y, width, height, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+      else
+         glTexSubImage3D(GetGLTextureType(), 0, x, y, layer, width, height, 1, GetTexturePixelFormat(channels), GetPixelType(), pixels);
+
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+   }
+
+   bool GLTexture::LoadLayers(const std::vector<std::string>& filepaths)
+   {
+      if(m_TextureType == TextureType::TEXTURE2D || filepaths.empty())
+      {
+         std::cout << "ERROR: LoadLayers() needs an array, cube map or 3D texture and at least one file" << std::endl;
+         return false;
+      }
+      if(m_TextureType == TextureType::TEXTURE_CUBE_MAP && filepaths.size() != 6)
+      {
+         std::cout << "ERROR: Cube maps need 6 faces, got " << filepaths.size() << std::endl;
+         return false;
+      }
+
+      // storage is specified from the first file, the rest are decoded and uploaded one at a time
+      int width = 0, height = 0, channels = 0;
+      for(size_t layer = 0; layer < filepaths.size(); layer++)
+      {
+         int w, h, n;
+         void* decoded = GetPixelType() == GL_FLOAT ? (void*)stbi_loadf(filepaths[layer].c_str(), &w, &h, &n, 0)
+            : (void*)stbi_load(filepaths[layer].c_str(), &w, &h, &n, 0);
+         std::unique_ptr<void, void(*)(void*)> pixels(decoded, stbi_image_free);
+         if(pixels == nullptr)
+         {
+            std::cout << "ERROR on loading Texture " << filepaths[layer] << std::endl;
+            return false;
+         }
+
+         if(layer == 0)
+         {
+            width = w;
+            height = h;
+            channels = n;
+            SpecifyLayers(width, height, (int)filepaths.size(), channels, nullptr, 0);
+         }
+         else if(w != width || h != height || n != channels)
+         {
+            std::cout << "ERROR: " << filepaths[layer] << " is " << w << "x" << h << "x" << n
+               << ", other layers are " << width << "x" << height << "x" << channels << std::endl;
+            return false;
+         }
+
+         SubImageLayer((int)layer, 0, 0, w, h, n, pixels.get());
+      }
+
+      if(m_CreateInfo.mipmaps)
+         GenerateMipmaps();
+      return true;
+   }
+
+   bool GLTexture::LoadCompressed(const char* filepath)
+   {
+      CompressedImage image;
+      if(!CompressedTexture::Load(filepath, image))
+         return false;
+      return UploadCompressed(image);
+   }
+
+   bool GLTexture::UploadCompressed(const CompressedImage& image)
+   {
+      if(m_TextureType != TextureType::TEXTURE2D || image.levels.empty())
+      {
+         std::cout << "ERROR: Compressed images can only be uploaded to 2D textures" << std::endl;
+         return false;
+      }
+      // images built by hand skip the container checks
+      if((int)image.levels.size() > CompressedTexture::MaxLevelCount(image.width, image.height))
+      {
+         std::cout << "ERROR: Compressed image has " << image.levels.size() << " levels, a " << image.width << "x" << image.height
+            << " chain has " << CompressedTexture::MaxLevelCount(image.width, image.height) << std::endl;
+         return false;
+      }
+
+      // checked up front so a failed decode leaves the texture untouched
+      bool onGpu = CompressedTexture::IsSupported(image.format, image.srgb);
+      int channels = CompressedTexture::DecodedChannels(image.format);
+      if(!onGpu && channels == 0)
+      {
+         std::cout << "ERROR: Compressed format " << (int)image.format << " is not supported by the driver and has no CPU decoder" << std::endl;
+         return false;
+      }
+
+      m_Channels = channels != 0 ? channels : 4;
+      // decoded levels get a plain format of the same channel count
+      GLenum internalFormat = onGpu ? CompressedTexture::GetGLFormat(image.format, image.srgb)
+         : channels == 1 ? GL_R8 : channels == 2 ? GL_RG8 : image.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+      // compressed levels can't be generated, a file without a full chain only samples what it stores
+      GLsizei levels = (GLsizei)image.levels.size();
+      bool immutable = AllocateStorage(internalFormat, image.width, image.height, 1, levels);
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(channels);
+      std::vector<unsigned char> pixels;
+      for(GLsizei level = 0; level < levels; level++)
+      {
+         const CompressedLevel& info = image.levels[level];
+         if(onGpu && immutable)
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, internalFormat, (GLsizei)info.size, image.LevelData(level));
+         else if(onGpu)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, info.width, info.height, 0, (GLsizei)info.size, image.LevelData(level));
+         else
+         {
+            pixels.resize((size_t)info.width * info.height * channels);
+            CompressedTexture::Decode(image.format, info.width, info.height, image.LevelData(level), pixels.data());
+            if(immutable)
+               glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, GetTexturePixelFormat(channels), GL_UNSIGNED_BYTE, pixels.data());
+            else
+               glTexImage2D(GL_TEXTURE_2D, level, internalFormat, info.width, info.height, 0, GetTexturePixelFormat(channels), GL_UNSIGNED_BYTE, pixels.data());
+         }
+      }
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+      return true;
+   }
+
+   bool GLTexture::UploadMipChain(const MipChain& chain, GLintptr unpackOffset /* = 0*/)
    {
-      if(m_TextureID != 0)
-         glDeleteTextures(1, &m_TextureID);
+      if(m_TextureType != TextureType::TEXTURE2D || chain.levels.empty() || GetPixelType() != GL_UNSIGNED_BYTE)
+      {
+         std::cout << "ERROR: Mip chains can only be uploaded to 2D textures with an 8 bit format" << std::endl;
+         return false;
+      }
 
-      //if(m_Pixels != nullptr)
-         //stbi_image_free(m_Pixels);
+      m_Channels = chain.channels;
+      GLenum internalFormat = GetInternalFormat(chain.channels);
+      GLenum format = GetTexturePixelFormat(chain.channels);
+      bool immutable = AllocateStorage(internalFormat, chain.width, chain.height, 1, (GLsizei)chain.levels.size());
+      const unsigned char* base = IsUnpackBufferBound() ? (const unsigned char*)unpackOffset : chain.data.data();
+
+      GLint oldUnpackAlignment = SetTextureUnpackAlignment(chain.channels);
+      for(size_t level = 0; level < chain.levels.size(); level++)
+      {
+         const MipLevel& info = chain.levels[level];
+         if(immutable)
+            glTexSubImage2D(GL_TEXTURE_2D, (GLint)level, 0, 0, info.width, info.height, format, GL_UNSIGNED_BYTE, base + info.offset);
+         else
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, info.width, info.height, 0, format, GL_UNSIGNED_BYTE, base + info.offset);
+      }
+      if(oldUnpackAlignment != 0)
+         glPixelStorei(GL_UNPACK_ALIGNMENT, oldUnpackAlignment);
+      return true;
+   }
+
+   void GLTexture::GenerateMipmaps()
+   {
+      BindForEdit();
+      glGenerateMipmap(GetGLTextureType());
+   }
+
+   void GLTexture::DeleteTextures()
+   {
+      // textures that aren't owned have no handle
+      if(GLObjectPool::IsValid(m_Handle))
+         GLObjectPool::Destroy(m_Handle);
+      m_TextureID = 0;
+      m_StorageFormat = 0;
+      m_StorageLevels = 0;
+      SetGpuBytes(0);
    }
 
    void GLTexture::Bind(int slot /* = 0*/) const
    {
-      glActiveTexture(GL_TEXTURE0 + slot);
-      glBindTexture(GetGLTextureType(), m_TextureID);
+      GLContext::BindTexture(slot, GetGLTextureType(), m_TextureID);
+   }
+
+   void GLTexture::BindForEdit() const
+   {
+      GLContext::BindTextureOnActiveUnit(GetGLTextureType(), m_TextureID);
+   }
+
+   // static
+   void GLTexture::Unbind(TextureType type)
+   {
+      GLContext::BindTextureOnActiveUnit(GetTextureTarget(type), 0);
+   }
+
+   // static
+   void GLTexture::BindTextures(int firstSlot, std::initializer_list<const GLTexture*> textures)
+   {
+      GLenum targets[32];
+      GLuint names[32];
+      int count = 0;
+      for(const GLTexture* texture : textures)
+      {
+         targets[count] = texture != nullptr ? texture->GetGLTextureType() : GL_TEXTURE_2D;
+         names[count] = texture != nullptr ? texture->m_TextureID : 0;
+         if(++count == 32)
+         {
+            // more than a material uses, split up
+            GLContext::BindTextures(firstSlot, count, targets, names);
+            firstSlot += count;
+            count = 0;
+         }
+      }
+      if(count > 0)
+         GLContext::BindTextures(firstSlot, count, targets, names);
    }
 } // namespace EaseGL
 
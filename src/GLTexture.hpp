@@ -3,49 +3,232 @@
 #pragma once
 	
 #include <glad/glad.h>
+#include "GLObjectPool.hpp"
+#include "MipChain.hpp"
+#include <initializer_list>
 #include <string>
+#include <vector>
 
 namespace EaseGL
 {
+	struct CompressedImage;
+	struct TextureStreamRing;
+
 	enum class TextureType
 	{
 		NONE = 0,
 		TEXTURE2D,
+		TEXTURE2D_ARRAY,
+		TEXTURE_CUBE_MAP, // layers are the faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order: +X, -X, +Y, -Y, +Z, -Z
+		TEXTURE3D,        // layers are depth slices
+	};
+
+	enum class TextureFormat
+	{
+		NONE = 0, // picked from the channel count: R8, RG8, RGB8 or RGBA8 (SRGB8, SRGB8_ALPHA8 if 'srgb')
+		R8,
+		RG8,
+		RGB8,
+		RGBA8,
+		SRGB8,
+		SRGB8_ALPHA8,
+		// pixels are uploaded as floats
+		R16F,
+		RG16F,
+		RGB16F,
+		RGBA16F,
+	};
+
+	enum class TextureResidency
+	{
+		DROP_AFTER_UPLOAD = 0, // decoded pixels are freed once they are on the GPU
+		KEEP,                  // kept for CPU side reads through GetPixels()
+		RELOAD_ON_DEMAND,      // freed after upload, GetPixels() decodes the file again
+	};
+
+	struct TextureMemoryStats
+	{
+		size_t cpuBytes = 0; // decoded pixels held by GLTexture
+		size_t gpuBytes = 0; // estimated from the internal format and allocated levels, drivers may pad
+		uint32_t textures = 0; // with GPU storage
+	};
+
+	struct TextureCreateInfo
+	{
+		TextureFormat format = TextureFormat::NONE;
+		bool srgb = false;   // only used with TextureFormat::NONE, for 3 and 4 channel images
+		bool mipmaps = true; // allocate and generate the full mip chain
+		// builds the mip chain of 8 bit 2D textures on the CPU (see MipGenerator) instead of glGenerateMipmap
+		MipFilter mipFilter = MipFilter::NONE;
+		TextureResidency residency = TextureResidency::DROP_AFTER_UPLOAD; // for pixels decoded by LoadTexture()
+		uint32_t updateBuffers = 2; // pixel unpack buffers Update() cycles through
 
-		// Cubemap, 1d, 3d textures
+		/** @brief Color of a 'channels' channel image is stored sRGB encoded */
+		bool IsSRGB(int channels) const
+		{
+			return format == TextureFormat::SRGB8 || format == TextureFormat::SRGB8_ALPHA8
+				|| (format == TextureFormat::NONE && srgb && channels >= 3);
+		}
 	};
 	
+	struct TextureRegion
+	{
+		int x = 0, y = 0;
+		int width = 0, height = 0; // 0 extends to the edge of level 0
+		int layer = 0;             // array layer, cube face or 3D slice
+	};
+
 	class GLTexture 
 	{
 		private:
 			GLuint m_TextureID;
+			GLHandle m_Handle; // invalid for textures that were created outside of GLTexture
 			TextureType m_TextureType;
 
 			int m_Width, m_Height, m_Channels;
-			unsigned char* m_Pixels;
+			int m_Layers; // array layers, cube faces or depth, 1 for 2D textures
+			unsigned char* m_Pixels; // floats for 16F formats
+			size_t m_PixelBytes = 0;
+			size_t m_GpuBytes = 0;
 
 			std::string m_Filepath;
 
+			TextureCreateInfo m_CreateInfo;
+			// immutable storage made with glTexStorage*, 0 if the texture is mutable
+			GLenum m_StorageFormat = 0;
+			GLsizei m_StorageLevels = 0;
+
+			TextureStreamRing* m_Stream = nullptr; // created by the first Update()
+
 			GLenum GetGLTextureType() const;
+			GLenum GetInternalFormat(int channels) const;
+			GLenum GetPixelType() const;
 
+			void CreateTexture();
+			/**
+			 * @brief Makes immutable storage if the context supports it, recreating the texture object unless the
+			 * current storage already matches. Returns false for mutable textures, the caller specifies level 0 itself
+			 */
+			bool AllocateStorage(GLenum internalFormat, int width, int height, int layers, GLsizei levels);
+			void SetGpuBytes(size_t bytes);
+			bool DecodePixels(const char* filepath);
+			// 'layerStride' bytes between the layers in 'pixels', 0 repeats the same image
+			void SpecifyLayers(int width, int height, int layers, int channels, const void* pixels, size_t layerStride);
 			void GenTextures();
 			void DeleteTextures();
+			void DeleteStream();
+			// binds on the active unit so glTex* calls that follow act on this texture
+			void BindForEdit() const;
+			void MoveFrom(GLTexture& other);
 		public:
-			GLTexture() : m_TextureType(TextureType::TEXTURE2D), m_Pixels(nullptr), m_Width(0), m_Height(0), m_Channels(0), m_TextureID(0), m_Filepath("") {};
+			GLTexture() : m_TextureID(0), m_TextureType(TextureType::TEXTURE2D), m_Width(0), m_Height(0), m_Channels(0), m_Layers(1), m_Pixels(nullptr), m_Filepath("") {};
+			// Doesn't take ownership of 'textureID'
 			GLTexture(GLuint textureID, TextureType textureType);
+			GLTexture(TextureType type, const TextureCreateInfo& createInfo);
 
+			/** @brief Decodes and uploads 'filepath', the pixels are kept or dropped as TextureCreateInfo::residency says */
 			void LoadTexture(const char* filepath);
 
+			/**
+			 * @brief Pixels decoded by LoadTexture(), nullptr if they were dropped.
+			 * With RELOAD_ON_DEMAND the file is decoded again and kept until ReleasePixels()
+			 */
+			const void* GetPixels();
+			void ReleasePixels();
+			size_t CpuBytes() const { return m_PixelBytes; }
+			size_t GpuBytes() const { return m_GpuBytes; }
+
+			/** @brief Totals over all GLTextures */
+			static const TextureMemoryStats& GetMemoryStats();
+
+			/**
+			 * @brief (Re)specifies the image and regenerates mipmaps, creates the texture object on first use.
+			 * If a GL_PIXEL_UNPACK_BUFFER is bound 'pixels' is an offset into it.
+			 * The pixels are not kept, unlike LoadTexture().
+			 * Storage is immutable where glTexStorage2D is available, uploading another size or format
+			 * then creates a new texture object (GLTexture::Bind() always uses the current one)
+			 */
+			void Upload(int width, int height, int channels, const void* pixels);
+			/** @brief Replaces a region of level 0, mipmaps are not regenerated */
+			void SubImage(int x, int y, int width, int height, int channels, const void* pixels);
+			void GenerateMipmaps();
+			/**
+			 * @brief (Re)specifies a 2D texture with every level of 'chain', nothing is generated by the driver.
+			 * If a GL_PIXEL_UNPACK_BUFFER is bound, a copy of 'chain.data' starts at 'unpackOffset' in it
+			 */
+			bool UploadMipChain(const MipChain& chain, GLintptr unpackOffset = 0);
+
+			/**
+			 * @brief Replaces 'region' of level 0 with tightly packed pixels in the texture's current channel count
+			 * (floats for 16F formats), without waiting for the GPU. The pixels are copied into the next of
+			 * TextureCreateInfo::updateBuffers pixel unpack buffers and uploaded from there, so the copy for frame N
+			 * overlaps the GPU still reading frame N - 1. A buffer the GPU isn't done with yet is orphaned
+			 * instead of waited on. Mipmaps are not regenerated.
+			 *
+			 * video.Update({ 0, 0, width, height }, frame);
+			 */
+			void Update(const TextureRegion& region, const void* pixels);
+			/**
+			 * @brief Same as Update() without the copy: returns write only memory for 'region' that
+			 * has to be filled before EndUpdate(), nullptr if the region is invalid
+			 */
+			void* BeginUpdate(const TextureRegion& region);
+			void EndUpdate();
+			// Update() calls that found their buffer still in use and orphaned it
+			uint64_t UpdateOrphanCount() const;
+
+			/**
+			 * @brief Loads one file per layer of a 2D array, face of a cube map or slice of a 3D texture.
+			 * Every file has to have the same size and channel count, cube maps need exactly 6
+			 */
+			bool LoadLayers(const std::vector<std::string>& filepaths);
+			/**
+			 * @brief (Re)specifies all layers at once from 'layers' tightly packed images and regenerates mipmaps.
+			 * Upload() on these types specifies a single layer, or the same image on every cube face
+			 */
+			void UploadLayers(int width, int height, int layers, int channels, const void* pixels);
+			/** @brief Replaces a region of one layer (or cube face) of level 0, mipmaps are not regenerated */
+			void SubImageLayer(int layer, int x, int y, int width, int height, int channels, const void* pixels);
+
+			/**
+			 * @brief Loads a block compressed KTX, KTX2 or DDS file with all of its stored mip levels.
+			 * Formats the driver doesn't support are decoded on the CPU if possible (BC1-BC5), see CompressedTexture
+			 */
+			bool LoadCompressed(const char* filepath);
+			bool UploadCompressed(const CompressedImage& image);
+
 			int Width() { return m_Width; }
 			int Height() { return m_Height; }
+			int Layers() const { return m_Layers; }
+			/** @brief Applies to the next Upload()/LoadTexture() */
+			void SetCreateInfo(const TextureCreateInfo& createInfo) { m_CreateInfo = createInfo; }
+			const TextureCreateInfo& GetCreateInfo() const { return m_CreateInfo; }
+			bool IsImmutable() const { return m_StorageFormat != 0; }
+			TextureType Type() const { return m_TextureType; }
 
 			GLTexture(TextureType type);
 			GLTexture(TextureType type, const char* filepath);
 			~GLTexture();
 
+			GLTexture(const GLTexture&) = delete;
+			GLTexture& operator=(const GLTexture&) = delete;
+			GLTexture(GLTexture&& other) noexcept;
+			GLTexture& operator=(GLTexture&& other) noexcept;
+
 			operator GLuint() { return m_TextureID; }
+			GLHandle Handle() const { return m_Handle; }
 
+			/** @brief Binds for sampling, skipped if the texture is already bound to 'slot' (see GLContext) */
 			void Bind(int slot = 0) const;
+			/**
+			 * @brief Binds a material's textures to consecutive slots, with one glBindTextures where available.
+			 * nullptr unbinds the slot
+			 *
+			 * EaseGL::GLTexture::BindTextures(0, { &albedo, &normal, &roughness });
+			 */
+			static void BindTextures(int firstSlot, std::initializer_list<const GLTexture*> textures);
+			/** @brief Unbinds 'type' on the active unit */
+			static void Unbind(TextureType type);
 	};
 } // namespace EaseGL
 
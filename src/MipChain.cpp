@@ -0,0 +1,441 @@
+#include "MipChain.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "PixelConvert.hpp"
+
+namespace EaseGL
+{
+   struct MipCacheHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t key;
+      int32_t width, height, channels;
+      uint32_t levelCount;
+      uint64_t dataSize;
+   };
+
+   static const uint32_t MIP_CACHE_MAGIC = 0x434D4745; // "EGMC"
+
+   struct MipCacheData
+   {
+      std::mutex mutex;
+      std::string directory;
+      MipCacheStats stats;
+   };
+   static MipCacheData s_MipCache;
+
+   // Kaiser window over a sinc, half width in destination texels and the window shape
+   static const float MIP_KAISER_WIDTH = 3.0f;
+   static const float MIP_KAISER_ALPHA = 4.0f;
+
+   struct MipTap
+   {
+      int index;
+      float weight;
+   };
+
+   // every destination texel has 'tapCount' taps, unused ones have weight 0
+   struct MipFilterTaps
+   {
+      int tapCount = 0;
+      std::vector<MipTap> taps;
+   };
+
+   struct MipColorTables
+   {
+      float unorm[256];
+      float srgbToLinear[256];
+      float srgbThresholds[255]; // linear value halfway between consecutive encoded values
+
+      MipColorTables()
+      {
+         for(int i = 0; i < 256; i++)
+         {
+            unorm[i] = i / 255.0f;
+            srgbToLinear[i] = (float)SRGBToLinear(i / 255.0);
+         }
+         for(int i = 0; i < 255; i++)
+            srgbThresholds[i] = (float)SRGBToLinear((i + 0.5) / 255.0);
+      }
+
+      static double SRGBToLinear(double value)
+      {
+         return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+      }
+   };
+
+   const MipColorTables& GetMipColorTables()
+   {
+      static MipColorTables tables;
+      return tables;
+   }
+
+   // same as rounding the encoded value, the encoding is monotonic
+   inline uint8_t EncodeMipSRGB(const MipColorTables& tables, float linear)
+   {
+      const float* end = tables.srgbThresholds + 255;
+      return (uint8_t)(std::upper_bound(tables.srgbThresholds, end, linear) - tables.srgbThresholds);
+   }
+
+   inline uint8_t EncodeMipUnorm(float value)
+   {
+      value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+      return (uint8_t)(value * 255.0f + 0.5f);
+   }
+
+   double MipBesselI0(double x)
+   {
+      double sum = 1.0, term = 1.0;
+      for(int k = 1; k < 32 && term > sum * 1e-12; k++)
+      {
+         term *= (x * 0.5 / k) * (x * 0.5 / k);
+         sum += term;
+      }
+      return sum;
+   }
+
+   float MipKaiserWeight(float t)
+   {
+      if(std::fabs(t) >= MIP_KAISER_WIDTH)
+         return 0.0f;
+      double x = t / MIP_KAISER_WIDTH;
+      double sinc = t == 0.0f ? 1.0 : std::sin(3.14159265358979 * t) / (3.14159265358979 * t);
+      return (float)(sinc * MipBesselI0(MIP_KAISER_ALPHA * std::sqrt(1.0 - x * x)) / MipBesselI0(MIP_KAISER_ALPHA));
+   }
+
+   // source texels and weights for each destination texel along one axis, edges are clamped
+   void ComputeMipTaps(int srcSize, int dstSize, MipFilter filter, MipFilterTaps& result)
+   {
+      float scale = (float)srcSize / dstSize;
+      std::vector<std::vector<MipTap>> texels(dstSize);
+      for(int x = 0; x < dstSize; x++)
+      {
+         std::vector<MipTap>& taps = texels[x];
+         if(filter == MipFilter::BOX)
+         {
+            // area of each source texel covered by the destination texel, odd sizes get fractional weights
+            float low = x * scale, high = low + scale;
+            for(int i = (int)low; i < srcSize && i < high; i++)
+            {
+               float weight = std::min(high, i + 1.0f) - std::max(low, (float)i);
+               if(weight > 0.0f)
+                  taps.push_back({ i, weight });
+            }
+         }
+         else
+         {
+            float center = (x + 0.5f) * scale;
+            float radius = MIP_KAISER_WIDTH * scale;
+            for(int i = (int)std::floor(center - radius); i <= (int)std::ceil(center + radius); i++)
+            {
+               float weight = MipKaiserWeight((i + 0.5f - center) / scale);
+               if(weight != 0.0f)
+                  taps.push_back({ std::min(std::max(i, 0), srcSize - 1), weight });
+            }
+         }
+
+         float sum = 0.0f;
+         for(const MipTap& tap : taps)
+            sum += tap.weight;
+         for(MipTap& tap : taps)
+            tap.weight /= sum;
+         result.tapCount = std::max(result.tapCount, (int)taps.size());
+      }
+
+      result.taps.assign((size_t)dstSize * result.tapCount, { 0, 0.0f });
+      for(int x = 0; x < dstSize; x++)
+         std::copy(texels[x].begin(), texels[x].end(), result.taps.begin() + (size_t)x * result.tapCount);
+   }
+
+   // separable filter of destination rows [rowBegin, rowEnd): columns first into a float row, then along it
+   void FilterMipRows(const unsigned char* src, int srcWidth, unsigned char* dst, int dstWidth, int channels, bool srgb,
+      const MipFilterTaps& xTaps, const MipFilterTaps& yTaps, int rowBegin, int rowEnd)
+   {
+      const MipColorTables& tables = GetMipColorTables();
+      int colorChannels = channels == 2 || channels == 4 ? channels - 1 : channels;
+      const float* decode[4];
+      for(int c = 0; c < channels; c++)
+         decode[c] = srgb && c < colorChannels ? tables.srgbToLinear : tables.unorm;
+
+      size_t srcRowSize = (size_t)srcWidth * channels;
+      std::vector<float> row(srcRowSize);
+      for(int y = rowBegin; y < rowEnd; y++)
+      {
+         std::fill(row.begin(), row.end(), 0.0f);
+         for(int t = 0; t < yTaps.tapCount; t++)
+         {
+            const MipTap& tap = yTaps.taps[(size_t)y * yTaps.tapCount + t];
+            if(tap.weight == 0.0f)
+               continue;
+            const unsigned char* srcRow = src + tap.index * srcRowSize;
+            if(!srgb)
+            {
+               float weight = tap.weight * (1.0f / 255.0f);
+               for(size_t i = 0; i < srcRowSize; i++)
+                  row[i] += weight * srcRow[i];
+            }
+            else
+            {
+               for(size_t i = 0; i < srcRowSize; i += channels)
+                  for(int c = 0; c < channels; c++)
+                     row[i + c] += tap.weight * decode[c][srcRow[i + c]];
+            }
+         }
+
+         unsigned char* dstRow = dst + (size_t)y * dstWidth * channels;
+         for(int x = 0; x < dstWidth; x++)
+         {
+            float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            const MipTap* taps = xTaps.taps.data() + (size_t)x * xTaps.tapCount;
+            for(int t = 0; t < xTaps.tapCount; t++)
+            {
+               const float* texel = row.data() + (size_t)taps[t].index * channels;
+               for(int c = 0; c < channels; c++)
+                  sums[c] += taps[t].weight * texel[c];
+            }
+            for(int c = 0; c < channels; c++)
+               dstRow[x * channels + c] = srgb && c < colorChannels ? EncodeMipSRGB(tables, sums[c]) : EncodeMipUnorm(sums[c]);
+         }
+      }
+   }
+
+   void HalveMipRows(const unsigned char* src, int srcWidth, unsigned char* dst, int dstWidth, int channels, int rowBegin, int rowEnd)
+   {
+      size_t srcRowSize = (size_t)srcWidth * channels;
+      for(int y = rowBegin; y < rowEnd; y++)
+         PixelConvert::HalveBox(src + y * 2 * srcRowSize, src + (y * 2 + 1) * srcRowSize, dst + (size_t)y * dstWidth * channels, dstWidth, channels);
+   }
+
+   void SetMipChainLayout(int width, int height, int channels, MipChain& chain)
+   {
+      chain.width = width;
+      chain.height = height;
+      chain.channels = channels;
+      chain.levels.clear();
+
+      size_t offset = 0;
+      while(true)
+      {
+         size_t size = (size_t)width * height * channels;
+         chain.levels.push_back({ width, height, offset, size });
+         offset += size;
+         if(width == 1 && height == 1)
+            break;
+         width = std::max(width / 2, 1);
+         height = std::max(height / 2, 1);
+      }
+      chain.data.resize(offset);
+   }
+
+   uint64_t HashMipBytes(uint64_t hash, const void* data, size_t size)
+   {
+      // 8 bytes per step, level 0 of a large texture is tens of megabytes
+      const unsigned char* bytes = (const unsigned char*)data;
+      size_t i = 0;
+      for(; i + 8 <= size; i += 8)
+      {
+         uint64_t word;
+         memcpy(&word, bytes + i, sizeof(word));
+         hash = (hash ^ word) * 0x100000001B3ull;
+         hash ^= hash >> 29;
+      }
+      for(; i < size; i++)
+         hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+      return hash;
+   }
+
+   // static
+   bool MipGenerator::Build(const unsigned char* pixels, int width, int height, int channels, MipFilter filter, bool srgb,
+      MipChain& chain, uint32_t threadCount /* = 0*/)
+   {
+      if(pixels == nullptr || width <= 0 || height <= 0 || channels < 1 || channels > 4 || filter == MipFilter::NONE)
+      {
+         std::cout << "ERROR: Can't build a mip chain for a " << width << "x" << height << "x" << channels << " image" << std::endl;
+         return false;
+      }
+
+      bool cached = !GetCacheDirectory().empty();
+      uint64_t key = 14695981039346656037ull;
+      if(cached)
+      {
+         int32_t description[6] = { (int32_t)FORMAT_VERSION, width, height, channels, (int32_t)filter, srgb ? 1 : 0 };
+         key = HashMipBytes(key, description, sizeof(description));
+         key = HashMipBytes(key, pixels, (size_t)width * height * channels);
+         if(LoadCached(key, width, height, channels, chain))
+            return true;
+      }
+
+      SetMipChainLayout(width, height, channels, chain);
+      memcpy(chain.data.data(), pixels, chain.levels[0].size);
+
+      if(threadCount == 0)
+         threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+      for(size_t level = 1; level < chain.levels.size(); level++)
+      {
+         const MipLevel& source = chain.levels[level - 1];
+         const MipLevel& target = chain.levels[level];
+         const unsigned char* src = chain.data.data() + source.offset;
+         unsigned char* dst = chain.data.data() + target.offset;
+
+         // exact halving of plain values is the integer kernel, everything else goes through the float filter
+         bool halve = filter == MipFilter::BOX && !srgb && source.width == target.width * 2 && source.height == target.height * 2;
+         MipFilterTaps xTaps, yTaps;
+         if(!halve)
+         {
+            ComputeMipTaps(source.width, target.width, filter, xTaps);
+            ComputeMipTaps(source.height, target.height, filter, yTaps);
+         }
+
+         auto filterRows = [&](int rowBegin, int rowEnd)
+         {
+            if(halve)
+               HalveMipRows(src, source.width, dst, target.width, channels, rowBegin, rowEnd);
+            else
+               FilterMipRows(src, source.width, dst, target.width, channels, srgb, xTaps, yTaps, rowBegin, rowEnd);
+         };
+
+         // bands of at least 32 rows, starting threads costs more than filtering small levels
+         uint32_t bands = std::min(threadCount, (uint32_t)std::max(target.height / 32, 1));
+         if((size_t)target.width * target.height < 128 * 128)
+            bands = 1;
+         int bandRows = (target.height + bands - 1) / bands;
+
+         std::vector<std::thread> workers;
+         for(uint32_t band = 1; band < bands; band++)
+         {
+            int rowBegin = band * bandRows;
+            workers.emplace_back(filterRows, rowBegin, std::min(rowBegin + bandRows, target.height));
+         }
+         filterRows(0, std::min(bandRows, target.height));
+         for(std::thread& worker : workers)
+            worker.join();
+      }
+
+      if(cached)
+         StoreCached(key, chain);
+      return true;
+   }
+
+   // static
+   void MipGenerator::SetCacheDirectory(const std::string& directory)
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      s_MipCache.directory.clear();
+      if(directory.empty())
+         return;
+
+      std::string versioned = directory + "/v" + std::to_string(FORMAT_VERSION);
+      std::error_code error;
+      std::filesystem::create_directories(versioned, error);
+      if(error)
+      {
+         std::cout << "ERROR: Failed to create mip cache directory " << versioned << ": " << error.message() << std::endl;
+         return;
+      }
+      s_MipCache.directory = versioned;
+   }
+
+   // static
+   std::string MipGenerator::GetCacheDirectory()
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      return s_MipCache.directory;
+   }
+
+   // static
+   std::string MipGenerator::FilePath(uint64_t key)
+   {
+      char name[32];
+      snprintf(name, sizeof(name), "%016llx.mips", (unsigned long long)key);
+      return GetCacheDirectory() + "/" + name;
+   }
+
+   // static
+   bool MipGenerator::LoadCached(uint64_t key, int width, int height, int channels, MipChain& chain)
+   {
+      std::ifstream file(FilePath(key), std::ios::binary);
+      bool valid = false;
+      if(file)
+      {
+         SetMipChainLayout(width, height, channels, chain);
+         MipCacheHeader header;
+         valid = (bool)file.read((char*)&header, sizeof(header))
+            && header.magic == MIP_CACHE_MAGIC && header.version == FORMAT_VERSION && header.key == key
+            && header.width == width && header.height == height && header.channels == channels
+            && header.levelCount == chain.levels.size() && header.dataSize == chain.data.size()
+            && (bool)file.read((char*)chain.data.data(), chain.data.size());
+      }
+
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      if(valid)
+         s_MipCache.stats.hits++;
+      else
+         s_MipCache.stats.misses++;
+      return valid;
+   }
+
+   // static
+   void MipGenerator::StoreCached(uint64_t key, const MipChain& chain)
+   {
+      MipCacheHeader header;
+      header.magic = MIP_CACHE_MAGIC;
+      header.version = FORMAT_VERSION;
+      header.key = key;
+      header.width = chain.width;
+      header.height = chain.height;
+      header.channels = chain.channels;
+      header.levelCount = (uint32_t)chain.levels.size();
+      header.dataSize = chain.data.size();
+
+      // written next to the target and renamed, so a crash or another thread never sees half a file
+      std::string path = FilePath(key);
+      std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if(!file)
+      {
+         std::cout << "ERROR: Failed to write mip chain " << tempPath << std::endl;
+         return;
+      }
+      file.write((const char*)&header, sizeof(header));
+      file.write((const char*)chain.data.data(), chain.data.size());
+      file.close();
+
+      std::error_code error;
+      std::filesystem::rename(tempPath, path, error);
+      if(error)
+      {
+         std::filesystem::remove(tempPath, error);
+         return;
+      }
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      s_MipCache.stats.stored++;
+   }
+
+   // static
+   MipCacheStats MipGenerator::GetStats()
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      return s_MipCache.stats;
+   }
+
+   // static
+   void MipGenerator::ResetStats()
+   {
+      std::lock_guard<std::mutex> lock(s_MipCache.mutex);
+      s_MipCache.stats = MipCacheStats();
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,82 @@
+#ifndef MIPCHAIN_H
+#define MIPCHAIN_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace EaseGL
+{
+	enum class MipFilter
+	{
+		NONE = 0, // levels are generated by the driver with glGenerateMipmap
+		BOX,      // 2x2 average, what most drivers do, but computed on the CPU
+		KAISER,   // Kaiser windowed sinc, keeps small details sharper down the chain
+	};
+
+	struct MipLevel
+	{
+		int width, height;
+		size_t offset; // into MipChain::data
+		size_t size;
+	};
+
+	/** @brief 8 bit pixels of every level down to 1x1, tightly packed one after another */
+	struct MipChain
+	{
+		int width = 0, height = 0, channels = 0;
+		std::vector<MipLevel> levels; // level 0 first
+		std::vector<unsigned char> data;
+
+		const unsigned char* LevelData(size_t level) const { return data.data() + levels[level].offset; }
+	};
+
+	struct MipCacheStats
+	{
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		uint32_t stored = 0;
+	};
+
+	/**
+	 * @brief Builds mip chains on the CPU, see TextureCreateInfo::mipFilter and GLTexture::UploadMipChain().
+	 * Each level is filtered from the previous one, split into bands of rows over worker threads.
+	 * sRGB images are filtered in linear space (alpha is always linear), which keeps them from darkening
+	 * down the chain the way averaging encoded values does.
+	 *
+	 * With SetCacheDirectory() finished chains are also written to disk, keyed by the level 0 pixels and
+	 * the filter, so loading the same image again skips filtering.
+	 * Safe to call from any thread.
+	 */
+	class MipGenerator
+	{
+		private:
+			MipGenerator() {}
+
+			static std::string FilePath(uint64_t key);
+			static bool LoadCached(uint64_t key, int width, int height, int channels, MipChain& chain);
+			static void StoreCached(uint64_t key, const MipChain& chain);
+		public:
+			// bump when the file layout, the key or a filter changes, old directories are left alone
+			static constexpr uint32_t FORMAT_VERSION = 1;
+
+			/**
+			 * @brief Fills 'chain' with 'pixels' as level 0 and every smaller level down to 1x1.
+			 * @param srgb color is sRGB encoded, the last channel of 2 and 4 channel images is alpha and stays linear
+			 * @param threadCount threads per level, 0 uses the hardware threads. Small levels always use one
+			 */
+			static bool Build(const unsigned char* pixels, int width, int height, int channels, MipFilter filter, bool srgb,
+				MipChain& chain, uint32_t threadCount = 0);
+
+			/** @brief Enables the disk cache, files are written to 'directory'/v<FORMAT_VERSION>. Empty string disables it */
+			static void SetCacheDirectory(const std::string& directory);
+			static std::string GetCacheDirectory();
+
+			static MipCacheStats GetStats();
+			static void ResetStats();
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,329 @@
+#include "PixelConvert.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <cstring>
+
+#if !defined(EASEGL_PIXELCONVERT_SCALAR)
+   #if defined(__AVX2__)
+      #define EASEGL_PIXELCONVERT_AVX2
+   #endif
+   // AVX2 doesn't imply F16C for the compiler (gcc -mavx2 alone), MSVC allows its intrinsics with /arch:AVX2
+   #if defined(EASEGL_PIXELCONVERT_AVX2) && (defined(__F16C__) || defined(_MSC_VER))
+      #define EASEGL_PIXELCONVERT_F16C
+   #endif
+   // MSVC doesn't define __SSSE3__, every AVX2 cpu has it
+   #if defined(__SSSE3__) || defined(EASEGL_PIXELCONVERT_AVX2)
+      #define EASEGL_PIXELCONVERT_SSSE3
+   #endif
+   #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+      #define EASEGL_PIXELCONVERT_SSE2
+   #endif
+#endif
+
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+   #include <immintrin.h>
+#elif defined(EASEGL_PIXELCONVERT_SSSE3)
+   #include <tmmintrin.h>
+#elif defined(EASEGL_PIXELCONVERT_SSE2)
+   #include <emmintrin.h>
+#endif
+
+namespace EaseGL
+{
+   // round(c * a / 255) without a division, exact for all 8 bit inputs
+   inline uint8_t PremultiplyChannel(uint32_t c, uint32_t a)
+   {
+      uint32_t t = c * a + 128;
+      return (uint8_t)((t + (t >> 8)) >> 8);
+   }
+
+   // round to nearest even, inputs here are never subnormal or out of half range
+   uint16_t FloatToHalfBits(float value)
+   {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      uint32_t sign = (bits >> 16) & 0x8000;
+      int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+      uint32_t mantissa = bits & 0x7FFFFF;
+      if(exponent <= 0)
+         return (uint16_t)sign;
+      if(exponent >= 31)
+         return (uint16_t)(sign | 0x7C00);
+
+      uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+      uint32_t rest = mantissa & 0x1FFF;
+      if(rest > 0x1000 || (rest == 0x1000 && (half & 1) != 0))
+         half++; // a carry out of the mantissa correctly bumps the exponent
+      return (uint16_t)half;
+   }
+
+   struct PixelConvertHalfTable
+   {
+      uint16_t values[256];
+
+      PixelConvertHalfTable()
+      {
+         // same expression as the vector paths so every backend rounds identically
+         for(int i = 0; i < 256; i++)
+            values[i] = FloatToHalfBits((float)i * (1.0f / 255.0f));
+      }
+   };
+
+   const uint16_t* GetHalfTable()
+   {
+      static PixelConvertHalfTable table;
+      return table.values;
+   }
+
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+   // 2 pixels widened to 16 bit lanes
+   inline __m128i PremultiplyWide(__m128i pixels, __m128i alphaLanes, __m128i c255, __m128i c128)
+   {
+      __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+      // alpha itself is multiplied by 255 so it comes out unchanged
+      alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, c255));
+      __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), c128);
+      return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+   }
+#endif
+
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+   inline __m256i PremultiplyWide256(__m256i pixels, __m256i alphaLanes, __m256i c255, __m256i c128)
+   {
+      __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+      alpha = _mm256_or_si256(_mm256_andnot_si256(alphaLanes, alpha), _mm256_and_si256(alphaLanes, c255));
+      __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), c128);
+      return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+   }
+#endif
+
+   // static
+   void PixelConvert::RGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha /* = 255*/)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+         __m256i alphas = _mm256_set1_epi32((int)((uint32_t)alpha << 24));
+         // each lane reads 16 bytes for 4 pixels, the last one may read 4 bytes past its 12
+         for(; i + 10 <= pixelCount; i += 8)
+         {
+            const uint8_t* src = rgb + i * 3;
+            __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)),
+               _mm_loadu_si128((const __m128i*)(src + 12)), 1);
+            _mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alphas));
+         }
+      }
+#elif defined(EASEGL_PIXELCONVERT_SSSE3)
+      {
+         __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+         __m128i alphas = _mm_set1_epi32((int)((uint32_t)alpha << 24));
+         for(; i + 6 <= pixelCount; i += 4)
+         {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(rgb + i * 3));
+            _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alphas));
+         }
+      }
+#endif
+      // SSE2 has no byte shuffle, a 3 -> 4 byte expansion with shifts is no faster than this
+      for(; i < pixelCount; i++)
+      {
+         rgba[i * 4 + 0] = rgb[i * 3 + 0];
+         rgba[i * 4 + 1] = rgb[i * 3 + 1];
+         rgba[i * 4 + 2] = rgb[i * 3 + 2];
+         rgba[i * 4 + 3] = alpha;
+      }
+   }
+
+   // static
+   void PixelConvert::PremultiplyAlpha(const uint8_t* rgba, uint8_t* out, size_t pixelCount)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i zero = _mm256_setzero_si256();
+         __m256i alphaLanes = _mm256_set1_epi64x((long long)0xFFFF000000000000ull);
+         __m256i c255 = _mm256_set1_epi16(255);
+         __m256i c128 = _mm256_set1_epi16(128);
+         for(; i + 8 <= pixelCount; i += 8)
+         {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(rgba + i * 4));
+            __m256i low = PremultiplyWide256(_mm256_unpacklo_epi8(pixels, zero), alphaLanes, c255, c128);
+            __m256i high = PremultiplyWide256(_mm256_unpackhi_epi8(pixels, zero), alphaLanes, c255, c128);
+            _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_packus_epi16(low, high));
+         }
+      }
+#endif
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+      {
+         __m128i zero = _mm_setzero_si128();
+         __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+         __m128i c255 = _mm_set1_epi16(255);
+         __m128i c128 = _mm_set1_epi16(128);
+         for(; i + 4 <= pixelCount; i += 4)
+         {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+            __m128i low = PremultiplyWide(_mm_unpacklo_epi8(pixels, zero), alphaLanes, c255, c128);
+            __m128i high = PremultiplyWide(_mm_unpackhi_epi8(pixels, zero), alphaLanes, c255, c128);
+            _mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(low, high));
+         }
+      }
+#endif
+      for(; i < pixelCount; i++)
+      {
+         uint8_t a = rgba[i * 4 + 3];
+         out[i * 4 + 0] = PremultiplyChannel(rgba[i * 4 + 0], a);
+         out[i * 4 + 1] = PremultiplyChannel(rgba[i * 4 + 1], a);
+         out[i * 4 + 2] = PremultiplyChannel(rgba[i * 4 + 2], a);
+         out[i * 4 + 3] = a;
+      }
+   }
+
+   // static
+   void PixelConvert::SwapRedBlue(const uint8_t* in, uint8_t* out, size_t pixelCount)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+         for(; i + 8 <= pixelCount; i += 8)
+         {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(in + i * 4));
+            _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+         }
+      }
+#endif
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+      {
+         // green and alpha stay, red and blue trade places within each 32 bit pixel
+         __m128i greenAlpha = _mm_set1_epi32((int)0xFF00FF00);
+         for(; i + 4 <= pixelCount; i += 4)
+         {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(in + i * 4));
+            __m128i redBlue = _mm_andnot_si128(greenAlpha, pixels);
+            __m128i swapped = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+            _mm_storeu_si128((__m128i*)(out + i * 4), _mm_or_si128(_mm_and_si128(greenAlpha, pixels), swapped));
+         }
+      }
+#endif
+      for(; i < pixelCount; i++)
+      {
+         uint8_t red = in[i * 4 + 0];
+         out[i * 4 + 0] = in[i * 4 + 2];
+         out[i * 4 + 1] = in[i * 4 + 1];
+         out[i * 4 + 2] = red;
+         out[i * 4 + 3] = in[i * 4 + 3];
+      }
+   }
+
+   // static
+   void PixelConvert::ToHalf(const uint8_t* in, uint16_t* out, size_t valueCount)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_F16C)
+      {
+         __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+         for(; i + 8 <= valueCount; i += 8)
+         {
+            __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(in + i))));
+            _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_mul_ps(values, scale), _MM_FROUND_TO_NEAREST_INT));
+         }
+      }
+#endif
+      // without a float -> half instruction a 256 entry table beats converting
+      const uint16_t* table = GetHalfTable();
+      for(; i < valueCount; i++)
+         out[i] = table[in[i]];
+   }
+
+   // static
+   void PixelConvert::GrayToRG(const uint8_t* gray, uint8_t* rg, size_t pixelCount, uint8_t green /* = 255*/)
+   {
+      size_t i = 0;
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      {
+         __m256i greens = _mm256_set1_epi8((char)green);
+         for(; i + 32 <= pixelCount; i += 32)
+         {
+            // unpack works per 128 bit lane, order the 64 bit halves so both outputs come out contiguous
+            __m256i values = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(gray + i)), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)(rg + i * 2), _mm256_unpacklo_epi8(values, greens));
+            _mm256_storeu_si256((__m256i*)(rg + i * 2 + 32), _mm256_unpackhi_epi8(values, greens));
+         }
+      }
+#endif
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+      {
+         __m128i greens = _mm_set1_epi8((char)green);
+         for(; i + 16 <= pixelCount; i += 16)
+         {
+            __m128i values = _mm_loadu_si128((const __m128i*)(gray + i));
+            _mm_storeu_si128((__m128i*)(rg + i * 2), _mm_unpacklo_epi8(values, greens));
+            _mm_storeu_si128((__m128i*)(rg + i * 2 + 16), _mm_unpackhi_epi8(values, greens));
+         }
+      }
+#endif
+      for(; i < pixelCount; i++)
+      {
+         rg[i * 2 + 0] = gray[i];
+         rg[i * 2 + 1] = green;
+      }
+   }
+
+   // static
+   void PixelConvert::HalveBox(const uint8_t* row0, const uint8_t* row1, uint8_t* out, size_t outPixels, int channels)
+   {
+      size_t i = 0;
+      if(channels == 4)
+      {
+#if defined(EASEGL_PIXELCONVERT_SSE2)
+         __m128i zero = _mm_setzero_si128();
+         __m128i two = _mm_set1_epi16(2);
+         for(; i + 4 <= outPixels; i += 4)
+         {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + i * 8));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + i * 8 + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + i * 8));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + i * 8 + 16));
+            // vertical sums, two source pixels per register
+            __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+            __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+            __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+            __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+            // horizontal pairs are the two 64 bit halves
+            __m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+            __m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+            h0 = _mm_srli_epi16(_mm_add_epi16(h0, two), 2);
+            h1 = _mm_srli_epi16(_mm_add_epi16(h1, two), 2);
+            _mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(h0, h1));
+         }
+#endif
+      }
+      for(; i < outPixels; i++)
+      {
+         for(int c = 0; c < channels; c++)
+         {
+            size_t left = i * 2 * channels + c;
+            out[i * channels + c] = (uint8_t)((row0[left] + row0[left + channels] + row1[left] + row1[left + channels] + 2) >> 2);
+         }
+      }
+   }
+
+   // static
+   const char* PixelConvert::Backend()
+   {
+#if defined(EASEGL_PIXELCONVERT_AVX2)
+      return "AVX2";
+#elif defined(EASEGL_PIXELCONVERT_SSSE3)
+      return "SSSE3";
+#elif defined(EASEGL_PIXELCONVERT_SSE2)
+      return "SSE2";
+#else
+      return "scalar";
+#endif
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,48 @@
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace EaseGL
+{
+	/**
+	 * @brief Pixel format conversions for the upload path, so the driver is handed data already in its final layout.
+	 * The backend is picked at compile time: AVX2, SSSE3 or SSE2, with a scalar fallback for the rest (ARM included)
+	 * and for the tails. ToHalf() is only vectorized when F16C is enabled too (-mf16c, or -march=haswell and later).
+	 * Define EASEGL_PIXELCONVERT_SCALAR to force the fallback.
+	 * All kernels give the same results on every backend. Safe to call from any thread.
+	 */
+	class PixelConvert
+	{
+		private:
+			PixelConvert() {}
+		public:
+			/** @brief 3 bytes per pixel to 4, 'alpha' is written to the new channel. 'rgb' and 'rgba' can't overlap */
+			static void RGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha = 255);
+
+			/** @brief Multiplies color by alpha (rounded c * a / 255), alpha is kept. 'out' may be 'rgba' */
+			static void PremultiplyAlpha(const uint8_t* rgba, uint8_t* out, size_t pixelCount);
+
+			/** @brief Swaps the first and third channel, BGRA <-> RGBA. 'out' may be 'in' */
+			static void SwapRedBlue(const uint8_t* in, uint8_t* out, size_t pixelCount);
+
+			/** @brief 8 bit unorm values to half floats (value / 255), for 16F textures */
+			static void ToHalf(const uint8_t* in, uint16_t* out, size_t valueCount);
+
+			/** @brief 1 byte per pixel to 2, red is the gray value and green is 'green' */
+			static void GrayToRG(const uint8_t* gray, uint8_t* rg, size_t pixelCount, uint8_t green = 255);
+
+			/**
+			 * @brief Averages 2x2 blocks of 'channels' byte pixels (rounded), one mip level step of a box filter.
+			 * 'row0' and 'row1' hold 2 * 'outPixels' pixels each, 'out' gets 'outPixels'. Vectorized for 4 channels
+			 */
+			static void HalveBox(const uint8_t* row0, const uint8_t* row1, uint8_t* out, size_t outPixels, int channels);
+
+			/** @brief "AVX2", "SSSE3", "SSE2" or "scalar" */
+			static const char* Backend();
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,200 @@
+#include "ProgramBinaryCache.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "GLContext.hpp"
+
+namespace EaseGL
+{
+   struct ProgramBinaryHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t key;
+      uint32_t format;
+      uint32_t length;
+   };
+
+   static const uint32_t PROGRAM_BINARY_MAGIC = 0x42504745; // "EGPB"
+
+   static std::string s_ProgramCacheDirectory;
+   static ProgramBinaryCacheStats s_ProgramCacheStats;
+
+   uint64_t HashProgramBytes(uint64_t hash, const void* data, size_t size)
+   {
+      const unsigned char* bytes = (const unsigned char*)data;
+      for(size_t i = 0; i < size; i++)
+         hash = (hash ^ bytes[i]) * 1099511628211ull;
+      return hash;
+   }
+
+   // static
+   void ProgramBinaryCache::SetDirectory(const std::string& directory)
+   {
+      s_ProgramCacheDirectory.clear();
+      if(directory.empty())
+         return;
+
+      std::string versioned = directory + "/v" + std::to_string(FORMAT_VERSION);
+      std::error_code error;
+      std::filesystem::create_directories(versioned, error);
+      if(error)
+      {
+         std::cout << "ERROR: Failed to create program cache directory " << versioned << ": " << error.message() << std::endl;
+         return;
+      }
+      s_ProgramCacheDirectory = versioned;
+   }
+
+   // static
+   const std::string& ProgramBinaryCache::GetDirectory()
+   {
+      return s_ProgramCacheDirectory;
+   }
+
+   // static
+   bool ProgramBinaryCache::IsAvailable()
+   {
+      if(s_ProgramCacheDirectory.empty())
+         return false;
+      if(!GLContext::HasVersion(4, 1) && !GLContext::HasExtension("GL_ARB_get_program_binary"))
+         return false;
+
+      GLint formatCount = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+      return formatCount > 0;
+   }
+
+   // static
+   uint64_t ProgramBinaryCache::Key(const std::string* stageSources, size_t stageCount)
+   {
+      const std::string& driver = GLContext::DriverIdentity();
+      uint64_t hash = 14695981039346656037ull;
+      hash = HashProgramBytes(hash, driver.data(), driver.size());
+      for(size_t i = 0; i < stageCount; i++)
+      {
+         // length prefix so moving text between stages changes the key
+         uint64_t length = stageSources[i].size();
+         hash = HashProgramBytes(hash, &length, sizeof(length));
+         hash = HashProgramBytes(hash, stageSources[i].data(), stageSources[i].size());
+      }
+      return hash;
+   }
+
+   // static
+   std::string ProgramBinaryCache::FilePath(uint64_t key)
+   {
+      char name[32];
+      snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+      return s_ProgramCacheDirectory + "/" + name;
+   }
+
+   // static
+   bool ProgramBinaryCache::Load(GLuint program, uint64_t key)
+   {
+      std::string path = FilePath(key);
+      std::ifstream file(path, std::ios::binary);
+      if(!file)
+      {
+         s_ProgramCacheStats.misses++;
+         return false;
+      }
+
+      // Store() writes the header and exactly 'length' bytes, anything else is a corrupt entry
+      file.seekg(0, std::ios::end);
+      std::streamoff fileSize = file.tellg();
+      file.seekg(0, std::ios::beg);
+
+      ProgramBinaryHeader header;
+      std::vector<char> binary;
+      bool valid = fileSize >= (std::streamoff)sizeof(header) && (bool)file.read((char*)&header, sizeof(header))
+         && header.magic == PROGRAM_BINARY_MAGIC && header.version == FORMAT_VERSION && header.key == key
+         && header.length > 0 && (std::streamoff)header.length == fileSize - (std::streamoff)sizeof(header);
+      if(valid)
+      {
+         binary.resize(header.length);
+         valid = (bool)file.read(binary.data(), header.length);
+      }
+      file.close();
+
+      GLint success = 0;
+      if(valid)
+      {
+         glProgramBinary(program, header.format, binary.data(), (GLsizei)header.length);
+         glGetProgramiv(program, GL_LINK_STATUS, &success);
+      }
+
+      if(!success)
+      {
+         s_ProgramCacheStats.rejected++;
+         std::error_code error;
+         std::filesystem::remove(path, error);
+         return false;
+      }
+
+      s_ProgramCacheStats.hits++;
+      return true;
+   }
+
+   // static
+   void ProgramBinaryCache::Store(GLuint program, uint64_t key)
+   {
+      GLint length = 0;
+      glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+      if(length <= 0)
+         return;
+
+      std::vector<char> binary(length);
+      GLenum format = 0;
+      glGetProgramBinary(program, length, &length, &format, binary.data());
+
+      ProgramBinaryHeader header;
+      header.magic = PROGRAM_BINARY_MAGIC;
+      header.version = FORMAT_VERSION;
+      header.key = key;
+      header.format = format;
+      header.length = (uint32_t)length;
+
+      // written next to the target and renamed, a crash never leaves a truncated binary behind
+      std::string path = FilePath(key);
+      std::string tempPath = path + ".tmp";
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if(!file)
+      {
+         std::cout << "ERROR: Failed to write program binary " << tempPath << std::endl;
+         return;
+      }
+      file.write((const char*)&header, sizeof(header));
+      file.write(binary.data(), length);
+      file.close();
+
+      std::error_code error;
+      std::filesystem::rename(tempPath, path, error);
+      if(error)
+      {
+         std::filesystem::remove(tempPath, error);
+         return;
+      }
+      s_ProgramCacheStats.stored++;
+   }
+
+   // static
+   const ProgramBinaryCacheStats& ProgramBinaryCache::GetStats()
+   {
+      return s_ProgramCacheStats;
+   }
+
+   // static
+   void ProgramBinaryCache::ResetStats()
+   {
+      s_ProgramCacheStats = ProgramBinaryCacheStats();
+   }
+} // namespace EaseGL
+#endif
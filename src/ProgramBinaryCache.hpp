@@ -0,0 +1,61 @@
+#ifndef PROGRAMBINARYCACHE_H
+#define PROGRAMBINARYCACHE_H
+#pragma once
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <string>
+
+namespace EaseGL
+{
+	struct ProgramBinaryCacheStats
+	{
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		uint32_t rejected = 0; // binaries the driver refused, recompiled from source
+		uint32_t stored = 0;
+	};
+
+	/**
+	 * @brief Stores linked programs on disk with glGetProgramBinary so the next launch can skip compiling.
+	 * Disabled until SetDirectory() is called. Binaries are keyed by the stage sources and GLContext::DriverIdentity(),
+	 * a driver update or a shader edit simply produces a new key.
+	 *
+	 * EaseGL::ProgramBinaryCache::SetDirectory("cache/shaders");
+	 * EaseGL::Shader shader("shader.glsl"); // loaded from cache/shaders/v1/ if possible
+	 */
+	class ProgramBinaryCache
+	{
+		private:
+			ProgramBinaryCache() {}
+
+			static std::string FilePath(uint64_t key);
+		public:
+			// bump when the file layout or key changes, old directories are left alone
+			static constexpr uint32_t FORMAT_VERSION = 1;
+
+			/** @brief Enables the cache, files are written to 'directory'/v<FORMAT_VERSION>. Empty string disables it */
+			static void SetDirectory(const std::string& directory);
+			static const std::string& GetDirectory();
+
+			/** @brief Enabled and the context can retrieve program binaries */
+			static bool IsAvailable();
+
+			/** @brief Key for a program made from 'stageCount' stage sources on the current driver */
+			static uint64_t Key(const std::string* stageSources, size_t stageCount);
+
+			/**
+			 * @brief Loads the binary stored under 'key' into 'program'. Returns false if there is none
+			 * or the driver rejects it, in which case the file is removed and 'program' should be linked from source.
+			 */
+			static bool Load(GLuint program, uint64_t key);
+
+			/** @brief 'program' must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set */
+			static void Store(GLuint program, uint64_t key);
+
+			static const ProgramBinaryCacheStats& GetStats();
+			static void ResetStats();
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,218 @@
+#include "Sampler.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "GLContext.hpp"
+#include "GLObjectPool.hpp"
+
+namespace EaseGL
+{
+   struct SamplerCacheData
+   {
+      std::vector<SamplerDesc> descs;
+      std::vector<GLHandle> handles; // same order as 'descs'
+      std::vector<GLuint> boundSamplers; // per texture unit, 0 where texture parameters apply
+      float maxAnisotropy = 0.0f;    // queried on first use
+      uint32_t contextResets = 0;    // GLContext::ResetCount() of the context the samplers belong to
+   };
+
+   static SamplerCacheData s_SamplerCache;
+
+   // samplers of a context that was reset are gone with it, only the cache entries are dropped
+   void DropStaleSamplerCache()
+   {
+      if(s_SamplerCache.contextResets == GLContext::ResetCount())
+         return;
+      s_SamplerCache = SamplerCacheData();
+      s_SamplerCache.contextResets = GLContext::ResetCount();
+   }
+
+   GLenum GetSamplerMinFilter(SamplerFilter filter, SamplerMipmapMode mipmapMode)
+   {
+      bool linear = filter == SamplerFilter::LINEAR;
+      return mipmapMode == SamplerMipmapMode::NEAREST ? (linear ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST)
+         : mipmapMode == SamplerMipmapMode::LINEAR ? (linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR)
+         : linear ? GL_LINEAR : GL_NEAREST;
+   }
+
+   GLenum GetSamplerWrap(SamplerWrap wrap)
+   {
+      return wrap == SamplerWrap::MIRRORED_REPEAT ? GL_MIRRORED_REPEAT
+         : wrap == SamplerWrap::CLAMP_TO_EDGE ? GL_CLAMP_TO_EDGE
+         : wrap == SamplerWrap::CLAMP_TO_BORDER ? GL_CLAMP_TO_BORDER
+         : GL_REPEAT;
+   }
+
+   GLenum GetSamplerCompareFunc(SamplerCompare compare)
+   {
+      return compare == SamplerCompare::GREATER_EQUAL ? GL_GEQUAL
+         : compare == SamplerCompare::LESS ? GL_LESS
+         : compare == SamplerCompare::GREATER ? GL_GREATER
+         : compare == SamplerCompare::EQUAL ? GL_EQUAL
+         : compare == SamplerCompare::NOT_EQUAL ? GL_NOTEQUAL
+         : compare == SamplerCompare::ALWAYS ? GL_ALWAYS
+         : compare == SamplerCompare::NEVER ? GL_NEVER
+         : GL_LEQUAL;
+   }
+
+   bool SamplerDesc::operator==(const SamplerDesc& other) const
+   {
+      return minFilter == other.minFilter && magFilter == other.magFilter && mipmapMode == other.mipmapMode
+         && wrapS == other.wrapS && wrapT == other.wrapT && wrapR == other.wrapR
+         && maxAnisotropy == other.maxAnisotropy && lodBias == other.lodBias && minLod == other.minLod && maxLod == other.maxLod
+         && compare == other.compare && memcmp(borderColor, other.borderColor, sizeof(borderColor)) == 0;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Nearest(SamplerWrap wrap /* = SamplerWrap::REPEAT*/)
+   {
+      SamplerDesc desc;
+      desc.minFilter = SamplerFilter::NEAREST;
+      desc.magFilter = SamplerFilter::NEAREST;
+      desc.mipmapMode = SamplerMipmapMode::NEAREST;
+      desc.wrapS = desc.wrapT = desc.wrapR = wrap;
+      return desc;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Trilinear(SamplerWrap wrap /* = SamplerWrap::REPEAT*/)
+   {
+      SamplerDesc desc;
+      desc.wrapS = desc.wrapT = desc.wrapR = wrap;
+      return desc;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Anisotropic(float maxAnisotropy, SamplerWrap wrap /* = SamplerWrap::REPEAT*/)
+   {
+      SamplerDesc desc = Trilinear(wrap);
+      desc.maxAnisotropy = maxAnisotropy;
+      return desc;
+   }
+
+   // static
+   SamplerDesc SamplerDesc::Shadow()
+   {
+      SamplerDesc desc = Trilinear(SamplerWrap::CLAMP_TO_EDGE);
+      desc.mipmapMode = SamplerMipmapMode::NONE;
+      desc.compare = SamplerCompare::LESS_EQUAL;
+      return desc;
+   }
+
+   // static
+   bool SamplerCache::IsSupported()
+   {
+      return GLContext::HasVersion(3, 3) || GLContext::HasExtension("GL_ARB_sampler_objects");
+   }
+
+   // static
+   float SamplerCache::MaxAnisotropy()
+   {
+      DropStaleSamplerCache();
+      if(s_SamplerCache.maxAnisotropy == 0.0f)
+      {
+         s_SamplerCache.maxAnisotropy = 1.0f;
+         if(GLContext::HasVersion(4, 6) || GLContext::HasExtension("GL_EXT_texture_filter_anisotropic")
+            || GLContext::HasExtension("GL_ARB_texture_filter_anisotropic"))
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &s_SamplerCache.maxAnisotropy);
+      }
+      return s_SamplerCache.maxAnisotropy;
+   }
+
+   // static
+   void SamplerCache::Create(GLuint sampler, const SamplerDesc& desc)
+   {
+      glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GetSamplerMinFilter(desc.minFilter, desc.mipmapMode));
+      glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, desc.magFilter == SamplerFilter::NEAREST ? GL_NEAREST : GL_LINEAR);
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, GetSamplerWrap(desc.wrapS));
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GetSamplerWrap(desc.wrapT));
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, GetSamplerWrap(desc.wrapR));
+      glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, desc.lodBias);
+      glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, desc.minLod);
+      glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, desc.maxLod);
+      glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, desc.borderColor);
+      if(desc.compare != SamplerCompare::NONE)
+      {
+         glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+         glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, GetSamplerCompareFunc(desc.compare));
+      }
+
+      // without the extension the description still gets its own sampler, just without anisotropy
+      float maxAnisotropy = MaxAnisotropy();
+      if(desc.maxAnisotropy > 1.0f && maxAnisotropy > 1.0f)
+         glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, desc.maxAnisotropy < maxAnisotropy ? desc.maxAnisotropy : maxAnisotropy);
+   }
+
+   // static
+   GLuint SamplerCache::Get(const SamplerDesc& desc)
+   {
+      if(!IsSupported())
+         return 0;
+      DropStaleSamplerCache();
+
+      // a handful of descriptions per application, a linear search beats hashing them
+      for(size_t i = 0; i < s_SamplerCache.descs.size(); i++)
+      {
+         if(s_SamplerCache.descs[i] == desc)
+            return GLObjectPool::Name(s_SamplerCache.handles[i]);
+      }
+
+      GLHandle handle = GLObjectPool::Create(GLObjectType::SAMPLER);
+      Create(GLObjectPool::Name(handle), desc);
+      s_SamplerCache.descs.push_back(desc);
+      s_SamplerCache.handles.push_back(handle);
+      return GLObjectPool::Name(handle);
+   }
+
+   // static
+   void SamplerCache::Bind(int slot, const SamplerDesc& desc)
+   {
+      GLuint sampler = Get(desc);
+      if(sampler == 0 || slot < 0)
+         return;
+
+      std::vector<GLuint>& bound = s_SamplerCache.boundSamplers;
+      if((size_t)slot >= bound.size())
+         bound.resize(slot + 1, 0);
+      if(bound[slot] == sampler)
+         return;
+      glBindSampler(slot, sampler);
+      bound[slot] = sampler;
+   }
+
+   // static
+   void SamplerCache::Unbind(int slot)
+   {
+      DropStaleSamplerCache();
+      std::vector<GLuint>& bound = s_SamplerCache.boundSamplers;
+      if(slot < 0 || (size_t)slot >= bound.size() || bound[slot] == 0)
+         return;
+      glBindSampler(slot, 0);
+      bound[slot] = 0;
+   }
+
+   // static
+   uint32_t SamplerCache::Count()
+   {
+      DropStaleSamplerCache();
+      return (uint32_t)s_SamplerCache.descs.size();
+   }
+
+   // static
+   void SamplerCache::Clear()
+   {
+      DropStaleSamplerCache();
+      for(size_t slot = 0; slot < s_SamplerCache.boundSamplers.size(); slot++)
+         Unbind((int)slot);
+      for(GLHandle& handle : s_SamplerCache.handles)
+         GLObjectPool::Destroy(handle);
+      s_SamplerCache = SamplerCacheData();
+      s_SamplerCache.contextResets = GLContext::ResetCount();
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,112 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+#pragma once
+
+#include <glad/glad.h>
+#include <stdint.h>
+
+// core in 4.6, glad only has them when one of the anisotropic filtering extensions was selected
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+namespace EaseGL
+{
+	enum class SamplerFilter
+	{
+		NONE = 0,
+		NEAREST,
+		LINEAR,
+	};
+
+	enum class SamplerMipmapMode
+	{
+		NONE = 0, // only the base level is sampled
+		NEAREST,
+		LINEAR,
+	};
+
+	enum class SamplerWrap
+	{
+		NONE = 0,
+		REPEAT,
+		MIRRORED_REPEAT,
+		CLAMP_TO_EDGE,
+		CLAMP_TO_BORDER,
+	};
+
+	enum class SamplerCompare
+	{
+		NONE = 0, // plain sampling, shadow samplers need one of the others
+		LESS_EQUAL,
+		GREATER_EQUAL,
+		LESS,
+		GREATER,
+		EQUAL,
+		NOT_EQUAL,
+		ALWAYS,
+		NEVER,
+	};
+
+	/** @brief How a texture is sampled, independent of the texture itself. Equal descriptions share one GL sampler */
+	struct SamplerDesc
+	{
+		SamplerFilter minFilter = SamplerFilter::LINEAR;
+		SamplerFilter magFilter = SamplerFilter::LINEAR;
+		SamplerMipmapMode mipmapMode = SamplerMipmapMode::LINEAR;
+		SamplerWrap wrapS = SamplerWrap::REPEAT;
+		SamplerWrap wrapT = SamplerWrap::REPEAT;
+		SamplerWrap wrapR = SamplerWrap::REPEAT;
+		float maxAnisotropy = 1.0f; // 1 disables, clamped to what the driver supports
+		float lodBias = 0.0f;
+		float minLod = -1000.0f;
+		float maxLod = 1000.0f;
+		SamplerCompare compare = SamplerCompare::NONE;
+		float borderColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; // for CLAMP_TO_BORDER
+
+		bool operator==(const SamplerDesc& other) const;
+		bool operator!=(const SamplerDesc& other) const { return !(*this == other); }
+
+		static SamplerDesc Nearest(SamplerWrap wrap = SamplerWrap::REPEAT);
+		static SamplerDesc Trilinear(SamplerWrap wrap = SamplerWrap::REPEAT);
+		static SamplerDesc Anisotropic(float maxAnisotropy, SamplerWrap wrap = SamplerWrap::REPEAT);
+		// linear, clamped depth comparison for sampler2DShadow
+		static SamplerDesc Shadow();
+	};
+
+	/**
+	 * @brief GL sampler objects deduplicated by SamplerDesc, created on first use and kept until Clear().
+	 * A sampler bound to a texture unit overrides the parameters of whatever texture is bound there, so the
+	 * filtering of every texture using a description changes by binding another one, not by touching textures.
+	 *
+	 * shader.Uniform("u_Albedo", albedo, EaseGL::SamplerDesc::Anisotropic(8.0f), 0);
+	 *
+	 * Needs OpenGL 3.3 or GL_ARB_sampler_objects, otherwise nothing is bound and texture parameters apply.
+	 */
+	class SamplerCache
+	{
+		private:
+			SamplerCache() {}
+
+			static void Create(GLuint sampler, const SamplerDesc& desc);
+		public:
+			/** @brief Sampler object for 'desc', 0 if sampler objects aren't supported */
+			static GLuint Get(const SamplerDesc& desc);
+
+			/** @brief Binds the sampler for 'desc' to texture unit 'slot', skipped if it is already bound there */
+			static void Bind(int slot, const SamplerDesc& desc);
+			/** @brief Texture parameters apply again on 'slot' */
+			static void Unbind(int slot);
+
+			static bool IsSupported();
+			/** @brief Highest anisotropy the driver allows, 1 without anisotropic filtering */
+			static float MaxAnisotropy();
+
+			static uint32_t Count();
+			/** @brief Deletes every sampler, call before destroying the context. After GLContext::Reset() the cache starts over on its own */
+			static void Clear();
+	};
+} // namespace EaseGL
+
+#endif
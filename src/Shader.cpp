@@ -1,153 +1,281 @@
 #include "Shader.hpp" 
 #ifdef EASEGL_IMPLEMENTATION
 
-#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <string.h>
 
 #include "GLBuffer.hpp"
+#include "GLContext.hpp"
+#include "ProgramBinaryCache.hpp"
 
 namespace EaseGL
 {
    void GetShaderError(GLuint shader, const char* filename, const char* type)
    {
       int  success;
-      char infoLog[512];
       glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
       if(!success)
       {
-         glGetShaderInfoLog(shader, 512, NULL, infoLog);
+         GLint length = 0;
+         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+         std::string infoLog(length > 1 ? length : 1, '\0');
+         glGetShaderInfoLog(shader, (GLsizei)infoLog.size(), NULL, &infoLog[0]);
+         infoLog.resize(strlen(infoLog.c_str()));
          std::cout << "ERROR::SHADER::" << type << "::COMPILATION_FAILED\n" << infoLog << '\n' << filename << std::endl;
-         throw;
+         // the log is part of the message, callers that catch (ShaderBatch, variants) have nothing else to show
+         throw std::runtime_error(std::string("Shader compilation failed: ") + type + "\n" + infoLog + '\n' + filename);
       }
    }
    void GetProgramError(GLuint shader, const char* filename)
    {
       int  success;
-      char infoLog[512];
       glGetProgramiv(shader, GL_LINK_STATUS, &success);
       if(!success)
       {
-         glGetProgramInfoLog(shader, 512, NULL, infoLog);
+         GLint length = 0;
+         glGetProgramiv(shader, GL_INFO_LOG_LENGTH, &length);
+         std::string infoLog(length > 1 ? length : 1, '\0');
+         glGetProgramInfoLog(shader, (GLsizei)infoLog.size(), NULL, &infoLog[0]);
+         infoLog.resize(strlen(infoLog.c_str()));
          std::cout << "ERROR::SHADER::PROGRAM::COMPILATION_FAILED\n" << infoLog << '\n' << filename << std::endl;
-         throw;
+         throw std::runtime_error(std::string("Shader program linking failed\n") + infoLog + '\n' + filename);
       }
    }
 
+   static UniformShadowStats s_GlobalShadowStats;
+
+   Shader::Shader()
+      : m_VertexShaderID(0), m_FragmentShaderID(0), m_GeometryShaderID(0), m_ComputeShaderID(0), m_ProgramID(0),
+      m_UniformShadowing(true), m_MaxTextureSlots(0), m_LinkPending(false), m_StoreBinary(false), m_LinkCacheKey(0)
+   {
+   }
+
    Shader::Shader(const char* shaderPath)
-      : m_ProgramID(0)
+      : m_VertexShaderID(0), m_FragmentShaderID(0), m_GeometryShaderID(0), m_ComputeShaderID(0), m_ProgramID(0),
+      m_UniformShadowing(true), m_MaxTextureSlots(0), m_LinkPending(false), m_StoreBinary(false), m_LinkCacheKey(0)
    {
       LoadShader(shaderPath);
    }
 
-   void Shader::LoadShader(const char* shaderPath)
+   Shader::Shader(Shader&& other) noexcept
+      : m_VertexShaderID(other.m_VertexShaderID), m_FragmentShaderID(other.m_FragmentShaderID),
+      m_GeometryShaderID(other.m_GeometryShaderID), m_ComputeShaderID(other.m_ComputeShaderID),
+      m_ProgramID(other.m_ProgramID), m_Handle(other.m_Handle),
+      m_Uniforms(std::move(other.m_Uniforms)), m_UniformBlocks(std::move(other.m_UniformBlocks)),
+      m_UniformTable(std::move(other.m_UniformTable)), m_UniformShadow(std::move(other.m_UniformShadow)),
+      m_UniformShadowing(other.m_UniformShadowing), m_ShadowStats(other.m_ShadowStats), m_MaxTextureSlots(other.m_MaxTextureSlots),
+      m_LinkPending(other.m_LinkPending), m_LinkPath(std::move(other.m_LinkPath)),
+      m_StoreBinary(other.m_StoreBinary), m_LinkCacheKey(other.m_LinkCacheKey)
    {
-      glGetIntegerv(GL_MAX_TEXTURE_UNITS, &m_MaxTextureSlots);
+      other.m_VertexShaderID = 0;
+      other.m_FragmentShaderID = 0;
+      other.m_GeometryShaderID = 0;
+      other.m_ComputeShaderID = 0;
+      other.m_ProgramID = 0;
+      other.m_Handle = GLHandle();
+      other.m_LinkPending = false;
+   }
 
-      ShaderType currentType = ShaderType::NONE;
-      std::ifstream ifstream;
-      ifstream.open(shaderPath);
-      if(!ifstream)
+   Shader& Shader::operator=(Shader&& other) noexcept
+   {
+      if(this != &other)
       {
-         std::cout << shaderPath;
-         throw std::runtime_error("Failed to load file");
-      }
+         DeleteStageShaders();
+         GLObjectPool::Destroy(m_Handle);
 
-      std::string vertexShaderStr = "";
-      std::string fragmentShaderStr = "";
-      std::string geometryShaderStr = "";
+         m_VertexShaderID = other.m_VertexShaderID;
+         m_FragmentShaderID = other.m_FragmentShaderID;
+         m_GeometryShaderID = other.m_GeometryShaderID;
+         m_ComputeShaderID = other.m_ComputeShaderID;
+         m_ProgramID = other.m_ProgramID;
+         m_Handle = other.m_Handle;
+         m_Uniforms = std::move(other.m_Uniforms);
+         m_UniformBlocks = std::move(other.m_UniformBlocks);
+         m_UniformTable = std::move(other.m_UniformTable);
+         m_UniformShadow = std::move(other.m_UniformShadow);
+         m_UniformShadowing = other.m_UniformShadowing;
+         m_ShadowStats = other.m_ShadowStats;
+         m_MaxTextureSlots = other.m_MaxTextureSlots;
+         m_LinkPending = other.m_LinkPending;
+         m_LinkPath = std::move(other.m_LinkPath);
+         m_StoreBinary = other.m_StoreBinary;
+         m_LinkCacheKey = other.m_LinkCacheKey;
 
-      std::string line;
-      while (std::getline(ifstream, line))
-      {
-         if(strncmp(line.c_str(), "#shader vertex", strlen("#shader vertex")) == 0)
-         {
-            currentType = ShaderType::VERTEX;
-         }
-         else if(strncmp(line.c_str(), "#shader fragment", strlen("#shader fragment")) == 0)
-         {
-            currentType = ShaderType::FRAGMENT;
-         }
-         else if(strncmp(line.c_str(), "#shader geometry", strlen("#shader geometry")) == 0)
-         {
-            currentType = ShaderType::GEOMETRY;
-         }
-         else
-         {
-            // 'line' is shader code
-            if(currentType == ShaderType::VERTEX)
-            {
-               vertexShaderStr += line + '\n';
-            }
-            else if(currentType == ShaderType::FRAGMENT)
-            {
-               fragmentShaderStr += line + '\n';
-            }
-            else if(currentType == ShaderType::GEOMETRY)
-            {
-               geometryShaderStr += line + '\n';
-            }
-         }
-         
+         other.m_VertexShaderID = 0;
+         other.m_FragmentShaderID = 0;
+         other.m_GeometryShaderID = 0;
+         other.m_ComputeShaderID = 0;
+         other.m_ProgramID = 0;
+         other.m_Handle = GLHandle();
+         other.m_LinkPending = false;
       }
-      ifstream.close();
+      return *this;
+   }
+
+   void Shader::LoadShader(const char* shaderPath)
+   {
+      BeginLoad(shaderPath);
+      FinishLoad();
+   }
 
+   void Shader::BeginLoad(const char* shaderPath)
+   {
+      ShaderSources sources;
+      ParseShaderFile(shaderPath, sources);
+      BeginLink(sources, shaderPath);
+   }
 
-      if(vertexShaderStr != "")
-      {
-         m_VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-         const char* vertexShaderSrc = vertexShaderStr.c_str();
-         glShaderSource(m_VertexShaderID, 1, &vertexShaderSrc, NULL);
-         glCompileShader(m_VertexShaderID);
-         GetShaderError(m_VertexShaderID, shaderPath, "VERTEX");
-      }
+   void Shader::LoadSources(const ShaderSources& sources, const char* name)
+   {
+      BeginLink(sources, name);
+      FinishLink();
+   }
 
-      if(fragmentShaderStr != "")
-      {
-         m_FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-         const char* fragmentShaderSrc = fragmentShaderStr.c_str();
-         glShaderSource(m_FragmentShaderID, 1, &fragmentShaderSrc, NULL);
-         glCompileShader(m_FragmentShaderID);
-         GetShaderError(m_FragmentShaderID, shaderPath, "FRAGMENT");
-      }
+   void Shader::BeginLoadSources(const ShaderSources& sources, const char* name)
+   {
+      BeginLink(sources, name);
+   }
+
+   bool Shader::IsLoadComplete() const
+   {
+      if(!m_LinkPending || !SupportsParallelCompile())
+         return true;
+
+      GLint complete = GL_FALSE;
+      glGetProgramiv(m_ProgramID, GL_COMPLETION_STATUS_KHR, &complete);
+      return complete == GL_TRUE;
+   }
+
+   void Shader::FinishLoad()
+   {
+      FinishLink();
+   }
+
+   // static
+   bool Shader::SupportsParallelCompile()
+   {
+      return GLContext::HasExtension("GL_KHR_parallel_shader_compile")
+         || GLContext::HasExtension("GL_ARB_parallel_shader_compile");
+   }
 
-      if(geometryShaderStr != "")
+   // static
+   void Shader::ParseShaderFile(const char* shaderPath, ShaderSources& sources)
+   {
+      ShaderSourceCache::Preprocess(shaderPath, sources);
+   }
+
+   GLuint CompileShaderStage(GLenum type, const std::string& source)
+   {
+      GLuint shader = glCreateShader(type);
+      const char* src = source.c_str();
+      glShaderSource(shader, 1, &src, NULL);
+      glCompileShader(shader);
+      return shader;
+   }
+
+   void Shader::BeginLink(const ShaderSources& sources, const char* shaderPath)
+   {
+      // GL_MAX_TEXTURE_UNITS is the fixed function limit, an invalid enum in core profiles
+      glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &m_MaxTextureSlots);
+
+      DeleteStageShaders();
+      GLObjectPool::Destroy(m_Handle);
+      m_ProgramID = 0;
+      m_Uniforms.clear();
+      m_UniformBlocks.clear();
+      m_UniformTable.clear();
+      m_UniformShadow.clear();
+
+      m_Handle = GLObjectPool::Create(GLObjectType::PROGRAM);
+      m_ProgramID = GLObjectPool::Name(m_Handle);
+
+      m_LinkPending = true;
+      m_LinkPath = shaderPath + sources.fileLegend;
+      m_StoreBinary = false;
+
+      if(ProgramBinaryCache::IsAvailable())
       {
-         m_GeometryShaderID = glCreateShader(GL_GEOMETRY_SHADER);
-         const char* geometryShaderSrc = geometryShaderStr.c_str();
-         glShaderSource(m_GeometryShaderID, 1, &geometryShaderSrc, NULL);
-         glCompileShader(m_GeometryShaderID);
-         GetShaderError(m_GeometryShaderID, shaderPath, "GEOMETRY");
+         m_LinkCacheKey = ProgramBinaryCache::Key(sources.stages, ShaderSources::STAGE_COUNT);
+         if(ProgramBinaryCache::Load(m_ProgramID, m_LinkCacheKey))
+            return;
+         glProgramParameteri(m_ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+         m_StoreBinary = true;
       }
 
+      // statuses are not queried here, the driver is free to compile in the background until FinishLink()
+      if(sources[ShaderType::VERTEX] != "")
+         m_VertexShaderID = CompileShaderStage(GL_VERTEX_SHADER, sources[ShaderType::VERTEX]);
+      if(sources[ShaderType::FRAGMENT] != "")
+         m_FragmentShaderID = CompileShaderStage(GL_FRAGMENT_SHADER, sources[ShaderType::FRAGMENT]);
+      if(sources[ShaderType::GEOMETRY] != "")
+         m_GeometryShaderID = CompileShaderStage(GL_GEOMETRY_SHADER, sources[ShaderType::GEOMETRY]);
+      if(sources[ShaderType::COMPUTE] != "")
+         m_ComputeShaderID = CompileShaderStage(GL_COMPUTE_SHADER, sources[ShaderType::COMPUTE]);
 
-      
-      m_ProgramID = glCreateProgram();
-
-      if(vertexShaderStr != "")
+      if(m_VertexShaderID != 0)
          glAttachShader(m_ProgramID, m_VertexShaderID);
-      if(fragmentShaderStr != "")
+      if(m_FragmentShaderID != 0)
          glAttachShader(m_ProgramID, m_FragmentShaderID);
-      if(geometryShaderStr != "")
+      if(m_GeometryShaderID != 0)
          glAttachShader(m_ProgramID, m_GeometryShaderID);
+      if(m_ComputeShaderID != 0)
+         glAttachShader(m_ProgramID, m_ComputeShaderID);
       glLinkProgram(m_ProgramID);
+   }
 
-      GetProgramError(m_ProgramID, shaderPath);
+   void Shader::FinishLink()
+   {
+      if(!m_LinkPending)
+         return;
+      m_LinkPending = false;
+
+      try
+      {
+         const char* shaderPath = m_LinkPath.c_str();
+         if(m_VertexShaderID != 0)
+            GetShaderError(m_VertexShaderID, shaderPath, "VERTEX");
+         if(m_FragmentShaderID != 0)
+            GetShaderError(m_FragmentShaderID, shaderPath, "FRAGMENT");
+         if(m_GeometryShaderID != 0)
+            GetShaderError(m_GeometryShaderID, shaderPath, "GEOMETRY");
+         if(m_ComputeShaderID != 0)
+            GetShaderError(m_ComputeShaderID, shaderPath, "COMPUTE");
+         GetProgramError(m_ProgramID, shaderPath);
+      }
+      catch(...)
+      {
+         DeleteStageShaders();
+         throw;
+      }
 
+      DeleteStageShaders();
+      if(m_StoreBinary)
+         ProgramBinaryCache::Store(m_ProgramID, m_LinkCacheKey);
+      ReflectUniforms();
+   }
 
+   void Shader::DeleteStageShaders()
+   {
       if(m_VertexShaderID != 0)
          glDeleteShader(m_VertexShaderID);
       if(m_FragmentShaderID != 0)
          glDeleteShader(m_FragmentShaderID);
       if(m_GeometryShaderID != 0)
          glDeleteShader(m_GeometryShaderID);
+      if(m_ComputeShaderID != 0)
+         glDeleteShader(m_ComputeShaderID);
+      m_VertexShaderID = 0;
+      m_FragmentShaderID = 0;
+      m_GeometryShaderID = 0;
+      m_ComputeShaderID = 0;
    }
       
    Shader::~Shader()
    {
-      if(m_ProgramID != 0)
-         glDeleteProgram(m_ProgramID);
+      DeleteStageShaders();
+      GLObjectPool::Destroy(m_Handle);
    }
 
    void Shader::Bind() 
@@ -155,53 +283,345 @@ namespace EaseGL
       glUseProgram(m_ProgramID);
    }
 
-   GLuint Shader::GetUniformLocation(const std::string& name) 
+   void Shader::Dispatch(GLuint groupsX, GLuint groupsY /* = 1*/, GLuint groupsZ /* = 1*/)
+   {
+      glUseProgram(m_ProgramID);
+      glDispatchCompute(groupsX, groupsY, groupsZ);
+   }
+
+   void Shader::DispatchIndirect(const GLBuffer& indirectBuffer, GLintptr offset /* = 0*/)
+   {
+      glUseProgram(m_ProgramID);
+      glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, indirectBuffer.m_BufferID);
+      glDispatchComputeIndirect(offset);
+   }
+
+   // static
+   void Shader::Barrier(MemoryBarrierBits barriers)
+   {
+      glMemoryBarrier((GLbitfield)barriers);
+   }
+
+   bool IsSamplerUniformType(GLenum type)
    {
-      for(const auto& uniform : m_UniformLocations)
+      return type == GL_SAMPLER_1D || type == GL_SAMPLER_2D || type == GL_SAMPLER_3D || type == GL_SAMPLER_CUBE
+         || type == GL_SAMPLER_1D_SHADOW || type == GL_SAMPLER_2D_SHADOW || type == GL_SAMPLER_CUBE_SHADOW
+         || type == GL_SAMPLER_1D_ARRAY || type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_1D_ARRAY_SHADOW || type == GL_SAMPLER_2D_ARRAY_SHADOW
+         || type == GL_SAMPLER_CUBE_MAP_ARRAY || type == GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW
+         || type == GL_SAMPLER_2D_MULTISAMPLE || type == GL_SAMPLER_2D_MULTISAMPLE_ARRAY || type == GL_SAMPLER_BUFFER || type == GL_SAMPLER_2D_RECT
+         || type == GL_INT_SAMPLER_2D || type == GL_INT_SAMPLER_3D || type == GL_INT_SAMPLER_CUBE || type == GL_INT_SAMPLER_2D_ARRAY
+         || type == GL_UNSIGNED_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_3D || type == GL_UNSIGNED_INT_SAMPLER_CUBE || type == GL_UNSIGNED_INT_SAMPLER_2D_ARRAY;
+   }
+
+   // texture type a sampler uniform reads from, NONE for the ones GLTexture can't be
+   TextureType GetSamplerTextureType(GLenum type)
+   {
+      return type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_SHADOW || type == GL_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_2D ? TextureType::TEXTURE2D
+         : type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_ARRAY_SHADOW || type == GL_INT_SAMPLER_2D_ARRAY || type == GL_UNSIGNED_INT_SAMPLER_2D_ARRAY ? TextureType::TEXTURE2D_ARRAY
+         : type == GL_SAMPLER_CUBE || type == GL_SAMPLER_CUBE_SHADOW || type == GL_INT_SAMPLER_CUBE || type == GL_UNSIGNED_INT_SAMPLER_CUBE ? TextureType::TEXTURE_CUBE_MAP
+         : type == GL_SAMPLER_3D || type == GL_INT_SAMPLER_3D || type == GL_UNSIGNED_INT_SAMPLER_3D ? TextureType::TEXTURE3D
+         : TextureType::NONE;
+   }
+
+   uint32_t GetUniformTypeSize(GLenum type)
+   {
+      return type == GL_FLOAT || type == GL_INT || type == GL_UNSIGNED_INT || type == GL_BOOL ? 4
+         : type == GL_FLOAT_VEC2 || type == GL_INT_VEC2 || type == GL_UNSIGNED_INT_VEC2 || type == GL_BOOL_VEC2 ? 8
+         : type == GL_FLOAT_VEC3 || type == GL_INT_VEC3 || type == GL_UNSIGNED_INT_VEC3 || type == GL_BOOL_VEC3 ? 12
+         : type == GL_FLOAT_VEC4 || type == GL_INT_VEC4 || type == GL_UNSIGNED_INT_VEC4 || type == GL_BOOL_VEC4 ? 16
+         : type == GL_FLOAT_MAT2 ? 16
+         : type == GL_FLOAT_MAT3 ? 36
+         : type == GL_FLOAT_MAT4 ? 64
+         : type == GL_FLOAT_MAT2x3 || type == GL_FLOAT_MAT3x2 ? 24
+         : type == GL_FLOAT_MAT2x4 || type == GL_FLOAT_MAT4x2 ? 32
+         : type == GL_FLOAT_MAT3x4 || type == GL_FLOAT_MAT4x3 ? 48
+         : IsSamplerUniformType(type) ? 4
+         : 0;
+   }
+
+   void Shader::ReflectUniforms()
+   {
+      GLint uniformCount = 0;
+      GLint maxNameLength = 0;
+      glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORMS, &uniformCount);
+      glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+      std::vector<char> nameBuffer(maxNameLength + 1);
+      for(GLint i = 0; i < uniformCount; i++)
+      {
+         GLsizei length = 0;
+         UniformInfo info;
+         glGetActiveUniform(m_ProgramID, i, (GLsizei)nameBuffer.size(), &length, &info.arraySize, &info.type, nameBuffer.data());
+         info.name.assign(nameBuffer.data(), length);
+         info.location = glGetUniformLocation(m_ProgramID, info.name.c_str());
+
+         // members of uniform blocks have no location, they are set through buffers
+         if(info.location == -1)
+            continue;
+
+         info.isSampler = IsSamplerUniformType(info.type);
+         info.hash = HashUniformName(info.name.c_str());
+
+         // "name" and "name[0]" share the same shadow
+         info.shadowSize = GetUniformTypeSize(info.type);
+         info.shadowOffset = (uint32_t)m_UniformShadow.size();
+         info.shadowValid = false;
+         m_UniformShadow.resize(m_UniformShadow.size() + info.shadowSize);
+
+         std::string arrayName;
+         if(info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+            arrayName = info.name.substr(0, info.name.size() - 3);
+
+         UniformInfo arrayInfo = info;
+         AddUniform(std::move(info));
+         if(!arrayName.empty())
+         {
+            arrayInfo.name = arrayName;
+            arrayInfo.hash = HashUniformName(arrayName.c_str());
+            AddUniform(std::move(arrayInfo));
+         }
+      }
+
+      GLint blockCount = 0;
+      glGetProgramiv(m_ProgramID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+      for(GLint i = 0; i < blockCount; i++)
       {
-         if(uniform.first == name)
-            return uniform.second;
+         GLint length = 0;
+         glGetActiveUniformBlockiv(m_ProgramID, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &length);
+
+         UniformBlockInfo block;
+         std::vector<char> blockName(length + 1);
+         glGetActiveUniformBlockName(m_ProgramID, i, (GLsizei)blockName.size(), NULL, blockName.data());
+         block.name = blockName.data();
+         block.index = i;
+         glGetActiveUniformBlockiv(m_ProgramID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+         block.isStorageBlock = false;
+         m_UniformBlocks.push_back(block);
       }
 
-      GLint loc = glGetUniformLocation(m_ProgramID, name.c_str());
-      if(loc == -1)
+      if(GLContext::HasVersion(4, 3))
       {
-         std::cout << "ERROR: Uniform " << name << " not found!\n";
+         GLint storageBlockCount = 0;
+         glGetProgramInterfaceiv(m_ProgramID, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &storageBlockCount);
+         for(GLint i = 0; i < storageBlockCount; i++)
+         {
+            const GLenum properties[] = { GL_NAME_LENGTH, GL_BUFFER_DATA_SIZE };
+            GLint values[2] = { 0, 0 };
+            glGetProgramResourceiv(m_ProgramID, GL_SHADER_STORAGE_BLOCK, i, 2, properties, 2, NULL, values);
+
+            UniformBlockInfo block;
+            std::vector<char> blockName(values[0] + 1);
+            glGetProgramResourceName(m_ProgramID, GL_SHADER_STORAGE_BLOCK, i, (GLsizei)blockName.size(), NULL, blockName.data());
+            block.name = blockName.data();
+            block.index = i;
+            block.dataSize = values[1];
+            block.isStorageBlock = true;
+            m_UniformBlocks.push_back(block);
+         }
       }
-      m_UniformLocations[name] = loc;
-      return loc;
+
+      RebuildUniformTable();
    }
 
-   void Shader::BindUBO(GLBuffer uniformBuffer, int bufferIndex, const char* uniformName) 
+   int32_t Shader::AddUniform(UniformInfo&& info)
+   {
+      m_Uniforms.push_back(std::move(info));
+      return (int32_t)m_Uniforms.size() - 1;
+   }
+
+   void Shader::RebuildUniformTable()
+   {
+      // keep the load factor at or below 50%
+      size_t tableSize = 8;
+      while(tableSize < m_Uniforms.size() * 2)
+         tableSize *= 2;
+
+      m_UniformTable.assign(tableSize, -1);
+      for(int32_t i = 0; i < (int32_t)m_Uniforms.size(); i++)
+      {
+         size_t slot = m_Uniforms[i].hash & (tableSize - 1);
+         while(m_UniformTable[slot] != -1)
+            slot = (slot + 1) & (tableSize - 1);
+         m_UniformTable[slot] = i;
+      }
+   }
+
+   int32_t Shader::FindUniform(UniformName name)
+   {
+      if(!m_UniformTable.empty())
+      {
+         size_t mask = m_UniformTable.size() - 1;
+         for(size_t slot = name.hash & mask; m_UniformTable[slot] != -1; slot = (slot + 1) & mask)
+         {
+            // names with the same hash share a probe chain, the hash only saves most string compares
+            const UniformInfo& uniform = m_Uniforms[m_UniformTable[slot]];
+            if(uniform.hash == name.hash && uniform.name == name.name)
+               return m_UniformTable[slot];
+         }
+      }
+
+      // not reported by reflection (e.g. "lights[3]"), ask the driver once and remember the answer
+      UniformInfo info;
+      info.name = name.name;
+      info.hash = name.hash;
+      info.location = glGetUniformLocation(m_ProgramID, name.name);
+      info.type = GL_NONE;
+      info.arraySize = 1;
+      info.isSampler = false;
+      info.shadowOffset = 0;
+      info.shadowSize = 0;
+      info.shadowValid = false;
+      if(info.location == -1)
+      {
+         std::cout << "ERROR: Uniform " << name.name << " not found!\n";
+      }
+
+      int32_t index = AddUniform(std::move(info));
+      RebuildUniformTable();
+      return index;
+   }
+
+   GLint Shader::GetUniformLocation(UniformName name) 
+   {
+      return m_Uniforms[FindUniform(name)].location;
+   }
+
+   UniformHandle Shader::GetUniformHandle(UniformName name)
+   {
+      UniformHandle handle;
+      handle.index = FindUniform(name);
+      handle.location = m_Uniforms[handle.index].location;
+      return handle;
+   }
+
+   void Shader::BindUBO(const GLBuffer& uniformBuffer, int bufferIndex, const char* uniformName) 
    {
-      std::cout << "DONT USE UNIFORM BUFFERS YET!" << std::endl;
-      
       glBindBufferBase(GL_UNIFORM_BUFFER, bufferIndex, uniformBuffer.m_BufferID);
 
-      int uniformIndex = glGetUniformBlockIndex(m_ProgramID, uniformName);
+      GLuint uniformIndex = glGetUniformBlockIndex(m_ProgramID, uniformName);
+      if(uniformIndex == GL_INVALID_INDEX)
+      {
+         std::cout << "ERROR: Uniform block " << uniformName << " not found!\n";
+         return;
+      }
       glUniformBlockBinding(m_ProgramID, uniformIndex, bufferIndex);
    }
 
 
 
-   void Shader::Uniform(const std::string& name, const glm::mat4& uniform)
+   void Shader::Uniform(UniformName name, const glm::mat4& uniform)
+   {
+      Uniform(GetUniformHandle(name), uniform);
+   }
+
+   void Shader::Uniform(UniformName name, const GLTexture& uniform, int slot) 
+   {
+      Uniform(GetUniformHandle(name), uniform, slot);
+   }
+
+   void Shader::Uniform(UniformName name, const GLTexture& uniform, const SamplerDesc& sampler, int slot)
+   {
+      Uniform(GetUniformHandle(name), uniform, sampler, slot);
+   }
+
+   void Shader::Uniform(UniformName name, int uniform) 
+   {
+      Uniform(GetUniformHandle(name), uniform);
+   }
+
+   bool Shader::UpdateUniformShadow(UniformHandle handle, const void* value, uint32_t size)
    {
-      glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &uniform[0][0]);
+      if(!m_UniformShadowing || handle.index < 0)
+         return true;
+
+      UniformInfo& info = m_Uniforms[handle.index];
+      if(info.shadowSize != size)
+         return true;
+
+      unsigned char* shadow = m_UniformShadow.data() + info.shadowOffset;
+      if(info.shadowValid && memcmp(shadow, value, size) == 0)
+      {
+         m_ShadowStats.hits++;
+         s_GlobalShadowStats.hits++;
+         return false;
+      }
+
+      memcpy(shadow, value, size);
+      info.shadowValid = true;
+      m_ShadowStats.misses++;
+      s_GlobalShadowStats.misses++;
+      return true;
    }
 
-   void Shader::Uniform(const std::string& name, const GLTexture& uniform, int slot) 
+   void Shader::InvalidateUniformShadow()
+   {
+      for(UniformInfo& info : m_Uniforms)
+         info.shadowValid = false;
+   }
+
+   // static
+   const UniformShadowStats& Shader::GetGlobalUniformShadowStats()
+   {
+      return s_GlobalShadowStats;
+   }
+
+   // static
+   void Shader::ResetGlobalUniformShadowStats()
+   {
+      s_GlobalShadowStats = UniformShadowStats();
+   }
+
+   void Shader::Uniform(UniformHandle handle, const glm::mat4& uniform)
+   {
+      if(UpdateUniformShadow(handle, &uniform[0][0], sizeof(float) * 16))
+         glUniformMatrix4fv(handle.location, 1, GL_FALSE, &uniform[0][0]);
+   }
+
+   void Shader::CheckTextureUniform(UniformHandle handle, const GLTexture& texture, int slot) const
    {
       if(slot >= m_MaxTextureSlots)
       {
          std::cout << "TEXTURE SLOT " << slot << " NOT EXISTS! MAX: " << m_MaxTextureSlots - 1 << std::endl;
       }
+      if(handle.index >= 0)
+      {
+         // binding a cube map to a sampler2D leaves the sampler incomplete and it silently reads black
+         const UniformInfo& info = m_Uniforms[handle.index];
+         TextureType samplerType = GetSamplerTextureType(info.type);
+         if(samplerType != TextureType::NONE && samplerType != texture.Type())
+            std::cout << "ERROR: Texture bound to " << info.name << " doesn't match the sampler type" << std::endl;
+      }
+   }
+
+   void Shader::Uniform(UniformHandle handle, const GLTexture& uniform, int slot) 
+   {
+      CheckTextureUniform(handle, uniform, slot);
+      uniform.Bind(slot);
+      // a sampler left on the unit by an earlier pair would override the texture parameters
+      SamplerCache::Unbind(slot);
+      Uniform(handle, slot);
+   }
+
+   void Shader::Uniform(UniformHandle handle, const GLTexture& uniform, const SamplerDesc& sampler, int slot)
+   {
+      CheckTextureUniform(handle, uniform, slot);
+      if(handle.index >= 0)
+      {
+         // without a compare mode shadow lookups are undefined
+         GLenum type = m_Uniforms[handle.index].type;
+         bool shadowSampler = type == GL_SAMPLER_2D_SHADOW || type == GL_SAMPLER_2D_ARRAY_SHADOW || type == GL_SAMPLER_CUBE_SHADOW;
+         if(shadowSampler != (sampler.compare != SamplerCompare::NONE))
+            std::cout << "ERROR: Sampler compare mode doesn't match " << m_Uniforms[handle.index].name << std::endl;
+      }
       uniform.Bind(slot);
-      Uniform(name, slot);
+      SamplerCache::Bind(slot, sampler);
+      Uniform(handle, slot);
    }
 
-   void Shader::Uniform(const std::string& name, int uniform) 
+   void Shader::Uniform(UniformHandle handle, int uniform) 
    {
-      glUniform1i(GetUniformLocation(name), uniform);
+      if(UpdateUniformShadow(handle, &uniform, sizeof(int)))
+         glUniform1i(handle.location, uniform);
    }
 } // namespace EaseGL
 
@@ -4,49 +4,243 @@
 
 #include <glad/glad.h>
 #include "GLBuffer.hpp"
-#include <unordered_map>
+#include "GLObjectPool.hpp"
+#include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include "GLTexture.hpp"
+#include "Sampler.hpp"
+#include "ShaderSource.hpp"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 namespace EaseGL
 {
-	enum class ShaderType
+	enum class MemoryBarrierBits : GLbitfield
 	{
 		NONE = 0,
-		VERTEX,
-		FRAGMENT,
-		GEOMETRY,
+		VERTEX_ATTRIB_ARRAY = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT,
+		ELEMENT_ARRAY = GL_ELEMENT_ARRAY_BARRIER_BIT,
+		UNIFORM = GL_UNIFORM_BARRIER_BIT,
+		TEXTURE_FETCH = GL_TEXTURE_FETCH_BARRIER_BIT,
+		SHADER_IMAGE_ACCESS = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT,
+		COMMAND = GL_COMMAND_BARRIER_BIT, // indirect draw/dispatch arguments
+		PIXEL_BUFFER = GL_PIXEL_BUFFER_BARRIER_BIT,
+		TEXTURE_UPDATE = GL_TEXTURE_UPDATE_BARRIER_BIT,
+		BUFFER_UPDATE = GL_BUFFER_UPDATE_BARRIER_BIT,
+		FRAMEBUFFER = GL_FRAMEBUFFER_BARRIER_BIT,
+		SHADER_STORAGE = GL_SHADER_STORAGE_BARRIER_BIT,
+		ALL = GL_ALL_BARRIER_BITS,
+	};
+
+	inline MemoryBarrierBits operator|(MemoryBarrierBits left, MemoryBarrierBits right)
+	{
+		return (MemoryBarrierBits)((GLbitfield)left | (GLbitfield)right);
+	}
+
+	// FNV-1a, constexpr so names in constant expressions are hashed at compile time
+	constexpr uint32_t HashUniformName(const char* name)
+	{
+		uint32_t hash = 2166136261u;
+		for(; *name != '\0'; name++)
+			hash = (hash ^ (uint32_t)(unsigned char)*name) * 16777619u;
+		return hash;
+	}
+
+	/**
+	 * @brief Uniform name with its hash, 'name' is only compared when the hash matches.
+	 * A literal passed straight to Uniform("u_Model", ...) is hashed at run time on every call (the optimizer may fold it,
+	 * nothing guarantees it). Only a constexpr object is hashed at compile time:
+	 *
+	 * static constexpr EaseGL::UniformName u_Model = "u_Model";
+	 * shader.Uniform(u_Model, model);
+	 *
+	 * The UniformHandle returned by GetUniformHandle() skips the hash and the lookup entirely.
+	 */
+	struct UniformName
+	{
+		uint32_t hash;
+		const char* name;
+
+		constexpr UniformName(const char* _name)
+			: hash(HashUniformName(_name)), name(_name)
+		{
+		}
+		UniformName(const std::string& _name)
+			: hash(HashUniformName(_name.c_str())), name(_name.c_str())
+		{
+		}
+	};
+
+	// Resolved uniform, valid for the program it was queried from until it is reloaded
+	struct UniformHandle
+	{
+		int32_t index = -1; // into Shader::GetUniforms()
+		GLint location = -1;
+
+		bool IsValid() const { return location != -1; }
 	};
+
+	struct UniformInfo
+	{
+		std::string name; // array uniforms are registered both as "name[0]" and "name"
+		uint32_t hash;
+		GLint location;
+		GLenum type;
+		GLint arraySize;
+		bool isSampler;
+
+		// last value sent to the program, only the first element of arrays is shadowed
+		uint32_t shadowOffset;
+		uint32_t shadowSize; // 0 if the type is unknown
+		bool shadowValid;
+	};
+
+	struct UniformShadowStats
+	{
+		uint64_t hits = 0;   // writes that were dropped because the program already had the value
+		uint64_t misses = 0; // writes that reached the driver
+	};
+
+	struct UniformBlockInfo
+	{
+		std::string name;
+		GLuint index;
+		GLint dataSize;
+		bool isStorageBlock;
+	};
+
 	class Shader  
 	{
 		private:
 			GLuint m_VertexShaderID;
 			GLuint m_FragmentShaderID;
 			GLuint m_GeometryShaderID;
+			GLuint m_ComputeShaderID;
 
 			GLuint m_ProgramID;
+			GLHandle m_Handle;
+
+			// filled once after linking
+			std::vector<UniformInfo> m_Uniforms;
+			std::vector<UniformBlockInfo> m_UniformBlocks;
+			// open addressing table of indices into m_Uniforms, keyed by UniformInfo::hash
+			std::vector<int32_t> m_UniformTable;
 
-			std::unordered_map<std::string, GLint> m_UniformLocations;
+			std::vector<unsigned char> m_UniformShadow;
+			bool m_UniformShadowing;
+			UniformShadowStats m_ShadowStats;
 
 			int m_MaxTextureSlots;
+
+			// state between BeginLink() and FinishLink()
+			bool m_LinkPending;
+			std::string m_LinkPath;
+			bool m_StoreBinary;
+			uint64_t m_LinkCacheKey;
+
+			static void ParseShaderFile(const char* shaderPath, ShaderSources& sources);
+			// 'shaderPath' is only used in error messages
+			void BeginLink(const ShaderSources& sources, const char* shaderPath);
+			void FinishLink();
+			void DeleteStageShaders();
+
+			void ReflectUniforms();
+			int32_t AddUniform(UniformInfo&& info);
+			void RebuildUniformTable();
+			int32_t FindUniform(UniformName name);
+			// slot range and sampler type of a texture bound to 'handle'
+			void CheckTextureUniform(UniformHandle handle, const GLTexture& texture, int slot) const;
+			bool UpdateUniformShadow(UniformHandle handle, const void* value, uint32_t size);
 		public:
 
-			Shader() = default;
+			Shader();
 			Shader(const char* shaderPath);
 			~Shader();
 
+			Shader(const Shader&) = delete;
+			Shader& operator=(const Shader&) = delete;
+			Shader(Shader&& other) noexcept;
+			Shader& operator=(Shader&& other) noexcept;
+
+			/** @brief Compiles and links the file, or loads it from ProgramBinaryCache if enabled */
 			void LoadShader(const char* shaderPath);
 
+			/**
+			 * @brief LoadShader() in two halves. BeginLoad() submits the compile and link without querying
+			 * their status, FinishLoad() checks for errors (throws std::runtime_error) and reflects uniforms.
+			 * IsLoadComplete() never blocks if SupportsParallelCompile(), otherwise it always returns true
+			 * and FinishLoad() waits for the driver. See ShaderBatch
+			 */
+			void BeginLoad(const char* shaderPath);
+			bool IsLoadComplete() const;
+			void FinishLoad();
+			bool IsLoadPending() const { return m_LinkPending; }
+
+			/** @brief Same as LoadShader()/BeginLoad() with already preprocessed sources, 'name' is used in error messages */
+			void LoadSources(const ShaderSources& sources, const char* name);
+			void BeginLoadSources(const ShaderSources& sources, const char* name);
+
+			// GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile
+			static bool SupportsParallelCompile();
+
 
 			void Bind();
 
-			GLuint GetUniformLocation(const std::string& name);
+			operator GLuint() const { return m_ProgramID; }
+			GLHandle Handle() const { return m_Handle; }
+
+			/**
+			 * @brief Binds the program and runs its '#shader compute' stage
+			 */
+			void Dispatch(GLuint groupsX, GLuint groupsY = 1, GLuint groupsZ = 1);
+			/**
+			 * @brief Same as Dispatch() but group counts are read by the GPU from a DispatchIndirectCommand
+			 * 
+			 * @param offset byte offset of the DispatchIndirectCommand, must be a multiple of 4
+			 */
+			void DispatchIndirect(const GLBuffer& indirectBuffer, GLintptr offset = 0);
+
+			/**
+			 * @brief Makes writes of previous dispatches visible to the operations in 'barriers',
+			 * e.g. SHADER_STORAGE | VERTEX_ATTRIB_ARRAY before drawing particles simulated in a compute shader
+			 */
+			static void Barrier(MemoryBarrierBits barriers);
+
+			GLint GetUniformLocation(UniformName name);
+			UniformHandle GetUniformHandle(UniformName name);
+
+			const std::vector<UniformInfo>& GetUniforms() const { return m_Uniforms; }
+			const std::vector<UniformBlockInfo>& GetUniformBlocks() const { return m_UniformBlocks; }
+
 
+			void Uniform(UniformName name, const glm::mat4& uniform);
+			void Uniform(UniformName name, const GLTexture& uniform, int slot);
+			void Uniform(UniformName name, const GLTexture& uniform, const SamplerDesc& sampler, int slot);
+			void Uniform(UniformName name, int uniform);
 
+			void Uniform(UniformHandle handle, const glm::mat4& uniform);
+			// without a SamplerDesc the texture's own parameters are used
+			void Uniform(UniformHandle handle, const GLTexture& uniform, int slot);
+			/** @brief Binds 'uniform' with the cached sampler object for 'sampler' to 'slot', see SamplerCache */
+			void Uniform(UniformHandle handle, const GLTexture& uniform, const SamplerDesc& sampler, int slot);
+			void Uniform(UniformHandle handle, int uniform);
+
+			/**
+			 * @brief Uniform writes are compared (with memcmp) against the last value written through this
+			 * Shader and dropped if they match. Enabled by default.
+			 */
+			void SetUniformShadowing(bool enabled) { m_UniformShadowing = enabled; }
+			// Call after changing uniforms of this program without going through Shader
+			void InvalidateUniformShadow();
 
-			void Uniform(const std::string& name, const glm::mat4& uniform);
-			void Uniform(const std::string& name, const GLTexture& uniform, int slot);
-			void Uniform(const std::string& name, int uniform);
+			const UniformShadowStats& GetUniformShadowStats() const { return m_ShadowStats; }
+			void ResetUniformShadowStats() { m_ShadowStats = UniformShadowStats(); }
+			// Sum of all shaders
+			static const UniformShadowStats& GetGlobalUniformShadowStats();
+			static void ResetGlobalUniformShadowStats();
 
 
 			/**
@@ -56,7 +250,7 @@ namespace EaseGL
 			 * @param bufferIndex between 0 and GL_MAX_UNIFORM_BUFFER_BINDINGS, similar to glActiveTexture
 			 * @param uniformName
 			 */
-			void BindUBO(GLBuffer uniformBuffer, int bufferIndex, const char* uniformName);
+			void BindUBO(const GLBuffer& uniformBuffer, int bufferIndex, const char* uniformName);
 	};
 } // namespace EaseGL
 
@@ -0,0 +1,129 @@
+#include "ShaderBatch.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <iostream>
+#include <stdexcept>
+
+#include "GLContext.hpp"
+
+namespace EaseGL
+{
+   static bool s_ParallelCompileEnabled = false;
+
+   ShaderBatch::ShaderBatch()
+      : m_PendingCount(0)
+   {
+      EnableParallelCompile();
+   }
+
+   // static
+   void ShaderBatch::EnableParallelCompile()
+   {
+      if(s_ParallelCompileEnabled)
+         return;
+      s_ParallelCompileEnabled = true;
+
+#ifdef GL_KHR_parallel_shader_compile
+      // 0xFFFFFFFF leaves the thread count to the implementation
+      if(GLContext::HasExtension("GL_KHR_parallel_shader_compile"))
+         glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
+   }
+
+   ShaderBatchHandle ShaderBatch::Add(const char* shaderPath)
+   {
+      ShaderBatchHandle handle = (ShaderBatchHandle)m_Entries.size();
+      m_Entries.emplace_back();
+      Entry& entry = m_Entries.back();
+      entry.shader = std::make_unique<Shader>();
+
+      try
+      {
+         entry.shader->BeginLoad(shaderPath);
+         entry.status = ShaderLoadStatus::PENDING;
+         m_PendingCount++;
+      }
+      catch(const std::exception& e)
+      {
+         entry.status = ShaderLoadStatus::FAILED;
+         entry.error = e.what();
+      }
+      return handle;
+   }
+
+   void ShaderBatch::Finish(Entry& entry)
+   {
+      try
+      {
+         entry.shader->FinishLoad();
+         entry.status = ShaderLoadStatus::READY;
+      }
+      catch(const std::exception& e)
+      {
+         entry.status = ShaderLoadStatus::FAILED;
+         entry.error = e.what();
+      }
+      m_PendingCount--;
+   }
+
+   uint32_t ShaderBatch::Poll()
+   {
+      if(m_PendingCount == 0)
+         return 0;
+
+      for(Entry& entry : m_Entries)
+      {
+         if(entry.status == ShaderLoadStatus::PENDING && entry.shader->IsLoadComplete())
+            Finish(entry);
+      }
+      return m_PendingCount;
+   }
+
+   void ShaderBatch::Wait()
+   {
+      for(Entry& entry : m_Entries)
+      {
+         if(entry.status == ShaderLoadStatus::PENDING)
+            Finish(entry);
+      }
+   }
+
+   ShaderLoadStatus ShaderBatch::GetStatus(ShaderBatchHandle handle) const
+   {
+      if(handle >= m_Entries.size())
+         return ShaderLoadStatus::NONE;
+      return m_Entries[handle].status;
+   }
+
+   const std::string& ShaderBatch::GetError(ShaderBatchHandle handle) const
+   {
+      static const std::string empty;
+      if(handle >= m_Entries.size())
+         return empty;
+      return m_Entries[handle].error;
+   }
+
+   Shader& ShaderBatch::GetShader(ShaderBatchHandle handle)
+   {
+      if(GetStatus(handle) != ShaderLoadStatus::READY)
+         std::cout << "ERROR: ShaderBatch::GetShader(" << handle << ") is not ready" << std::endl;
+      return *m_Entries.at(handle).shader;
+   }
+
+   Shader ShaderBatch::TakeShader(ShaderBatchHandle handle)
+   {
+      // a shader that is still compiling or failed stays with the batch
+      if(GetStatus(handle) != ShaderLoadStatus::READY)
+      {
+         std::cout << "ERROR: ShaderBatch::TakeShader(" << handle << ") is not ready" << std::endl;
+         return Shader();
+      }
+
+      Shader shader = std::move(*m_Entries[handle].shader);
+      m_Entries[handle].status = ShaderLoadStatus::NONE;
+      return shader;
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,86 @@
+#ifndef SHADERBATCH_H
+#define SHADERBATCH_H
+#pragma once
+
+#include <glad/glad.h>
+#include "Shader.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EaseGL
+{
+	typedef uint32_t ShaderBatchHandle;
+
+	enum class ShaderLoadStatus
+	{
+		NONE = 0,
+		PENDING,
+		READY,
+		FAILED,
+	};
+
+	/**
+	 * @brief Loads many shaders without waiting on each compile. Add() submits compile and link,
+	 * Poll() finishes the ones the driver is done with. With GL_KHR_parallel_shader_compile the driver
+	 * compiles on its own threads and Poll() never blocks, so loading can overlap other startup work.
+	 *
+	 * ShaderBatch batch;
+	 * ShaderBatchHandle sprite = batch.Add("sprite.glsl");
+	 * ...
+	 * while(!batch.IsDone())
+	 * {
+	 *    batch.Poll();
+	 *    // decode textures, draw a loading screen, ...
+	 * }
+	 * if(batch.GetStatus(sprite) == ShaderLoadStatus::READY)
+	 *    batch.GetShader(sprite).Bind();
+	 *
+	 * Without the extension Poll() finishes everything submitted, which waits for the driver.
+	 */
+	class ShaderBatch
+	{
+		private:
+			struct Entry
+			{
+				std::unique_ptr<Shader> shader;
+				ShaderLoadStatus status = ShaderLoadStatus::NONE;
+				std::string error;
+			};
+
+			std::vector<Entry> m_Entries;
+			uint32_t m_PendingCount;
+
+			void Finish(Entry& entry);
+		public:
+			ShaderBatch();
+
+			ShaderBatch(const ShaderBatch&) = delete;
+			ShaderBatch& operator=(const ShaderBatch&) = delete;
+
+			/** @brief Parses the file and submits its compile and link. Failures are reported through GetStatus() */
+			ShaderBatchHandle Add(const char* shaderPath);
+
+			/** @brief Finishes every shader whose link has completed. Returns how many are still pending */
+			uint32_t Poll();
+			/** @brief Blocks until everything is finished */
+			void Wait();
+			bool IsDone() const { return m_PendingCount == 0; }
+
+			ShaderLoadStatus GetStatus(ShaderBatchHandle handle) const;
+			/** @brief Why the shader FAILED, with the stage, the path and the driver's compile or link log */
+			const std::string& GetError(ShaderBatchHandle handle) const;
+
+			/** @brief Only valid once the status is READY. The Shader stays owned by the batch */
+			Shader& GetShader(ShaderBatchHandle handle);
+			/** @brief Moves a READY shader out of the batch, returns an empty Shader if it isn't READY */
+			Shader TakeShader(ShaderBatchHandle handle);
+
+			size_t Count() const { return m_Entries.size(); }
+
+			/** @brief Lets the driver use as many compiler threads as it wants, called by the first ShaderBatch */
+			static void EnableParallelCompile();
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,95 @@
+#include "ShaderRegistry.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "ShaderSource.hpp"
+
+namespace EaseGL
+{
+   struct ShaderRegistryEntry
+   {
+      std::weak_ptr<Shader> shader;
+      // ShaderSourceCache::Generation() when the entry was made, a newer one means files may have changed
+      uint32_t generation = 0;
+   };
+
+   struct ShaderRegistryData
+   {
+      std::unordered_map<std::string, ShaderRegistryEntry> byPath;
+      std::unordered_map<uint64_t, std::weak_ptr<Shader>> bySource;
+      uint32_t compileCount = 0;
+   };
+
+   static ShaderRegistryData s_ShaderRegistry;
+
+   // static
+   std::shared_ptr<Shader> ShaderRegistry::Load(const char* shaderPath)
+   {
+      const ShaderSourceFile* file = ShaderSourceCache::Load(shaderPath);
+      if(file == nullptr)
+      {
+         std::cout << shaderPath;
+         throw std::runtime_error("Failed to load file");
+      }
+
+      ShaderRegistryEntry& entry = s_ShaderRegistry.byPath[file->path];
+      if(entry.generation == ShaderSourceCache::Generation())
+      {
+         if(std::shared_ptr<Shader> shader = entry.shader.lock())
+            return shader;
+      }
+
+      ShaderSources sources;
+      ShaderSourceCache::Preprocess(shaderPath, sources);
+      // Copies of a file share one program, the hash skips the source ids in #line directives but not the line numbers.
+      // The trade-off: compile errors and the file legend of a shared program name the files of the first one loaded
+      uint64_t sourceHash = HashShaderSources(sources);
+
+      std::weak_ptr<Shader>& sameSource = s_ShaderRegistry.bySource[sourceHash];
+      std::shared_ptr<Shader> shader = sameSource.lock();
+      if(shader == nullptr)
+      {
+         shader = std::make_shared<Shader>();
+         shader->LoadSources(sources, file->path.c_str());
+         sameSource = shader;
+         s_ShaderRegistry.compileCount++;
+      }
+
+      entry.shader = shader;
+      entry.generation = ShaderSourceCache::Generation();
+      return shader;
+   }
+
+   // static
+   void ShaderRegistry::Prune()
+   {
+      for(auto it = s_ShaderRegistry.byPath.begin(); it != s_ShaderRegistry.byPath.end();)
+         it = it->second.shader.expired() ? s_ShaderRegistry.byPath.erase(it) : std::next(it);
+      for(auto it = s_ShaderRegistry.bySource.begin(); it != s_ShaderRegistry.bySource.end();)
+         it = it->second.expired() ? s_ShaderRegistry.bySource.erase(it) : std::next(it);
+   }
+
+   // static
+   size_t ShaderRegistry::LiveCount()
+   {
+      size_t count = 0;
+      for(const auto& it : s_ShaderRegistry.bySource)
+      {
+         if(!it.second.expired())
+            count++;
+      }
+      return count;
+   }
+
+   // static
+   uint32_t ShaderRegistry::CompileCount()
+   {
+      return s_ShaderRegistry.compileCount;
+   }
+} // namespace EaseGL
+#endif
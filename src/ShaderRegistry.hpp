@@ -0,0 +1,39 @@
+#ifndef SHADERREGISTRY_H
+#define SHADERREGISTRY_H
+#pragma once
+
+#include <glad/glad.h>
+#include "Shader.hpp"
+#include <memory>
+#include <string>
+
+namespace EaseGL
+{
+	/**
+	 * @brief Process-wide registry of loaded shader files. Load() returns the same program for the same
+	 * canonical path, and for different files whose preprocessed source is identical apart from the
+	 * source ids in #line directives.
+	 * The registry only keeps weak references, a program is deleted when the last shared_ptr is released.
+	 *
+	 * std::shared_ptr<EaseGL::Shader> shader = EaseGL::ShaderRegistry::Load("shader.glsl");
+	 *
+	 * Edited files are picked up after ShaderSourceCache::Invalidate(path). Not thread safe.
+	 */
+	class ShaderRegistry
+	{
+		private:
+			ShaderRegistry() {}
+		public:
+			/** @brief Throws std::runtime_error if the file can't be read or compiled */
+			static std::shared_ptr<Shader> Load(const char* shaderPath);
+
+			/** @brief Forgets entries whose programs were released */
+			static void Prune();
+			// programs still referenced
+			static size_t LiveCount();
+			// Load() calls that compiled a program
+			static uint32_t CompileCount();
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,346 @@
+#include "ShaderSource.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string.h>
+
+namespace EaseGL
+{
+   struct ShaderSourceCacheData
+   {
+      std::unordered_map<std::string, std::unique_ptr<ShaderSourceFile>> files;
+      std::unordered_map<uint32_t, const ShaderSourceFile*> filesById;
+      std::vector<std::string> includeDirectories;
+      uint32_t fileReads = 0;
+      uint32_t generation = 0;
+   };
+
+   static ShaderSourceCacheData s_ShaderSourceCache;
+
+   uint64_t HashShaderSource(std::string_view text, uint64_t hash /* = 14695981039346656037ull*/)
+   {
+      for(char c : text)
+         hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+      return hash;
+   }
+
+   std::string CanonicalShaderPath(const std::string& path)
+   {
+      std::error_code error;
+      std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+      return error ? path : canonical.generic_string();
+   }
+
+   // 'line' without leading whitespace and trailing '\r'
+   std::string_view TrimShaderLine(std::string_view line)
+   {
+      size_t start = line.find_first_not_of(" \t");
+      if(start == std::string_view::npos)
+         return std::string_view();
+      line.remove_prefix(start);
+      if(!line.empty() && line.back() == '\r')
+         line.remove_suffix(1);
+      return line;
+   }
+
+   bool StartsWithDirective(std::string_view line, std::string_view directive)
+   {
+      return line.size() >= directive.size() && line.compare(0, directive.size(), directive) == 0
+         && (line.size() == directive.size() || line[directive.size()] == ' ' || line[directive.size()] == '\t');
+   }
+
+   // returns the next line of 'text' starting at 'pos' and moves 'pos' past it
+   std::string_view NextShaderLine(std::string_view text, size_t& pos)
+   {
+      size_t end = text.find('\n', pos);
+      if(end == std::string_view::npos)
+         end = text.size();
+      std::string_view line = text.substr(pos, end - pos);
+      pos = end + 1;
+      return line;
+   }
+
+   // comments may come before #version, so the whole section is searched, not just its first line
+   bool HasVersionDirective(std::string_view section)
+   {
+      size_t pos = 0;
+      while(pos < section.size())
+      {
+         if(StartsWithDirective(TrimShaderLine(NextShaderLine(section, pos)), "#version"))
+            return true;
+      }
+      return false;
+   }
+
+   uint64_t HashShaderSources(const ShaderSources& sources)
+   {
+      uint64_t hash = 14695981039346656037ull;
+      for(const std::string& stage : sources.stages)
+      {
+         // separator so moving text between stages changes the hash
+         hash = HashShaderSource(std::string_view("\0", 1), hash);
+
+         // the source id of a #line directive is left out so copies of a file in different places still hash equal,
+         // the line number is kept, the same text arriving from different line layouts is a different program
+         std::string_view text = stage;
+         size_t pos = 0;
+         while(pos < text.size())
+         {
+            size_t lineStart = pos;
+            std::string_view line = NextShaderLine(text, pos);
+            size_t lineEnd = std::min(pos, text.size());
+            if(line.compare(0, 6, "#line ") == 0)
+            {
+               lineEnd = line.find_first_not_of("0123456789", 6);
+               lineEnd = lineStart + (lineEnd == std::string_view::npos ? line.size() : lineEnd);
+            }
+            hash = HashShaderSource(text.substr(lineStart, lineEnd - lineStart), hash);
+         }
+      }
+      return hash;
+   }
+
+   void AppendLineDirective(std::string& out, uint32_t line, uint32_t sourceId)
+   {
+      char directive[32];
+      snprintf(directive, sizeof(directive), "#line %u %u\n", line, sourceId);
+      out += directive;
+   }
+
+   bool ReadShaderFile(const std::string& path, std::string& text)
+   {
+      FILE* fp = fopen(path.c_str(), "rb");
+      if(fp == nullptr)
+         return false;
+
+      fseek(fp, 0, SEEK_END);
+      long size = ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      text.resize(size > 0 ? (size_t)size : 0);
+      size_t read = fread(&text[0], 1, text.size(), fp);
+      fclose(fp);
+      text.resize(read);
+      s_ShaderSourceCache.fileReads++;
+      return true;
+   }
+
+   // static
+   const ShaderSourceFile* ShaderSourceCache::Load(const std::string& path)
+   {
+      std::string canonical = CanonicalShaderPath(path);
+      auto it = s_ShaderSourceCache.files.find(canonical);
+      if(it != s_ShaderSourceCache.files.end())
+         return it->second.get();
+
+      std::unique_ptr<ShaderSourceFile> file = std::make_unique<ShaderSourceFile>();
+      if(!ReadShaderFile(canonical, file->text))
+         return nullptr;
+
+      file->path = canonical;
+      file->hash = HashShaderSource(file->text);
+
+      // GLSL source string numbers are plain integers, keep them small and derived from the path
+      uint32_t sourceId = 1 + (uint32_t)(HashShaderSource(canonical) % 99999);
+      while(s_ShaderSourceCache.filesById.count(sourceId) != 0)
+         sourceId = sourceId % 99999 + 1;
+      file->sourceId = sourceId;
+
+      const ShaderSourceFile* result = file.get();
+      s_ShaderSourceCache.filesById[sourceId] = result;
+      s_ShaderSourceCache.files[canonical] = std::move(file);
+      return result;
+   }
+
+   // static
+   const ShaderSourceFile* ShaderSourceCache::Reload(const std::string& path)
+   {
+      auto it = s_ShaderSourceCache.files.find(CanonicalShaderPath(path));
+      if(it == s_ShaderSourceCache.files.end())
+         return Load(path);
+
+      std::string text;
+      if(!ReadShaderFile(it->second->path, text))
+         return nullptr;
+
+      // updated in place, the entry keeps its source id
+      ShaderSourceFile& file = *it->second;
+      if(text != file.text)
+      {
+         file.text = std::move(text);
+         file.hash = HashShaderSource(file.text);
+         s_ShaderSourceCache.generation++;
+      }
+      return &file;
+   }
+
+   // static
+   const ShaderSourceFile* ShaderSourceCache::FindBySourceId(uint32_t sourceId)
+   {
+      auto it = s_ShaderSourceCache.filesById.find(sourceId);
+      return it != s_ShaderSourceCache.filesById.end() ? it->second : nullptr;
+   }
+
+   // static
+   void ShaderSourceCache::AppendSection(std::string& out, std::string_view section, const ShaderSourceFile& file,
+      uint32_t firstLine, int depth, std::vector<uint32_t>& usedFiles)
+   {
+      if(std::find(usedFiles.begin(), usedFiles.end(), file.sourceId) == usedFiles.end())
+         usedFiles.push_back(file.sourceId);
+
+      size_t pos = 0;
+      uint32_t lineNumber = firstLine;
+      while(pos < section.size())
+      {
+         std::string_view rawLine = NextShaderLine(section, pos);
+         std::string_view line = TrimShaderLine(rawLine);
+         lineNumber++;
+
+         if(StartsWithDirective(line, "#include"))
+         {
+            std::string_view name = TrimShaderLine(line.substr(strlen("#include")));
+            char close = !name.empty() && name[0] == '<' ? '>' : '"';
+            size_t end = name.size() > 1 ? name.find(close, 1) : std::string_view::npos;
+            if(name.empty() || (name[0] != '"' && name[0] != '<') || end == std::string_view::npos)
+            {
+               std::cout << "ERROR: Malformed #include in " << file.path << ":" << lineNumber << std::endl;
+               throw std::runtime_error("Malformed #include");
+            }
+            name = name.substr(1, end - 1);
+            if(depth >= MAX_INCLUDE_DEPTH)
+            {
+               std::cout << "ERROR: #include depth exceeds " << MAX_INCLUDE_DEPTH << " in " << file.path << ":" << lineNumber << std::endl;
+               throw std::runtime_error("#include depth exceeded");
+            }
+
+            std::filesystem::path relative = std::filesystem::path(file.path).parent_path() / std::string(name);
+            const ShaderSourceFile* included = Load(relative.string());
+            for(size_t i = 0; included == nullptr && i < s_ShaderSourceCache.includeDirectories.size(); i++)
+               included = Load(s_ShaderSourceCache.includeDirectories[i] + "/" + std::string(name));
+            if(included == nullptr)
+            {
+               std::cout << "ERROR: Can't find #include \"" << name << "\" from " << file.path << ":" << lineNumber << std::endl;
+               throw std::runtime_error("Failed to load file");
+            }
+
+            AppendLineDirective(out, 1, included->sourceId);
+            AppendSection(out, included->text, *included, 0, depth + 1, usedFiles);
+            AppendLineDirective(out, lineNumber + 1, file.sourceId);
+            continue;
+         }
+
+         out.append(rawLine.data(), rawLine.size());
+         out += '\n';
+
+         // #line is not allowed before #version
+         if(StartsWithDirective(line, "#version"))
+            AppendLineDirective(out, lineNumber + 1, file.sourceId);
+      }
+   }
+
+   // static
+   void ShaderSourceCache::Preprocess(const char* path, ShaderSources& sources)
+   {
+      // the file itself is read every time so edits are picked up, only its includes come from the cache
+      const ShaderSourceFile* file = Reload(path);
+      if(file == nullptr)
+      {
+         std::cout << path;
+         throw std::runtime_error("Failed to load file");
+      }
+
+      struct Section
+      {
+         ShaderType type;
+         size_t begin;
+         size_t end;
+         uint32_t firstLine; // line of the '#shader' directive
+      };
+      std::vector<Section> sections;
+
+      // split by reference into the cached text, nothing is copied until the stages are assembled
+      std::string_view text = file->text;
+      size_t pos = 0;
+      uint32_t lineNumber = 0;
+      while(pos < text.size())
+      {
+         size_t lineStart = pos;
+         std::string_view line = TrimShaderLine(NextShaderLine(text, pos));
+         lineNumber++;
+         if(!StartsWithDirective(line, "#shader"))
+            continue;
+
+         std::string_view stage = TrimShaderLine(line.substr(strlen("#shader")));
+         ShaderType type = stage.compare(0, 6, "vertex") == 0 ? ShaderType::VERTEX
+            : stage.compare(0, 8, "fragment") == 0 ? ShaderType::FRAGMENT
+            : stage.compare(0, 8, "geometry") == 0 ? ShaderType::GEOMETRY
+            : stage.compare(0, 7, "compute") == 0 ? ShaderType::COMPUTE
+            : ShaderType::NONE;
+
+         if(!sections.empty())
+            sections.back().end = lineStart;
+         sections.push_back({ type, std::min(pos, text.size()), text.size(), lineNumber });
+      }
+
+      std::vector<uint32_t> usedFiles;
+      for(const Section& section : sections)
+      {
+         std::string_view sectionText = text.substr(section.begin, section.end - section.begin);
+         if(section.type == ShaderType::NONE || sectionText.empty())
+            continue;
+
+         std::string& out = sources[section.type];
+         out.reserve(out.size() + sectionText.size() + 64);
+
+         // without a #version line the first #line directive can go at the top, otherwise AppendSection() puts it after #version
+         if(!HasVersionDirective(sectionText))
+            AppendLineDirective(out, section.firstLine + 1, file->sourceId);
+         AppendSection(out, sectionText, *file, section.firstLine, 0, usedFiles);
+      }
+
+      for(uint32_t sourceId : usedFiles)
+         sources.fileLegend += "\n  source " + std::to_string(sourceId) + ": " + FindBySourceId(sourceId)->path;
+   }
+
+   // static
+   void ShaderSourceCache::AddIncludeDirectory(const std::string& directory)
+   {
+      s_ShaderSourceCache.includeDirectories.push_back(directory);
+   }
+
+   // static
+   void ShaderSourceCache::Invalidate(const std::string& path)
+   {
+      auto it = s_ShaderSourceCache.files.find(CanonicalShaderPath(path));
+      if(it == s_ShaderSourceCache.files.end())
+         return;
+      s_ShaderSourceCache.filesById.erase(it->second->sourceId);
+      s_ShaderSourceCache.files.erase(it);
+      s_ShaderSourceCache.generation++;
+   }
+
+   // static
+   void ShaderSourceCache::Clear()
+   {
+      s_ShaderSourceCache.files.clear();
+      s_ShaderSourceCache.filesById.clear();
+      s_ShaderSourceCache.generation++;
+   }
+
+   // static
+   uint32_t ShaderSourceCache::FileReadCount()
+   {
+      return s_ShaderSourceCache.fileReads;
+   }
+
+   // static
+   uint32_t ShaderSourceCache::Generation()
+   {
+      return s_ShaderSourceCache.generation;
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,95 @@
+#ifndef SHADERSOURCE_H
+#define SHADERSOURCE_H
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace EaseGL
+{
+	enum class ShaderType
+	{
+		NONE = 0,
+		VERTEX,
+		FRAGMENT,
+		GEOMETRY,
+		COMPUTE,
+	};
+
+	// Source of each stage, empty stages are skipped
+	struct ShaderSources
+	{
+		static constexpr int STAGE_COUNT = 4;
+		std::string stages[STAGE_COUNT];
+
+		// "source <id>: <path>" for every file used, printed with compile errors
+		std::string fileLegend;
+
+		std::string& operator[](ShaderType type) { return stages[(int)type - 1]; }
+		const std::string& operator[](ShaderType type) const { return stages[(int)type - 1]; }
+	};
+
+	struct ShaderSourceFile
+	{
+		std::string path; // canonical
+		std::string text;
+		uint64_t hash;
+		// source string number used in #line directives, derived from the path so it is stable between runs
+		uint32_t sourceId;
+	};
+
+	/**
+	 * @brief Process-wide cache of shader files, each included file is read from disk once no matter how many
+	 * programs #include it. Not thread safe.
+	 *
+	 * Preprocess() reads the file it is given from disk on every call, splits it into its '#shader <stage>' sections and expands
+	 * #include "file" (relative to the including file, then the include directories).
+	 * '#line <line> <sourceId>' is emitted around includes and after #version so compiler errors
+	 * point at the right file, sourceId -> path is in ShaderSources::fileLegend.
+	 */
+	class ShaderSourceCache
+	{
+		private:
+			ShaderSourceCache() {}
+
+			static void AppendSection(std::string& out, std::string_view section, const ShaderSourceFile& file,
+				uint32_t firstLine, int depth, std::vector<uint32_t>& usedFiles);
+		public:
+			static constexpr int MAX_INCLUDE_DEPTH = 32;
+
+			/** @brief Returns the cached file, reading it on first use. nullptr if it can't be read */
+			static const ShaderSourceFile* Load(const std::string& path);
+			/** @brief Reads the file from disk again and updates the cached entry, Generation() changes if the text did */
+			static const ShaderSourceFile* Reload(const std::string& path);
+			static const ShaderSourceFile* FindBySourceId(uint32_t sourceId);
+
+			/** @brief Throws std::runtime_error if the file or one of its includes can't be read */
+			static void Preprocess(const char* path, ShaderSources& sources);
+
+			static void AddIncludeDirectory(const std::string& directory);
+
+			/** @brief Drops a file so the next Load() reads it again (hot reload of included files) */
+			static void Invalidate(const std::string& path);
+			static void Clear();
+
+			// files actually read from disk
+			static uint32_t FileReadCount();
+			// changes on every Invalidate()/Clear(), anything derived from an older generation may be stale
+			static uint32_t Generation();
+	};
+
+	// line scanning shared by the shader preprocessors
+	std::string_view NextShaderLine(std::string_view text, size_t& pos);
+	std::string_view TrimShaderLine(std::string_view line);
+	bool StartsWithDirective(std::string_view line, std::string_view directive);
+
+	uint64_t HashShaderSource(std::string_view text, uint64_t hash = 14695981039346656037ull);
+	// hash of all stages ignoring the source ids of #line directives, equal hashes mean equal programs
+	uint64_t HashShaderSources(const ShaderSources& sources);
+} // namespace EaseGL
+
+#endif
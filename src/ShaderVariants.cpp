@@ -0,0 +1,408 @@
+#include "ShaderVariants.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace EaseGL
+{
+   int32_t FindShaderKeyword(const std::vector<std::string>& keywords, std::string_view name)
+   {
+      for(size_t i = 0; i < keywords.size(); i++)
+      {
+         if(keywords[i] == name)
+            return (int32_t)i;
+      }
+      return -1;
+   }
+
+   std::string_view TrimKeywordExpression(std::string_view text)
+   {
+      size_t start = text.find_first_not_of(" \t\r");
+      if(start == std::string_view::npos)
+         return std::string_view();
+      size_t end = text.find_last_not_of(" \t\r");
+      return text.substr(start, end - start + 1);
+   }
+
+   // 1 or 0 if 'expression' only tests one keyword, -1 if it has to be left to the GLSL preprocessor
+   int EvaluateKeywordCondition(std::string_view directive, std::string_view expression,
+      const std::vector<std::string>& keywords, ShaderKeywordMask mask)
+   {
+      expression = TrimKeywordExpression(expression);
+      bool negate = directive == "ifndef";
+      if(directive == "if" || directive == "elif")
+      {
+         if(!expression.empty() && expression[0] == '!')
+         {
+            negate = true;
+            expression = TrimKeywordExpression(expression.substr(1));
+         }
+         if(expression.compare(0, 7, "defined") != 0)
+            return -1;
+         expression = TrimKeywordExpression(expression.substr(7));
+         if(!expression.empty() && expression.front() == '(' && expression.back() == ')')
+            expression = TrimKeywordExpression(expression.substr(1, expression.size() - 2));
+      }
+
+      int32_t keyword = FindShaderKeyword(keywords, expression);
+      if(keyword < 0)
+         return -1;
+      bool defined = (mask & ((ShaderKeywordMask)1 << keyword)) != 0;
+      return defined != negate ? 1 : 0;
+   }
+
+   /**
+    * Resolves conditionals that only test keywords, everything else is left to the GLSL preprocessor.
+    * Removed lines are kept as empty lines so the #line directives of the source stay correct.
+    */
+   void ResolveKeywordConditionals(const std::string& source, const std::vector<std::string>& keywords,
+      ShaderKeywordMask mask, std::string& out)
+   {
+      struct Frame
+      {
+         bool known;       // resolved here, its directives are not emitted
+         bool parentEmit;
+         bool branchTaken;
+         bool emit;
+      };
+      std::vector<Frame> frames;
+
+      out.reserve(source.size());
+      std::string_view text = source;
+      size_t pos = 0;
+      while(pos < text.size())
+      {
+         size_t end = text.find('\n', pos);
+         if(end == std::string_view::npos)
+            end = text.size();
+         std::string_view line = text.substr(pos, end - pos);
+         pos = end + 1;
+
+         bool emit = frames.empty() || frames.back().emit;
+         std::string_view trimmed = TrimKeywordExpression(line);
+         if(trimmed.empty() || trimmed[0] != '#')
+         {
+            if(emit)
+               out.append(line.data(), line.size());
+            out += '\n';
+            continue;
+         }
+
+         std::string_view directive = TrimKeywordExpression(trimmed.substr(1));
+         size_t nameEnd = directive.find_first_of(" \t(");
+         std::string_view name = directive.substr(0, nameEnd);
+         std::string_view expression = nameEnd == std::string_view::npos ? std::string_view() : directive.substr(nameEnd);
+
+         bool keepLine = emit;
+         if(name == "if" || name == "ifdef" || name == "ifndef")
+         {
+            int value = EvaluateKeywordCondition(name, expression, keywords, mask);
+            if(value < 0)
+               frames.push_back({ false, emit, false, emit });
+            else
+            {
+               frames.push_back({ true, emit, value == 1, emit && value == 1 });
+               keepLine = false;
+            }
+         }
+         else if((name == "elif" || name == "else" || name == "endif") && !frames.empty())
+         {
+            Frame& frame = frames.back();
+            keepLine = frame.parentEmit && !frame.known;
+            if(name == "endif")
+               frames.pop_back();
+            else if(frame.known && name == "else")
+            {
+               frame.emit = frame.parentEmit && !frame.branchTaken;
+               frame.branchTaken = true;
+            }
+            else if(frame.known && frame.branchTaken)
+               frame.emit = false;
+            else if(frame.known)
+            {
+               int value = EvaluateKeywordCondition(name, expression, keywords, mask);
+               if(value >= 0)
+               {
+                  frame.branchTaken = value == 1;
+                  frame.emit = frame.parentEmit && value == 1;
+               }
+               else
+               {
+                  // every branch before was false, the rest of the chain becomes a plain #if
+                  frame.known = false;
+                  frame.emit = frame.parentEmit;
+                  if(frame.parentEmit)
+                  {
+                     out += "#if";
+                     out.append(expression.data(), expression.size());
+                  }
+                  keepLine = false;
+               }
+            }
+         }
+
+         if(keepLine)
+            out.append(line.data(), line.size());
+         out += '\n';
+      }
+   }
+
+   bool ContainsKeywordToken(const std::string& text, const std::string& keyword)
+   {
+      auto isIdentifier = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; };
+      for(size_t pos = text.find(keyword); pos != std::string::npos; pos = text.find(keyword, pos + 1))
+      {
+         size_t end = pos + keyword.size();
+         if((pos == 0 || !isIdentifier(text[pos - 1])) && (end == text.size() || !isIdentifier(text[end])))
+            return true;
+      }
+      return false;
+   }
+
+   ShaderVariants::ShaderVariants(const char* shaderPath, const std::vector<std::string>& keywords)
+      : m_Path(shaderPath), m_Keywords(keywords), m_VariantCount(0)
+   {
+      if(m_Keywords.size() > MAX_KEYWORDS)
+      {
+         std::cout << "ERROR: ShaderVariants supports up to " << MAX_KEYWORDS << " keywords, " << shaderPath << " has " << m_Keywords.size() << std::endl;
+         m_Keywords.resize(MAX_KEYWORDS);
+      }
+      ShaderSourceCache::Preprocess(shaderPath, m_Sources);
+   }
+
+   ShaderKeywordMask ShaderVariants::Keyword(const char* keyword) const
+   {
+      int32_t index = FindShaderKeyword(m_Keywords, keyword);
+      if(index < 0)
+      {
+         std::cout << "ERROR: Unknown shader keyword " << keyword << " in " << m_Path << std::endl;
+         return 0;
+      }
+      return (ShaderKeywordMask)1 << index;
+   }
+
+   ShaderKeywordMask ShaderVariants::Mask(std::initializer_list<const char*> keywords) const
+   {
+      ShaderKeywordMask mask = 0;
+      for(const char* keyword : keywords)
+         mask |= Keyword(keyword);
+      return mask;
+   }
+
+   int32_t ShaderVariants::FindVariant(ShaderKeywordMask mask) const
+   {
+      if(m_Table.empty())
+         return -1;
+
+      size_t tableMask = m_Table.size() - 1;
+      for(size_t i = (size_t)(mask * 0x9E3779B97F4A7C15ull >> 32) & tableMask;; i = (i + 1) & tableMask)
+      {
+         if(m_Table[i].program < 0)
+            return -1;
+         if(m_Table[i].mask == mask)
+            return m_Table[i].program;
+      }
+   }
+
+   void ShaderVariants::InsertVariant(ShaderKeywordMask mask, int32_t program)
+   {
+      // keep the load factor at or below 50%
+      if((m_VariantCount + 1) * 2 > m_Table.size())
+      {
+         std::vector<Slot> old = std::move(m_Table);
+         m_Table.assign(old.empty() ? 16 : old.size() * 2, Slot{ 0, -1 });
+         m_VariantCount = 0;
+         for(const Slot& slot : old)
+         {
+            if(slot.program >= 0)
+               InsertVariant(slot.mask, slot.program);
+         }
+      }
+
+      size_t tableMask = m_Table.size() - 1;
+      size_t i = (size_t)(mask * 0x9E3779B97F4A7C15ull >> 32) & tableMask;
+      while(m_Table[i].program >= 0)
+         i = (i + 1) & tableMask;
+      m_Table[i] = Slot{ mask, program };
+      m_VariantCount++;
+   }
+
+   void ShaderVariants::BuildVariantSources(ShaderKeywordMask mask, ShaderSources& out) const
+   {
+      out.fileLegend = m_Sources.fileLegend;
+      for(int stage = 0; stage < ShaderSources::STAGE_COUNT; stage++)
+      {
+         const std::string& source = m_Sources.stages[stage];
+         if(source.empty())
+            continue;
+
+         std::string resolved;
+         ResolveKeywordConditionals(source, m_Keywords, mask, resolved);
+
+         // only keywords the remaining source still mentions are defined
+         std::string defines;
+         for(size_t i = 0; i < m_Keywords.size(); i++)
+         {
+            if((mask & ((ShaderKeywordMask)1 << i)) != 0 && ContainsKeywordToken(resolved, m_Keywords[i]))
+               defines += "#define " + m_Keywords[i] + " 1\n";
+         }
+
+         // defines have to follow #version, the #line directive after it keeps line numbers right
+         size_t insert = 0;
+         size_t pos = 0;
+         while(pos < resolved.size())
+         {
+            std::string_view line = NextShaderLine(resolved, pos);
+            if(StartsWithDirective(TrimShaderLine(line), "#version"))
+            {
+               insert = std::min(pos, resolved.size());
+               break;
+            }
+         }
+         if(!defines.empty() && insert > 0 && resolved[insert - 1] != '\n')
+            defines.insert(0, 1, '\n');
+         resolved.insert(insert, defines);
+
+         out.stages[stage] = std::move(resolved);
+      }
+   }
+
+   int32_t ShaderVariants::SubmitVariant(ShaderKeywordMask mask, bool& submitted)
+   {
+      submitted = false;
+
+      ShaderSources sources;
+      BuildVariantSources(mask, sources);
+
+      uint64_t hash = HashShaderSources(sources);
+
+      auto it = m_ProgramsBySource.find(hash);
+      if(it != m_ProgramsBySource.end())
+         return it->second;
+
+      std::string name = m_Path + " [";
+      for(size_t i = 0; i < m_Keywords.size(); i++)
+      {
+         if((mask & ((ShaderKeywordMask)1 << i)) != 0)
+            name += " " + m_Keywords[i];
+      }
+      name += " ]";
+
+      int32_t program = (int32_t)m_Programs.size();
+      m_Programs.push_back(std::make_unique<Shader>());
+      m_ProgramsBySource[hash] = program;
+      m_Programs.back()->BeginLoadSources(sources, name.c_str());
+      submitted = true;
+      return program;
+   }
+
+   Shader& ShaderVariants::Get(ShaderKeywordMask mask)
+   {
+      if(m_Keywords.size() < MAX_KEYWORDS)
+         mask &= ((ShaderKeywordMask)1 << m_Keywords.size()) - 1;
+
+      int32_t program = FindVariant(mask);
+      if(program >= 0)
+         return *m_Programs[program];
+
+      // throws if the variant fails to compile
+      Prewarm(std::vector<ShaderKeywordMask>{ mask });
+      return *m_Programs[FindVariant(mask)];
+   }
+
+   void ShaderVariants::Prewarm(const std::vector<ShaderKeywordMask>& masks)
+   {
+      struct Pending
+      {
+         ShaderKeywordMask mask;
+         int32_t program;
+         bool submitted;
+      };
+      std::vector<Pending> pending;
+
+      for(ShaderKeywordMask mask : masks)
+      {
+         if(m_Keywords.size() < MAX_KEYWORDS)
+            mask &= ((ShaderKeywordMask)1 << m_Keywords.size()) - 1;
+         if(FindVariant(mask) >= 0)
+            continue;
+
+         bool submitted = false;
+         int32_t program = SubmitVariant(mask, submitted);
+         pending.push_back({ mask, program, submitted });
+      }
+
+      // every link is submitted before the first status check so drivers can compile them in parallel
+      std::string error;
+      for(const Pending& variant : pending)
+      {
+         if(!variant.submitted)
+            continue;
+         try
+         {
+            m_Programs[variant.program]->FinishLoad();
+         }
+         catch(const std::exception& e)
+         {
+            // dropped so the next Get() compiles it again
+            for(auto it = m_ProgramsBySource.begin(); it != m_ProgramsBySource.end(); ++it)
+            {
+               if(it->second == variant.program)
+               {
+                  m_ProgramsBySource.erase(it);
+                  break;
+               }
+            }
+            m_Programs[variant.program].reset();
+            error = e.what();
+         }
+      }
+
+      for(const Pending& variant : pending)
+      {
+         if(m_Programs[variant.program] != nullptr && FindVariant(variant.mask) < 0)
+            InsertVariant(variant.mask, variant.program);
+      }
+
+      if(!error.empty())
+         throw std::runtime_error(error);
+   }
+
+   void ShaderVariants::Prewarm(const char* manifestPath)
+   {
+      std::ifstream manifest(manifestPath);
+      if(!manifest)
+      {
+         std::cout << "ERROR: Failed to open shader variant manifest " << manifestPath << std::endl;
+         return;
+      }
+
+      std::vector<ShaderKeywordMask> masks;
+      std::string line;
+      while(std::getline(manifest, line))
+      {
+         line = line.substr(0, line.find('#'));
+         std::istringstream keywords(line);
+         std::string keyword;
+         ShaderKeywordMask mask = 0;
+         bool empty = true;
+         while(keywords >> keyword)
+         {
+            empty = false;
+            if(keyword != "-")
+               mask |= Keyword(keyword.c_str());
+         }
+         if(!empty)
+            masks.push_back(mask);
+      }
+      Prewarm(masks);
+   }
+} // namespace EaseGL
+#endif
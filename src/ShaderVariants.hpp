@@ -0,0 +1,78 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+#pragma once
+
+#include <glad/glad.h>
+#include "Shader.hpp"
+#include "ShaderSource.hpp"
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace EaseGL
+{
+	typedef uint64_t ShaderKeywordMask;
+
+	/**
+	 * @brief One shader file compiled with different sets of '#define' keywords, each set is a bit mask.
+	 * Variants are compiled on first Get() (or by Prewarm()) and looked up in an open addressing table.
+	 *
+	 * #ifdef / #ifndef / #if defined(...) on keywords are resolved before compiling, and keywords that are
+	 * not referenced afterwards are not defined, so keyword sets that end up with the same source share one program.
+	 *
+	 * ShaderVariants lit("lit.glsl", { "NORMAL_MAP", "SHADOWS", "FOG" });
+	 * lit.Get(lit.Mask({ "NORMAL_MAP", "FOG" })).Bind();
+	 */
+	class ShaderVariants
+	{
+		private:
+			struct Slot
+			{
+				ShaderKeywordMask mask;
+				int32_t program; // -1 for empty slots
+			};
+
+			ShaderSources m_Sources;
+			std::string m_Path;
+			std::vector<std::string> m_Keywords;
+
+			std::vector<std::unique_ptr<Shader>> m_Programs;
+			std::unordered_map<uint64_t, int32_t> m_ProgramsBySource;
+
+			std::vector<Slot> m_Table;
+			uint32_t m_VariantCount;
+
+			int32_t FindVariant(ShaderKeywordMask mask) const;
+			void InsertVariant(ShaderKeywordMask mask, int32_t program);
+			// returns the program of an equivalent variant, or a new one that BeginLoadSources() was called on
+			int32_t SubmitVariant(ShaderKeywordMask mask, bool& submitted);
+			void BuildVariantSources(ShaderKeywordMask mask, ShaderSources& out) const;
+		public:
+			static constexpr size_t MAX_KEYWORDS = 64;
+
+			ShaderVariants(const char* shaderPath, const std::vector<std::string>& keywords);
+
+			ShaderVariants(const ShaderVariants&) = delete;
+			ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+			ShaderKeywordMask Keyword(const char* keyword) const;
+			ShaderKeywordMask Mask(std::initializer_list<const char*> keywords) const;
+
+			/** @brief Compiles the variant if it doesn't exist yet, throws std::runtime_error if that fails */
+			Shader& Get(ShaderKeywordMask mask);
+
+			/** @brief Compiles the variants up front, all links are submitted before any status is checked */
+			void Prewarm(const std::vector<ShaderKeywordMask>& masks);
+			/** @brief One variant per line, keywords separated by spaces, '#' starts a comment and '-' alone is the variant without keywords */
+			void Prewarm(const char* manifestPath);
+
+			const std::vector<std::string>& GetKeywords() const { return m_Keywords; }
+			uint32_t VariantCount() const { return m_VariantCount; }
+			// unique programs, at most VariantCount()
+			uint32_t ProgramCount() const { return (uint32_t)m_ProgramsBySource.size(); }
+	};
+} // namespace EaseGL
+
+#endif
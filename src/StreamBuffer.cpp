@@ -0,0 +1,138 @@
+#include "StreamBuffer.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <iostream>
+
+#include "GLContext.hpp"
+
+namespace EaseGL
+{
+   StreamBuffer::StreamBuffer(GLBufferType bufferType, GLsizeiptr regionSize, uint32_t regionCount /* = 3*/)
+      : m_Buffer(bufferType), m_MappedPointer(nullptr), m_RegionSize(regionSize), m_RegionCount(regionCount),
+      m_CurrentRegion(0), m_RegionHead(0), m_RegionFences(regionCount, nullptr), m_StallCount(0)
+   {
+      if(regionSize <= 0 || regionCount == 0)
+      {
+         std::cout << "ERROR: StreamBuffer needs at least one region of at least one byte, got "
+            << regionCount << " regions of " << regionSize << " bytes" << std::endl;
+         return;
+      }
+
+      if(!GLContext::HasVersion(4, 4) && !GLContext::HasExtension("GL_ARB_buffer_storage"))
+      {
+         std::cout << "ERROR: StreamBuffer requires OpenGL 4.4 or GL_ARB_buffer_storage" << std::endl;
+         return;
+      }
+
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      m_Buffer.BufferStorage(nullptr, m_RegionSize * m_RegionCount, flags);
+      m_MappedPointer = (unsigned char*)m_Buffer.MapBufferRange(0, m_RegionSize * m_RegionCount, flags);
+
+      if(m_MappedPointer == nullptr)
+         std::cout << "ERROR: StreamBuffer failed to map " << m_RegionSize * m_RegionCount << " bytes" << std::endl;
+   }
+
+   StreamBuffer::~StreamBuffer()
+   {
+      for(GLsync fence : m_RegionFences)
+      {
+         if(fence != nullptr)
+            glDeleteSync(fence);
+      }
+
+      if(m_MappedPointer != nullptr)
+      {
+         m_Buffer.Bind();
+         m_Buffer.UnmapBuffer();
+      }
+   }
+
+   void StreamBuffer::WaitRegion(uint32_t region)
+   {
+      GLsync& fence = m_RegionFences[region];
+      if(fence == nullptr)
+         return;
+
+      GLenum result = glClientWaitSync(fence, 0, 0);
+      if(result == GL_TIMEOUT_EXPIRED)
+      {
+         m_StallCount++;
+         // flush once so the fence is guaranteed to be signaled eventually
+         GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+         do
+         {
+            result = glClientWaitSync(fence, waitFlags, 1000000); // 1ms
+            waitFlags = 0;
+         } while(result == GL_TIMEOUT_EXPIRED);
+      }
+
+      if(result == GL_WAIT_FAILED)
+         std::cout << "ERROR: StreamBuffer fence wait failed" << std::endl;
+
+      glDeleteSync(fence);
+      fence = nullptr;
+   }
+
+   void StreamBuffer::BeginFrame()
+   {
+      if(m_MappedPointer == nullptr)
+         return;
+
+      WaitRegion(m_CurrentRegion);
+      m_RegionHead = 0;
+   }
+
+   void StreamBuffer::EndFrame()
+   {
+      if(m_MappedPointer == nullptr)
+         return;
+
+      if(m_RegionFences[m_CurrentRegion] != nullptr)
+         glDeleteSync(m_RegionFences[m_CurrentRegion]);
+      m_RegionFences[m_CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+      m_CurrentRegion = (m_CurrentRegion + 1) % m_RegionCount;
+      m_RegionHead = 0;
+   }
+
+   StreamAllocation StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment /* = 4*/)
+   {
+      StreamAllocation allocation;
+      if(m_MappedPointer == nullptr || size <= 0)
+         return allocation;
+
+      if(alignment <= 0)
+         alignment = 1;
+
+      // align the absolute offset, region base isn't necessarily a multiple of 'alignment'
+      GLintptr regionBase = (GLintptr)m_CurrentRegion * m_RegionSize;
+      GLintptr offset = regionBase + m_RegionHead;
+      offset = ((offset + alignment - 1) / alignment) * alignment;
+
+      if(offset + size > regionBase + m_RegionSize)
+      {
+         std::cout << "ERROR: StreamBuffer region is full, requested " << size << " bytes, "
+            << m_RegionSize - m_RegionHead << " left" << std::endl;
+         return allocation;
+      }
+
+      m_RegionHead = offset + size - regionBase;
+
+      allocation.pointer = m_MappedPointer + offset;
+      allocation.offset = offset;
+      allocation.size = size;
+      return allocation;
+   }
+
+   void StreamBuffer::Bind() const
+   {
+      m_Buffer.Bind();
+   }
+
+   void StreamBuffer::BindRange(GLuint bufferIndex, const StreamAllocation& allocation)
+   {
+      m_Buffer.BindBufferRange(bufferIndex, allocation.offset, allocation.size);
+   }
+} // namespace EaseGL
+#endif
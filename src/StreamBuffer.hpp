@@ -0,0 +1,88 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+#pragma once
+
+#include <glad/glad.h>
+#include "GLBuffer.hpp"
+#include <vector>
+
+namespace EaseGL
+{
+	struct StreamAllocation
+	{
+		void* pointer = nullptr; // CPU pointer, write only
+		GLintptr offset = 0;     // offset inside the GL buffer
+		GLsizeiptr size = 0;
+
+		operator bool() const { return pointer != nullptr; }
+	};
+
+	/**
+	 * @brief Persistently mapped buffer that is split into 'regionCount' frame regions.
+	 * Each frame allocates from one region, regions are fenced at EndFrame() and
+	 * BeginFrame() only waits if the GPU is still reading the region that is about to be reused.
+	 * 
+	 * StreamBuffer stream(GLBufferType::ARRAY_BUFFER, 4 * 1024 * 1024);
+	 * 
+	 * stream.BeginFrame();
+	 * StreamAllocation vertices = stream.Allocate(sizeof(Vertex) * count, sizeof(Vertex));
+	 * memcpy(vertices.pointer, data, vertices.size);
+	 * glDrawArrays(GL_TRIANGLES, vertices.offset / sizeof(Vertex), count);
+	 * stream.EndFrame();
+	 * 
+	 * Requires OpenGL 4.4 or GL_ARB_buffer_storage. IsMapped() is false if that is missing or the
+	 * region size or count is zero, the frame calls do nothing then and Allocate() returns empty allocations
+	 */
+	class StreamBuffer  
+	{
+		private:
+			GLBuffer m_Buffer;
+			unsigned char* m_MappedPointer;
+
+			GLsizeiptr m_RegionSize;
+			uint32_t m_RegionCount;
+			uint32_t m_CurrentRegion;
+			GLsizeiptr m_RegionHead; // bump allocation offset inside current region
+
+			std::vector<GLsync> m_RegionFences;
+
+			uint64_t m_StallCount;
+
+			void WaitRegion(uint32_t region);
+		public:
+			StreamBuffer(GLBufferType bufferType, GLsizeiptr regionSize, uint32_t regionCount = 3);
+			~StreamBuffer();
+
+			StreamBuffer(const StreamBuffer&) = delete;
+			StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+			/**
+			 * @brief Waits until GPU is done with the current region, call before the first Allocate() of the frame
+			 */
+			void BeginFrame();
+			/**
+			 * @brief Fences the current region and moves to the next one, call after the last draw that uses this frame's allocations
+			 */
+			void EndFrame();
+
+			/**
+			 * @brief Bump allocates from current region, returns empty allocation if the region is full
+			 * 
+			 * @param alignment doesn't have to be a power of two, vertex stride can be used to get a valid base vertex
+			 */
+			StreamAllocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+
+			void Bind() const;
+			void BindRange(GLuint bufferIndex, const StreamAllocation& allocation);
+
+			bool IsMapped() const { return m_MappedPointer != nullptr; }
+			GLsizeiptr RegionSize() const { return m_RegionSize; }
+			GLsizeiptr RegionUsed() const { return m_RegionHead; }
+			// Count of BeginFrame() calls that had to wait for the GPU
+			uint64_t StallCount() const { return m_StallCount; }
+
+			GLBuffer& Buffer() { return m_Buffer; }
+	};
+} // namespace EaseGL
+
+#endif
@@ -4,6 +4,8 @@
 	
 #include <glad/glad.h>
 #include "GLTexture.hpp"
+#include <string>
+#include <vector>
 
 namespace EaseGL
 {
@@ -14,6 +16,19 @@ namespace EaseGL
 			{
 				return GLTexture(TextureType::TEXTURE2D, filepath);
 			}
+			static GLTexture New(const char* filepath, const TextureCreateInfo& createInfo)
+			{
+				GLTexture texture(TextureType::TEXTURE2D, createInfo);
+				texture.LoadTexture(filepath);
+				return texture;
+			}
+			// KTX, KTX2 or DDS with BCn/ETC2 blocks
+			static GLTexture NewCompressed(const char* filepath)
+			{
+				GLTexture texture(TextureType::TEXTURE2D);
+				texture.LoadCompressed(filepath);
+				return texture;
+			}
 			static GLTexture New()
 			{
 				return GLTexture(TextureType::TEXTURE2D);
@@ -21,7 +36,7 @@ namespace EaseGL
 
 			static void Unbind()
 			{
-				glBindTexture(GL_TEXTURE_2D, 0);
+				GLTexture::Unbind(TextureType::TEXTURE2D);
 			}
 
 		private:
@@ -29,5 +44,83 @@ namespace EaseGL
 		public:
 			~Texture2D();
 	};
+
+	struct Texture2DArray
+	{
+		public:
+			// one file per layer, all of the same size
+			static GLTexture New(const std::vector<std::string>& filepaths)
+			{
+				GLTexture texture(TextureType::TEXTURE2D_ARRAY);
+				texture.LoadLayers(filepaths);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE2D_ARRAY);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE2D_ARRAY);
+			}
+
+		private:
+			Texture2DArray();
+		public:
+			~Texture2DArray();
+	};
+
+	struct TextureCubeMap
+	{
+		public:
+			// faces in +X, -X, +Y, -Y, +Z, -Z order
+			static GLTexture New(const std::vector<std::string>& faceFilepaths)
+			{
+				GLTexture texture(TextureType::TEXTURE_CUBE_MAP);
+				texture.LoadLayers(faceFilepaths);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE_CUBE_MAP);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE_CUBE_MAP);
+			}
+
+		private:
+			TextureCubeMap();
+		public:
+			~TextureCubeMap();
+	};
+
+	struct Texture3D
+	{
+		public:
+			// one file per depth slice
+			static GLTexture New(const std::vector<std::string>& sliceFilepaths)
+			{
+				GLTexture texture(TextureType::TEXTURE3D);
+				texture.LoadLayers(sliceFilepaths);
+				return texture;
+			}
+			static GLTexture New()
+			{
+				return GLTexture(TextureType::TEXTURE3D);
+			}
+
+			static void Unbind()
+			{
+				GLTexture::Unbind(TextureType::TEXTURE3D);
+			}
+
+		private:
+			Texture3D();
+		public:
+			~Texture3D();
+	};
 } // namespace EaseGL
 #endif
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "TextureAtlas.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#ifdef STB_IMAGE_IMPLEMENTATION
+   #undef STB_IMAGE_IMPLEMENTATION
+   #include <stb/stb_image.h>
+   #define STB_IMAGE_IMPLEMENTATION
+#else
+   #include <stb/stb_image.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace EaseGL
+{
+   TextureAtlas::TextureAtlas(int pageWidth /* = 2048*/, int pageHeight /* = 2048*/, int padding /* = 2*/)
+      : m_PageWidth(pageWidth), m_PageHeight(pageHeight), m_Padding(padding)
+   {
+   }
+
+   void TextureAtlas::AddPage()
+   {
+      m_Pages.emplace_back();
+      Page& page = m_Pages.back();
+      page.texture.Upload(m_PageWidth, m_PageHeight, 4, nullptr);
+      page.skyline.push_back({ 0, 0, m_PageWidth });
+   }
+
+   // y the rectangle would sit at when its left edge is at skyline node 'index', -1 if it doesn't fit
+   int TextureAtlas::FitSkyline(const Page& page, size_t index, int width, int height) const
+   {
+      int x = page.skyline[index].x;
+      if(x + width > m_PageWidth)
+         return -1;
+
+      int y = 0;
+      int widthLeft = width;
+      for(size_t i = index; widthLeft > 0; i++)
+      {
+         y = std::max(y, page.skyline[i].y);
+         if(y + height > m_PageHeight)
+            return -1;
+         widthLeft -= page.skyline[i].width;
+      }
+      return y;
+   }
+
+   bool TextureAtlas::FindPosition(const Page& page, int width, int height, int& x, int& y) const
+   {
+      // bottom-left: lowest top edge, then leftmost
+      int bestTop = m_PageHeight + 1;
+      for(size_t i = 0; i < page.skyline.size(); i++)
+      {
+         int fitY = FitSkyline(page, i, width, height);
+         if(fitY >= 0 && fitY + height < bestTop)
+         {
+            bestTop = fitY + height;
+            x = page.skyline[i].x;
+            y = fitY;
+         }
+      }
+      return bestTop <= m_PageHeight;
+   }
+
+   void TextureAtlas::AddSkylineLevel(Page& page, int x, int y, int width, int height)
+   {
+      std::vector<SkylineNode>& skyline = page.skyline;
+      int top = y + height;
+      int end = x + width;
+
+      size_t i = 0;
+      while(i < skyline.size() && skyline[i].x + skyline[i].width <= x)
+         i++;
+      if(i < skyline.size() && skyline[i].x < x)
+      {
+         SkylineNode left = { skyline[i].x, skyline[i].y, x - skyline[i].x };
+         skyline[i].x = x;
+         skyline[i].width -= left.width;
+         skyline.insert(skyline.begin() + i, left);
+         i++;
+      }
+
+      // nodes under the new level are replaced, the level never drops below them
+      while(i < skyline.size() && skyline[i].x < end)
+      {
+         top = std::max(top, skyline[i].y);
+         if(skyline[i].x + skyline[i].width <= end)
+            skyline.erase(skyline.begin() + i);
+         else
+         {
+            skyline[i].width -= end - skyline[i].x;
+            skyline[i].x = end;
+            break;
+         }
+      }
+      skyline.insert(skyline.begin() + i, { x, top, width });
+
+      for(size_t j = 1; j < skyline.size();)
+      {
+         if(skyline[j - 1].y == skyline[j].y)
+         {
+            skyline[j - 1].width += skyline[j].width;
+            skyline.erase(skyline.begin() + j);
+         }
+         else
+            j++;
+      }
+   }
+
+   bool TextureAtlas::PackPlacement(const std::string& name, int width, int height, Placement& placement)
+   {
+      int packedWidth = width + m_Padding * 2;
+      int packedHeight = height + m_Padding * 2;
+      if(packedWidth > m_PageWidth || packedHeight > m_PageHeight)
+         return false;
+
+      int x = 0, y = 0;
+      uint32_t pageIndex = 0;
+      while(pageIndex < m_Pages.size() && !FindPosition(m_Pages[pageIndex], packedWidth, packedHeight, x, y))
+         pageIndex++;
+      if(pageIndex == m_Pages.size())
+      {
+         AddPage();
+         x = 0;
+         y = 0;
+      }
+
+      AddSkylineLevel(m_Pages[pageIndex], x, y, packedWidth, packedHeight);
+      placement = { name, pageIndex, x + m_Padding, y + m_Padding, width, height };
+      return true;
+   }
+
+   void TextureAtlas::UploadRegion(const AtlasRegion& region, int channels, const unsigned char* pixels)
+   {
+      int packedWidth = region.width + m_Padding * 2;
+      int packedHeight = region.height + m_Padding * 2;
+
+      // RGBA with the padding filled by clamping to the nearest edge pixel
+      std::vector<unsigned char> extruded((size_t)packedWidth * packedHeight * 4);
+      for(int dy = 0; dy < packedHeight; dy++)
+      {
+         int sy = std::min(std::max(dy - m_Padding, 0), region.height - 1);
+         for(int dx = 0; dx < packedWidth; dx++)
+         {
+            int sx = std::min(std::max(dx - m_Padding, 0), region.width - 1);
+            const unsigned char* src = pixels + ((size_t)sy * region.width + sx) * channels;
+            unsigned char* dst = &extruded[((size_t)dy * packedWidth + dx) * 4];
+            // same expansion as glTexImage2D with GL_RED/GL_RG/GL_RGB
+            dst[0] = src[0];
+            dst[1] = channels >= 2 ? src[1] : 0;
+            dst[2] = channels >= 3 ? src[2] : 0;
+            dst[3] = channels == 4 ? src[3] : 255;
+         }
+      }
+
+      Page& page = m_Pages[region.page];
+      page.texture.SubImage(region.x - m_Padding, region.y - m_Padding, packedWidth, packedHeight, 4, extruded.data());
+      page.dirty = true;
+   }
+
+   int32_t TextureAtlas::Insert(const std::string& name, int width, int height, int channels, const unsigned char* pixels)
+   {
+      if(width <= 0 || height <= 0 || channels < 1 || channels > 4 || pixels == nullptr)
+      {
+         std::cout << "ERROR: Invalid image for texture atlas " << name << std::endl;
+         return -1;
+      }
+
+      // reuse the stored placement if the image still has the same size
+      auto stored = m_PlacementsByName.find(name);
+      size_t placementIndex = stored != m_PlacementsByName.end() ? stored->second : m_Placements.size();
+      if(placementIndex == m_Placements.size()
+         || m_Placements[placementIndex].width != width || m_Placements[placementIndex].height != height)
+      {
+         Placement placement;
+         if(!PackPlacement(name, width, height, placement))
+         {
+            std::cout << "ERROR: " << name << " (" << width << "x" << height << ") doesn't fit in a "
+               << m_PageWidth << "x" << m_PageHeight << " atlas page" << std::endl;
+            return -1;
+         }
+         if(stored != m_PlacementsByName.end())
+            m_Placements[stored->second].name.clear();
+         placementIndex = m_Placements.size();
+         m_Placements.push_back(placement);
+         m_PlacementsByName[name] = placementIndex;
+      }
+
+      int32_t index;
+      auto existing = m_RegionsByName.find(name);
+      if(existing != m_RegionsByName.end())
+         index = existing->second;
+      else
+      {
+         index = (int32_t)m_Regions.size();
+         m_Regions.emplace_back();
+         m_RegionsByName[name] = index;
+      }
+
+      const Placement& placement = m_Placements[placementIndex];
+      AtlasRegion& region = m_Regions[index];
+      region.name = name;
+      region.page = placement.page;
+      region.x = placement.x;
+      region.y = placement.y;
+      region.width = placement.width;
+      region.height = placement.height;
+      region.uvOffset = glm::vec2((float)placement.x / m_PageWidth, (float)placement.y / m_PageHeight);
+      region.uvScale = glm::vec2((float)placement.width / m_PageWidth, (float)placement.height / m_PageHeight);
+
+      UploadRegion(region, channels, pixels);
+      return index;
+   }
+
+   int32_t TextureAtlas::InsertFile(const char* filepath)
+   {
+      int width, height, channels;
+      unsigned char* pixels = stbi_load(filepath, &width, &height, &channels, 0);
+      if(pixels == NULL)
+      {
+         std::cout << "ERROR on loading Texture " << filepath << std::endl;
+         return -1;
+      }
+
+      int32_t index = Insert(filepath, width, height, channels, pixels);
+      stbi_image_free(pixels);
+      return index;
+   }
+
+   void TextureAtlas::InsertFiles(const std::vector<std::string>& filepaths)
+   {
+      struct Image
+      {
+         const std::string* path;
+         unsigned char* pixels;
+         int width, height, channels;
+      };
+      std::vector<Image> images;
+      images.reserve(filepaths.size());
+
+      for(const std::string& path : filepaths)
+      {
+         Image image = { &path, nullptr, 0, 0, 0 };
+         image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+         if(image.pixels == NULL)
+         {
+            std::cout << "ERROR on loading Texture " << path << std::endl;
+            continue;
+         }
+         images.push_back(image);
+      }
+
+      std::stable_sort(images.begin(), images.end(), [](const Image& a, const Image& b) { return a.height > b.height; });
+      for(Image& image : images)
+      {
+         Insert(*image.path, image.width, image.height, image.channels, image.pixels);
+         stbi_image_free(image.pixels);
+      }
+   }
+
+   const AtlasRegion* TextureAtlas::Find(const std::string& name) const
+   {
+      auto it = m_RegionsByName.find(name);
+      return it != m_RegionsByName.end() ? &m_Regions[it->second] : nullptr;
+   }
+
+   void TextureAtlas::GenerateMipmaps()
+   {
+      for(Page& page : m_Pages)
+      {
+         if(!page.dirty)
+            continue;
+         page.texture.GenerateMipmaps();
+         page.dirty = false;
+      }
+   }
+
+   bool TextureAtlas::SaveLayout(const char* filepath) const
+   {
+      std::ofstream file(filepath, std::ios::trunc);
+      if(!file)
+      {
+         std::cout << "ERROR: Failed to write atlas layout " << filepath << std::endl;
+         return false;
+      }
+
+      file << "easegl-atlas 1\n";
+      file << m_PageWidth << ' ' << m_PageHeight << ' ' << m_Padding << ' ' << m_Placements.size() << '\n';
+      // the name goes last so it can contain spaces
+      for(const Placement& placement : m_Placements)
+         file << placement.page << ' ' << placement.x << ' ' << placement.y << ' ' << placement.width << ' ' << placement.height << ' ' << placement.name << '\n';
+      return (bool)file;
+   }
+
+   bool TextureAtlas::LoadLayout(const char* filepath)
+   {
+      if(!m_Placements.empty())
+      {
+         std::cout << "ERROR: TextureAtlas::LoadLayout has to be called before inserting images" << std::endl;
+         return false;
+      }
+
+      std::ifstream file(filepath);
+      std::string magic;
+      int version = 0, pageWidth = 0, pageHeight = 0, padding = 0;
+      size_t count = 0;
+      if(!(file >> magic >> version >> pageWidth >> pageHeight >> padding >> count) || magic != "easegl-atlas" || version != 1)
+         return false;
+
+      // a layout for other page settings would have to be packed again anyway
+      if(pageWidth != m_PageWidth || pageHeight != m_PageHeight || padding != m_Padding)
+         return false;
+
+      // every placement takes at least "0 0 0 0 0\n", a count the rest of the file can't hold is corrupt
+      std::streamoff dataStart = file.tellg();
+      file.seekg(0, std::ios::end);
+      std::streamoff remaining = file.tellg() - dataStart;
+      file.seekg(dataStart);
+      if(remaining < 0 || count > (size_t)remaining / 10)
+         return false;
+
+      // nothing is applied until the whole file checked out
+      std::vector<Placement> placements(count);
+      size_t pageCount = m_Pages.size();
+      for(Placement& placement : placements)
+      {
+         if(!(file >> placement.page >> placement.x >> placement.y >> placement.width >> placement.height))
+            return false;
+         std::getline(file, placement.name);
+         if(!placement.name.empty() && placement.name[0] == ' ')
+            placement.name.erase(0, 1);
+
+         // pages are filled in order, a layout can't skip ahead
+         if(placement.page > pageCount)
+            return false;
+         if(placement.page == pageCount)
+            pageCount++;
+
+         // the padded rectangle has to lie inside the page
+         int64_t left = (int64_t)placement.x - m_Padding, top = (int64_t)placement.y - m_Padding;
+         int64_t right = (int64_t)placement.x + placement.width + m_Padding, bottom = (int64_t)placement.y + placement.height + m_Padding;
+         if(placement.width <= 0 || placement.height <= 0 || left < 0 || top < 0 || right > m_PageWidth || bottom > m_PageHeight)
+            return false;
+      }
+
+      for(size_t i = 0; i < placements.size(); i++)
+      {
+         const Placement& placement = placements[i];
+         while(m_Pages.size() <= placement.page)
+            AddPage();
+         AddSkylineLevel(m_Pages[placement.page], placement.x - m_Padding, placement.y - m_Padding,
+            placement.width + m_Padding * 2, placement.height + m_Padding * 2);
+         if(!placement.name.empty())
+            m_PlacementsByName[placement.name] = i;
+      }
+      m_Placements = std::move(placements);
+      return true;
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,121 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+#pragma once
+
+#include <glad/glad.h>
+#include "GLTexture.hpp"
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace EaseGL
+{
+	struct AtlasRegion
+	{
+		std::string name;
+		uint32_t page = 0;
+		int x = 0, y = 0;          // in pixels, padding excluded
+		int width = 0, height = 0;
+
+		// uv in the image's own 0..1 space -> uv in the page
+		glm::vec2 uvOffset = glm::vec2(0.0f);
+		glm::vec2 uvScale = glm::vec2(1.0f);
+
+		glm::vec2 TransformUV(glm::vec2 uv) const { return uvOffset + uv * uvScale; }
+	};
+
+	/**
+	 * @brief Packs many images into a few RGBA8 pages so sprites can be batched with one texture bound.
+	 * Images are placed with a bottom-left skyline packer, each surrounded by 'padding' pixels that repeat
+	 * its edge pixels so filtering and lower mip levels don't bleed neighbours in.
+	 *
+	 * TextureAtlas atlas(2048, 2048, 2);
+	 * atlas.LoadLayout("sprites.atlas");      // optional, reuses last run's placement
+	 * atlas.InsertFiles({ "a.png", "b.png" }); // packed tallest first
+	 * atlas.GenerateMipmaps();
+	 * atlas.SaveLayout("sprites.atlas");
+	 *
+	 * const AtlasRegion* region = atlas.Find("a.png");
+	 * atlas.GetPage(region->page).Bind();
+	 * uv = region->TransformUV(uv);
+	 *
+	 * Images can be inserted at any time, pages are added when the current ones are full.
+	 */
+	class TextureAtlas
+	{
+		private:
+			struct SkylineNode
+			{
+				int x, y, width;
+			};
+
+			struct Page
+			{
+				GLTexture texture;
+				std::vector<SkylineNode> skyline;
+				bool dirty = false;
+			};
+
+			// every packed rectangle in packing order, replaying them rebuilds the skylines exactly
+			struct Placement
+			{
+				std::string name; // empty once the image moved to another placement
+				uint32_t page;
+				int x, y, width, height;
+			};
+
+			int m_PageWidth, m_PageHeight;
+			int m_Padding;
+			std::vector<Page> m_Pages;
+			std::vector<AtlasRegion> m_Regions;
+			std::unordered_map<std::string, int32_t> m_RegionsByName;
+
+			std::vector<Placement> m_Placements;
+			std::unordered_map<std::string, size_t> m_PlacementsByName;
+
+			void AddPage();
+			int FitSkyline(const Page& page, size_t index, int width, int height) const;
+			bool FindPosition(const Page& page, int width, int height, int& x, int& y) const;
+			void AddSkylineLevel(Page& page, int x, int y, int width, int height);
+			// false if it doesn't fit in an empty page
+			bool PackPlacement(const std::string& name, int width, int height, Placement& placement);
+			void UploadRegion(const AtlasRegion& region, int channels, const unsigned char* pixels);
+		public:
+			TextureAtlas(int pageWidth = 2048, int pageHeight = 2048, int padding = 2);
+
+			TextureAtlas(const TextureAtlas&) = delete;
+			TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+			/**
+			 * @brief Packs and uploads one image with 1-4 channels (expanded like glTexImage2D would).
+			 * @return region index, -1 if it doesn't fit in an empty page. Inserting an existing name replaces its pixels
+			 */
+			int32_t Insert(const std::string& name, int width, int height, int channels, const unsigned char* pixels);
+			/** @brief Decodes with stb_image, the path is the region name */
+			int32_t InsertFile(const char* filepath);
+			/** @brief Decodes all files first and packs them tallest first, which packs tighter than one by one */
+			void InsertFiles(const std::vector<std::string>& filepaths);
+
+			const AtlasRegion* Find(const std::string& name) const;
+			const AtlasRegion& GetRegion(int32_t index) const { return m_Regions[index]; }
+			size_t RegionCount() const { return m_Regions.size(); }
+
+			GLTexture& GetPage(uint32_t page) { return m_Pages[page].texture; }
+			size_t PageCount() const { return m_Pages.size(); }
+
+			/** @brief Regenerates the mipmaps of pages changed since the last call */
+			void GenerateMipmaps();
+
+			/** @brief Writes page size, padding and every placement in insertion order */
+			bool SaveLayout(const char* filepath) const;
+			/**
+			 * @brief Reads a layout written by SaveLayout(). Images inserted afterwards with a stored name and size
+			 * are placed where they were without packing. Has to be called before anything is inserted.
+			 * A file for other page settings, or with placements outside the pages, is rejected as a whole
+			 */
+			bool LoadLayout(const char* filepath);
+	};
+} // namespace EaseGL
+
+#endif
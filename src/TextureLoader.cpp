@@ -0,0 +1,275 @@
+#include "TextureLoader.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+
+#ifdef STB_IMAGE_IMPLEMENTATION
+   #undef STB_IMAGE_IMPLEMENTATION
+   #include <stb/stb_image.h>
+   #define STB_IMAGE_IMPLEMENTATION
+#else
+   #include <stb/stb_image.h>
+#endif
+
+#include "PixelConvert.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace EaseGL
+{
+   TextureLoader::TextureLoader(uint32_t workerCount /* = 0*/, uint32_t pboCount /* = 3*/, GLsizeiptr pboSize /* = 16 * 1024 * 1024*/)
+      : m_InFlight(0), m_PremultiplyAlpha(false), m_Stop(false), m_PboSize(pboSize), m_PboHead(0), m_PboIndex(0)
+   {
+      SetPlaceholderColor(128, 128, 128, 255);
+
+      for(uint32_t i = 0; i < pboCount && pboSize > 0; i++)
+      {
+         m_Pbos.emplace_back(GLBufferType::PIXEL_UNPACK_BUFFER);
+         m_Pbos.back().BufferData(nullptr, (uint32_t)pboSize, GLBufferUsage::STREAM_DRAW);
+      }
+      m_PboFences.assign(m_Pbos.size(), nullptr);
+      // a bound unpack buffer would turn every later client memory upload into an offset
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      if(workerCount == 0)
+      {
+         unsigned int hardwareThreads = std::thread::hardware_concurrency();
+         workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+      }
+      for(uint32_t i = 0; i < workerCount; i++)
+         m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
+   }
+
+   TextureLoader::~TextureLoader()
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         m_Stop = true;
+      }
+      m_JobAvailable.notify_all();
+      for(std::thread& worker : m_Workers)
+         worker.join();
+
+      for(DecodedImage& image : m_Decoded)
+      {
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+      }
+      for(DecodedImage& image : m_Uploads)
+      {
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+      }
+      for(GLsync fence : m_PboFences)
+      {
+         if(fence != nullptr)
+            glDeleteSync(fence);
+      }
+   }
+
+   void TextureLoader::SetPlaceholderColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+   {
+      m_Placeholder[0] = r;
+      m_Placeholder[1] = g;
+      m_Placeholder[2] = b;
+      m_Placeholder[3] = a;
+   }
+
+   std::shared_ptr<GLTexture> TextureLoader::Load(const char* filepath)
+   {
+      return Load(filepath, TextureCreateInfo());
+   }
+
+   std::shared_ptr<GLTexture> TextureLoader::Load(const char* filepath, const TextureCreateInfo& createInfo)
+   {
+      TextureCreateInfo info = createInfo;
+      if(info.format >= TextureFormat::R16F)
+      {
+         std::cout << "ERROR: TextureLoader decodes 8 bit images, " << filepath << " is loaded with an 8 bit format" << std::endl;
+         info.format = TextureFormat::NONE;
+      }
+
+      std::shared_ptr<GLTexture> texture = std::make_shared<GLTexture>(TextureType::TEXTURE2D, info);
+      texture->Upload(1, 1, 4, m_Placeholder);
+
+      m_Stats.requested++;
+      m_InFlight++;
+      {
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         m_Jobs.push_back({ filepath, texture, info });
+      }
+      m_JobAvailable.notify_one();
+      return texture;
+   }
+
+   void TextureLoader::WorkerLoop()
+   {
+      while(true)
+      {
+         Job job;
+         {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobAvailable.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+            if(m_Stop)
+               return;
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+         }
+
+         DecodedImage image = { job.texture, nullptr, {}, 0, 0, 0, {} };
+         // nobody holds the texture anymore, skip the decode
+         if(!job.texture.expired())
+         {
+            image.pixels = stbi_load(job.path.c_str(), &image.width, &image.height, &image.channels, 0);
+            if(image.pixels == nullptr)
+               std::cout << "ERROR on loading Texture " << job.path << std::endl;
+            else
+               ConvertImage(image, job.createInfo);
+         }
+
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         m_Decoded.push_back(std::move(image));
+      }
+   }
+
+   void TextureLoader::ConvertImage(DecodedImage& image, const TextureCreateInfo& createInfo)
+   {
+      size_t pixelCount = (size_t)image.width * image.height;
+      if(image.channels == 3)
+      {
+         image.converted.resize(pixelCount * 4);
+         PixelConvert::RGBToRGBA(image.pixels, image.converted.data(), pixelCount);
+         image.channels = 4;
+         stbi_image_free(image.pixels);
+         image.pixels = nullptr;
+      }
+      else if(image.channels == 4 && m_PremultiplyAlpha)
+         PixelConvert::PremultiplyAlpha(image.pixels, image.pixels, pixelCount);
+
+      // one thread per image, the other workers are busy with their own
+      if(createInfo.mipmaps && createInfo.mipFilter != MipFilter::NONE && pixelCount > 1
+         && MipGenerator::Build(image.Data(), image.width, image.height, image.channels, createInfo.mipFilter,
+            createInfo.IsSRGB(image.channels), image.mips, 1))
+      {
+         // level 0 is in the chain now
+         image.converted = std::vector<unsigned char>();
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+         image.pixels = nullptr;
+      }
+   }
+
+   bool TextureLoader::UploadImage(const DecodedImage& image, GLTexture& texture)
+   {
+      GLsizeiptr size = (GLsizeiptr)image.Size();
+      if(m_Pbos.empty() || size > m_PboSize)
+      {
+         if(!image.mips.levels.empty())
+            texture.UploadMipChain(image.mips);
+         else
+            texture.Upload(image.width, image.height, image.channels, image.Data());
+         m_Stats.directUploads++;
+         return true;
+      }
+
+      if(m_PboHead + size > m_PboSize)
+      {
+         // fence the PBO that is left first, with a single PBO it is also the next one.
+         // A stalled call already fenced it, the retry must not fence it again
+         if(m_PboFences[m_PboIndex] == nullptr)
+            m_PboFences[m_PboIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+         // the next PBO may still be read by uploads from the last time around the ring
+         size_t next = (m_PboIndex + 1) % m_Pbos.size();
+         GLsync& fence = m_PboFences[next];
+         if(fence != nullptr)
+         {
+            if(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+               return false;
+            glDeleteSync(fence);
+            fence = nullptr;
+         }
+
+         m_PboIndex = next;
+         m_PboHead = 0;
+      }
+
+      GLBuffer& pbo = m_Pbos[m_PboIndex];
+      void* pointer = pbo.MapBufferRange(m_PboHead, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      if(pointer == nullptr)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+         if(!image.mips.levels.empty())
+            texture.UploadMipChain(image.mips);
+         else
+            texture.Upload(image.width, image.height, image.channels, image.Data());
+         m_Stats.directUploads++;
+         return true;
+      }
+      memcpy(pointer, image.Data(), size);
+      pbo.UnmapBuffer();
+
+      if(!image.mips.levels.empty())
+         texture.UploadMipChain(image.mips, m_PboHead);
+      else
+         texture.Upload(image.width, image.height, image.channels, (const void*)m_PboHead);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      m_PboHead = ((m_PboHead + size + 15) / 16) * 16;
+      return true;
+   }
+
+   void TextureLoader::Update(double budgetMilliseconds)
+   {
+      auto start = std::chrono::steady_clock::now();
+      {
+         std::lock_guard<std::mutex> lock(m_Mutex);
+         while(!m_Decoded.empty())
+         {
+            m_Uploads.push_back(std::move(m_Decoded.front()));
+            m_Decoded.pop_front();
+         }
+      }
+
+      bool uploadedAny = false;
+      while(!m_Uploads.empty())
+      {
+         std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+         if(uploadedAny && elapsed.count() >= budgetMilliseconds)
+            break;
+
+         DecodedImage& image = m_Uploads.front();
+         std::shared_ptr<GLTexture> texture = image.texture.lock();
+         if(image.Data() != nullptr && texture != nullptr)
+         {
+            if(!UploadImage(image, *texture))
+            {
+               m_Stats.pboStalls++;
+               break;
+            }
+            m_Stats.uploaded++;
+            uploadedAny = true;
+         }
+         else if(texture != nullptr)
+            m_Stats.failed++; // keeps the placeholder
+
+         if(image.pixels != nullptr)
+            stbi_image_free(image.pixels);
+         m_Uploads.pop_front();
+         m_InFlight--;
+      }
+   }
+
+   void TextureLoader::Finish()
+   {
+      while(m_InFlight.load() != 0)
+      {
+         Update(1000.0);
+         if(m_InFlight.load() != 0)
+            std::this_thread::yield();
+      }
+   }
+} // namespace EaseGL
+#endif
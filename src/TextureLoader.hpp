@@ -0,0 +1,139 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+#pragma once
+
+#include <glad/glad.h>
+#include "GLBuffer.hpp"
+#include "GLTexture.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace EaseGL
+{
+	struct TextureLoaderStats
+	{
+		uint32_t requested = 0;
+		uint32_t uploaded = 0;
+		uint32_t failed = 0;
+		uint32_t pboStalls = 0;     // Update() calls that stopped early because the next PBO was still in use
+		uint32_t directUploads = 0; // images larger than a PBO, uploaded from client memory
+	};
+
+	/**
+	 * @brief Decodes image files on worker threads and uploads them on the GL thread under a time budget.
+	 * Load() returns a texture holding a 1x1 placeholder right away, the same GLTexture is
+	 * respecified with the real image once it is uploaded, so it can be bound and drawn at any time
+	 * (with immutable storage that swaps the GL name underneath, don't keep the raw GLuint).
+	 *
+	 * EaseGL::TextureLoader loader;
+	 * std::shared_ptr<EaseGL::GLTexture> albedo = loader.Load("albedo.png");
+	 * while(running)
+	 * {
+	 *    loader.Update(2.0); // at most ~2ms of uploads per frame
+	 *    albedo->Bind();
+	 *    ...
+	 * }
+	 *
+	 * Workers also expand RGB images to RGBA (see PixelConvert), so rows are 4 byte aligned and the
+	 * driver doesn't repack them on the GL thread. They build mip chains too when TextureCreateInfo::mipFilter is set.
+	 * Decoded images are copied into a ring of pixel unpack buffers and uploaded from there, each PBO is
+	 * fenced when the ring moves past it and only reused once the GPU has read it.
+	 * Everything except the worker threads must be called from the GL thread.
+	 */
+	class TextureLoader
+	{
+		private:
+			struct Job
+			{
+				std::string path;
+				std::weak_ptr<GLTexture> texture;
+				TextureCreateInfo createInfo;
+			};
+
+			struct DecodedImage
+			{
+				std::weak_ptr<GLTexture> texture;
+				unsigned char* pixels; // from stb_image
+				std::vector<unsigned char> converted; // replaces 'pixels' when not empty
+				int width, height, channels;
+				MipChain mips; // every level, built on the worker when TextureCreateInfo::mipFilter asks for it
+
+				const unsigned char* Data() const { return !mips.data.empty() ? mips.data.data() : converted.empty() ? pixels : converted.data(); }
+				size_t Size() const { return !mips.data.empty() ? mips.data.size() : (size_t)width * height * channels; }
+			};
+
+			std::vector<std::thread> m_Workers;
+			std::mutex m_Mutex;
+			std::condition_variable m_JobAvailable;
+			std::deque<Job> m_Jobs;
+			std::deque<DecodedImage> m_Decoded;
+			std::atomic<uint32_t> m_InFlight; // queued or decoding or waiting for upload
+			std::atomic<bool> m_PremultiplyAlpha;
+			bool m_Stop;
+
+			// GL thread only
+			std::deque<DecodedImage> m_Uploads;
+			std::vector<GLBuffer> m_Pbos;
+			std::vector<GLsync> m_PboFences;
+			GLsizeiptr m_PboSize;
+			GLintptr m_PboHead;
+			size_t m_PboIndex;
+
+			unsigned char m_Placeholder[4];
+			TextureLoaderStats m_Stats;
+
+			void WorkerLoop();
+			// runs on the workers, brings 'image' into the layout that is uploaded
+			void ConvertImage(DecodedImage& image, const TextureCreateInfo& createInfo);
+			// false if the image has to wait for a PBO
+			bool UploadImage(const DecodedImage& image, GLTexture& texture);
+		public:
+			/**
+			 * @param workerCount decoding threads, 0 uses one less than the hardware threads
+			 * @param pboCount, pboSize ring of pixel unpack buffers, images larger than 'pboSize' are uploaded directly.
+			 *        With a single PBO every wrap waits until the GPU has read it, 0 uploads everything directly
+			 */
+			TextureLoader(uint32_t workerCount = 0, uint32_t pboCount = 3, GLsizeiptr pboSize = 16 * 1024 * 1024);
+			~TextureLoader();
+
+			TextureLoader(const TextureLoader&) = delete;
+			TextureLoader& operator=(const TextureLoader&) = delete;
+
+			/** @brief Queues 'filepath' for decoding, the returned texture shows the placeholder until it is uploaded */
+			std::shared_ptr<GLTexture> Load(const char* filepath);
+			/**
+			 * @brief Same with storage options for the texture. With a TextureCreateInfo::mipFilter the mip chain is
+			 * built on the worker too, images are decoded to 8 bits so 16F formats are not supported
+			 */
+			std::shared_ptr<GLTexture> Load(const char* filepath, const TextureCreateInfo& createInfo);
+
+			/**
+			 * @brief Uploads decoded images until 'budgetMilliseconds' is used up, at least one per call.
+			 * Call once per frame on the GL thread
+			 */
+			void Update(double budgetMilliseconds);
+
+			/** @brief Blocks until every queued texture is uploaded */
+			void Finish();
+
+			// textures that are not uploaded yet
+			uint32_t PendingCount() const { return m_InFlight.load(); }
+			uint32_t WorkerCount() const { return (uint32_t)m_Workers.size(); }
+
+			/** @brief Premultiplies color by alpha on the workers, for images decoded after the call */
+			void SetPremultiplyAlpha(bool enabled) { m_PremultiplyAlpha = enabled; }
+
+			/** @brief Color of textures that are still loading, and of the ones that failed */
+			void SetPlaceholderColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+
+			const TextureLoaderStats& GetStats() const { return m_Stats; }
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,83 @@
+#include "UniformBlock.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+
+namespace EaseGL
+{
+   bool ValidateBlockLayout(GLuint program, BlockLayout layout, const char* blockName, GLuint bindingIndex,
+      const char* const* fieldNames, const size_t* offsets, size_t fieldCount, size_t size)
+   {
+      const char* layoutName = layout == BlockLayout::STD140 ? "std140" : "std430";
+
+      GLint dataSize = 0;
+      std::vector<GLint> linkedOffsets(fieldCount, -1);
+      if(layout == BlockLayout::STD140)
+      {
+         GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+         if(blockIndex == GL_INVALID_INDEX)
+         {
+            std::cout << "ERROR: Uniform block " << blockName << " not found!" << std::endl;
+            return false;
+         }
+         glUniformBlockBinding(program, blockIndex, bindingIndex);
+         glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+
+         std::vector<GLuint> indices(fieldCount, GL_INVALID_INDEX);
+         glGetUniformIndices(program, (GLsizei)fieldCount, fieldNames, indices.data());
+         for(size_t i = 0; i < fieldCount; i++)
+         {
+            if(indices[i] != GL_INVALID_INDEX)
+               glGetActiveUniformsiv(program, 1, &indices[i], GL_UNIFORM_OFFSET, &linkedOffsets[i]);
+         }
+      }
+      else
+      {
+         GLuint blockIndex = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, blockName);
+         if(blockIndex == GL_INVALID_INDEX)
+         {
+            std::cout << "ERROR: Shader storage block " << blockName << " not found!" << std::endl;
+            return false;
+         }
+         glShaderStorageBlockBinding(program, blockIndex, bindingIndex);
+
+         const GLenum dataSizeProperty = GL_BUFFER_DATA_SIZE;
+         glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, blockIndex, 1, &dataSizeProperty, 1, NULL, &dataSize);
+
+         const GLenum offsetProperty = GL_OFFSET;
+         for(size_t i = 0; i < fieldCount; i++)
+         {
+            GLuint index = glGetProgramResourceIndex(program, GL_BUFFER_VARIABLE, fieldNames[i]);
+            if(index != GL_INVALID_INDEX)
+               glGetProgramResourceiv(program, GL_BUFFER_VARIABLE, index, 1, &offsetProperty, 1, NULL, &linkedOffsets[i]);
+         }
+      }
+
+      bool valid = true;
+      for(size_t i = 0; i < fieldCount; i++)
+      {
+         if(linkedOffsets[i] == -1)
+         {
+            std::cout << "ERROR: Block " << blockName << " has no field " << fieldNames[i] << std::endl;
+            valid = false;
+         }
+         else if((size_t)linkedOffsets[i] != offsets[i])
+         {
+            std::cout << "ERROR: Block " << blockName << " field " << fieldNames[i] << " is at offset " << linkedOffsets[i]
+               << " but " << layoutName << " layout puts it at " << offsets[i] << std::endl;
+            valid = false;
+         }
+      }
+
+      if((size_t)dataSize > size)
+      {
+         std::cout << "ERROR: Block " << blockName << " is " << dataSize << " bytes but its " << layoutName
+            << " layout only has " << size << " bytes" << std::endl;
+         valid = false;
+      }
+      return valid;
+   }
+} // namespace EaseGL
+#endif
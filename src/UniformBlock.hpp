@@ -0,0 +1,263 @@
+#ifndef UNIFORMBLOCK_H
+#define UNIFORMBLOCK_H
+#pragma once
+
+#include <glad/glad.h>
+#include "GLBuffer.hpp"
+#include "Shader.hpp"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+
+namespace EaseGL
+{
+	enum class BlockLayout
+	{
+		STD140, // uniform blocks
+		STD430, // shader storage blocks
+	};
+
+	constexpr size_t AlignBlockOffset(size_t offset, size_t alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	 * @brief Base alignment, size and CPU -> GPU copy of a field type.
+	 * Specialized for 32 bit scalars, glm vectors, glm matrices and arrays of them.
+	 */
+	template<typename T>
+	struct BlockFieldTraits;
+
+	template<typename T>
+	struct BlockScalarTraits
+	{
+		static_assert(sizeof(T) == 4, "block scalars have to be 32 bit, use int32_t instead of bool");
+
+		static constexpr size_t Alignment(BlockLayout) { return 4; }
+		static constexpr size_t Size(BlockLayout) { return 4; }
+		static void Write(unsigned char* destination, const T& value, BlockLayout) { memcpy(destination, &value, 4); }
+	};
+
+	template<> struct BlockFieldTraits<float> : BlockScalarTraits<float> {};
+	template<> struct BlockFieldTraits<int32_t> : BlockScalarTraits<int32_t> {};
+	template<> struct BlockFieldTraits<uint32_t> : BlockScalarTraits<uint32_t> {};
+
+	template<glm::length_t L, typename T, glm::qualifier Q>
+	struct BlockFieldTraits<glm::vec<L, T, Q>>
+	{
+		static_assert(sizeof(T) == 4, "block vectors have to have 32 bit components");
+
+		// vec3 is aligned like vec4 but only takes 12 bytes
+		static constexpr size_t Alignment(BlockLayout) { return L == 1 ? 4 : L == 2 ? 8 : 16; }
+		static constexpr size_t Size(BlockLayout) { return L * 4; }
+		static void Write(unsigned char* destination, const glm::vec<L, T, Q>& value, BlockLayout) { memcpy(destination, &value[0], L * 4); }
+	};
+
+	// Matrices are laid out as an array of column vectors
+	template<glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+	struct BlockFieldTraits<glm::mat<C, R, T, Q>>
+	{
+		typedef BlockFieldTraits<glm::vec<R, T, Q>> ColumnTraits;
+
+		static constexpr size_t ColumnStride(BlockLayout layout)
+		{
+			return layout == BlockLayout::STD140 ? AlignBlockOffset(ColumnTraits::Alignment(layout), 16) : ColumnTraits::Alignment(layout);
+		}
+		static constexpr size_t Alignment(BlockLayout layout) { return ColumnStride(layout); }
+		static constexpr size_t Size(BlockLayout layout) { return C * ColumnStride(layout); }
+		static void Write(unsigned char* destination, const glm::mat<C, R, T, Q>& value, BlockLayout layout)
+		{
+			for(glm::length_t column = 0; column < C; column++)
+				memcpy(destination + column * ColumnStride(layout), &value[column][0], R * 4);
+		}
+	};
+
+	// std140 rounds array element alignment and stride up to 16 bytes, std430 doesn't
+	template<typename T, size_t N>
+	struct BlockArrayTraits
+	{
+		typedef BlockFieldTraits<T> ElementTraits;
+
+		static constexpr size_t Alignment(BlockLayout layout)
+		{
+			return layout == BlockLayout::STD140 ? AlignBlockOffset(ElementTraits::Alignment(layout), 16) : ElementTraits::Alignment(layout);
+		}
+		static constexpr size_t Stride(BlockLayout layout) { return AlignBlockOffset(ElementTraits::Size(layout), Alignment(layout)); }
+		static constexpr size_t Size(BlockLayout layout) { return N * Stride(layout); }
+
+		template<typename Array>
+		static void WriteArray(unsigned char* destination, const Array& value, BlockLayout layout)
+		{
+			for(size_t i = 0; i < N; i++)
+				ElementTraits::Write(destination + i * Stride(layout), value[i], layout);
+		}
+	};
+
+	template<typename T, size_t N>
+	struct BlockFieldTraits<T[N]> : BlockArrayTraits<T, N>
+	{
+		static void Write(unsigned char* destination, const T (&value)[N], BlockLayout layout) { BlockArrayTraits<T, N>::WriteArray(destination, value, layout); }
+	};
+
+	template<typename T, size_t N>
+	struct BlockFieldTraits<std::array<T, N>> : BlockArrayTraits<T, N>
+	{
+		static void Write(unsigned char* destination, const std::array<T, N>& value, BlockLayout layout) { BlockArrayTraits<T, N>::WriteArray(destination, value, layout); }
+	};
+
+	template<BlockLayout L, typename... Fields>
+	constexpr std::array<size_t, sizeof...(Fields)> ComputeBlockOffsets()
+	{
+		const size_t alignments[] = { BlockFieldTraits<Fields>::Alignment(L)... };
+		const size_t sizes[] = { BlockFieldTraits<Fields>::Size(L)... };
+
+		std::array<size_t, sizeof...(Fields)> offsets = {};
+		size_t offset = 0;
+		for(size_t i = 0; i < sizeof...(Fields); i++)
+		{
+			offset = AlignBlockOffset(offset, alignments[i]);
+			offsets[i] = offset;
+			offset += sizes[i];
+		}
+		return offsets;
+	}
+
+	template<BlockLayout L, typename... Fields>
+	constexpr size_t ComputeBlockSize()
+	{
+		const size_t alignments[] = { BlockFieldTraits<Fields>::Alignment(L)... };
+		const size_t sizes[] = { BlockFieldTraits<Fields>::Size(L)... };
+
+		size_t offset = 0;
+		size_t blockAlignment = L == BlockLayout::STD140 ? 16 : 4;
+		for(size_t i = 0; i < sizeof...(Fields); i++)
+		{
+			offset = AlignBlockOffset(offset, alignments[i]) + sizes[i];
+			blockAlignment = alignments[i] > blockAlignment ? alignments[i] : blockAlignment;
+		}
+		return AlignBlockOffset(offset, blockAlignment);
+	}
+
+	/**
+	 * @brief Field description of a uniform/shader storage block, offsets and size are computed at compile time
+	 * 
+	 * typedef UniformLayout<BlockLayout::STD140, glm::mat4, glm::mat4, glm::vec3, float> CameraLayout;
+	 * static_assert(CameraLayout::Offsets[3] == 140);
+	 */
+	template<BlockLayout L, typename... Fields>
+	struct UniformLayout
+	{
+		static_assert(sizeof...(Fields) > 0, "UniformLayout needs at least one field");
+
+		static constexpr BlockLayout Layout = L;
+		static constexpr size_t FieldCount = sizeof...(Fields);
+
+		template<size_t I>
+		using FieldType = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+		static constexpr std::array<size_t, sizeof...(Fields)> Offsets = ComputeBlockOffsets<L, Fields...>();
+		static constexpr std::array<size_t, sizeof...(Fields)> Sizes = { BlockFieldTraits<Fields>::Size(L)... };
+		static constexpr size_t Size = ComputeBlockSize<L, Fields...>();
+	};
+
+	/**
+	 * @brief Compares 'offsets' with the offsets the linker assigned and sets the block's binding index.
+	 * Used by UniformBlock::Attach
+	 */
+	bool ValidateBlockLayout(GLuint program, BlockLayout layout, const char* blockName, GLuint bindingIndex,
+		const char* const* fieldNames, const size_t* offsets, size_t fieldCount, size_t size);
+
+	/**
+	 * @brief Typed uniform (STD140) or shader storage (STD430) block, Upload() only sends fields that changed
+	 * 
+	 * UniformBlock<CameraLayout> camera;
+	 * camera.Attach(shader, "Camera", 0, { "u_View", "u_Projection", "u_CameraPosition", "u_Time" });
+	 * 
+	 * camera.Set<0>(view);
+	 * camera.Set<3>(time);
+	 * camera.Upload();
+	 * camera.Bind(0);
+	 */
+	template<typename Layout>
+	class UniformBlock  
+	{
+		private:
+			static_assert(Layout::FieldCount <= 64, "UniformBlock supports up to 64 fields");
+
+			GLBuffer m_Buffer;
+			std::array<unsigned char, Layout::Size> m_Data;
+			uint64_t m_DirtyFields;
+			bool m_Allocated;
+		public:
+			UniformBlock()
+				: m_Buffer(Layout::Layout == BlockLayout::STD140 ? GLBufferType::UNIFORM_BUFFER : GLBufferType::SHADER_STORAGE_BUFFER),
+				m_Data(), m_DirtyFields(0), m_Allocated(false)
+			{
+			}
+
+			template<size_t I>
+			void Set(const typename Layout::template FieldType<I>& value)
+			{
+				constexpr size_t offset = Layout::Offsets[I];
+				constexpr size_t size = Layout::Sizes[I];
+
+				unsigned char field[size] = {};
+				BlockFieldTraits<typename Layout::template FieldType<I>>::Write(field, value, Layout::Layout);
+				if(memcmp(m_Data.data() + offset, field, size) != 0)
+				{
+					memcpy(m_Data.data() + offset, field, size);
+					m_DirtyFields |= (uint64_t)1 << I;
+				}
+			}
+
+			/**
+			 * @brief Uploads changed fields, neighbouring changed fields are sent with a single call
+			 */
+			void Upload()
+			{
+				if(!m_Allocated)
+				{
+					m_Buffer.BufferData(m_Data.data(), (uint32_t)Layout::Size, GLBufferUsage::DYNAMIC_DRAW);
+					m_Allocated = true;
+					m_DirtyFields = 0;
+					return;
+				}
+
+				for(size_t i = 0; i < Layout::FieldCount && m_DirtyFields != 0; i++)
+				{
+					if((m_DirtyFields & ((uint64_t)1 << i)) == 0)
+						continue;
+
+					size_t first = i;
+					while(i + 1 < Layout::FieldCount && (m_DirtyFields & ((uint64_t)1 << (i + 1))) != 0)
+						i++;
+
+					size_t begin = Layout::Offsets[first];
+					size_t end = Layout::Offsets[i] + Layout::Sizes[i];
+					m_Buffer.BufferSubData(m_Data.data() + begin, begin, end - begin);
+				}
+				m_DirtyFields = 0;
+			}
+
+			/**
+			 * @brief Checks the C++ layout against the linked program and assigns 'bindingIndex' to the block
+			 * 
+			 * @param fieldNames names as seen by glGetUniformIndices, prefixed with the instance name if the block has one
+			 * @return false if the block or a field is missing or an offset doesn't match
+			 */
+			bool Attach(const Shader& shader, const char* blockName, GLuint bindingIndex, const std::array<const char*, Layout::FieldCount>& fieldNames)
+			{
+				return ValidateBlockLayout(shader, Layout::Layout, blockName, bindingIndex,
+					fieldNames.data(), Layout::Offsets.data(), Layout::FieldCount, Layout::Size);
+			}
+
+			void Bind(GLuint bindingIndex) { m_Buffer.BindBufferBase(bindingIndex); }
+
+			GLBuffer& Buffer() { return m_Buffer; }
+	};
+} // namespace EaseGL
+
+#endif
@@ -0,0 +1,172 @@
+#include "UploadQueue.hpp"
+
+#ifdef EASEGL_IMPLEMENTATION
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+
+namespace EaseGL
+{
+   UploadQueue::UploadQueue()
+      : m_StagingBuffer(GLBufferType::ARRAY_BUFFER), m_UseStagingCopy(false), m_MergeGap(0)
+   {
+   }
+
+   UploadQueue::~UploadQueue()
+   {
+   }
+
+   void UploadQueue::Record(const GLBuffer& buffer, GLintptr offset, const void* data, GLsizeiptr size)
+   {
+      if(size <= 0)
+         return;
+
+      Range range;
+      range.buffer = buffer;
+      range.mirror = nullptr;
+      range.offset = offset;
+      range.size = size;
+      range.stagingOffset = m_Staging.size();
+      range.sequence = (uint32_t)m_Ranges.size();
+      m_Ranges.push_back(range);
+
+      m_Staging.insert(m_Staging.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+
+      m_Stats.rangesRecorded++;
+      m_Stats.bytesRecorded += size;
+   }
+
+   void UploadQueue::MarkDirty(const GLBuffer& buffer, const void* mirror, GLintptr offset, GLsizeiptr size)
+   {
+      if(size <= 0)
+         return;
+
+      Range range;
+      range.buffer = buffer;
+      range.mirror = (const unsigned char*)mirror;
+      range.offset = offset;
+      range.size = size;
+      range.stagingOffset = 0;
+      range.sequence = (uint32_t)m_Ranges.size();
+      m_Ranges.push_back(range);
+
+      m_Stats.rangesRecorded++;
+      m_Stats.bytesRecorded += size;
+   }
+
+   void UploadQueue::PackSpan(const Span& span, const std::vector<uint32_t>& ranges, const unsigned char* mirror)
+   {
+      unsigned char* destination = m_Packed.data() + span.packedOffset;
+      if(mirror != nullptr)
+      {
+         memcpy(destination, mirror + span.offset, span.size);
+         return;
+      }
+
+      // ranges are sorted by offset, overlapping bytes have to be written in recording order
+      if(ranges.size() > 1)
+      {
+         m_SpanRanges = ranges;
+         std::sort(m_SpanRanges.begin(), m_SpanRanges.end(), [this](uint32_t a, uint32_t b) {
+            return m_Ranges[a].sequence < m_Ranges[b].sequence;
+         });
+      }
+      const std::vector<uint32_t>& ordered = ranges.size() > 1 ? m_SpanRanges : ranges;
+
+      for(uint32_t index : ordered)
+      {
+         const Range& range = m_Ranges[index];
+         memcpy(destination + (range.offset - span.offset), m_Staging.data() + range.stagingOffset, range.size);
+      }
+   }
+
+   void UploadQueue::Flush()
+   {
+      if(m_Ranges.empty())
+         return;
+
+      m_SortedRanges.resize(m_Ranges.size());
+      for(uint32_t i = 0; i < m_SortedRanges.size(); i++)
+         m_SortedRanges[i] = i;
+
+      std::sort(m_SortedRanges.begin(), m_SortedRanges.end(), [this](uint32_t a, uint32_t b) {
+         const Range& left = m_Ranges[a];
+         const Range& right = m_Ranges[b];
+         if(left.buffer != right.buffer)
+            return left.buffer < right.buffer;
+         if(left.mirror != right.mirror)
+            return left.mirror < right.mirror;
+         if(left.offset != right.offset)
+            return left.offset < right.offset;
+         return left.sequence < right.sequence;
+      });
+
+      // merge sorted ranges into spans and pack their bytes
+      m_Spans.clear();
+      m_Packed.clear();
+      size_t i = 0;
+      while(i < m_SortedRanges.size())
+      {
+         const Range& first = m_Ranges[m_SortedRanges[i]];
+         GLsizeiptr gap = first.mirror != nullptr ? m_MergeGap : 0;
+
+         Span span;
+         span.buffer = first.buffer;
+         span.offset = first.offset;
+         GLintptr end = first.offset + first.size;
+
+         m_MergedRanges.clear();
+         m_MergedRanges.push_back(m_SortedRanges[i]);
+         i++;
+
+         while(i < m_SortedRanges.size())
+         {
+            const Range& next = m_Ranges[m_SortedRanges[i]];
+            if(next.buffer != first.buffer || next.mirror != first.mirror || next.offset > end + gap)
+               break;
+
+            end = std::max(end, (GLintptr)(next.offset + next.size));
+            m_MergedRanges.push_back(m_SortedRanges[i]);
+            i++;
+         }
+
+         span.size = end - span.offset;
+         span.packedOffset = m_Packed.size();
+         m_Packed.resize(m_Packed.size() + span.size);
+         PackSpan(span, m_MergedRanges, first.mirror);
+         m_Spans.push_back(span);
+
+         m_Stats.rangesUploaded++;
+         m_Stats.bytesUploaded += span.size;
+      }
+
+      if(m_UseStagingCopy)
+      {
+         // glBufferData also orphans last frame's staging storage, so there is no need to wait on it
+         glBindBuffer(GL_COPY_READ_BUFFER, m_StagingBuffer);
+         glBufferData(GL_COPY_READ_BUFFER, m_Packed.size(), m_Packed.data(), GL_STREAM_DRAW);
+         m_Stats.glCalls += 2;
+      }
+
+      GLuint boundBuffer = 0;
+      for(const Span& span : m_Spans)
+      {
+         if(span.buffer != boundBuffer)
+         {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, span.buffer);
+            boundBuffer = span.buffer;
+            m_Stats.glCalls++;
+         }
+
+         if(m_UseStagingCopy)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, span.packedOffset, span.offset, span.size);
+         else
+            glBufferSubData(GL_COPY_WRITE_BUFFER, span.offset, span.size, m_Packed.data() + span.packedOffset);
+         m_Stats.glCalls++;
+      }
+
+      m_Ranges.clear();
+      m_Staging.clear();
+   }
+} // namespace EaseGL
+#endif
@@ -0,0 +1,104 @@
+#ifndef UPLOADQUEUE_H
+#define UPLOADQUEUE_H
+#pragma once
+
+#include <glad/glad.h>
+#include "GLBuffer.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace EaseGL
+{
+	struct UploadQueueStats
+	{
+		uint64_t rangesRecorded = 0;
+		uint64_t rangesUploaded = 0; // after merging
+		uint64_t glCalls = 0;        // binds, uploads and copies issued by Flush()
+		uint64_t bytesRecorded = 0;
+		uint64_t bytesUploaded = 0;  // includes gap bytes of merged MarkDirty() ranges
+	};
+
+	/**
+	 * @brief Defers buffer updates to a single Flush() per frame.
+	 * Overlapping and adjacent ranges of the same buffer are merged into a single upload.
+	 * 
+	 * Record() copies the data into a CPU staging arena right away.
+	 * MarkDirty() only remembers a range of 'mirror', a CPU copy of the whole buffer that has to stay
+	 * alive until Flush(). Since gap bytes can be read from the mirror, MarkDirty() ranges that are
+	 * at most SetMergeGap() bytes apart are merged too.
+	 * 
+	 * Record() and MarkDirty() ranges of the same buffer shouldn't overlap in the same frame,
+	 * Record() ranges are uploaded first.
+	 */
+	class UploadQueue  
+	{
+		private:
+			struct Range
+			{
+				GLuint buffer;
+				const unsigned char* mirror; // nullptr for Record() ranges
+				GLintptr offset;
+				GLsizeiptr size;
+				size_t stagingOffset;
+				uint32_t sequence;
+			};
+
+			struct Span
+			{
+				GLuint buffer;
+				GLintptr offset;
+				GLsizeiptr size;
+				size_t packedOffset;
+			};
+
+			std::vector<Range> m_Ranges;
+			std::vector<unsigned char> m_Staging;
+
+			// merged spans packed back to back, uploaded with one call when staging copy is used
+			std::vector<Span> m_Spans;
+			std::vector<unsigned char> m_Packed;
+			std::vector<uint32_t> m_SortedRanges;
+			std::vector<uint32_t> m_MergedRanges;
+			std::vector<uint32_t> m_SpanRanges;
+
+			GLBuffer m_StagingBuffer;
+			bool m_UseStagingCopy;
+			GLsizeiptr m_MergeGap;
+
+			UploadQueueStats m_Stats;
+
+			void PackSpan(const Span& span, const std::vector<uint32_t>& ranges, const unsigned char* mirror);
+		public:
+			UploadQueue();
+			~UploadQueue();
+
+			UploadQueue(const UploadQueue&) = delete;
+			UploadQueue& operator=(const UploadQueue&) = delete;
+
+			void Record(const GLBuffer& buffer, GLintptr offset, const void* data, GLsizeiptr size);
+			void MarkDirty(const GLBuffer& buffer, const void* mirror, GLintptr offset, GLsizeiptr size);
+
+			/**
+			 * @brief Uploads all recorded ranges and clears the queue
+			 */
+			void Flush();
+
+			/**
+			 * @param bytes MarkDirty() ranges that are at most 'bytes' apart are uploaded as one range
+			 */
+			void SetMergeGap(GLsizeiptr bytes) { m_MergeGap = bytes; }
+			/**
+			 * @brief When enabled, Flush() uploads everything into one staging buffer with a single call
+			 * and then copies each range with glCopyBufferSubData, instead of a glBufferSubData per range
+			 */
+			void SetStagingCopy(bool enabled) { m_UseStagingCopy = enabled; }
+
+			size_t PendingRanges() const { return m_Ranges.size(); }
+
+			const UploadQueueStats& Stats() const { return m_Stats; }
+			void ResetStats() { m_Stats = UploadQueueStats(); }
+	};
+} // namespace EaseGL
+
+#endif
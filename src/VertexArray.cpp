@@ -11,10 +11,38 @@ namespace EaseGL
    VertexArray::VertexArray()
       : m_VertexArrayID(0)
    {
-      glGenVertexArrays(1, &m_VertexArrayID);
+      m_Handle = GLObjectPool::Create(GLObjectType::VERTEX_ARRAY);
+      m_VertexArrayID = GLObjectPool::Name(m_Handle);
       glBindVertexArray(m_VertexArrayID);
    }
 
+   VertexArray::VertexArray(VertexArray&& other) noexcept
+      : m_VertexArrayID(other.m_VertexArrayID), m_Handle(other.m_Handle),
+      m_AttributeSizeInBytes(other.m_AttributeSizeInBytes), m_UsedAttributes(std::move(other.m_UsedAttributes))
+   {
+      other.m_VertexArrayID = 0;
+      other.m_Handle = GLHandle();
+      other.m_AttributeSizeInBytes = 0;
+   }
+
+   VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+   {
+      if(this != &other)
+      {
+         GLObjectPool::Destroy(m_Handle);
+
+         m_VertexArrayID = other.m_VertexArrayID;
+         m_Handle = other.m_Handle;
+         m_AttributeSizeInBytes = other.m_AttributeSizeInBytes;
+         m_UsedAttributes = std::move(other.m_UsedAttributes);
+
+         other.m_VertexArrayID = 0;
+         other.m_Handle = GLHandle();
+         other.m_AttributeSizeInBytes = 0;
+      }
+      return *this;
+   }
+
    // static
    VertexArray VertexArray::New() 
    {
@@ -23,8 +51,7 @@ namespace EaseGL
       
    VertexArray::~VertexArray()
    {
-      if(m_VertexArrayID != 0)
-         glDeleteVertexArrays(1, &m_VertexArrayID);
+      GLObjectPool::Destroy(m_Handle);
    }
 
    void VertexArray::Bind() const
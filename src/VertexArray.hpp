@@ -3,6 +3,7 @@
 #pragma once
 
 #include <glad/glad.h>
+#include "GLObjectPool.hpp"
 #include <vector>
 
 namespace EaseGL
@@ -20,6 +21,7 @@ namespace EaseGL
 		private:
 
 			GLuint m_VertexArrayID;
+			GLHandle m_Handle;
 		public:
 			VertexArray();
 			// creating a vertex array automatically binds it
@@ -28,6 +30,13 @@ namespace EaseGL
 
 			~VertexArray();
 
+			VertexArray(const VertexArray&) = delete;
+			VertexArray& operator=(const VertexArray&) = delete;
+			VertexArray(VertexArray&& other) noexcept;
+			VertexArray& operator=(VertexArray&& other) noexcept;
+
+			GLHandle Handle() const { return m_Handle; }
+
 			void Bind() const;
 			static void Unbind();
 
@@ -28,8 +28,28 @@
  * EaseGL::GLBuffer buffer = IndexBuffer::New();
  * 
  * EaseGL::GLTexture texture = Texture2D::New();
+ * EaseGL::TextureCreateInfo createInfo; createInfo.format = EaseGL::TextureFormat::RGBA16F; Texture2D::New("sky.hdr", createInfo);
+ * EaseGL::GLTexture::GetMemoryStats().cpuBytes; // decoded pixels still in RAM, see TextureCreateInfo::residency
+ * texture.Update({ x, y, width, height }, pixels); // per frame updates through a ring of PBOs, see TextureCreateInfo::updateBuffers
+ * shader.Uniform("u_Texture", texture, EaseGL::SamplerDesc::Anisotropic(8.0f), 0); // shared GL sampler objects, see SamplerCache
+ * EaseGL::GLTexture tiles = Texture2DArray::New({ "grass.png", "dirt.png" }); tiles.SubImageLayer(1, 0, 0, w, h, 4, pixels);
+ * EaseGL::GLTexture compressed = Texture2D::NewCompressed("texture.ktx2");
+ * EaseGL::GLTexture::BindTextures(0, { &albedo, &normal }); // redundant binds are skipped, see GLContext::GetTextureBindingStats()
+ * EaseGL::TextureLoader loader; std::shared_ptr<EaseGL::GLTexture> async = loader.Load("texture.png"); loader.Update(2.0);
+ * EaseGL::TextureAtlas atlas; atlas.InsertFiles({ "a.png", "b.png" }); atlas.Find("a.png")->TransformUV(uv);
+ * EaseGL::PixelConvert::RGBToRGBA(rgb, rgba, pixelCount); // SIMD when available, see PixelConvert::Backend()
+ * EaseGL::TextureCreateInfo info; info.mipFilter = EaseGL::MipFilter::KAISER; // CPU mip chain, MipGenerator::SetCacheDirectory("cache/mips")
  * 
  * EaseGL::Shader
+ * EaseGL::ProgramBinaryCache::SetDirectory("cache/shaders");
+ * std::shared_ptr<EaseGL::Shader> shared = EaseGL::ShaderRegistry::Load("shader.glsl");
+ * EaseGL::ShaderBatch batch; batch.Add("shader.glsl"); batch.Poll();
+ * EaseGL::ShaderVariants variants("shader.glsl", { "KEYWORD" }); variants.Get(variants.Mask({ "KEYWORD" }));
+ * 
+ * EaseGL::StreamBuffer stream(GLBufferType::ARRAY_BUFFER, regionSize);
+ * EaseGL::BufferArena arena(GLBufferType::ARRAY_BUFFER, pageSize);
+ * 
+ * EaseGL::UniformBlock<UniformLayout<BlockLayout::STD140, glm::mat4, glm::vec3>> block;
  */
 
 